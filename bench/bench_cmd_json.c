@@ -0,0 +1,170 @@
+/**
+ * @file bench_cmd_json.c
+ * @brief Command server parse/format benchmark: legacy strstr path vs sls_json
+ *
+ * Both paths turn one request line into one reply line, which is the work
+ * handle_command does per command. Build with `make bench`.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cmd_protocol.h"
+
+#define ITERATIONS 2000000
+
+static const char *const k_lines[] = {
+    "{\"cmd\":\"status\"}",
+    "{\"cmd\":\"go\"}",
+    "{\"cmd\":\"set_throttle\",\"value\":75}",
+    "{\"cmd\":\"nogo\",\"id\":42}",
+    "{ \"id\": 7, \"cmd\": \"set_throttle\", \"value\": 60, \"source\": \"gui\" }",
+    "{\"cmd\":\"abort\"}",
+};
+#define NUM_LINES (sizeof(k_lines) / sizeof(k_lines[0]))
+
+static int g_go = 0;
+static int g_throttle = 0;
+
+// Verbatim copy of the pre-sls_json handle_command for comparison
+static void legacy_handle_command(const char *line, char *out, size_t out_sz)
+{
+    if (strstr(line, "\"status\""))
+    {
+        snprintf(out, out_sz, "{\"type\":\"status\",\"go\":%s,\"throttle\":%d}\n",
+                 g_go ? "true" : "false", g_throttle);
+        return;
+    }
+    if (strstr(line, "\"go\""))
+    {
+        g_go = 1;
+        snprintf(out, out_sz, "{\"type\":\"ack\",\"cmd\":\"go\"}\n");
+        return;
+    }
+    if (strstr(line, "\"nogo\""))
+    {
+        g_go = 0;
+        snprintf(out, out_sz, "{\"type\":\"ack\",\"cmd\":\"nogo\"}\n");
+        return;
+    }
+    if (strstr(line, "\"abort\""))
+    {
+        g_go = 0;
+        g_throttle = 0;
+        snprintf(out, out_sz, "{\"type\":\"ack\",\"cmd\":\"abort\"}\n");
+        return;
+    }
+    if (strstr(line, "\"set_throttle\""))
+    {
+        const char *v = strstr(line, "\"value\"");
+        if (v)
+        {
+            int val = atoi(v + 8);
+            g_throttle = val < 0 ? 0 : (val > 100 ? 100 : val);
+            snprintf(out, out_sz, "{\"type\":\"ack\",\"cmd\":\"set_throttle\",\"value\":%d}\n",
+                     g_throttle);
+        }
+        else
+        {
+            snprintf(out, out_sz, "{\"type\":\"error\",\"msg\":\"missing value\"}\n");
+        }
+        return;
+    }
+    snprintf(out, out_sz, "{\"type\":\"error\",\"msg\":\"unknown cmd\"}\n");
+}
+
+static void json_handle_command(const char *line, size_t len, char *out, size_t out_sz)
+{
+    cmd_request_t req;
+    int rc = cmd_parse_request(line, len, &req);
+    if (rc != CMD_PARSE_OK)
+    {
+        cmd_format_error(out, out_sz, &req, cmd_parse_status_string(rc));
+        return;
+    }
+    switch (req.type)
+    {
+    case CMD_REQ_STATUS:
+        cmd_format_status(out, out_sz, &req, g_go, g_throttle);
+        return;
+    case CMD_REQ_GO:
+        g_go = 1;
+        break;
+    case CMD_REQ_NOGO:
+        g_go = 0;
+        break;
+    case CMD_REQ_ABORT:
+        g_go = 0;
+        g_throttle = 0;
+        break;
+    case CMD_REQ_SET_THROTTLE:
+        req.value = req.value < 0 ? 0 : (req.value > 100 ? 100 : req.value);
+        g_throttle = (int)req.value;
+        break;
+    default:
+        break;
+    }
+    cmd_format_ack(out, out_sz, &req);
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+int main(void)
+{
+    char out[512];
+    size_t lens[NUM_LINES];
+    size_t sink = 0;
+
+    for (size_t i = 0; i < NUM_LINES; i++)
+    {
+        lens[i] = strlen(k_lines[i]);
+    }
+
+    // Warm up caches and branch predictors
+    for (int i = 0; i < ITERATIONS / 10; i++)
+    {
+        legacy_handle_command(k_lines[i % NUM_LINES], out, sizeof(out));
+        json_handle_command(k_lines[i % NUM_LINES], lens[i % NUM_LINES], out, sizeof(out));
+    }
+
+    double t0 = now_ns();
+    for (int i = 0; i < ITERATIONS; i++)
+    {
+        legacy_handle_command(k_lines[i % NUM_LINES], out, sizeof(out));
+        sink += (unsigned char)out[8];
+    }
+    double t1 = now_ns();
+    for (int i = 0; i < ITERATIONS; i++)
+    {
+        json_handle_command(k_lines[i % NUM_LINES], lens[i % NUM_LINES], out, sizeof(out));
+        sink += (unsigned char)out[8];
+    }
+    double t2 = now_ns();
+
+    double legacy_ns = (t1 - t0) / ITERATIONS;
+    double json_ns = (t2 - t1) / ITERATIONS;
+
+    printf("cmd_server request handling (%d iterations, %zu line mix)\n",
+           ITERATIONS, NUM_LINES);
+    printf("  legacy strstr/snprintf : %8.1f ns/op  %10.0f ops/s\n", legacy_ns, 1e9 / legacy_ns);
+    printf("  sls_json parse/format  : %8.1f ns/op  %10.0f ops/s\n", json_ns, 1e9 / json_ns);
+    printf("  speedup                : %8.2fx\n", legacy_ns / json_ns);
+
+    // Correctness difference on a line that merely mentions "go"
+    const char *tricky = "{\"cmd\":\"set_throttle\",\"value\":40,\"note\":\"go\"}";
+    g_go = 0;
+    legacy_handle_command(tricky, out, sizeof(out));
+    printf("  legacy on %s -> %s", tricky, out);
+    g_go = 0;
+    json_handle_command(tricky, strlen(tricky), out, sizeof(out));
+    printf("  sls_json on %s -> %s", tricky, out);
+
+    return sink == 0 ? 1 : 0;
+}
@@ -0,0 +1,258 @@
+/**
+ * @file bench_cmd_local.c
+ * @brief Local command round-trip latency: TCP vs Unix seqpacket vs shm mailbox
+ *
+ * Starts the real command server in-process with a thread draining the
+ * engine control queue, then sends one status/set_throttle command at a
+ * time (no pipelining) over each local transport and reports the round-trip
+ * distribution. Also times a mailbox state snapshot read. Build with
+ * `make bench`.
+ *
+ * The mailbox only beats the sockets by a wide margin when the client and
+ * the mailbox thread spin on different cores; on a single CPU every round
+ * trip includes a yield to the server thread.
+ */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cmd_mailbox.h"
+#include "cmd_server.h"
+#include "sim_proto.h"
+#include "sls_cmd_queue.h"
+#include "sls_logging.h"
+
+#define CMD_PORT 5055
+#define CMD_UNIX_PATH "/tmp/sls_cmd.sock"
+#define WARMUP 1000
+#define ROUND_TRIPS 20000
+
+static atomic_bool g_drain_running = true;
+static uint64_t g_samples[ROUND_TRIPS];
+
+// The server calls this on abort; the benchmark never sends one
+void sls_request_mission_abort(const char *reason)
+{
+    (void)reason;
+}
+
+static void *drain_thread(void *arg)
+{
+    (void)arg;
+    sls_cmd_queue_t *queue = sls_cmd_queue_for(SUBSYS_ENGINE_CONTROL);
+    command_t cmd;
+    while (atomic_load(&g_drain_running))
+    {
+        if (sls_cmd_queue_pop(queue, &cmd))
+        {
+            sls_cmd_acknowledge(&cmd);
+        }
+        else
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void report(const char *name, int n)
+{
+    uint64_t sum = 0;
+    for (int i = 0; i < n; i++)
+    {
+        sum += g_samples[i];
+    }
+    qsort(g_samples, (size_t)n, sizeof(g_samples[0]), cmp_u64);
+    printf("  %-18s: mean %8.0f  p50 %8llu  p99 %8llu  max %9llu ns\n", name,
+           (double)sum / n, (unsigned long long)g_samples[n / 2],
+           (unsigned long long)g_samples[(n * 99) / 100],
+           (unsigned long long)g_samples[n - 1]);
+}
+
+static int recv_exact(int s, void *buf, size_t len)
+{
+    char *p = buf;
+    while (len > 0)
+    {
+        ssize_t n = recv(s, p, len, 0);
+        if (n <= 0)
+        {
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+static int connect_retry(int domain, int type, const struct sockaddr *addr, socklen_t len)
+{
+    for (int attempt = 0; attempt < 100; attempt++)
+    {
+        int s = socket(domain, type, 0);
+        if (s < 0)
+        {
+            return -1;
+        }
+        if (connect(s, addr, len) == 0)
+        {
+            return s;
+        }
+        close(s);
+        usleep(10000);
+    }
+    return -1;
+}
+
+static int connect_tcp(void)
+{
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(CMD_PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int s = connect_retry(AF_INET, SOCK_STREAM, (struct sockaddr *)&addr, sizeof(addr));
+    if (s >= 0)
+    {
+        int nodelay = 1;
+        setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+    }
+    return s;
+}
+
+static int connect_unix(void)
+{
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, CMD_UNIX_PATH, sizeof(addr.sun_path) - 1);
+    return connect_retry(AF_UNIX, SOCK_SEQPACKET, (struct sockaddr *)&addr, sizeof(addr));
+}
+
+static sim_msg_t make_msg(int i)
+{
+    sim_msg_t m = {(i & 1) ? CMD_STATUS : CMD_SET_THROTTLE, i % 101};
+    return m;
+}
+
+// Binary records over a connected socket, one outstanding command at a time
+static void run_socket(const char *name, int s)
+{
+    uint8_t magic = SIM_WIRE_MAGIC;
+    if (s < 0 || send(s, &magic, 1, 0) != 1 || recv_exact(s, &magic, 1) != 0)
+    {
+        fprintf(stderr, "%s: connect failed\n", name);
+        exit(1);
+    }
+
+    uint8_t req[SIM_MSG_WIRE_SZ];
+    uint8_t rep[SIM_REPLY_WIRE_SZ];
+    for (int i = 0; i < WARMUP + ROUND_TRIPS; i++)
+    {
+        sim_msg_t m = make_msg(i);
+        sim_msg_encode(&m, req);
+        uint64_t t0 = now_ns();
+        if (send(s, req, sizeof(req), 0) != (ssize_t)sizeof(req) ||
+            recv_exact(s, rep, sizeof(rep)) != 0)
+        {
+            fprintf(stderr, "%s: exchange failed\n", name);
+            exit(1);
+        }
+        if (i >= WARMUP)
+        {
+            g_samples[i - WARMUP] = now_ns() - t0;
+        }
+    }
+    close(s);
+    report(name, ROUND_TRIPS);
+}
+
+static void run_mailbox(void)
+{
+    cmd_mailbox_client_t client;
+    if (cmd_mailbox_open(&client) != 0)
+    {
+        fprintf(stderr, "mailbox open failed: %s\n", strerror(errno));
+        exit(1);
+    }
+
+    for (int i = 0; i < WARMUP + ROUND_TRIPS; i++)
+    {
+        sim_msg_t m = make_msg(i);
+        sim_reply_t r;
+        uint64_t t0 = now_ns();
+        if (cmd_mailbox_call(&client, &m, &r, 1000) != 0)
+        {
+            fprintf(stderr, "mailbox call failed: %s\n", strerror(errno));
+            exit(1);
+        }
+        if (i >= WARMUP)
+        {
+            g_samples[i - WARMUP] = now_ns() - t0;
+        }
+    }
+    report("shm mailbox", ROUND_TRIPS);
+
+    for (int i = 0; i < ROUND_TRIPS; i++)
+    {
+        cmd_mailbox_state_t st;
+        uint64_t t0 = now_ns();
+        cmd_mailbox_read_state(&client, &st);
+        g_samples[i] = now_ns() - t0;
+    }
+    report("shm state read", ROUND_TRIPS);
+    cmd_mailbox_close(&client);
+}
+
+int main(void)
+{
+    sls_logging_set_level(LOG_LEVEL_ERROR);
+    sls_cmd_queues_init();
+
+    pthread_t drain;
+    pthread_create(&drain, NULL, drain_thread, NULL);
+    if (cmd_server_start() != 0)
+    {
+        fprintf(stderr, "cmd_server_start failed\n");
+        return 1;
+    }
+
+    printf("local command round trips (%d commands, one outstanding)\n", ROUND_TRIPS);
+    run_socket("TCP loopback", connect_tcp());
+    run_socket("Unix seqpacket", connect_unix());
+    run_mailbox();
+
+    cmd_server_stop();
+    atomic_store(&g_drain_running, false);
+    pthread_join(drain, NULL);
+    return 0;
+}
@@ -0,0 +1,236 @@
+/**
+ * @file bench_cmd_stress.c
+ * @brief Command server stress test: binary records vs JSON lines
+ *
+ * Starts the real command server in-process with a thread standing in for
+ * engine control (draining and acknowledging its queue), then pipelines
+ * set_throttle/status commands over loopback TCP in windows and measures
+ * round-trip throughput for each wire format. Build with `make bench`.
+ */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cmd_server.h"
+#include "sim_proto.h"
+#include "sls_cmd_queue.h"
+#include "sls_logging.h"
+
+#define CMD_PORT 5055
+#define COMMANDS 200000
+#define WINDOW 32 // Half of them set_throttle, well under the queue capacity
+
+static atomic_bool g_drain_running = true;
+
+// The server calls this on abort; the stress mix never sends one
+void sls_request_mission_abort(const char *reason)
+{
+    (void)reason;
+}
+
+static void *drain_thread(void *arg)
+{
+    (void)arg;
+    sls_cmd_queue_t *queue = sls_cmd_queue_for(SUBSYS_ENGINE_CONTROL);
+    command_t cmd;
+    while (atomic_load(&g_drain_running))
+    {
+        if (sls_cmd_queue_pop(queue, &cmd))
+        {
+            sls_cmd_acknowledge(&cmd);
+        }
+        else
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static int connect_server(void)
+{
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(CMD_PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    for (int attempt = 0; attempt < 100; attempt++)
+    {
+        int s = socket(AF_INET, SOCK_STREAM, 0);
+        if (s < 0)
+        {
+            return -1;
+        }
+        if (connect(s, (struct sockaddr *)&addr, sizeof(addr)) == 0)
+        {
+            int nodelay = 1;
+            setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+            return s;
+        }
+        close(s);
+        usleep(10000);
+    }
+    return -1;
+}
+
+static int recv_exact(int s, void *buf, size_t len)
+{
+    char *p = buf;
+    while (len > 0)
+    {
+        ssize_t n = recv(s, p, len, 0);
+        if (n <= 0)
+        {
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+static double run_binary(long *failures)
+{
+    int s = connect_server();
+    uint8_t magic = SIM_WIRE_MAGIC;
+    if (s < 0 || send(s, &magic, 1, 0) != 1 || recv_exact(s, &magic, 1) != 0)
+    {
+        fprintf(stderr, "binary connect failed\n");
+        exit(1);
+    }
+
+    uint8_t req[WINDOW * SIM_MSG_WIRE_SZ];
+    uint8_t rep[WINDOW * SIM_REPLY_WIRE_SZ];
+    *failures = 0;
+
+    double t0 = now_sec();
+    for (int done = 0; done < COMMANDS; done += WINDOW)
+    {
+        for (int i = 0; i < WINDOW; i++)
+        {
+            sim_msg_t m = {(i & 1) ? CMD_STATUS : CMD_SET_THROTTLE, (done + i) % 101};
+            sim_msg_encode(&m, req + i * SIM_MSG_WIRE_SZ);
+        }
+        if (send(s, req, sizeof(req), 0) != (ssize_t)sizeof(req) ||
+            recv_exact(s, rep, sizeof(rep)) != 0)
+        {
+            fprintf(stderr, "binary exchange failed\n");
+            exit(1);
+        }
+        for (int i = 0; i < WINDOW; i++)
+        {
+            sim_reply_t r;
+            sim_reply_decode(rep + i * SIM_REPLY_WIRE_SZ, &r);
+            *failures += !r.ok;
+        }
+    }
+    double elapsed = now_sec() - t0;
+    close(s);
+    return COMMANDS / elapsed;
+}
+
+static double run_json(long *failures)
+{
+    int s = connect_server();
+    if (s < 0)
+    {
+        fprintf(stderr, "json connect failed\n");
+        exit(1);
+    }
+
+    char req[WINDOW * 64];
+    char rep[16384];
+    *failures = 0;
+
+    double t0 = now_sec();
+    for (int done = 0; done < COMMANDS; done += WINDOW)
+    {
+        size_t len = 0;
+        for (int i = 0; i < WINDOW; i++)
+        {
+            len += (size_t)(i & 1
+                                ? snprintf(req + len, sizeof(req) - len, "{\"cmd\":\"status\"}\n")
+                                : snprintf(req + len, sizeof(req) - len,
+                                           "{\"cmd\":\"set_throttle\",\"value\":%d}\n",
+                                           (done + i) % 101));
+        }
+        if (send(s, req, len, 0) != (ssize_t)len)
+        {
+            fprintf(stderr, "json send failed\n");
+            exit(1);
+        }
+
+        // One reply line per request
+        int lines = 0;
+        while (lines < WINDOW)
+        {
+            ssize_t n = recv(s, rep, sizeof(rep), 0);
+            if (n <= 0)
+            {
+                fprintf(stderr, "json recv failed\n");
+                exit(1);
+            }
+            for (ssize_t i = 0; i < n; i++)
+            {
+                lines += rep[i] == '\n';
+                *failures += (rep[i] == 'e' && i + 6 < n && memcmp(rep + i, "error\"", 6) == 0);
+            }
+        }
+    }
+    double elapsed = now_sec() - t0;
+    close(s);
+    return COMMANDS / elapsed;
+}
+
+int main(void)
+{
+    sls_logging_set_level(LOG_LEVEL_ERROR);
+    sls_cmd_queues_init();
+
+    pthread_t drain;
+    pthread_create(&drain, NULL, drain_thread, NULL);
+    if (cmd_server_start() != 0)
+    {
+        fprintf(stderr, "cmd_server_start failed\n");
+        return 1;
+    }
+
+    long bin_fail = 0, json_fail = 0;
+    double json_rate = run_json(&json_fail);
+    double bin_rate = run_binary(&bin_fail);
+
+    printf("cmd_server pipelined round trips (%d commands, window %d, loopback TCP)\n",
+           COMMANDS, WINDOW);
+    printf("  JSON lines     : %10.0f cmds/s  (%ld rejected)\n", json_rate, json_fail);
+    printf("  binary records : %10.0f cmds/s  (%ld rejected)\n", bin_rate, bin_fail);
+    printf("  speedup        : %10.2fx\n", bin_rate / json_rate);
+    printf("  (rejected = engine queue full; the drain thread shares the CPU)\n");
+
+    cmd_server_stop();
+    atomic_store(&g_drain_running, false);
+    pthread_join(drain, NULL);
+    return 0;
+}
@@ -0,0 +1,461 @@
+/**
+ * @file bench_false_sharing.c
+ * @brief Coherence traffic of the cross-thread state layouts, before and after padding
+ *
+ * Replays the access pattern of two pieces of shared state with the old
+ * (adjacent) and the new (one cache line per writer) layout:
+ *
+ *   channels  flight control writes six stream channels, engine control
+ *             two more, and the stream thread reads all eight
+ *             (cmd_server.c g_channels)
+ *   mission   the main loop writes the mission clock, phase and state
+ *             while two loops poll the shutdown flag (main.c g_shared)
+ *
+ * Each thread is pinned to its own CPU where there are enough. Writers run
+ * flat out by default, or at --hz (the 100 Hz main and flight loops are
+ * --hz 100); readers always poll flat out, as the loops' shutdown checks
+ * and the stream thread's reads add up to far more reads than writes.
+ * Cache misses and L1D load misses are counted for the whole process with
+ * perf_event_open (user space only); where perf is not permitted, only the
+ * operation rates are reported. On a single CPU there is no cross-core
+ * traffic, so the layouts measure the same.
+ *
+ *   bench_false_sharing [--ms N] [--hz N] [--json FILE]
+ *
+ * Build with `make bench`.
+ */
+
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "sls_types.h"
+
+#define MAX_THREADS 3
+#define MAX_WORDS 8
+
+// ---- the layouts ----
+
+// Before: eight adjacent words, all on one line
+typedef struct
+{
+    _Alignas(SLS_CACHE_LINE) _Atomic uint64_t bits[MAX_WORDS];
+} channels_packed_t;
+
+// After: one line per channel
+typedef struct
+{
+    _Alignas(SLS_CACHE_LINE) _Atomic uint64_t bits;
+} channel_cell_t;
+
+// Before: shutdown flag, phase, state and clock declared next to each other
+typedef struct
+{
+    _Alignas(SLS_CACHE_LINE) _Atomic uint64_t shutdown_requested;
+    _Atomic uint64_t current_phase;
+    _Atomic uint64_t system_state;
+    _Atomic uint64_t mission_time;
+} mission_packed_t;
+
+// After: the main loop's group and the shutdown flag on separate lines
+typedef struct
+{
+    _Alignas(SLS_CACHE_LINE) _Atomic uint64_t mission_time;
+    _Atomic uint64_t current_phase;
+    _Atomic uint64_t system_state;
+    _Alignas(SLS_CACHE_LINE) _Atomic uint64_t shutdown_requested;
+} mission_padded_t;
+
+static channels_packed_t g_channels_packed;
+static channel_cell_t g_channels_padded[MAX_WORDS];
+static mission_packed_t g_mission_packed;
+static mission_padded_t g_mission_padded;
+
+// ---- workers ----
+
+typedef struct
+{
+    bool writer;
+    _Atomic uint64_t *words[MAX_WORDS];
+    int num_words;
+    int cpu;
+    uint64_t ops;
+} worker_t;
+
+typedef struct
+{
+    const char *name;
+    worker_t workers[MAX_THREADS];
+    int num_workers;
+} bench_case_t;
+
+static atomic_bool g_go;
+static atomic_bool g_stop;
+static long g_period_ns; // writer pacing; 0 runs flat out
+
+static void *worker_main(void *arg)
+{
+    worker_t *w = arg;
+
+#ifdef __linux__
+    if (w->cpu >= 0)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(w->cpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+#endif
+
+    while (!atomic_load_explicit(&g_go, memory_order_acquire))
+    {
+    }
+
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    uint64_t ops = 0;
+    uint64_t sink = 0;
+    while (!atomic_load_explicit(&g_stop, memory_order_relaxed))
+    {
+        for (int i = 0; i < w->num_words; i++)
+        {
+            if (w->writer)
+            {
+                atomic_store_explicit(w->words[i], ops, memory_order_relaxed);
+            }
+            else
+            {
+                sink += atomic_load_explicit(w->words[i], memory_order_relaxed);
+            }
+        }
+        ops++;
+
+        if (w->writer && g_period_ns > 0)
+        {
+            next.tv_nsec += g_period_ns;
+            while (next.tv_nsec >= 1000000000L)
+            {
+                next.tv_nsec -= 1000000000L;
+                next.tv_sec++;
+            }
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+        }
+    }
+    __asm__ volatile("" : : "r"(sink));
+    w->ops = ops;
+    return NULL;
+}
+
+// ---- perf counters ----
+
+typedef struct
+{
+    int fd[2]; // cache misses, L1D read misses; -1 if unavailable
+    int err;
+} counters_t;
+
+static int perf_open(uint32_t type, uint64_t config)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.inherit = 1; // threads created while enabled are counted too
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static void counters_open(counters_t *c)
+{
+    c->fd[0] = perf_open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    c->err = c->fd[0] < 0 ? errno : 0;
+    c->fd[1] = perf_open(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+                                                 (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                                 (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+}
+
+static void counters_ctl(const counters_t *c, unsigned long request)
+{
+    for (int i = 0; i < 2; i++)
+    {
+        if (c->fd[i] >= 0)
+        {
+            ioctl(c->fd[i], request, 0);
+        }
+    }
+}
+
+// -1 where a counter is unavailable
+static void counters_read(const counters_t *c, long long out[2])
+{
+    for (int i = 0; i < 2; i++)
+    {
+        uint64_t v = 0;
+        out[i] = (c->fd[i] >= 0 && read(c->fd[i], &v, sizeof(v)) == (ssize_t)sizeof(v))
+                     ? (long long)v
+                     : -1;
+    }
+}
+
+static void counters_close(counters_t *c)
+{
+    for (int i = 0; i < 2; i++)
+    {
+        if (c->fd[i] >= 0)
+        {
+            close(c->fd[i]);
+        }
+    }
+}
+
+// ---- cases ----
+
+static void add_worker(bench_case_t *bc, bool writer)
+{
+    worker_t *w = &bc->workers[bc->num_workers++];
+    memset(w, 0, sizeof(*w));
+    w->writer = writer;
+}
+
+static void add_word(bench_case_t *bc, _Atomic uint64_t *word)
+{
+    worker_t *w = &bc->workers[bc->num_workers - 1];
+    w->words[w->num_words++] = word;
+}
+
+static int build_cases(bench_case_t *cases)
+{
+    bench_case_t *bc = cases;
+
+    // Stream channels: 0-5 flight control, 6-7 engine control
+    for (int padded = 0; padded < 2; padded++, bc++)
+    {
+        bc->name = padded ? "channels_padded" : "channels_packed";
+        bc->num_workers = 0;
+        add_worker(bc, true); // flight control
+        for (int ch = 0; ch < 6; ch++)
+        {
+            add_word(bc, padded ? &g_channels_padded[ch].bits : &g_channels_packed.bits[ch]);
+        }
+        add_worker(bc, true); // engine control
+        for (int ch = 6; ch < MAX_WORDS; ch++)
+        {
+            add_word(bc, padded ? &g_channels_padded[ch].bits : &g_channels_packed.bits[ch]);
+        }
+        add_worker(bc, false); // stream thread
+        for (int ch = 0; ch < MAX_WORDS; ch++)
+        {
+            add_word(bc, padded ? &g_channels_padded[ch].bits : &g_channels_packed.bits[ch]);
+        }
+    }
+
+    // Mission state: the main loop writes, two loops poll for shutdown
+    for (int padded = 0; padded < 2; padded++, bc++)
+    {
+        bc->name = padded ? "mission_padded" : "mission_packed";
+        bc->num_workers = 0;
+        add_worker(bc, true); // main loop
+        add_word(bc, padded ? &g_mission_padded.mission_time : &g_mission_packed.mission_time);
+        add_word(bc, padded ? &g_mission_padded.current_phase : &g_mission_packed.current_phase);
+        for (int i = 0; i < 2; i++)
+        {
+            add_worker(bc, false);
+            add_word(bc, padded ? &g_mission_padded.shutdown_requested
+                                : &g_mission_packed.shutdown_requested);
+        }
+    }
+    return (int)(bc - cases);
+}
+
+typedef struct
+{
+    double writes_per_sec;
+    double reads_per_sec;
+    long long counts[2]; // per second; -1 if unavailable
+} case_result_t;
+
+static void run_case(bench_case_t *bc, int num_cpus, long duration_ms, case_result_t *res)
+{
+    counters_t ctr;
+    counters_open(&ctr);
+    counters_ctl(&ctr, PERF_EVENT_IOC_RESET);
+    counters_ctl(&ctr, PERF_EVENT_IOC_ENABLE);
+
+    atomic_store(&g_go, false);
+    atomic_store(&g_stop, false);
+    pthread_t threads[MAX_THREADS];
+    for (int i = 0; i < bc->num_workers; i++)
+    {
+        bc->workers[i].cpu = num_cpus > 1 ? i % num_cpus : -1;
+        pthread_create(&threads[i], NULL, worker_main, &bc->workers[i]);
+    }
+
+    atomic_store_explicit(&g_go, true, memory_order_release);
+    struct timespec d = {duration_ms / 1000, (duration_ms % 1000) * 1000000L};
+    nanosleep(&d, NULL);
+    atomic_store(&g_stop, true);
+    for (int i = 0; i < bc->num_workers; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    counters_ctl(&ctr, PERF_EVENT_IOC_DISABLE);
+    long long counts[2];
+    counters_read(&ctr, counts);
+    counters_close(&ctr);
+
+    double secs = (double)duration_ms / 1000.0;
+    memset(res, 0, sizeof(*res));
+    for (int i = 0; i < bc->num_workers; i++)
+    {
+        if (bc->workers[i].writer)
+        {
+            res->writes_per_sec += (double)bc->workers[i].ops / secs;
+        }
+        else
+        {
+            res->reads_per_sec += (double)bc->workers[i].ops / secs;
+        }
+    }
+    for (int i = 0; i < 2; i++)
+    {
+        res->counts[i] = counts[i] < 0 ? -1 : (long long)((double)counts[i] / secs);
+    }
+}
+
+static const char *fmt_count(char *buf, size_t size, long long v)
+{
+    if (v < 0)
+    {
+        return "n/a";
+    }
+    snprintf(buf, size, "%lld", v);
+    return buf;
+}
+
+static void json_count(FILE *f, const char *key, long long v)
+{
+    if (v < 0)
+    {
+        fprintf(f, ",\"%s\":null", key);
+    }
+    else
+    {
+        fprintf(f, ",\"%s\":%lld", key, v);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    long duration_ms = 500;
+    long hz = 0;
+    const char *json_path = NULL;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "--ms") == 0)
+        {
+            duration_ms = atol(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--hz") == 0)
+        {
+            hz = atol(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--json") == 0)
+        {
+            json_path = argv[i + 1];
+        }
+        else
+        {
+            duration_ms = 0; // unknown option: print usage
+            break;
+        }
+    }
+    if (argc % 2 == 0 || duration_ms <= 0 || hz < 0)
+    {
+        fprintf(stderr, "usage: %s [--ms N] [--hz N] [--json FILE]\n", argv[0]);
+        return 2;
+    }
+    g_period_ns = hz > 0 ? 1000000000L / hz : 0;
+
+    int num_cpus = 1;
+#ifdef __linux__
+    cpu_set_t avail;
+    if (sched_getaffinity(0, sizeof(avail), &avail) == 0)
+    {
+        num_cpus = CPU_COUNT(&avail);
+    }
+#endif
+
+    counters_t probe;
+    counters_open(&probe);
+    bool have_perf = probe.fd[0] >= 0;
+    int perf_err = probe.err;
+    counters_close(&probe);
+
+    printf("false sharing: %ld ms per case, writers %s, %d cpu%s\n", duration_ms,
+           hz > 0 ? "paced" : "flat out", num_cpus, num_cpus == 1 ? " (no cross-core traffic)" : "s");
+    if (hz > 0)
+    {
+        printf("  writers at %ld Hz\n", hz);
+    }
+    if (!have_perf)
+    {
+        printf("  perf counters unavailable (%s); rates only\n", strerror(perf_err));
+    }
+    printf("  %-18s %14s %14s %16s %16s\n", "case", "writes/s", "reads/s", "cache-miss/s",
+           "l1d-miss/s");
+
+    bench_case_t cases[4];
+    case_result_t results[4];
+    int num_cases = build_cases(cases);
+    for (int i = 0; i < num_cases; i++)
+    {
+        run_case(&cases[i], num_cpus, duration_ms, &results[i]);
+        char misses[24], l1d[24];
+        printf("  %-18s %14.0f %14.0f %16s %16s\n", cases[i].name, results[i].writes_per_sec,
+               results[i].reads_per_sec, fmt_count(misses, sizeof(misses), results[i].counts[0]),
+               fmt_count(l1d, sizeof(l1d), results[i].counts[1]));
+        fflush(stdout);
+    }
+
+    if (json_path)
+    {
+        FILE *f = strcmp(json_path, "-") == 0 ? stdout : fopen(json_path, "w");
+        if (!f)
+        {
+            perror(json_path);
+            return 1;
+        }
+        fprintf(f, "{\"suite\":\"false_sharing\",\"duration_ms\":%ld,\"writer_hz\":%ld,\"cpus\":%d,"
+                   "\"results\":[",
+                duration_ms, hz, num_cpus);
+        for (int i = 0; i < num_cases; i++)
+        {
+            fprintf(f, "%s\n{\"name\":\"%s\",\"writes_per_sec\":%.0f,\"reads_per_sec\":%.0f",
+                    i ? "," : "", cases[i].name, results[i].writes_per_sec,
+                    results[i].reads_per_sec);
+            json_count(f, "cache_misses_per_sec", results[i].counts[0]);
+            json_count(f, "l1d_read_misses_per_sec", results[i].counts[1]);
+            fprintf(f, "}");
+        }
+        fprintf(f, "\n]}\n");
+        if (f != stdout)
+        {
+            fclose(f);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,268 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+/**
+ * @file bench_harness.h
+ * @brief Small header-only harness for the host microbenchmarks
+ *
+ * Each case is a function that runs its operation a given number of times.
+ * The harness calibrates the count so one repetition takes about
+ * BENCH_TARGET_NS, runs one untimed warmup repetition, then times
+ * `--reps` repetitions and reports the median, best and worst ns/op.
+ *
+ * Command line (parsed by bench_init):
+ *   --reps N      timed repetitions per case (default 10)
+ *   --cpu N       pin the process to CPU N before running
+ *   --filter S    run only cases whose name contains S
+ *   --json FILE   also write the results as JSON ("-" for stdout)
+ *
+ * Results go to a copy of the original stdout taken by bench_init, so a
+ * suite may point fds 1 and 2 at /dev/null to silence the code it measures.
+ */
+
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_TARGET_NS 20000000ULL // 20 ms per repetition
+#define BENCH_MAX_REPS 100
+#define BENCH_MAX_RESULTS 64
+
+typedef void (*bench_fn_t)(void *ctx, uint64_t iterations);
+
+typedef struct
+{
+    char name[64];
+    double ns_per_op; // median repetition
+    double ns_min;
+    double ns_max;
+    uint64_t iterations; // per repetition
+} bench_result_t;
+
+typedef struct
+{
+    const char *suite;
+    int reps;
+    int cpu; // -1 if not pinned
+    const char *filter;
+    const char *json_path;
+    FILE *out;
+    bench_result_t results[BENCH_MAX_RESULTS];
+    int num_results;
+} bench_t;
+
+static inline uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Keep a value alive so the compiler cannot drop the work producing it
+ */
+static inline void bench_do_not_optimize(const void *p)
+{
+    __asm__ volatile("" : : "r"(p) : "memory");
+}
+
+static inline void bench_usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [--reps N] [--cpu N] [--filter S] [--json FILE|-]\n", prog);
+}
+
+/**
+ * @brief Parse the command line and pin the CPU
+ * @return 0 on success, -1 on a bad argument (usage has been printed)
+ */
+static inline int bench_init(bench_t *b, const char *suite, int argc, char **argv)
+{
+    memset(b, 0, sizeof(*b));
+    b->suite = suite;
+    b->reps = 10;
+    b->cpu = -1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (!val)
+        {
+            bench_usage(argv[0]);
+            return -1;
+        }
+        if (strcmp(arg, "--reps") == 0)
+        {
+            b->reps = atoi(val);
+        }
+        else if (strcmp(arg, "--cpu") == 0)
+        {
+            b->cpu = atoi(val);
+        }
+        else if (strcmp(arg, "--filter") == 0)
+        {
+            b->filter = val;
+        }
+        else if (strcmp(arg, "--json") == 0)
+        {
+            b->json_path = val;
+        }
+        else
+        {
+            bench_usage(argv[0]);
+            return -1;
+        }
+        i++;
+    }
+
+    if (b->reps < 1 || b->reps > BENCH_MAX_REPS)
+    {
+        fprintf(stderr, "--reps must be 1..%d\n", BENCH_MAX_REPS);
+        return -1;
+    }
+
+#ifdef __linux__
+    if (b->cpu >= 0)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(b->cpu, &set);
+        if (sched_setaffinity(0, sizeof(set), &set) != 0)
+        {
+            perror("sched_setaffinity");
+            return -1;
+        }
+    }
+#endif
+
+    int fd = dup(STDOUT_FILENO);
+    b->out = (fd >= 0) ? fdopen(fd, "w") : NULL;
+    if (!b->out)
+    {
+        b->out = stdout;
+    }
+
+    fprintf(b->out, "%s: %d reps of ~%llu ms, cpu %s%d\n", suite, b->reps,
+            (unsigned long long)(BENCH_TARGET_NS / 1000000ULL),
+            b->cpu >= 0 ? "" : "unpinned ", b->cpu >= 0 ? b->cpu : sched_getcpu());
+    fprintf(b->out, "  %-34s %10s %10s %10s %14s\n", "case", "ns/op", "min", "max", "ops/s");
+    fflush(b->out);
+    return 0;
+}
+
+static int bench_compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Calibrate, warm up and time one case
+ */
+static inline void bench_run(bench_t *b, const char *name, bench_fn_t fn, void *ctx)
+{
+    if (b->filter && !strstr(name, b->filter))
+    {
+        return;
+    }
+    if (b->num_results >= BENCH_MAX_RESULTS)
+    {
+        return;
+    }
+
+    // Grow the count until a batch is long enough to scale from
+    uint64_t iterations = 1;
+    uint64_t elapsed = 0;
+    for (;;)
+    {
+        uint64_t t0 = bench_now_ns();
+        fn(ctx, iterations);
+        elapsed = bench_now_ns() - t0;
+        if (elapsed >= BENCH_TARGET_NS / 20 || iterations >= (1ULL << 40))
+        {
+            break;
+        }
+        iterations *= 4;
+    }
+    if (elapsed > 0)
+    {
+        iterations = (uint64_t)((double)iterations * BENCH_TARGET_NS / (double)elapsed);
+    }
+    if (iterations < 1)
+    {
+        iterations = 1;
+    }
+
+    fn(ctx, iterations); // warmup
+
+    double per_op[BENCH_MAX_REPS];
+    for (int r = 0; r < b->reps; r++)
+    {
+        uint64_t t0 = bench_now_ns();
+        fn(ctx, iterations);
+        per_op[r] = (double)(bench_now_ns() - t0) / (double)iterations;
+    }
+    qsort(per_op, (size_t)b->reps, sizeof(double), bench_compare_double);
+
+    bench_result_t *res = &b->results[b->num_results++];
+    snprintf(res->name, sizeof(res->name), "%s", name);
+    res->ns_per_op = (b->reps % 2) ? per_op[b->reps / 2]
+                                   : (per_op[b->reps / 2 - 1] + per_op[b->reps / 2]) / 2.0;
+    res->ns_min = per_op[0];
+    res->ns_max = per_op[b->reps - 1];
+    res->iterations = iterations;
+
+    fprintf(b->out, "  %-34s %10.1f %10.1f %10.1f %14.0f\n", res->name, res->ns_per_op,
+            res->ns_min, res->ns_max, res->ns_per_op > 0 ? 1e9 / res->ns_per_op : 0.0);
+    fflush(b->out);
+}
+
+/**
+ * @brief Write the JSON report if one was asked for
+ * @return 0 on success, -1 if the file cannot be written
+ */
+static inline int bench_finish(bench_t *b)
+{
+    int rc = 0;
+
+    if (b->json_path)
+    {
+        FILE *f = strcmp(b->json_path, "-") == 0 ? b->out : fopen(b->json_path, "w");
+        if (!f)
+        {
+            perror(b->json_path);
+            rc = -1;
+        }
+        else
+        {
+            fprintf(f, "{\"suite\":\"%s\",\"cpu\":%d,\"repetitions\":%d,\"results\":[",
+                    b->suite, b->cpu, b->reps);
+            for (int i = 0; i < b->num_results; i++)
+            {
+                const bench_result_t *res = &b->results[i];
+                fprintf(f,
+                        "%s\n{\"name\":\"%s\",\"ns_per_op\":%.2f,\"ns_min\":%.2f,"
+                        "\"ns_max\":%.2f,\"ops_per_sec\":%.0f,\"iterations\":%llu}",
+                        i ? "," : "", res->name, res->ns_per_op, res->ns_min, res->ns_max,
+                        res->ns_per_op > 0 ? 1e9 / res->ns_per_op : 0.0,
+                        (unsigned long long)res->iterations);
+            }
+            fprintf(f, "\n]}\n");
+            if (f != b->out)
+            {
+                fclose(f);
+            }
+        }
+    }
+
+    fflush(b->out);
+    return rc;
+}
+
+#endif // BENCH_HARNESS_H
@@ -0,0 +1,28 @@
+#ifndef BENCH_HOOKS_H
+#define BENCH_HOOKS_H
+
+/**
+ * @file bench_hooks.h
+ * @brief Entry points into subsystem internals for the hot-path benchmarks
+ *
+ * The functions being measured are static to their subsystem files, so each
+ * hooks_*.c file includes one subsystem source and wraps the statics it
+ * needs. The subsystem file is then linked through its hooks file only.
+ */
+
+#include "sls_types.h"
+
+// flight_control.c
+void bench_fc_init(mission_phase_t phase);
+void bench_fc_reset(void);
+void bench_update_vehicle_dynamics(double dt);
+
+// engine_control.c
+int bench_engine_init(bool running); // returns the engine count
+void bench_monitor_engine_health(int engine_id);
+
+// telemetry.c (close with telemetry_close_log() from sls_subsystems.h)
+int bench_telemetry_open_log(const char *path);
+void bench_log_telemetry_to_file(const telemetry_point_t *point);
+
+#endif // BENCH_HOOKS_H
@@ -0,0 +1,277 @@
+/**
+ * @file bench_hotpaths.c
+ * @brief ns/op of the simulation's per-tick hot paths
+ *
+ * Covers IPC message creation and broadcast, sls_log at each level and
+ * destination, the telemetry CSV writer, telemetry validation (per point
+ * and batched), sensor noise, the vehicle dynamics step and engine health
+ * monitoring, using
+ * the MOCK_QNX_BUILD common and subsystem code. Console output of the
+ * code under test goes to /dev/null; log and CSV files go under /tmp and
+ * are removed at exit. See bench_harness.h for the options (--json,
+ * --cpu, --reps, --filter). Build with `make bench`.
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench_harness.h"
+#include "bench_hooks.h"
+#include "sls_alloc.h"
+#include "sls_ipc.h"
+#include "sls_logging.h"
+#include "sls_utils.h"
+#include "subsystems/sls_subsystems.h"
+
+#define BENCH_LOG_PATH "/tmp/sls_bench_hotpaths.log"
+#define BENCH_TELEM_PATH "/tmp/sls_bench_hotpaths.csv"
+#define DYNAMICS_RESET_STEPS 4096 // 41 s of flight at 100 Hz, then start over
+#define BATCH_POINTS 1024         // points per sls_validate_telemetry_batch call
+
+// Provided by main.c in the full simulation
+mission_phase_t sls_get_current_mission_phase(void)
+{
+    return PHASE_ASCENT;
+}
+
+double sls_get_mission_time(void)
+{
+    return 42.0;
+}
+
+void sls_request_mission_abort(const char *reason)
+{
+    (void)reason;
+}
+
+bool sls_shutdown_requested(void)
+{
+    return false;
+}
+
+typedef struct
+{
+    log_level_t level;
+    log_destination_t dest;
+} log_case_t;
+
+static telemetry_point_t g_point;
+static int g_num_engines;
+
+// g_point replicated in structure-of-arrays form, every 8th value out of range
+static struct
+{
+    double values[BATCH_POINTS];
+    double min_values[BATCH_POINTS];
+    double max_values[BATCH_POINTS];
+    sls_time_ns_t timestamps_ns[BATCH_POINTS];
+    uint64_t mask[BATCH_POINTS / 64];
+} g_batch;
+
+static void make_point(telemetry_point_t *point)
+{
+    memset(point, 0, sizeof(*point));
+    point->id = 101;
+    snprintf(point->name, sizeof(point->name), "ENG1_CHAMBER_PRESSURE");
+    point->type = SENSOR_PRESSURE;
+    point->value = 15000000.0;
+    point->min_value = 0.0;
+    point->max_value = 20000000.0;
+    snprintf(point->units, sizeof(point->units), "Pa");
+    point->timestamp_ns = sls_time_realtime_ns();
+    point->valid = true;
+    point->quality = 100;
+}
+
+static void run_ipc_send(void *ctx, uint64_t n)
+{
+    (void)ctx;
+    for (uint64_t i = 0; i < n; i++)
+    {
+        sls_ipc_send_telemetry(SUBSYS_FLIGHT_CONTROL, &g_point);
+    }
+}
+
+static void run_ipc_broadcast(void *ctx, uint64_t n)
+{
+    (void)ctx;
+    for (uint64_t i = 0; i < n; i++)
+    {
+        sls_ipc_broadcast_telemetry(&g_point);
+    }
+}
+
+static void run_log(void *ctx, uint64_t n)
+{
+    const log_case_t *c = ctx;
+    sls_logging_set_destination(c->dest);
+    for (uint64_t i = 0; i < n; i++)
+    {
+        sls_log(c->level, "BENCH", "Chamber pressure %.2f Pa on engine %d", g_point.value,
+                (int)(i & 3) + 1);
+    }
+}
+
+static void run_telemetry_csv(void *ctx, uint64_t n)
+{
+    (void)ctx;
+    for (uint64_t i = 0; i < n; i++)
+    {
+        bench_log_telemetry_to_file(&g_point);
+    }
+}
+
+static void run_validate(void *ctx, uint64_t n)
+{
+    (void)ctx;
+    int valid = 0;
+    for (uint64_t i = 0; i < n; i++)
+    {
+        valid += sls_validate_telemetry_point(&g_point);
+    }
+    bench_do_not_optimize(&valid);
+}
+
+static void make_batch(void)
+{
+    for (int i = 0; i < BATCH_POINTS; i++)
+    {
+        g_batch.values[i] = (i % 8 == 7) ? -1.0 : g_point.value;
+        g_batch.min_values[i] = g_point.min_value;
+        g_batch.max_values[i] = g_point.max_value;
+        g_batch.timestamps_ns[i] = g_point.timestamp_ns;
+    }
+}
+
+// One op is one point, for comparison with validate_telemetry_point
+static void run_validate_batch(void *ctx, uint64_t n)
+{
+    (void)ctx;
+    size_t valid = 0;
+    for (uint64_t done = 0; done < n; done += BATCH_POINTS)
+    {
+        size_t count = n - done < BATCH_POINTS ? (size_t)(n - done) : BATCH_POINTS;
+        valid += sls_validate_telemetry_batch(g_batch.values, g_batch.min_values,
+                                              g_batch.max_values, g_batch.timestamps_ns, count,
+                                              sls_time_realtime_ns(), g_batch.mask);
+    }
+    bench_do_not_optimize(&valid);
+}
+
+static void run_noise(void *ctx, uint64_t n)
+{
+    (void)ctx;
+    double sum = 0.0;
+    for (uint64_t i = 0; i < n; i++)
+    {
+        sum += sls_simulate_sensor_noise(g_point.value, 50000.0);
+    }
+    bench_do_not_optimize(&sum);
+}
+
+static void run_dynamics(void *ctx, uint64_t n)
+{
+    (void)ctx;
+    for (uint64_t i = 0; i < n; i++)
+    {
+        if (i % DYNAMICS_RESET_STEPS == 0)
+        {
+            bench_fc_reset();
+        }
+        bench_update_vehicle_dynamics(0.01);
+    }
+}
+
+static void run_engine_health(void *ctx, uint64_t n)
+{
+    (void)ctx;
+    for (uint64_t i = 0; i < n; i++)
+    {
+        bench_monitor_engine_health((int)(i % (uint64_t)g_num_engines));
+    }
+}
+
+/**
+ * @brief Point stdout/stderr at /dev/null so console logging is measured, not displayed
+ */
+static void silence_console(void)
+{
+    fflush(stdout);
+    fflush(stderr);
+    int fd = open("/dev/null", O_WRONLY);
+    if (fd >= 0)
+    {
+        dup2(fd, STDOUT_FILENO);
+        dup2(fd, STDERR_FILENO);
+        close(fd);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    bench_t b;
+    if (bench_init(&b, "hotpaths", argc, argv) != 0)
+    {
+        return 2;
+    }
+    silence_console();
+
+    if (sls_logging_init(BENCH_LOG_PATH) != 0 || sls_ipc_init() != 0)
+    {
+        fprintf(b.out, "init failed\n");
+        return 1;
+    }
+    sls_alloc_arena_init((size_t)SLS_ALLOC_ARENA_DEFAULT_KB * 1024, true, false);
+    make_point(&g_point);
+
+    // IPC: sls_log at DEBUG is filtered at the default INFO level
+    sls_logging_set_level(LOG_LEVEL_INFO);
+    bench_run(&b, "ipc_send_telemetry", run_ipc_send, NULL);
+    bench_run(&b, "ipc_broadcast_telemetry", run_ipc_broadcast, NULL);
+
+    static const struct
+    {
+        const char *name;
+        log_case_t c;
+    } log_cases[] = {
+        {"log_debug_filtered", {LOG_LEVEL_DEBUG, LOG_DEST_CONSOLE | LOG_DEST_FILE}},
+        {"log_info_console", {LOG_LEVEL_INFO, LOG_DEST_CONSOLE}},
+        {"log_info_file", {LOG_LEVEL_INFO, LOG_DEST_FILE}},
+        {"log_info_console_file", {LOG_LEVEL_INFO, LOG_DEST_CONSOLE | LOG_DEST_FILE}},
+        {"log_warning_console_file", {LOG_LEVEL_WARNING, LOG_DEST_CONSOLE | LOG_DEST_FILE}},
+        {"log_error_console_file", {LOG_LEVEL_ERROR, LOG_DEST_CONSOLE | LOG_DEST_FILE}},
+    };
+    for (size_t i = 0; i < sizeof(log_cases) / sizeof(log_cases[0]); i++)
+    {
+        bench_run(&b, log_cases[i].name, run_log, (void *)&log_cases[i].c);
+    }
+    sls_logging_set_destination(LOG_DEST_CONSOLE | LOG_DEST_FILE);
+
+    if (bench_telemetry_open_log(BENCH_TELEM_PATH) == 0)
+    {
+        bench_run(&b, "log_telemetry_to_file", run_telemetry_csv, NULL);
+        telemetry_close_log();
+    }
+
+    bench_run(&b, "validate_telemetry_point", run_validate, NULL);
+    make_batch();
+    bench_run(&b, "validate_telemetry_batch", run_validate_batch, NULL);
+    bench_run(&b, "simulate_sensor_noise", run_noise, NULL);
+
+    bench_fc_init(PHASE_ASCENT);
+    bench_run(&b, "update_vehicle_dynamics", run_dynamics, NULL);
+
+    g_num_engines = bench_engine_init(true);
+    bench_run(&b, "monitor_engine_health", run_engine_health, NULL);
+
+    int rc = bench_finish(&b);
+
+    sls_ipc_cleanup();
+    sls_logging_cleanup();
+    unlink(BENCH_LOG_PATH);
+    unlink(BENCH_TELEM_PATH);
+    return rc == 0 ? 0 : 1;
+}
@@ -0,0 +1,359 @@
+/**
+ * @file bench_qnx_ipc.c
+ * @brief QNX message passing round trips on the Linux stand-in (qnx_mock.c)
+ *
+ * Runs the unmodified QNX server (qnx/ipc.c) and measures:
+ *   - ipc_client_send() as the operator console uses it (cached connection),
+ *     in-process, and per command when batched with ipc_client_send_batch();
+ *   - reconnection after the server restarts;
+ *   - command throughput with 1, 2 and 4 client threads against the
+ *     receive thread pool, and how long ipc_server_stop() takes;
+ *   - MsgSend on a held connection, in-process and from a forked client
+ *     process, i.e. the console-to-simulator path;
+ *   - timer pulse period jitter (timer_pulse_start, 10 ms), both received
+ *     directly and as seen by a loop blocked in ipc_server_wait_tick(), the
+ *     way main_qnx.c paces the simulation.
+ * Round-trip p99 is checked against the 5 ms flight-control latency budget
+ * from docs/system-design.md. Build with `make bench`; ipc_server_start() asks
+ * for SCHED_RR, so run as root or with an rtprio limit.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ipc.h"
+
+#define SERVER_NAME "sls_bench_fcc"
+#define WARMUP 1000
+#define ROUND_TRIPS 20000
+#define BATCH 16
+#define SCALING_NS 500000000ULL // per client count
+#define PULSES 100
+#define PULSE_WARMUP 5 // the first expiries start glibc's notification thread
+#define PULSE_PERIOD_MS 10
+#define BUDGET_NS 5000000ULL // flight control max latency
+
+static uint64_t g_samples[ROUND_TRIPS];
+static volatile int g_mission_go = 0;
+static volatile int g_throttle = 0;
+static volatile int g_abort_req = 0;
+static int g_over_budget = 0;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// gated: whether the p99 counts against the latency budget
+static void report(const char *name, int n, int gated)
+{
+    uint64_t sum = 0;
+    for (int i = 0; i < n; i++)
+    {
+        sum += g_samples[i];
+    }
+    qsort(g_samples, (size_t)n, sizeof(g_samples[0]), cmp_u64);
+    uint64_t p99 = g_samples[(n * 99) / 100];
+    printf("  %-22s: mean %8.0f  p50 %8llu  p99 %8llu  max %9llu ns%s\n", name,
+           (double)sum / n, (unsigned long long)g_samples[n / 2], (unsigned long long)p99,
+           (unsigned long long)g_samples[n - 1],
+           gated && p99 > BUDGET_NS ? "  OVER BUDGET" : "");
+    g_over_budget |= gated && p99 > BUDGET_NS;
+}
+
+static sim_msg_t make_msg(int i)
+{
+    sim_msg_t m = {(i & 1) ? CMD_STATUS : CMD_SET_THROTTLE, i % 101};
+    return m;
+}
+
+static void run_client_send(void)
+{
+    for (int i = 0; i < WARMUP + ROUND_TRIPS; i++)
+    {
+        sim_msg_t m = make_msg(i);
+        sim_reply_t r;
+        uint64_t t0 = now_ns();
+        if (ipc_client_send(SERVER_NAME, &m, &r) != 0)
+        {
+            fprintf(stderr, "ipc_client_send failed: %s\n", strerror(errno));
+            exit(1);
+        }
+        if (i >= WARMUP)
+        {
+            g_samples[i - WARMUP] = now_ns() - t0;
+        }
+    }
+    report("ipc_client_send", ROUND_TRIPS, 1);
+}
+
+// Samples are per command: batch round trip / BATCH
+static void run_client_batch(void)
+{
+    sim_msg_t msgs[BATCH];
+    sim_reply_t replies[BATCH];
+    for (int i = 0; i < BATCH; i++)
+    {
+        msgs[i] = make_msg(i);
+    }
+    for (int i = 0; i < WARMUP + ROUND_TRIPS; i++)
+    {
+        uint64_t t0 = now_ns();
+        if (ipc_client_send_batch(SERVER_NAME, msgs, BATCH, replies) != 0 ||
+            replies[BATCH - 1].ok != 1)
+        {
+            fprintf(stderr, "ipc_client_send_batch failed: %s\n", strerror(errno));
+            exit(1);
+        }
+        if (i >= WARMUP)
+        {
+            g_samples[i - WARMUP] = (now_ns() - t0) / BATCH;
+        }
+    }
+    report("batch of 16, per cmd", ROUND_TRIPS, 1);
+}
+
+// The cached connection must survive a server restart
+static int check_reconnect(ipc_server_t *server)
+{
+    sim_msg_t m = make_msg(1);
+    sim_reply_t r;
+    ipc_server_stop(server);
+    if (ipc_server_start(server, SERVER_NAME, &g_mission_go, &g_throttle, &g_abort_req, 70) != 0 ||
+        ipc_client_send(SERVER_NAME, &m, &r) != 0)
+    {
+        fprintf(stderr, "reconnect after server restart failed: %s\n", strerror(errno));
+        return -1;
+    }
+    printf("  reconnect after server restart: ok\n");
+    return 0;
+}
+
+// Returns 0 on success; used in-process and from the forked client
+static int run_held_connection(const char *label)
+{
+    int coid = name_open(SERVER_NAME, 0);
+    if (coid == -1)
+    {
+        fprintf(stderr, "name_open failed: %s\n", strerror(errno));
+        return -1;
+    }
+    for (int i = 0; i < WARMUP + ROUND_TRIPS; i++)
+    {
+        sim_msg_t m = make_msg(i);
+        sim_reply_t r;
+        uint64_t t0 = now_ns();
+        if (MsgSend(coid, &m, sizeof(m), &r, sizeof(r)) == -1 || !r.ok)
+        {
+            fprintf(stderr, "MsgSend failed: %s\n", strerror(errno));
+            name_close(coid);
+            return -1;
+        }
+        if (i >= WARMUP)
+        {
+            g_samples[i - WARMUP] = now_ns() - t0;
+        }
+    }
+    name_close(coid);
+    report(label, ROUND_TRIPS, 1);
+    return 0;
+}
+
+static void *scaling_client(void *arg)
+{
+    long *count = arg;
+    int coid = name_open(SERVER_NAME, 0);
+    uint64_t end = now_ns() + SCALING_NS;
+    long n = 0;
+    while (coid != -1 && now_ns() < end)
+    {
+        sim_msg_t m = make_msg((int)n);
+        sim_reply_t r;
+        if (MsgSend(coid, &m, sizeof(m), &r, sizeof(r)) == -1)
+        {
+            break;
+        }
+        n++;
+    }
+    if (coid != -1)
+    {
+        name_close(coid);
+    }
+    *count = n;
+    return NULL;
+}
+
+static void run_scaling(const ipc_server_t *server)
+{
+    for (int clients = 1; clients <= 4; clients *= 2)
+    {
+        pthread_t threads[4];
+        long counts[4];
+        for (int i = 0; i < clients; i++)
+        {
+            pthread_create(&threads[i], NULL, scaling_client, &counts[i]);
+        }
+        long total = 0;
+        for (int i = 0; i < clients; i++)
+        {
+            pthread_join(threads[i], NULL);
+            total += counts[i];
+        }
+        printf("  %d client thread%s       : %10.0f cmds/s  (%d receive threads)\n", clients,
+               clients > 1 ? "s" : " ", total / (SCALING_NS / 1e9),
+               atomic_load(&server->nthreads));
+    }
+}
+
+static int run_cross_process(void)
+{
+    fflush(stdout);
+    pid_t child = fork();
+    if (child < 0)
+    {
+        return -1;
+    }
+    if (child == 0)
+    {
+        int child_rc = run_held_connection("MsgSend, other process") == 0 && !g_over_budget ? 0 : 1;
+        fflush(stdout);
+        _exit(child_rc);
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    if (!WIFEXITED(status))
+    {
+        return -1;
+    }
+    g_over_budget |= WEXITSTATUS(status) != 0;
+    return 0;
+}
+
+static int run_timer_pulses(void)
+{
+    int chid = ChannelCreate(0);
+    timer_t timer;
+    if (chid == -1 || !timer_pulse_start(chid, PULSE_PERIOD_MS, PULSE_TICK, 0, &timer))
+    {
+        fprintf(stderr, "timer_pulse_start failed: %s\n", strerror(errno));
+        return -1;
+    }
+
+    uint64_t last = 0;
+    int n = 0, seen = 0;
+    while (n < PULSES)
+    {
+        struct _pulse pulse;
+        if (MsgReceive(chid, &pulse, sizeof(pulse), NULL) != 0 || pulse.code != PULSE_TICK)
+        {
+            continue;
+        }
+        uint64_t t = now_ns();
+        if (++seen > PULSE_WARMUP)
+        {
+            uint64_t period = t - last;
+            uint64_t nominal = PULSE_PERIOD_MS * 1000000ULL;
+            g_samples[n++] = period > nominal ? period - nominal : nominal - period;
+        }
+        last = t;
+    }
+    timer_pulse_stop(timer);
+    ChannelDestroy(chid);
+    // Informational: a host without RT scheduling shows the same jitter
+    // with a plain nanosleep loop
+    report("timer pulse jitter", PULSES, 0);
+    return 0;
+}
+
+// Ticks delivered to the server channel and handed to a waiting loop
+static int run_server_ticks(ipc_server_t *server)
+{
+    timer_t timer;
+    if (!timer_pulse_start(server->chid, PULSE_PERIOD_MS, PULSE_TICK, 0, &timer))
+    {
+        fprintf(stderr, "timer_pulse_start failed: %s\n", strerror(errno));
+        return -1;
+    }
+
+    uint64_t seen = 0, last = 0, missed = 0;
+    int n = 0, got = 0;
+    while (n < PULSES)
+    {
+        int ticks = ipc_server_wait_tick(server, &seen, 10 * PULSE_PERIOD_MS);
+        if (ticks <= 0)
+        {
+            fprintf(stderr, "ipc_server_wait_tick timed out\n");
+            timer_pulse_stop(timer);
+            return -1;
+        }
+        uint64_t t = now_ns();
+        if (++got > PULSE_WARMUP)
+        {
+            uint64_t period = (t - last) / (uint64_t)ticks;
+            uint64_t nominal = PULSE_PERIOD_MS * 1000000ULL;
+            g_samples[n++] = period > nominal ? period - nominal : nominal - period;
+            missed += (uint64_t)ticks - 1;
+        }
+        last = t;
+    }
+    timer_pulse_stop(timer);
+    report("server tick jitter", PULSES, 0);
+    printf("  missed ticks          : %llu of %d\n", (unsigned long long)missed, PULSES);
+    return 0;
+}
+
+int main(void)
+{
+    ipc_server_t server;
+    if (ipc_server_start(&server, SERVER_NAME, &g_mission_go, &g_throttle, &g_abort_req, 70) != 0)
+    {
+        fprintf(stderr, "ipc_server_start failed (SCHED_RR needs root or an rtprio limit)\n");
+        return 1;
+    }
+
+    printf("QNX message passing on Linux (%d round trips, budget %llu ns)\n", ROUND_TRIPS,
+           (unsigned long long)BUDGET_NS);
+    int rc = run_held_connection("MsgSend, held coid");
+    run_client_send();
+    run_client_batch();
+    if (rc == 0)
+    {
+        rc = check_reconnect(&server);
+    }
+    if (rc == 0)
+    {
+        rc = run_cross_process();
+    }
+    if (rc == 0)
+    {
+        rc = run_timer_pulses();
+    }
+    if (rc == 0)
+    {
+        rc = run_server_ticks(&server);
+    }
+    if (rc == 0)
+    {
+        run_scaling(&server);
+    }
+
+    uint64_t t0 = now_ns();
+    ipc_server_stop(&server);
+    printf("  ipc_server_stop       : %10.3f ms\n", (now_ns() - t0) / 1e6);
+    return rc != 0 || g_over_budget;
+}
@@ -0,0 +1,475 @@
+/**
+ * @file bench_scenario.c
+ * @brief Headless end-to-end mission throughput: how fast can we fly a mission
+ *
+ * Steps flight control, engine control and telemetry from one thread in
+ * lockstep through the standard scenario (end of countdown, ignition,
+ * liftoff, max-Q, staging, orbit insertion up to mission complete) with
+ * no pacing, using the mission timeline and subsystem rates from
+ * config/system.conf. Flight control runs every tick; the others run
+ * every base_rate / rate ticks with the matching dt. Reports:
+ *
+ *   sim_seconds_per_wall_second   median over --reps runs (the tracked number)
+ *   peak_rss_kb                   process high-water mark
+ *   allocations_per_tick          malloc/calloc/realloc/aligned_alloc calls
+ *                                 made by simulator code (counted with
+ *                                 -Wl,--wrap; libc-internal ones are not seen)
+ *   steady_state_allocations      sls_alloc violations during the loop (the
+ *                                 loop runs sealed, under the allow policy)
+ *   log_bytes, telemetry_csv_bytes
+ *   telemetry points per simulated and per wall second
+ *
+ * The run is seeded and timestamps come from simulated time, so everything
+ * except the wall-clock figures repeats exactly and result files from
+ * different commits can be compared directly; --label tags a file (e.g.
+ * with the commit). The summary is printed as JSON and, with --json, also
+ * written to a file. Logs go to a scratch directory that is removed at exit.
+ *
+ *   bench_scenario [--reps N] [--cpu N] [--config FILE] [--label S] [--json FILE]
+ *
+ * Build with `make bench`.
+ */
+
+#include <fcntl.h>
+#include <limits.h>
+#include <math.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "bench_harness.h"
+#include "sls_alloc.h"
+#include "sls_cmd_queue.h"
+#include "sls_config_loader.h"
+#include "sls_ipc.h"
+#include "sls_logging.h"
+#include "sls_metrics.h"
+#include "sls_mission_config.h"
+#include "sls_utils.h"
+#include "subsystems/sls_subsystems.h"
+
+#define SCENARIO_NAME "countdown_to_orbit"
+#define SCENARIO_START_S -30.0 // last 30 s of the countdown
+#define SCENARIO_END_S 480.0   // mission complete in the default timeline
+#define SCENARIO_SEED 1
+#define SCENARIO_MAX_REPS 50
+
+// ---- allocation counting (linked with -Wl,--wrap=malloc,...) ----
+
+static atomic_ullong g_allocations;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void *__real_aligned_alloc(size_t alignment, size_t size);
+
+void *__wrap_malloc(size_t size)
+{
+    atomic_fetch_add_explicit(&g_allocations, 1, memory_order_relaxed);
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size)
+{
+    atomic_fetch_add_explicit(&g_allocations, 1, memory_order_relaxed);
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    atomic_fetch_add_explicit(&g_allocations, 1, memory_order_relaxed);
+    return __real_realloc(ptr, size);
+}
+
+void *__wrap_aligned_alloc(size_t alignment, size_t size)
+{
+    atomic_fetch_add_explicit(&g_allocations, 1, memory_order_relaxed);
+    return __real_aligned_alloc(alignment, size);
+}
+
+// ---- mission state normally owned by main.c ----
+
+static double g_mission_time;
+static mission_phase_t g_phase = PHASE_PRELAUNCH;
+
+mission_phase_t sls_get_current_mission_phase(void)
+{
+    return g_phase;
+}
+
+double sls_get_mission_time(void)
+{
+    return g_mission_time;
+}
+
+void sls_request_mission_abort(const char *reason)
+{
+    sls_log(LOG_LEVEL_CRITICAL, "SCENARIO", "Abort requested: %s", reason);
+    g_phase = PHASE_ABORT;
+}
+
+bool sls_shutdown_requested(void)
+{
+    return false;
+}
+
+// ---- scenario ----
+
+typedef struct
+{
+    double wall_s;
+    uint64_t ticks;
+    uint64_t allocations;
+    uint64_t steady_state_allocations;
+    uint64_t log_bytes;
+    uint64_t telemetry_csv_bytes;
+    uint64_t telemetry_points;
+    double max_q_pa;
+    double max_q_time_s;
+    double final_altitude_m;
+    mission_phase_t final_phase;
+} scenario_result_t;
+
+static uint32_t subsystem_rate(subsystem_type_t type, uint32_t default_hz)
+{
+    int count = 0;
+    const subsystem_config_t *table = sls_subsystem_table(&count);
+    for (int i = 0; i < count; i++)
+    {
+        if (table[i].type == type)
+        {
+            return table[i].update_rate_hz;
+        }
+    }
+    return default_hz;
+}
+
+static uint64_t steady_state_violations(void)
+{
+    uint64_t total = 0;
+    for (int owner = 0; owner < SLS_ALLOC_OWNERS; owner++)
+    {
+        sls_alloc_stats_t stats;
+        sls_alloc_get_stats(owner, &stats);
+        total += stats.after_seal;
+    }
+    return total;
+}
+
+static uint64_t file_size(const char *path)
+{
+    struct stat st;
+    return stat(path, &st) == 0 ? (uint64_t)st.st_size : 0;
+}
+
+static void run_scenario(scenario_result_t *res)
+{
+    const uint32_t base_hz = subsystem_rate(SUBSYS_FLIGHT_CONTROL, 100);
+    uint32_t engine_every = base_hz / subsystem_rate(SUBSYS_ENGINE_CONTROL, 50);
+    uint32_t telem_every = base_hz / subsystem_rate(SUBSYS_TELEMETRY, 10);
+    engine_every = engine_every ? engine_every : 1;
+    telem_every = telem_every ? telem_every : 1;
+
+    const double dt = 1.0 / base_hz;
+    const uint64_t ticks = (uint64_t)((SCENARIO_END_S - SCENARIO_START_S) * base_hz);
+    sls_metric_t *points = sls_metrics_counter("sls_ipc_telemetry_points_total", NULL, NULL);
+
+    memset(res, 0, sizeof(*res));
+    res->max_q_pa = NAN; // null in the JSON until a finite sample is seen
+    srand(SCENARIO_SEED);
+    g_phase = PHASE_PRELAUNCH;
+    sls_timeline_cursor_t cursor;
+    sls_timeline_cursor_init(&cursor);
+
+    flight_control_init();
+    engine_control_init();
+    telemetry_init();
+    const vehicle_state_t *vs = flight_control_vehicle_state();
+
+    sls_logging_flush();
+    uint64_t log_start = sls_logging_get_file_size();
+    uint64_t allocs_start = atomic_load(&g_allocations);
+    uint64_t violations_start = steady_state_violations();
+    double points_start = sls_metric_value(points);
+
+    // Telemetry timestamps follow simulated time from a fixed epoch
+    const sls_time_ns_t epoch_ns = 1700000000 * SLS_NS_PER_SEC;
+
+    uint64_t t0 = bench_now_ns();
+    for (uint64_t tick = 0; tick < ticks; tick++)
+    {
+        g_mission_time = SCENARIO_START_S + (double)tick * dt;
+
+        mission_phase_t phase = sls_timeline_phase(&cursor, g_mission_time);
+        if (g_phase != PHASE_ABORT && phase != PHASE_UNKNOWN && phase != g_phase)
+        {
+            g_phase = phase;
+            if (phase == PHASE_IGNITION)
+            {
+                // What the operator does at T-6: full throttle, GO
+                sls_cmd_submit(SUBSYS_ENGINE_CONTROL, CMD_OP_SET_THROTTLE, 100.0);
+                sls_cmd_submit(SUBSYS_ENGINE_CONTROL, CMD_OP_GO, 0.0);
+            }
+        }
+
+        sls_time_ns_t now = epoch_ns + sls_time_from_seconds(g_mission_time - SCENARIO_START_S);
+
+        flight_control_step(dt, now);
+        if (tick % engine_every == 0)
+        {
+            engine_control_step(dt * engine_every, now);
+        }
+        if (tick % telem_every == 0)
+        {
+            telemetry_step(dt * telem_every);
+        }
+
+        // Only finite samples count: a diverged state must not pass for max-Q
+        if (isfinite(vs->dynamic_pressure) &&
+            (isnan(res->max_q_pa) || vs->dynamic_pressure > res->max_q_pa))
+        {
+            res->max_q_pa = vs->dynamic_pressure;
+            res->max_q_time_s = g_mission_time;
+        }
+    }
+    res->wall_s = (double)(bench_now_ns() - t0) / 1e9;
+
+    telemetry_close_log();
+    sls_logging_flush();
+
+    res->ticks = ticks;
+    res->allocations = atomic_load(&g_allocations) - allocs_start;
+    res->steady_state_allocations = steady_state_violations() - violations_start;
+    res->log_bytes = sls_logging_get_file_size() - log_start;
+    res->telemetry_csv_bytes = file_size(TELEMETRY_FILE_PATH);
+    res->telemetry_points = (uint64_t)(sls_metric_value(points) - points_start);
+    res->final_altitude_m = vs->altitude;
+    res->final_phase = g_phase;
+}
+
+/**
+ * @brief Private working directory holding logs/, so runs never touch the repo's
+ */
+static int enter_scratch_dir(char *dir, size_t size)
+{
+    snprintf(dir, size, "/tmp/sls_scenario.XXXXXX");
+    if (!mkdtemp(dir) || chdir(dir) != 0 || mkdir("logs", 0755) != 0)
+    {
+        perror("scratch directory");
+        return -1;
+    }
+    return 0;
+}
+
+static void leave_scratch_dir(const char *dir)
+{
+    unlink(LOG_FILE_PATH);
+    unlink(TELEMETRY_FILE_PATH);
+    rmdir("logs");
+    if (chdir("/") == 0)
+    {
+        rmdir(dir);
+    }
+}
+
+/**
+ * @brief JSON number, or null if the simulation produced inf/NaN
+ */
+static void json_number(FILE *f, const char *key, double value, const char *suffix)
+{
+    if (isfinite(value))
+    {
+        fprintf(f, "  \"%s\": %.2f%s\n", key, value, suffix);
+    }
+    else
+    {
+        fprintf(f, "  \"%s\": null%s\n", key, suffix);
+    }
+}
+
+static void write_json(FILE *f, const char *label, int cpu, int reps, const double *rates,
+                       const scenario_result_t *r)
+{
+    double sim_s = SCENARIO_END_S - SCENARIO_START_S;
+    double median = (reps % 2) ? rates[reps / 2] : (rates[reps / 2 - 1] + rates[reps / 2]) / 2.0;
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+
+    fprintf(f, "{\n");
+    fprintf(f, "  \"scenario\": \"%s\",\n", SCENARIO_NAME);
+    fprintf(f, "  \"label\": \"%s\",\n", label);
+    fprintf(f, "  \"sim_start_s\": %.1f,\n  \"sim_end_s\": %.1f,\n", SCENARIO_START_S, SCENARIO_END_S);
+    fprintf(f, "  \"cpu\": %d,\n  \"repetitions\": %d,\n", cpu, reps);
+    fprintf(f, "  \"sim_seconds_per_wall_second\": %.1f,\n", median);
+    fprintf(f, "  \"sim_seconds_per_wall_second_min\": %.1f,\n", rates[0]);
+    fprintf(f, "  \"sim_seconds_per_wall_second_max\": %.1f,\n", rates[reps - 1]);
+    fprintf(f, "  \"ticks\": %llu,\n", (unsigned long long)r->ticks);
+    fprintf(f, "  \"peak_rss_kb\": %ld,\n", ru.ru_maxrss);
+    fprintf(f, "  \"allocations_per_tick\": %.3f,\n", (double)r->allocations / (double)r->ticks);
+    fprintf(f, "  \"steady_state_allocations\": %llu,\n",
+            (unsigned long long)r->steady_state_allocations);
+    fprintf(f, "  \"log_bytes\": %llu,\n", (unsigned long long)r->log_bytes);
+    fprintf(f, "  \"telemetry_csv_bytes\": %llu,\n", (unsigned long long)r->telemetry_csv_bytes);
+    fprintf(f, "  \"telemetry_points\": %llu,\n", (unsigned long long)r->telemetry_points);
+    fprintf(f, "  \"telemetry_points_per_sim_second\": %.1f,\n", (double)r->telemetry_points / sim_s);
+    fprintf(f, "  \"telemetry_points_per_wall_second\": %.0f,\n",
+            (double)r->telemetry_points / sim_s * median);
+    json_number(f, "max_q_pa", r->max_q_pa, ",");
+    json_number(f, "max_q_time_s", isfinite(r->max_q_pa) ? r->max_q_time_s : NAN, ",");
+    json_number(f, "final_altitude_m", r->final_altitude_m, ",");
+    fprintf(f, "  \"final_phase\": \"%s\"\n", sls_mission_phase_to_string(r->final_phase));
+    fprintf(f, "}\n");
+}
+
+int main(int argc, char **argv)
+{
+    int reps = 5;
+    int cpu = -1;
+    const char *label = "";
+    const char *json_path = NULL;
+    const char *config = "config/system.conf";
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "--reps") == 0)
+        {
+            reps = atoi(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--cpu") == 0)
+        {
+            cpu = atoi(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--label") == 0)
+        {
+            label = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--json") == 0)
+        {
+            json_path = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--config") == 0)
+        {
+            config = argv[i + 1];
+        }
+        else
+        {
+            reps = 0; // unknown option: print usage
+            break;
+        }
+    }
+    if (argc % 2 == 0 || reps < 1 || reps > SCENARIO_MAX_REPS)
+    {
+        fprintf(stderr, "usage: %s [--reps 1..%d] [--cpu N] [--config FILE] [--label S] "
+                        "[--json FILE]\n",
+                argv[0], SCENARIO_MAX_REPS);
+        return 2;
+    }
+
+#ifdef __linux__
+    if (cpu >= 0)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (sched_setaffinity(0, sizeof(set), &set) != 0)
+        {
+            perror("sched_setaffinity");
+            return 2;
+        }
+    }
+#endif
+
+    // Resolve paths before moving to the scratch directory
+    char config_path[PATH_MAX];
+    bool have_config = realpath(config, config_path) != NULL;
+    char json_abs[PATH_MAX];
+    if (json_path)
+    {
+        FILE *probe = fopen(json_path, "w");
+        if (!probe || !realpath(json_path, json_abs))
+        {
+            perror(json_path);
+            return 2;
+        }
+        fclose(probe);
+        json_path = json_abs;
+    }
+
+    char scratch[64];
+    if (enter_scratch_dir(scratch, sizeof(scratch)) != 0)
+    {
+        return 1;
+    }
+
+    // Results go to the original stdout; simulator console output does not
+    FILE *out = fdopen(dup(STDOUT_FILENO), "w");
+    int devnull = open("/dev/null", O_WRONLY);
+    if (!out || devnull < 0)
+    {
+        leave_scratch_dir(scratch);
+        return 1;
+    }
+    fflush(stdout);
+    fflush(stderr);
+    dup2(devnull, STDOUT_FILENO);
+    dup2(devnull, STDERR_FILENO);
+    close(devnull);
+
+    sls_logging_init(LOG_FILE_PATH);
+    if (!have_config || sls_config_load(config_path) < 0)
+    {
+        fprintf(out, "warning: %s not loaded, using built-in defaults\n", config);
+    }
+    sls_mission_config_load();
+    int arena_kb = sls_get_config_int("memory.arena_kb", SLS_ALLOC_ARENA_DEFAULT_KB);
+    sls_alloc_arena_init((size_t)arena_kb * 1024, sls_get_config_int("memory.huge_pages", 1),
+                         sls_get_config_int("memory.lock", 1));
+    sls_ipc_init();
+    sls_utils_init();
+    sls_cmd_queues_init();
+
+    // The stepping thread is every control loop at once: count, don't report
+    sls_alloc_set_policy(SLS_ALLOC_POLICY_ALLOW);
+    sls_alloc_seal();
+    sls_alloc_steady_thread();
+
+    double rates[SCENARIO_MAX_REPS];
+    scenario_result_t result;
+    fprintf(out, "%s: T%+.0f s to T+%.0f s, %d reps\n", SCENARIO_NAME, SCENARIO_START_S,
+            SCENARIO_END_S, reps);
+    for (int r = 0; r < reps; r++)
+    {
+        run_scenario(&result);
+        rates[r] = (SCENARIO_END_S - SCENARIO_START_S) / result.wall_s;
+        fprintf(out, "  run %d: %.3f s wall, %.1f sim s/wall s\n", r + 1, result.wall_s, rates[r]);
+        fflush(out);
+    }
+    qsort(rates, (size_t)reps, sizeof(double), bench_compare_double);
+
+    write_json(out, label, cpu, reps, rates, &result);
+    int rc = 0;
+    if (json_path)
+    {
+        FILE *f = fopen(json_path, "w");
+        if (f)
+        {
+            write_json(f, label, cpu, reps, rates, &result);
+            fclose(f);
+        }
+        else
+        {
+            rc = 1;
+        }
+    }
+
+    sls_ipc_cleanup();
+    sls_logging_cleanup();
+    sls_config_unload();
+    leave_scratch_dir(scratch);
+    fclose(out);
+    return rc;
+}
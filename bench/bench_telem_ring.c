@@ -0,0 +1,175 @@
+/**
+ * @file bench_telem_ring.c
+ * @brief Telemetry append cost with 0-8 concurrent /dev/sls_telemetry readers
+ *
+ * A writer appends telemetry-sized lines as fast as it can while reader
+ * threads drain the ring, once through telem_ring (lock-free, per-reader
+ * cursors) and once through the byte ring under one mutex that
+ * rmgr_telemetry.c used before. Reports the append latency distribution,
+ * bytes delivered per reader and records lost to overruns. Build with
+ * `make bench`.
+ *
+ * On a single CPU the max column is dominated by the writer being
+ * preempted; with the mutex it also includes waiting for a preempted
+ * reader that holds the lock.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "telem_ring.h"
+
+#define APPENDS 200000
+#define MAX_READERS 8
+#define READ_CHUNK 4096
+#define LEGACY_RING_SZ 8192
+
+static uint64_t g_samples[APPENDS];
+static telem_ring_t g_ring;
+static atomic_bool g_writing;
+
+// Previous implementation: byte ring, shared tail, one mutex
+static char g_legacy[LEGACY_RING_SZ];
+static size_t g_legacy_head, g_legacy_tail;
+static pthread_mutex_t g_legacy_mtx = PTHREAD_MUTEX_INITIALIZER;
+
+typedef struct
+{
+    int legacy;
+    uint64_t bytes;
+    uint64_t lost;
+} reader_t;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void legacy_append(const char *line, size_t len)
+{
+    pthread_mutex_lock(&g_legacy_mtx);
+    for (size_t i = 0; i < len; ++i)
+    {
+        g_legacy[g_legacy_head] = line[i];
+        g_legacy_head = (g_legacy_head + 1) % LEGACY_RING_SZ;
+        if (g_legacy_head == g_legacy_tail)
+        {
+            g_legacy_tail = (g_legacy_tail + 1) % LEGACY_RING_SZ;
+        }
+    }
+    pthread_mutex_unlock(&g_legacy_mtx);
+}
+
+static size_t legacy_read(char *buf, size_t len)
+{
+    pthread_mutex_lock(&g_legacy_mtx);
+    size_t avail = g_legacy_head >= g_legacy_tail
+                       ? g_legacy_head - g_legacy_tail
+                       : LEGACY_RING_SZ - (g_legacy_tail - g_legacy_head);
+    size_t n = avail < len ? avail : len;
+    if (g_legacy_tail + n > LEGACY_RING_SZ)
+    {
+        n = LEGACY_RING_SZ - g_legacy_tail;
+    }
+    memcpy(buf, g_legacy + g_legacy_tail, n);
+    g_legacy_tail = (g_legacy_tail + n) % LEGACY_RING_SZ;
+    pthread_mutex_unlock(&g_legacy_mtx);
+    return n;
+}
+
+static void *reader_thread(void *arg)
+{
+    reader_t *r = arg;
+    char buf[READ_CHUNK];
+    telem_cursor_t cur;
+    telem_cursor_init(&g_ring, &cur, 0);
+    while (atomic_load(&g_writing))
+    {
+        size_t n = r->legacy ? legacy_read(buf, sizeof(buf))
+                             : telem_ring_read(&g_ring, &cur, buf, sizeof(buf));
+        r->bytes += n;
+    }
+    r->lost = cur.lost;
+    return NULL;
+}
+
+static void run(int legacy, int readers)
+{
+    pthread_t threads[MAX_READERS];
+    reader_t state[MAX_READERS];
+    telem_ring_init(&g_ring);
+    g_legacy_head = g_legacy_tail = 0;
+
+    atomic_store(&g_writing, true);
+    for (int i = 0; i < readers; i++)
+    {
+        state[i] = (reader_t){.legacy = legacy};
+        pthread_create(&threads[i], NULL, reader_thread, &state[i]);
+    }
+
+    char line[128];
+    for (int i = 0; i < APPENDS; i++)
+    {
+        int len = snprintf(line, sizeof(line), "%llu.%03d,alt=%.2f,vel=%.2f,thr=%d,go=1\n",
+                           1700000000ULL + (unsigned long long)i / 10, (i % 10) * 100,
+                           i * 0.5, i * 0.01, i % 101);
+        uint64_t t0 = now_ns();
+        if (legacy)
+        {
+            legacy_append(line, (size_t)len);
+        }
+        else
+        {
+            telem_ring_append(&g_ring, line, (size_t)len);
+        }
+        g_samples[i] = now_ns() - t0;
+    }
+    atomic_store(&g_writing, false);
+
+    uint64_t bytes = 0, lost = 0;
+    for (int i = 0; i < readers; i++)
+    {
+        pthread_join(threads[i], NULL);
+        bytes += state[i].bytes;
+        lost += state[i].lost;
+    }
+
+    qsort(g_samples, APPENDS, sizeof(g_samples[0]), cmp_u64);
+    printf("  %-10s %d reader%s: append p50 %5llu  p99 %6llu  max %8llu ns", legacy ? "mutex" : "telem_ring",
+           readers, readers == 1 ? " " : "s", (unsigned long long)g_samples[APPENDS / 2],
+           (unsigned long long)g_samples[(APPENDS * 99) / 100],
+           (unsigned long long)g_samples[APPENDS - 1]);
+    if (readers > 0)
+    {
+        printf("  read %7.1f KiB/reader", bytes / 1024.0 / readers);
+        if (!legacy)
+        {
+            printf("  lost %llu", (unsigned long long)(lost / (uint64_t)readers));
+        }
+    }
+    printf("\n");
+}
+
+int main(void)
+{
+    printf("telemetry append with concurrent readers (%d lines)\n", APPENDS);
+    for (int readers = 0; readers <= MAX_READERS; readers = readers ? readers * 2 : 1)
+    {
+        run(1, readers);
+        run(0, readers);
+    }
+    return 0;
+}
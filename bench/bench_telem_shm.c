@@ -0,0 +1,211 @@
+/**
+ * @file bench_telem_shm.c
+ * @brief Telemetry text lines vs binary records vs the shared-memory export
+ *
+ * Publisher side: formatting a line with snprintf and appending it to the
+ * /dev/sls_telemetry ring (the old sim loop), appending a fixed-size
+ * sim_telem_record_t (the current one), and telem_shm_publish() of the
+ * same six channels. Consumer side: reading a line back and parsing it
+ * with sscanf, reading a record and formatting it (what a text-mode open
+ * now costs the reader), a seqlock read of every channel from the
+ * read-only mapping and a copy of the newest history sample. Build with
+ * `make bench`.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "sim_proto.h"
+#include "telem_ring.h"
+#include "telem_shm.h"
+
+#define ITERATIONS 200000
+#define CHANNELS 6
+#define SHM_NAME "/sls_bench_telemetry"
+
+static uint64_t g_samples[ITERATIONS];
+static telem_ring_t g_ring;
+
+static const telem_shm_channel_t g_channels[CHANNELS] = {
+    {"mission_time", "s"}, {"altitude", "m"}, {"velocity", "m/s"},
+    {"throttle", "%"},     {"mission_go", ""}, {"abort_req", ""},
+};
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void report(const char *name)
+{
+    uint64_t sum = 0;
+    for (int i = 0; i < ITERATIONS; i++)
+    {
+        sum += g_samples[i];
+    }
+    qsort(g_samples, ITERATIONS, sizeof(g_samples[0]), cmp_u64);
+    printf("  %-26s: mean %6.0f  p50 %5llu  p99 %6llu ns\n", name, (double)sum / ITERATIONS,
+           (unsigned long long)g_samples[ITERATIONS / 2],
+           (unsigned long long)g_samples[(ITERATIONS * 99) / 100]);
+}
+
+static void fill(double *v, int i)
+{
+    v[0] = i * 0.1;
+    v[1] = i * 3.7;
+    v[2] = i * 0.05;
+    v[3] = i % 101;
+    v[4] = 1;
+    v[5] = 0;
+}
+
+int main(void)
+{
+    telem_shm_t writer, reader;
+    if (telem_shm_create(&writer, SHM_NAME, g_channels, CHANNELS) != 0 ||
+        telem_shm_open(&reader, SHM_NAME) != 0)
+    {
+        perror("telem_shm");
+        return 1;
+    }
+    telem_cursor_t cur;
+    telem_cursor_init(&g_ring, &cur, 0);
+    volatile double sink = 0;
+
+    printf("telemetry per tick: text line vs shared memory (%d ticks)\n", ITERATIONS);
+    for (int i = 0; i < ITERATIONS; i++)
+    {
+        double v[CHANNELS];
+        fill(v, i);
+        char line[256];
+        uint64_t t0 = now_ns();
+        int len = snprintf(line, sizeof(line), "%ld.%03ld,alt=%.2f,vel=%.2f,thr=%d,go=%d\n",
+                           1700000000L + i / 10, (long)(i % 10) * 100, v[1], v[2], (int)v[3],
+                           (int)v[4]);
+        telem_ring_append(&g_ring, line, (size_t)len);
+        g_samples[i] = now_ns() - t0;
+
+        // Consumer: one line back and parsed
+        char buf[256];
+        size_t n = telem_ring_read(&g_ring, &cur, buf, sizeof(buf) - 1);
+        buf[n] = '\0';
+        long sec, msec;
+        double alt, vel;
+        int thr, go;
+        sscanf(buf, "%ld.%ld,alt=%lf,vel=%lf,thr=%d,go=%d", &sec, &msec, &alt, &vel, &thr, &go);
+        sink += alt;
+    }
+    report("snprintf + ring append");
+
+    telem_ring_init(&g_ring);
+    telem_cursor_init(&g_ring, &cur, 0);
+    for (int i = 0; i < ITERATIONS; i++)
+    {
+        double v[CHANNELS];
+        fill(v, i);
+        char line[256];
+        int len = snprintf(line, sizeof(line), "%ld.%03ld,alt=%.2f,vel=%.2f,thr=%d,go=%d\n",
+                           1700000000L + i / 10, (long)(i % 10) * 100, v[1], v[2], (int)v[3],
+                           (int)v[4]);
+        telem_ring_append(&g_ring, line, (size_t)len);
+
+        uint64_t t0 = now_ns();
+        char buf[256];
+        size_t n = telem_ring_read(&g_ring, &cur, buf, sizeof(buf) - 1);
+        buf[n] = '\0';
+        long sec, msec;
+        double alt, vel;
+        int thr, go;
+        sscanf(buf, "%ld.%ld,alt=%lf,vel=%lf,thr=%d,go=%d", &sec, &msec, &alt, &vel, &thr, &go);
+        g_samples[i] = now_ns() - t0;
+        sink += alt;
+    }
+    report("ring read + sscanf");
+
+    telem_ring_init(&g_ring);
+    telem_cursor_init(&g_ring, &cur, 0);
+    for (int i = 0; i < ITERATIONS; i++)
+    {
+        double v[CHANNELS];
+        fill(v, i);
+        uint64_t t0 = now_ns();
+        sim_telem_record_t rec = {.timestamp_ns = 1700000000000000000LL + i * 100000000LL,
+                                  .seq = (uint32_t)i,
+                                  .altitude_cm = (int64_t)(v[1] * 100.0),
+                                  .velocity_cms = (int64_t)(v[2] * 100.0),
+                                  .throttle = (uint8_t)v[3],
+                                  .mission_go = (uint8_t)v[4]};
+        telem_ring_append(&g_ring, &rec, sizeof(rec));
+        g_samples[i] = now_ns() - t0;
+
+        char line[SIM_TELEM_LINE_MAX];
+        telem_ring_read(&g_ring, &cur, &rec, sizeof(rec));
+        sink += sim_telem_format(&rec, line, sizeof(line));
+    }
+    report("record + ring append");
+
+    telem_ring_init(&g_ring);
+    telem_cursor_init(&g_ring, &cur, 0);
+    for (int i = 0; i < ITERATIONS; i++)
+    {
+        double v[CHANNELS];
+        fill(v, i);
+        sim_telem_record_t rec = {.timestamp_ns = 1700000000000000000LL + i * 100000000LL,
+                                  .altitude_cm = (int64_t)(v[1] * 100.0),
+                                  .velocity_cms = (int64_t)(v[2] * 100.0)};
+        telem_ring_append(&g_ring, &rec, sizeof(rec));
+
+        uint64_t t0 = now_ns();
+        char line[SIM_TELEM_LINE_MAX];
+        telem_ring_read(&g_ring, &cur, &rec, sizeof(rec));
+        sink += sim_telem_format(&rec, line, sizeof(line));
+        g_samples[i] = now_ns() - t0;
+    }
+    report("record read + format");
+
+    for (int i = 0; i < ITERATIONS; i++)
+    {
+        double v[CHANNELS];
+        fill(v, i);
+        uint64_t t0 = now_ns();
+        telem_shm_publish(&writer, v, (int64_t)i * 100000000LL);
+        g_samples[i] = now_ns() - t0;
+    }
+    report("telem_shm_publish");
+
+    for (int i = 0; i < ITERATIONS; i++)
+    {
+        uint64_t t0 = now_ns();
+        for (int ch = 0; ch < CHANNELS; ch++)
+        {
+            double value;
+            telem_shm_read(&reader, ch, &value, NULL);
+            sink += value;
+        }
+        g_samples[i] = now_ns() - t0;
+    }
+    report("telem_shm_read x6");
+
+    for (int i = 0; i < ITERATIONS; i++)
+    {
+        telem_shm_sample_t s;
+        uint64_t t0 = now_ns();
+        telem_shm_history_get(&reader, telem_shm_history_head(&reader) - 1, &s);
+        g_samples[i] = now_ns() - t0;
+        sink += s.values[1];
+    }
+    report("newest history sample");
+
+    telem_shm_close(&reader);
+    telem_shm_close(&writer);
+    return sink < 0;
+}
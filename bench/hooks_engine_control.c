@@ -0,0 +1,34 @@
+/**
+ * @file hooks_engine_control.c
+ * @brief Benchmark access to engine_control.c statics (see bench_hooks.h)
+ */
+
+#include "../src/subsystems/engine_control.c"
+
+#include "bench_hooks.h"
+
+int bench_engine_init(bool running)
+{
+    initialize_engine_control();
+    if (!running)
+    {
+        return NUM_ENGINES;
+    }
+
+    // Nominal mainstage values, inside every monitored limit
+    for (int i = 0; i < NUM_ENGINES; i++)
+    {
+        engine_data_t *engine = &g_ecs_state->engines[i];
+        engine->state = ENGINE_STATE_RUNNING;
+        engine->engine_params.thrust_percentage = 100.0;
+        engine->engine_params.chamber_pressure = 0.8 * ENGINE_MAX_CHAMBER_PRESSURE;
+        engine->engine_params.nozzle_temperature = 2500.0;
+        g_ecs_state->turbopump_speed[i] = 30000.0;
+    }
+    return NUM_ENGINES;
+}
+
+void bench_monitor_engine_health(int engine_id)
+{
+    monitor_engine_health(engine_id);
+}
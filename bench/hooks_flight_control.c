@@ -0,0 +1,27 @@
+/**
+ * @file hooks_flight_control.c
+ * @brief Benchmark access to flight_control.c statics (see bench_hooks.h)
+ */
+
+#include "../src/subsystems/flight_control.c"
+
+#include "bench_hooks.h"
+
+static flight_control_state_t g_bench_fc_initial;
+
+void bench_fc_init(mission_phase_t phase)
+{
+    initialize_flight_control();
+    g_fc_state->current_phase = phase;
+    g_bench_fc_initial = *g_fc_state;
+}
+
+void bench_fc_reset(void)
+{
+    *g_fc_state = g_bench_fc_initial;
+}
+
+void bench_update_vehicle_dynamics(double dt)
+{
+    update_vehicle_dynamics(dt);
+}
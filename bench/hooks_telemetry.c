@@ -0,0 +1,22 @@
+/**
+ * @file hooks_telemetry.c
+ * @brief Benchmark access to telemetry.c statics (see bench_hooks.h)
+ */
+
+#include "../src/subsystems/telemetry.c"
+
+#include "bench_hooks.h"
+
+int bench_telemetry_open_log(const char *path)
+{
+    reserve_telemetry_state();
+    memset(g_telem_state, 0, sizeof(*g_telem_state));
+    g_telem_state->logging_enabled = true;
+    g_telem_state->telemetry_log_file = fopen(path, "w");
+    return g_telem_state->telemetry_log_file ? 0 : -1;
+}
+
+void bench_log_telemetry_to_file(const telemetry_point_t *point)
+{
+    log_telemetry_to_file(point);
+}
@@ -0,0 +1,315 @@
+// cmd_mailbox.c — shared-memory command mailbox (server and client sides)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cmd_mailbox.h"
+#include "sls_logging.h"
+#include "sls_time.h"
+
+#define SERVER_SPIN_NS 200000L   // keep polling this long after the last request
+#define SERVER_PARK_MS 100       // idle wait, so stop requests are noticed
+#define CLIENT_SPIN_ITERS 256    // pure spins before yielding the CPU
+
+struct cmd_mailbox_shm {
+  atomic_uint magic; // written last by the server, after everything else
+  uint32_t version;
+  uint32_t num_slots;
+  pthread_mutex_t bell_lock; // process-shared
+  pthread_cond_t bell;       // process-shared
+  _Alignas(64) atomic_uint server_sleeping;
+  _Alignas(64) atomic_uint state_seq; // seqlock: odd while being written
+  cmd_mailbox_state_t state;
+  cmd_mailbox_slot_t slots[CMD_MAILBOX_SLOTS];
+};
+
+static cmd_mailbox_shm_t *g_shm = NULL;
+static cmd_mailbox_handler_t g_handler = NULL;
+static pthread_t g_thread;
+static atomic_int g_running = 0;
+static pthread_mutex_t g_publish_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  __asm__ __volatile__("yield");
+#endif
+}
+
+// Spinning only helps when the server runs on another core
+static unsigned client_spin_iters(void) {
+  static atomic_int iters = -1;
+  int n = atomic_load_explicit(&iters, memory_order_relaxed);
+  if (n < 0) {
+    n = sysconf(_SC_NPROCESSORS_ONLN) > 1 ? CLIENT_SPIN_ITERS : 0;
+    atomic_store_explicit(&iters, n, memory_order_relaxed);
+  }
+  return (unsigned)n;
+}
+
+// Serve every slot with an unanswered request; returns how many were served
+static int serve_slots(cmd_mailbox_shm_t *shm) {
+  int served = 0;
+  for (int i = 0; i < CMD_MAILBOX_SLOTS; i++) {
+    cmd_mailbox_slot_t *s = &shm->slots[i];
+    unsigned req = atomic_load_explicit(&s->req_seq, memory_order_acquire);
+    if (req == atomic_load_explicit(&s->rep_seq, memory_order_relaxed))
+      continue;
+    sim_msg_t msg = s->req;
+    g_handler(&msg, &s->rep);
+    atomic_store_explicit(&s->rep_seq, req, memory_order_release);
+    served++;
+  }
+  return served;
+}
+
+static void *mailbox_thread(void *unused) {
+  (void)unused;
+  cmd_mailbox_shm_t *shm = g_shm;
+  sls_time_ns_t last_active = sls_time_monotonic_ns();
+
+  while (atomic_load(&g_running)) {
+    if (serve_slots(shm) > 0) {
+      last_active = sls_time_monotonic_ns();
+      continue;
+    }
+    if (sls_time_monotonic_ns() - last_active < SERVER_SPIN_NS) {
+      sched_yield();
+      continue;
+    }
+
+    // Park. sleeping is set and the slots rescanned under bell_lock, and
+    // clients ring under the same lock, so a request cannot slip between
+    // the rescan and the wait.
+    pthread_mutex_lock(&shm->bell_lock);
+    atomic_store(&shm->server_sleeping, 1);
+    if (serve_slots(shm) == 0 && atomic_load(&g_running)) {
+      struct timespec deadline;
+      clock_gettime(CLOCK_MONOTONIC, &deadline);
+      deadline.tv_nsec += SERVER_PARK_MS * 1000000L;
+      if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+      }
+      pthread_cond_timedwait(&shm->bell, &shm->bell_lock, &deadline);
+    }
+    atomic_store(&shm->server_sleeping, 0);
+    pthread_mutex_unlock(&shm->bell_lock);
+    last_active = sls_time_monotonic_ns();
+  }
+  return NULL;
+}
+
+int cmd_mailbox_server_start(cmd_mailbox_handler_t handler) {
+  if (g_shm)
+    return 0;
+
+  shm_unlink(CMD_MAILBOX_NAME); // Stale object from a previous run
+  int fd = shm_open(CMD_MAILBOX_NAME, O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    sls_log(LOG_LEVEL_ERROR, "CMD", "mailbox shm_open failed: %s", strerror(errno));
+    return -1;
+  }
+  if (ftruncate(fd, sizeof(cmd_mailbox_shm_t)) != 0) {
+    sls_log(LOG_LEVEL_ERROR, "CMD", "mailbox ftruncate failed: %s", strerror(errno));
+    close(fd);
+    shm_unlink(CMD_MAILBOX_NAME);
+    return -1;
+  }
+  cmd_mailbox_shm_t *shm = mmap(NULL, sizeof(*shm), PROT_READ | PROT_WRITE,
+                                MAP_SHARED, fd, 0);
+  close(fd);
+  if (shm == MAP_FAILED) {
+    sls_log(LOG_LEVEL_ERROR, "CMD", "mailbox mmap failed: %s", strerror(errno));
+    shm_unlink(CMD_MAILBOX_NAME);
+    return -1;
+  }
+
+  memset(shm, 0, sizeof(*shm));
+  shm->version = CMD_MAILBOX_VERSION;
+  shm->num_slots = CMD_MAILBOX_SLOTS;
+
+  pthread_mutexattr_t ma;
+  pthread_mutexattr_init(&ma);
+  pthread_mutexattr_setpshared(&ma, PTHREAD_PROCESS_SHARED);
+  pthread_mutex_init(&shm->bell_lock, &ma);
+  pthread_mutexattr_destroy(&ma);
+
+  pthread_condattr_t ca;
+  pthread_condattr_init(&ca);
+  pthread_condattr_setpshared(&ca, PTHREAD_PROCESS_SHARED);
+  pthread_condattr_setclock(&ca, CLOCK_MONOTONIC);
+  pthread_cond_init(&shm->bell, &ca);
+  pthread_condattr_destroy(&ca);
+
+  atomic_store_explicit(&shm->magic, CMD_MAILBOX_MAGIC, memory_order_release);
+
+  g_shm = shm;
+  g_handler = handler;
+  atomic_store(&g_running, 1);
+  if (pthread_create(&g_thread, NULL, mailbox_thread, NULL) != 0) {
+    atomic_store(&g_running, 0);
+    munmap(shm, sizeof(*shm));
+    shm_unlink(CMD_MAILBOX_NAME);
+    g_shm = NULL;
+    return -1;
+  }
+
+  sls_log(LOG_LEVEL_INFO, "CMD", "mailbox at shm:%s (%d slots)", CMD_MAILBOX_NAME,
+          CMD_MAILBOX_SLOTS);
+  return 0;
+}
+
+void cmd_mailbox_server_stop(void) {
+  if (!g_shm)
+    return;
+  atomic_store(&g_running, 0);
+  pthread_mutex_lock(&g_shm->bell_lock);
+  pthread_cond_signal(&g_shm->bell);
+  pthread_mutex_unlock(&g_shm->bell_lock);
+  pthread_join(g_thread, NULL);
+
+  shm_unlink(CMD_MAILBOX_NAME);
+  munmap(g_shm, sizeof(*g_shm));
+  g_shm = NULL;
+}
+
+void cmd_mailbox_publish_state(const cmd_mailbox_state_t *state) {
+  cmd_mailbox_shm_t *shm = g_shm;
+  if (!shm)
+    return;
+
+  // Several server threads publish; the seqlock itself allows one writer
+  pthread_mutex_lock(&g_publish_lock);
+  unsigned seq = atomic_load_explicit(&shm->state_seq, memory_order_relaxed);
+  atomic_store_explicit(&shm->state_seq, seq + 1, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+  shm->state = *state;
+  atomic_store_explicit(&shm->state_seq, seq + 2, memory_order_release);
+  pthread_mutex_unlock(&g_publish_lock);
+}
+
+int cmd_mailbox_open(cmd_mailbox_client_t *client) {
+  memset(client, 0, sizeof(*client));
+
+  int fd = shm_open(CMD_MAILBOX_NAME, O_RDWR, 0);
+  if (fd < 0)
+    return -1;
+  cmd_mailbox_shm_t *shm = mmap(NULL, sizeof(*shm), PROT_READ | PROT_WRITE,
+                                MAP_SHARED, fd, 0);
+  close(fd);
+  if (shm == MAP_FAILED)
+    return -1;
+
+  if (atomic_load_explicit(&shm->magic, memory_order_acquire) != CMD_MAILBOX_MAGIC ||
+      shm->version != CMD_MAILBOX_VERSION) {
+    munmap(shm, sizeof(*shm));
+    errno = EPROTO;
+    return -1;
+  }
+
+  // Claim a free slot, or one whose owner has exited
+  unsigned me = (unsigned)getpid();
+  cmd_mailbox_slot_t *slot = NULL;
+  for (int pass = 0; pass < 2 && !slot; pass++) {
+    for (int i = 0; i < CMD_MAILBOX_SLOTS; i++) {
+      cmd_mailbox_slot_t *s = &shm->slots[i];
+      unsigned owner = atomic_load(&s->owner_pid);
+      if (pass == 0 && owner != 0)
+        continue;
+      if (pass == 1 && (owner == 0 || kill((pid_t)owner, 0) == 0 || errno != ESRCH))
+        continue;
+      if (atomic_compare_exchange_strong(&s->owner_pid, &owner, me)) {
+        slot = s;
+        break;
+      }
+    }
+  }
+  if (!slot) {
+    munmap(shm, sizeof(*shm));
+    errno = EBUSY;
+    return -1;
+  }
+
+  client->shm = shm;
+  client->slot = slot;
+  client->seq = atomic_load(&slot->req_seq);
+  return 0;
+}
+
+int cmd_mailbox_call(cmd_mailbox_client_t *client, const sim_msg_t *req,
+                     sim_reply_t *rep, int timeout_ms) {
+  cmd_mailbox_slot_t *s = client->slot;
+  cmd_mailbox_shm_t *shm = client->shm;
+  if (!s) {
+    errno = EBADF;
+    return -1;
+  }
+
+  unsigned seq = ++client->seq;
+  s->req = *req;
+  atomic_store(&s->req_seq, seq); // seq_cst: ordered before the sleeping check
+
+  if (atomic_load(&shm->server_sleeping)) {
+    pthread_mutex_lock(&shm->bell_lock);
+    pthread_cond_signal(&shm->bell);
+    pthread_mutex_unlock(&shm->bell_lock);
+  }
+
+  unsigned max_spins = client_spin_iters();
+  sls_time_ns_t deadline = 0;
+  for (unsigned spins = 0;
+       atomic_load_explicit(&s->rep_seq, memory_order_acquire) != seq; spins++) {
+    if (spins < max_spins) {
+      cpu_relax();
+      continue;
+    }
+    if (deadline == 0)
+      deadline = sls_time_monotonic_ns() + (sls_time_ns_t)timeout_ms * SLS_NS_PER_MS;
+    else if (sls_time_monotonic_ns() > deadline) {
+      errno = ETIMEDOUT;
+      return -1;
+    }
+    sched_yield();
+  }
+  *rep = s->rep;
+  return 0;
+}
+
+int cmd_mailbox_read_state(const cmd_mailbox_client_t *client,
+                           cmd_mailbox_state_t *state) {
+  cmd_mailbox_shm_t *shm = client->shm;
+  if (!shm) {
+    errno = EBADF;
+    return -1;
+  }
+  for (;;) {
+    unsigned s1 = atomic_load_explicit(&shm->state_seq, memory_order_acquire);
+    if (s1 & 1u) {
+      cpu_relax();
+      continue;
+    }
+    *state = shm->state;
+    atomic_thread_fence(memory_order_acquire);
+    if (atomic_load_explicit(&shm->state_seq, memory_order_relaxed) == s1)
+      return 0;
+  }
+}
+
+void cmd_mailbox_close(cmd_mailbox_client_t *client) {
+  if (client->slot)
+    atomic_store(&client->slot->owner_pid, 0u);
+  if (client->shm)
+    munmap(client->shm, sizeof(*client->shm));
+  memset(client, 0, sizeof(*client));
+}
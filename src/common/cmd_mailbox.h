@@ -0,0 +1,63 @@
+// cmd_mailbox.h — shared-memory command mailbox for co-located clients
+#ifndef CMD_MAILBOX_H
+#define CMD_MAILBOX_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include "cmd_protocol.h"
+#include "sim_proto.h"
+
+// The command server maps a POSIX shm object holding one request/reply slot
+// per client plus a seqlock-protected state snapshot. A client claims a
+// slot, writes a sim_msg_t, bumps req_seq and spins until rep_seq catches
+// up; reading state is a plain seqlock read. Neither takes a syscall while
+// the server is busy. An idle server parks on a process-shared condvar and
+// the client rings it, which is the only syscall on the client side.
+
+#define CMD_MAILBOX_NAME "/sls_cmd_mailbox"
+#define CMD_MAILBOX_MAGIC 0x534c534dU // "SLSM"
+#define CMD_MAILBOX_VERSION 1
+#define CMD_MAILBOX_SLOTS 16
+
+// State snapshot readable by every client
+typedef struct {
+  uint32_t seq; // command sequence of the last accepted command
+  int32_t mission_go;
+  int32_t throttle;
+  double channels[CMD_CH_COUNT];
+} cmd_mailbox_state_t;
+
+typedef struct {
+  _Alignas(64) atomic_uint owner_pid; // 0 = free
+  _Alignas(64) atomic_uint req_seq;   // written by the client
+  sim_msg_t req;
+  _Alignas(64) atomic_uint rep_seq; // written by the server
+  sim_reply_t rep;
+} cmd_mailbox_slot_t;
+
+typedef struct cmd_mailbox_shm cmd_mailbox_shm_t;
+
+// Client handle
+typedef struct {
+  cmd_mailbox_shm_t *shm;
+  cmd_mailbox_slot_t *slot;
+  uint32_t seq;
+} cmd_mailbox_client_t;
+
+// Server side (owned by cmd_server). The handler runs on the mailbox thread.
+typedef void (*cmd_mailbox_handler_t)(const sim_msg_t *req, sim_reply_t *rep);
+int cmd_mailbox_server_start(cmd_mailbox_handler_t handler);
+void cmd_mailbox_server_stop(void);
+void cmd_mailbox_publish_state(const cmd_mailbox_state_t *state);
+
+// Client side. Return 0 on success, -1 on error (errno set; ETIMEDOUT when
+// the server does not answer within timeout_ms).
+int cmd_mailbox_open(cmd_mailbox_client_t *client);
+int cmd_mailbox_call(cmd_mailbox_client_t *client, const sim_msg_t *req,
+                     sim_reply_t *rep, int timeout_ms);
+int cmd_mailbox_read_state(const cmd_mailbox_client_t *client,
+                           cmd_mailbox_state_t *state);
+void cmd_mailbox_close(cmd_mailbox_client_t *client);
+
+#endif // CMD_MAILBOX_H
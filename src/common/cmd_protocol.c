@@ -0,0 +1,359 @@
+// cmd_protocol.c — single-pass parsing and formatting of command server lines
+
+#include <string.h>
+
+#include "cmd_protocol.h"
+#include "sls_json.h"
+
+typedef struct {
+  const char *name;
+  size_t len;
+  cmd_request_type_t type;
+} cmd_name_entry_t;
+
+static const cmd_name_entry_t k_cmd_names[] = {
+    {"status", 6, CMD_REQ_STATUS},
+    {"go", 2, CMD_REQ_GO},
+    {"nogo", 4, CMD_REQ_NOGO},
+    {"abort", 5, CMD_REQ_ABORT},
+    {"set_throttle", 12, CMD_REQ_SET_THROTTLE},
+    {"subscribe", 9, CMD_REQ_SUBSCRIBE},
+    {"unsubscribe", 11, CMD_REQ_UNSUBSCRIBE},
+    {"latency", 7, CMD_REQ_LATENCY},
+};
+
+static const char *const k_channel_names[CMD_CH_COUNT] = {
+    "mission_time", "altitude", "velocity",   "acceleration",
+    "fuel",         "thrust",   "throttle",   "chamber_pressure",
+};
+
+static cmd_request_type_t lookup_cmd(const sls_json_token_t *tok) {
+  if (tok->escaped) {
+    for (size_t i = 0; i < sizeof(k_cmd_names) / sizeof(k_cmd_names[0]); i++) {
+      if (sls_json_token_equals(tok, k_cmd_names[i].name))
+        return k_cmd_names[i].type;
+    }
+    return CMD_REQ_UNKNOWN;
+  }
+  for (size_t i = 0; i < sizeof(k_cmd_names) / sizeof(k_cmd_names[0]); i++) {
+    if (tok->length == k_cmd_names[i].len &&
+        memcmp(tok->start, k_cmd_names[i].name, tok->length) == 0)
+      return k_cmd_names[i].type;
+  }
+  return CMD_REQ_UNKNOWN;
+}
+
+// Returns the channel bit for a name, "all" for every channel, 0 if unknown
+static uint32_t lookup_channel(const sls_json_token_t *tok) {
+  if (sls_json_token_equals(tok, "all"))
+    return CMD_CH_ALL;
+  for (int i = 0; i < CMD_CH_COUNT; i++) {
+    if (sls_json_token_equals(tok, k_channel_names[i]))
+      return 1u << i;
+  }
+  return 0;
+}
+
+typedef enum {
+  FIELD_OTHER = 0,
+  FIELD_CMD,
+  FIELD_VALUE,
+  FIELD_ID,
+  FIELD_CHANNELS,
+  FIELD_RATE,
+  FIELD_MODE
+} cmd_field_t;
+
+// Key dispatch by length first, so each key costs at most one memcmp
+static cmd_field_t lookup_field(const sls_json_token_t *key) {
+  if (key->escaped)
+    return sls_json_token_equals(key, "cmd")     ? FIELD_CMD
+           : sls_json_token_equals(key, "value") ? FIELD_VALUE
+           : sls_json_token_equals(key, "id")    ? FIELD_ID
+           : sls_json_token_equals(key, "channels") ? FIELD_CHANNELS
+           : sls_json_token_equals(key, "rate_hz")  ? FIELD_RATE
+           : sls_json_token_equals(key, "mode")     ? FIELD_MODE
+                                                    : FIELD_OTHER;
+  switch (key->length) {
+  case 2:
+    return memcmp(key->start, "id", 2) == 0 ? FIELD_ID : FIELD_OTHER;
+  case 3:
+    return memcmp(key->start, "cmd", 3) == 0 ? FIELD_CMD : FIELD_OTHER;
+  case 4:
+    return memcmp(key->start, "mode", 4) == 0 ? FIELD_MODE : FIELD_OTHER;
+  case 5:
+    return memcmp(key->start, "value", 5) == 0 ? FIELD_VALUE : FIELD_OTHER;
+  case 7:
+    return memcmp(key->start, "rate_hz", 7) == 0 ? FIELD_RATE : FIELD_OTHER;
+  case 8:
+    return memcmp(key->start, "channels", 8) == 0 ? FIELD_CHANNELS
+                                                  : FIELD_OTHER;
+  default:
+    return FIELD_OTHER;
+  }
+}
+
+int cmd_parse_request(const char *line, size_t len, cmd_request_t *req) {
+  memset(req, 0, sizeof(*req));
+
+  sls_json_reader_t rd;
+  sls_json_token_t tok;
+  sls_json_reader_init(&rd, line, len);
+
+  if (sls_json_next(&rd, &tok) != SLS_JSON_OBJECT_BEGIN)
+    return CMD_PARSE_MALFORMED;
+
+  int have_cmd = 0;
+  int status = CMD_PARSE_OK;
+
+  for (;;) {
+    sls_json_token_type_t t = sls_json_next(&rd, &tok);
+    if (t == SLS_JSON_OBJECT_END)
+      break;
+    if (t != SLS_JSON_KEY)
+      return CMD_PARSE_MALFORMED;
+
+    cmd_field_t field = lookup_field(&tok);
+    t = sls_json_next(&rd, &tok);
+    if (t == SLS_JSON_ERROR || t == SLS_JSON_END)
+      return CMD_PARSE_MALFORMED;
+
+    if (field == FIELD_CMD) {
+      if (t != SLS_JSON_STRING)
+        return CMD_PARSE_MALFORMED;
+      req->type = lookup_cmd(&tok);
+      have_cmd = 1;
+    } else if (field == FIELD_VALUE) {
+      long v;
+      if (sls_json_token_to_long(&tok, &v) != 0) {
+        status = CMD_PARSE_BAD_VALUE; // Keep going so the id is still echoed
+      } else {
+        req->value = v;
+        req->fields |= CMD_FIELD_VALUE;
+      }
+    } else if (field == FIELD_ID) {
+      long v;
+      if (sls_json_token_to_long(&tok, &v) == 0 && v >= 0 && v <= (long)UINT32_MAX) {
+        req->id = (uint32_t)v;
+        req->fields |= CMD_FIELD_ID;
+      }
+    } else if (field == FIELD_CHANNELS) {
+      // Either one name or an array of names
+      if (t == SLS_JSON_STRING) {
+        req->channels = lookup_channel(&tok);
+        if (!req->channels)
+          status = CMD_PARSE_UNKNOWN_CHANNEL;
+      } else if (t == SLS_JSON_ARRAY_BEGIN) {
+        while ((t = sls_json_next(&rd, &tok)) == SLS_JSON_STRING) {
+          uint32_t bit = lookup_channel(&tok);
+          if (!bit)
+            status = CMD_PARSE_UNKNOWN_CHANNEL;
+          req->channels |= bit;
+        }
+        if (t != SLS_JSON_ARRAY_END)
+          return CMD_PARSE_MALFORMED;
+      } else {
+        status = CMD_PARSE_BAD_VALUE;
+        if (sls_json_skip_value(&rd, &tok) != 0)
+          return CMD_PARSE_MALFORMED;
+      }
+      req->fields |= CMD_FIELD_CHANNELS;
+    } else if (field == FIELD_RATE) {
+      long v;
+      if (sls_json_token_to_long(&tok, &v) != 0 || v <= 0) {
+        status = CMD_PARSE_BAD_VALUE;
+      } else {
+        req->rate_hz = v;
+        req->fields |= CMD_FIELD_RATE;
+      }
+    } else if (field == FIELD_MODE) {
+      if (t == SLS_JSON_STRING && sls_json_token_equals(&tok, "json")) {
+        req->mode = CMD_STREAM_JSON;
+      } else if (t == SLS_JSON_STRING && sls_json_token_equals(&tok, "binary")) {
+        req->mode = CMD_STREAM_BINARY;
+      } else {
+        status = CMD_PARSE_BAD_VALUE;
+        if (sls_json_skip_value(&rd, &tok) != 0)
+          return CMD_PARSE_MALFORMED;
+      }
+      req->fields |= CMD_FIELD_MODE;
+    } else if (sls_json_skip_value(&rd, &tok) != 0) {
+      return CMD_PARSE_MALFORMED;
+    }
+  }
+
+  // Nothing but whitespace may follow the object
+  if (sls_json_next(&rd, &tok) != SLS_JSON_END)
+    return CMD_PARSE_MALFORMED;
+
+  if (!have_cmd)
+    return CMD_PARSE_MISSING_CMD;
+  if (req->type == CMD_REQ_UNKNOWN)
+    return CMD_PARSE_UNKNOWN_CMD;
+  if (status != CMD_PARSE_OK)
+    return status;
+  if (req->type == CMD_REQ_SET_THROTTLE && !(req->fields & CMD_FIELD_VALUE))
+    return CMD_PARSE_MISSING_VALUE;
+  return CMD_PARSE_OK;
+}
+
+const char *cmd_request_name(cmd_request_type_t type) {
+  switch (type) {
+  case CMD_REQ_STATUS:
+    return "status";
+  case CMD_REQ_GO:
+    return "go";
+  case CMD_REQ_NOGO:
+    return "nogo";
+  case CMD_REQ_ABORT:
+    return "abort";
+  case CMD_REQ_SET_THROTTLE:
+    return "set_throttle";
+  case CMD_REQ_SUBSCRIBE:
+    return "subscribe";
+  case CMD_REQ_UNSUBSCRIBE:
+    return "unsubscribe";
+  case CMD_REQ_LATENCY:
+    return "latency";
+  default:
+    return "unknown";
+  }
+}
+
+const char *cmd_channel_name(cmd_channel_t ch) {
+  if ((int)ch < 0 || ch >= CMD_CH_COUNT)
+    return "unknown";
+  return k_channel_names[ch];
+}
+
+const char *cmd_parse_status_string(int status) {
+  switch (status) {
+  case CMD_PARSE_OK:
+    return "ok";
+  case CMD_PARSE_MALFORMED:
+    return "malformed json";
+  case CMD_PARSE_MISSING_CMD:
+    return "missing cmd";
+  case CMD_PARSE_UNKNOWN_CMD:
+    return "unknown cmd";
+  case CMD_PARSE_MISSING_VALUE:
+    return "missing value";
+  case CMD_PARSE_BAD_VALUE:
+    return "invalid value";
+  case CMD_PARSE_UNKNOWN_CHANNEL:
+    return "unknown channel";
+  default:
+    return "error";
+  }
+}
+
+static void write_id(sls_json_writer_t *w, const cmd_request_t *req) {
+  if (req && (req->fields & CMD_FIELD_ID)) {
+    sls_json_write_key(w, "id");
+    sls_json_write_uint(w, req->id);
+  }
+}
+
+int cmd_format_status(char *out, size_t out_sz, const cmd_request_t *req,
+                      int mission_go, int throttle) {
+  sls_json_writer_t w;
+  sls_json_writer_init(&w, out, out_sz);
+  sls_json_begin_object(&w);
+  sls_json_write_key(&w, "type");
+  sls_json_write_string(&w, "status");
+  write_id(&w, req);
+  sls_json_write_key(&w, "go");
+  sls_json_write_bool(&w, mission_go != 0);
+  sls_json_write_key(&w, "throttle");
+  sls_json_write_int(&w, throttle);
+  sls_json_end_object(&w);
+  return sls_json_writer_finish_line(&w);
+}
+
+int cmd_format_ack(char *out, size_t out_sz, const cmd_request_t *req) {
+  sls_json_writer_t w;
+  sls_json_writer_init(&w, out, out_sz);
+  sls_json_begin_object(&w);
+  sls_json_write_key(&w, "type");
+  sls_json_write_string(&w, "ack");
+  sls_json_write_key(&w, "cmd");
+  sls_json_write_string(&w, cmd_request_name(req->type));
+  write_id(&w, req);
+  if (req->fields & CMD_FIELD_SEQ) {
+    sls_json_write_key(&w, "seq");
+    sls_json_write_uint(&w, req->seq);
+  }
+  if (req->type == CMD_REQ_SET_THROTTLE) {
+    sls_json_write_key(&w, "value");
+    sls_json_write_int(&w, req->value);
+  } else if (req->type == CMD_REQ_SUBSCRIBE) {
+    sls_json_write_key(&w, "rate_hz");
+    sls_json_write_int(&w, req->rate_hz);
+    sls_json_write_key(&w, "mode");
+    sls_json_write_string(&w, req->mode == CMD_STREAM_BINARY ? "binary" : "json");
+  }
+  sls_json_end_object(&w);
+  return sls_json_writer_finish_line(&w);
+}
+
+int cmd_format_error(char *out, size_t out_sz, const cmd_request_t *req,
+                     const char *msg) {
+  sls_json_writer_t w;
+  sls_json_writer_init(&w, out, out_sz);
+  sls_json_begin_object(&w);
+  sls_json_write_key(&w, "type");
+  sls_json_write_string(&w, "error");
+  write_id(&w, req);
+  sls_json_write_key(&w, "msg");
+  sls_json_write_string(&w, msg);
+  sls_json_end_object(&w);
+  return sls_json_writer_finish_line(&w);
+}
+
+int cmd_format_frame_json(char *out, size_t out_sz, uint32_t seq,
+                          uint32_t mask, const double *values) {
+  sls_json_writer_t w;
+  sls_json_writer_init(&w, out, out_sz);
+  sls_json_begin_object(&w);
+  sls_json_write_key(&w, "type");
+  sls_json_write_string(&w, "telemetry");
+  sls_json_write_key(&w, "seq");
+  sls_json_write_uint(&w, seq);
+  for (int i = 0; i < CMD_CH_COUNT; i++) {
+    if (mask & (1u << i)) {
+      sls_json_write_key(&w, k_channel_names[i]);
+      sls_json_write_double(&w, values[i], 3);
+    }
+  }
+  sls_json_end_object(&w);
+  return sls_json_writer_finish_line(&w);
+}
+
+static void put_le(unsigned char *p, uint64_t v, int bytes) {
+  for (int i = 0; i < bytes; i++)
+    p[i] = (unsigned char)(v >> (8 * i));
+}
+
+int cmd_format_frame_binary(char *out, size_t out_sz, uint32_t seq,
+                            uint32_t mask, const double *values) {
+  mask &= CMD_CH_ALL;
+  size_t payload = 8 + 8 * (size_t)__builtin_popcount(mask);
+  if (out_sz < CMD_FRAME_HEADER_SZ + payload)
+    return -1;
+
+  unsigned char *p = (unsigned char *)out;
+  p[0] = CMD_FRAME_MAGIC;
+  put_le(p + 1, payload, 2);
+  put_le(p + 3, seq, 4);
+  put_le(p + 7, mask, 4);
+  p += 11;
+  for (int i = 0; i < CMD_CH_COUNT; i++) {
+    if (mask & (1u << i)) {
+      uint64_t bits;
+      memcpy(&bits, &values[i], sizeof(bits));
+      put_le(p, bits, 8);
+      p += 8;
+    }
+  }
+  return (int)(CMD_FRAME_HEADER_SZ + payload);
+}
@@ -0,0 +1,109 @@
+// cmd_protocol.h — typed command records for the GUI command server
+#ifndef CMD_PROTOCOL_H
+#define CMD_PROTOCOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Command types; numeric values mirror cmd_t in qnx/ipc.h so the JSON and
+// QNX message-passing front ends agree on command identity.
+typedef enum {
+  CMD_REQ_UNKNOWN = 0,
+  CMD_REQ_STATUS = 1,
+  CMD_REQ_GO = 2,
+  CMD_REQ_NOGO = 3,
+  CMD_REQ_ABORT = 4,
+  CMD_REQ_SET_THROTTLE = 5,
+  CMD_REQ_SUBSCRIBE = 6,
+  CMD_REQ_UNSUBSCRIBE = 7,
+  CMD_REQ_LATENCY = 8,
+} cmd_request_type_t;
+
+// Telemetry channels that can be streamed to subscribers
+typedef enum {
+  CMD_CH_MISSION_TIME = 0,
+  CMD_CH_ALTITUDE,
+  CMD_CH_VELOCITY,
+  CMD_CH_ACCELERATION,
+  CMD_CH_FUEL,
+  CMD_CH_THRUST,
+  CMD_CH_THROTTLE,
+  CMD_CH_CHAMBER_PRESSURE,
+  CMD_CH_COUNT
+} cmd_channel_t;
+
+#define CMD_CH_ALL ((1u << CMD_CH_COUNT) - 1u)
+
+// Stream frame encodings
+typedef enum {
+  CMD_STREAM_JSON = 0,
+  CMD_STREAM_BINARY = 1,
+} cmd_stream_mode_t;
+
+#define CMD_STREAM_MAX_HZ 50
+
+// Binary frame layout (all integers and doubles little-endian):
+//   u8  CMD_FRAME_MAGIC
+//   u16 payload length (bytes after this field)
+//   u32 sequence, u32 channel mask,
+//   f64 value for each set mask bit, lowest channel first
+// The magic byte is never valid at the start of a JSON line, so clients
+// can tell frames and replies apart by their first byte.
+#define CMD_FRAME_MAGIC 0xB5
+#define CMD_FRAME_HEADER_SZ 3
+#define CMD_FRAME_MAX_SZ (CMD_FRAME_HEADER_SZ + 8 + 8 * CMD_CH_COUNT)
+
+typedef enum {
+  CMD_PARSE_OK = 0,
+  CMD_PARSE_MALFORMED,
+  CMD_PARSE_MISSING_CMD,
+  CMD_PARSE_UNKNOWN_CMD,
+  CMD_PARSE_MISSING_VALUE,
+  CMD_PARSE_BAD_VALUE,
+  CMD_PARSE_UNKNOWN_CHANNEL,
+} cmd_parse_status_t;
+
+// Presence bits for optional fields
+#define CMD_FIELD_VALUE (1u << 0)
+#define CMD_FIELD_ID (1u << 1)
+#define CMD_FIELD_CHANNELS (1u << 2)
+#define CMD_FIELD_RATE (1u << 3)
+#define CMD_FIELD_MODE (1u << 4)
+#define CMD_FIELD_SEQ (1u << 5) // set by the server, not parsed
+
+// One parsed request line, e.g. {"cmd":"set_throttle","value":75,"id":12}
+// or {"cmd":"subscribe","channels":["altitude","fuel"],"rate_hz":10}
+typedef struct {
+  cmd_request_type_t type;
+  uint32_t fields;        // CMD_FIELD_* bits
+  long value;             // "value"
+  uint32_t id;            // "id": client correlation tag, echoed in replies
+  uint32_t channels;      // "channels": mask of cmd_channel_t bits
+  long rate_hz;           // "rate_hz"
+  cmd_stream_mode_t mode; // "mode": "json" or "binary"
+  uint32_t seq;           // command sequence number once queued
+} cmd_request_t;
+
+// Parse one line (no trailing newline required, need not be NUL terminated).
+// Returns a cmd_parse_status_t; req is filled as far as parsing got.
+int cmd_parse_request(const char *line, size_t len, cmd_request_t *req);
+
+const char *cmd_request_name(cmd_request_type_t type);
+const char *cmd_channel_name(cmd_channel_t ch);
+const char *cmd_parse_status_string(int status);
+
+// Reply formatting. Each returns the line length (including '\n') or -1.
+int cmd_format_status(char *out, size_t out_sz, const cmd_request_t *req,
+                      int mission_go, int throttle);
+int cmd_format_ack(char *out, size_t out_sz, const cmd_request_t *req);
+int cmd_format_error(char *out, size_t out_sz, const cmd_request_t *req,
+                     const char *msg);
+
+// Stream frames. values[] is indexed by cmd_channel_t; only channels in
+// mask are encoded. Each returns the frame length or -1.
+int cmd_format_frame_json(char *out, size_t out_sz, uint32_t seq,
+                          uint32_t mask, const double *values);
+int cmd_format_frame_binary(char *out, size_t out_sz, uint32_t seq,
+                            uint32_t mask, const double *values);
+
+#endif // CMD_PROTOCOL_H
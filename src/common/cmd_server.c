@@ -1,108 +1,771 @@
 // cmd_server.c — simple TCP command server for GUI Chat
 // POSIX implementation; for QNX, this should compile the same with qcc
+// Local clients can also use a Unix seqpacket socket (same protocol, one
+// line or batch of records per message) or the shm mailbox (cmd_mailbox.h).
 
 #include <arpa/inet.h>
 #include <errno.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <pthread.h>
 #include <signal.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <time.h>
 #include <unistd.h>
 
-#include "sls_logging.h"
+#include "cmd_mailbox.h"
+#include "cmd_protocol.h"
 #include "cmd_server.h"
+#include "cmd_trace.h"
+#include "sim_proto.h"
+#include "sls_cmd_queue.h"
+#include "sls_config.h"
+#include "sls_logging.h"
+#include "sls_metrics.h"
+#include "sls_utils.h"
 
 #define CMD_PORT 5055
+#define CMD_UNIX_PATH "/tmp/sls_cmd.sock"
 #define BUF_SZ 2048
+#define REPLY_SZ 4096 // latency reports are the largest replies
+#define FRAME_BUF_SZ 512 // Largest JSON frame (all channels) fits easily
+#define DEFAULT_STREAM_HZ 10
+
+#ifdef MSG_NOSIGNAL
+#define SEND_FLAGS MSG_NOSIGNAL
+#else
+#define SEND_FLAGS 0
+#endif
+
+#ifndef MSG_DONTWAIT
+#define MSG_DONTWAIT 0
+#endif
+
+// One slot per connected client. Replies (client thread) and stream frames
+// (stream thread) share the socket, so every write happens under tx_lock.
+typedef struct {
+  atomic_int in_use;
+  int sock;
+  int seqpacket; // Unix listener: one recv is one whole client message
+  pthread_mutex_t tx_lock;
+
+  // Subscription: written by the client thread, read by the stream thread
+  atomic_uint sub_mask; // cmd_channel_t bits, 0 = not subscribed
+  atomic_int sub_mode;  // cmd_stream_mode_t
+  atomic_int sub_period; // stream ticks between frames
+
+  // Tail of a frame the socket only partly accepted (guarded by tx_lock).
+  // At most one frame is ever pending; newer frames are dropped meanwhile.
+  char pending[FRAME_BUF_SZ];
+  size_t pending_off;
+  size_t pending_len;
+
+  atomic_ulong frames_sent;
+  atomic_ulong frames_dropped;
+} cmd_conn_t;
 
 static volatile int g_server_running = 0;
 static int g_listen_fd = -1;
+static int g_unix_fd = -1;
+static cmd_conn_t g_conns[QNX_MAX_CLIENTS];
+static int g_conns_initialized = 0;
+
+// Shared state is grouped by writer, one cache line per group, so no writer
+// evicts a line that another writer or a polling reader is using.
+
+// Commanded state as last accepted from clients, for status replies. The
+// subsystems act on the queued commands, not on these. Written by the
+// client thread accepting a command.
+static struct {
+  _Alignas(SLS_CACHE_LINE) atomic_int mission_go;
+  atomic_int engine_throttle; // percent
+  atomic_uint last_seq;       // last accepted command, for the mailbox
+} g_commanded;
+
+// Latest channel values, stored as double bit patterns. One line per
+// channel: flight control (100 Hz) and engine control (50 Hz) publish
+// different channels, and the stream thread reads them all.
+typedef struct {
+  _Alignas(SLS_CACHE_LINE) _Atomic uint64_t bits;
+} channel_cell_t;
+static channel_cell_t g_channels[CMD_CH_COUNT];
+
+// Written by the stream thread only
+static struct {
+  _Alignas(SLS_CACHE_LINE) atomic_ulong frames_sent;
+  atomic_ulong frames_dropped;
+} g_stream;
 
-// Shared state (TODO: wire to real subsystems)
-static int g_mission_go = 0;
-static int g_engine_throttle = 0; // percent
-
-int cmd_get_mission_go(void) { return g_mission_go; }
-int cmd_get_engine_throttle(void) { return g_engine_throttle; }
-
-static void handle_command(const char *line, char *out, size_t out_sz) {
-  // Extremely naive JSON-ish parser for the commands we support
-  // Expect examples:
-  // {"cmd":"status"}\n
-  if (strstr(line, "\"status\"")) {
-    snprintf(out, out_sz,
-             "{\"type\":\"status\",\"go\":%s,\"throttle\":%d}\n",
-             g_mission_go ? "true" : "false", g_engine_throttle);
+// Operator commands by outcome (registered in cmd_server_start)
+static sls_metric_t *g_cmds_accepted;
+static sls_metric_t *g_cmds_rejected;
+
+int cmd_get_mission_go(void) { return atomic_load(&g_commanded.mission_go); }
+int cmd_get_engine_throttle(void) { return atomic_load(&g_commanded.engine_throttle); }
+
+void cmd_publish_channel(cmd_channel_t ch, double value) {
+  if ((int)ch < 0 || ch >= CMD_CH_COUNT)
     return;
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  atomic_store_explicit(&g_channels[ch].bits, bits, memory_order_relaxed);
+}
+
+void cmd_get_stream_stats(uint64_t *frames_sent, uint64_t *frames_dropped) {
+  if (frames_sent)
+    *frames_sent = atomic_load(&g_stream.frames_sent);
+  if (frames_dropped)
+    *frames_dropped = atomic_load(&g_stream.frames_dropped);
+}
+
+static void load_channels(double values[CMD_CH_COUNT]) {
+  for (int ch = 0; ch < CMD_CH_COUNT; ch++) {
+    uint64_t bits = atomic_load_explicit(&g_channels[ch].bits, memory_order_relaxed);
+    memcpy(&values[ch], &bits, sizeof(bits));
   }
-  if (strstr(line, "\"go\"")) {
-    g_mission_go = 1;
-    snprintf(out, out_sz, "{\"type\":\"ack\",\"cmd\":\"go\"}\n");
+}
+
+// Refresh the mailbox state snapshot (no-op when the mailbox is down)
+static void publish_mailbox_state(void) {
+  cmd_mailbox_state_t st;
+  st.seq = atomic_load(&g_commanded.last_seq);
+  st.mission_go = atomic_load(&g_commanded.mission_go);
+  st.throttle = atomic_load(&g_commanded.engine_throttle);
+  load_channels(st.channels);
+  cmd_mailbox_publish_state(&st);
+}
+
+static void subscribe(cmd_conn_t *c, cmd_request_t *req) {
+  if (!(req->fields & CMD_FIELD_CHANNELS))
+    req->channels = CMD_CH_ALL;
+  if (!(req->fields & CMD_FIELD_RATE))
+    req->rate_hz = DEFAULT_STREAM_HZ;
+  if (req->rate_hz > CMD_STREAM_MAX_HZ)
+    req->rate_hz = CMD_STREAM_MAX_HZ;
+
+  // Rates are whole divisions of the stream tick; report the one in effect
+  int period = (int)(CMD_STREAM_MAX_HZ / req->rate_hz);
+  req->rate_hz = CMD_STREAM_MAX_HZ / period;
+
+  atomic_store(&c->sub_mode, (int)req->mode);
+  atomic_store(&c->sub_period, period);
+  atomic_store(&c->sub_mask, req->channels);
+}
+
+// Queue an operator command for engine control and update the commanded
+// state. Shared by the JSON and binary front ends. Returns the command's
+// sequence number, 0 if the queue was full.
+static uint32_t submit_operator_command(command_opcode_t op, long value,
+                                        uint64_t recv_ns, uint64_t parse_ns) {
+  if (op == CMD_OP_SET_THROTTLE)
+    value = value < 0 ? 0 : (value > 100 ? 100 : value);
+
+  command_t cmd;
+  memset(&cmd, 0, sizeof(cmd));
+  cmd.target_subsystem = SUBSYS_ENGINE_CONTROL;
+  cmd.opcode = op;
+  cmd.value = (double)value;
+  cmd.stage_ns[CMD_STAGE_RECV] = recv_ns;
+  cmd.stage_ns[CMD_STAGE_PARSE] = parse_ns;
+  uint32_t seq = sls_cmd_submit_command(&cmd);
+  if (op == CMD_OP_ABORT)
+    sls_request_mission_abort("operator abort command");
+  if (g_cmds_accepted)
+    sls_metric_inc(seq ? g_cmds_accepted : g_cmds_rejected);
+  if (seq == 0)
+    return 0;
+
+  switch (op) {
+  case CMD_OP_GO:
+    atomic_store(&g_commanded.mission_go, 1);
+    break;
+  case CMD_OP_NOGO:
+    atomic_store(&g_commanded.mission_go, 0);
+    break;
+  case CMD_OP_ABORT:
+    atomic_store(&g_commanded.mission_go, 0);
+    atomic_store(&g_commanded.engine_throttle, 0);
+    break;
+  case CMD_OP_SET_THROTTLE:
+    atomic_store(&g_commanded.engine_throttle, (int)value);
+    break;
+  default:
+    break;
+  }
+  atomic_store(&g_commanded.last_seq, seq);
+  publish_mailbox_state();
+  return seq;
+}
+
+// recv_ns: when the bytes holding this line arrived (latency trace start)
+static void handle_command(cmd_conn_t *c, const char *line, size_t len,
+                           uint64_t recv_ns, char *out, size_t out_sz) {
+  cmd_request_t req;
+  int rc = cmd_parse_request(line, len, &req);
+  uint64_t parse_ns = cmd_trace_now_ns();
+  if (rc != CMD_PARSE_OK) {
+    cmd_format_error(out, out_sz, &req, cmd_parse_status_string(rc));
+    return;
+  }
+
+  command_opcode_t op = CMD_OP_NONE;
+  switch (req.type) {
+  case CMD_REQ_STATUS:
+    cmd_format_status(out, out_sz, &req, atomic_load(&g_commanded.mission_go),
+                      atomic_load(&g_commanded.engine_throttle));
+    return;
+  case CMD_REQ_GO:
+    op = CMD_OP_GO;
+    break;
+  case CMD_REQ_NOGO:
+    op = CMD_OP_NOGO;
+    break;
+  case CMD_REQ_ABORT:
+    op = CMD_OP_ABORT;
+    break;
+  case CMD_REQ_SET_THROTTLE:
+    if (req.value < 0)
+      req.value = 0;
+    if (req.value > 100)
+      req.value = 100;
+    op = CMD_OP_SET_THROTTLE;
+    break;
+  case CMD_REQ_SUBSCRIBE:
+    subscribe(c, &req);
+    break;
+  case CMD_REQ_UNSUBSCRIBE:
+    atomic_store(&c->sub_mask, 0u);
+    break;
+  case CMD_REQ_LATENCY:
+    if (cmd_trace_format_json(out, out_sz, &req) < 0)
+      cmd_format_error(out, out_sz, &req, "reply too large");
     return;
+  default:
+    cmd_format_error(out, out_sz, &req, "unknown cmd");
+    return;
+  }
+
+  if (op != CMD_OP_NONE) {
+    uint32_t seq = submit_operator_command(op, req.value, recv_ns, parse_ns);
+    if (seq == 0) {
+      cmd_format_error(out, out_sz, &req, "command queue full");
+      return;
+    }
+    req.seq = seq;
+    req.fields |= CMD_FIELD_SEQ;
+  }
+  cmd_format_ack(out, out_sz, &req);
+}
+
+// Execute one sim_msg_t: binary socket records and mailbox requests
+static void execute_sim_msg(const sim_msg_t *msg, uint64_t recv_ns,
+                            sim_reply_t *reply) {
+  uint64_t parse_ns = cmd_trace_now_ns();
+  command_opcode_t op = CMD_OP_NONE;
+  reply->ok = 1;
+  switch (msg->type) {
+  case CMD_STATUS:
+    break;
+  case CMD_GO:
+    op = CMD_OP_GO;
+    break;
+  case CMD_NOGO:
+    op = CMD_OP_NOGO;
+    break;
+  case CMD_ABORT:
+    op = CMD_OP_ABORT;
+    break;
+  case CMD_SET_THROTTLE:
+    op = CMD_OP_SET_THROTTLE;
+    break;
+  default:
+    reply->ok = 0;
+    break;
+  }
+  if (op != CMD_OP_NONE && submit_operator_command(op, msg->value, recv_ns, parse_ns) == 0)
+    reply->ok = 0;
+
+  reply->mission_go = atomic_load(&g_commanded.mission_go);
+  reply->throttle = atomic_load(&g_commanded.engine_throttle);
+}
+
+// Binary mode: one fixed record in, one fixed record out
+static void handle_binary(const uint8_t *rec, uint64_t recv_ns, uint8_t *out) {
+  sim_msg_t msg;
+  sim_reply_t reply;
+  sim_msg_decode(rec, &msg);
+  execute_sim_msg(&msg, recv_ns, &reply);
+  sim_reply_encode(&reply, out);
+}
+
+static void mailbox_handler(const sim_msg_t *req, sim_reply_t *rep) {
+  execute_sim_msg(req, cmd_trace_now_ns(), rep);
+}
+
+static int send_all(int sock, const char *data, size_t len) {
+  while (len > 0) {
+    ssize_t n = send(sock, data, len, SEND_FLAGS);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      return -1;
+    }
+    data += n;
+    len -= (size_t)n;
+  }
+  return 0;
+}
+
+// Reply from the client thread; finishes any partly sent frame first so
+// the reply never lands in the middle of one. Blocks like a plain send.
+static int conn_reply(cmd_conn_t *c, const char *data, size_t len) {
+  pthread_mutex_lock(&c->tx_lock);
+  int rc = 0;
+  if (c->pending_len > c->pending_off) {
+    rc = send_all(c->sock, c->pending + c->pending_off,
+                  c->pending_len - c->pending_off);
+    c->pending_off = c->pending_len = 0;
+  }
+  if (rc == 0)
+    rc = send_all(c->sock, data, len);
+  pthread_mutex_unlock(&c->tx_lock);
+  return rc;
+}
+
+// Never blocks: returns 0 when the pending tail is gone, -1 if some remains
+static int flush_pending(cmd_conn_t *c) {
+  while (c->pending_off < c->pending_len) {
+    ssize_t n = send(c->sock, c->pending + c->pending_off,
+                     c->pending_len - c->pending_off, SEND_FLAGS | MSG_DONTWAIT);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      if (errno != EAGAIN && errno != EWOULDBLOCK)
+        c->pending_off = c->pending_len; // Dead socket; recv side cleans up
+      break;
+    }
+    c->pending_off += (size_t)n;
   }
-  if (strstr(line, "\"nogo\"")) {
-    g_mission_go = 0;
-    snprintf(out, out_sz, "{\"type\":\"ack\",\"cmd\":\"nogo\"}\n");
+  if (c->pending_off < c->pending_len)
+    return -1;
+  c->pending_off = c->pending_len = 0;
+  return 0;
+}
+
+static void frame_dropped(cmd_conn_t *c) {
+  atomic_fetch_add_explicit(&c->frames_dropped, 1, memory_order_relaxed);
+  atomic_fetch_add_explicit(&g_stream.frames_dropped, 1, memory_order_relaxed);
+}
+
+// Stream thread side: a slow client gets the newest frame or nothing, never
+// a growing backlog of stale ones.
+static void conn_push_frame(cmd_conn_t *c, const char *frame, size_t len) {
+  if (pthread_mutex_trylock(&c->tx_lock) != 0) {
+    frame_dropped(c); // Client thread is mid-reply
     return;
   }
-  if (strstr(line, "\"abort\"")) {
-    g_mission_go = 0;
-    g_engine_throttle = 0;
-    // TODO: trigger real abort sequence
-    snprintf(out, out_sz, "{\"type\":\"ack\",\"cmd\":\"abort\"}\n");
+  if (c->sock < 0 || atomic_load(&c->sub_mask) == 0 || flush_pending(c) != 0) {
+    frame_dropped(c);
+    pthread_mutex_unlock(&c->tx_lock);
     return;
   }
-  if (strstr(line, "\"set_throttle\"")) {
-    // find value
-    const char *v = strstr(line, "\"value\"");
-    if (v) {
-      int val = atoi(v + 8);
-      if (val < 0)
-        val = 0;
-      if (val > 100)
-        val = 100;
-      g_engine_throttle = val;
-      snprintf(out, out_sz,
-               "{\"type\":\"ack\",\"cmd\":\"set_throttle\",\"value\":%d}\n",
-               val);
-    } else {
-      snprintf(out, out_sz,
-               "{\"type\":\"error\",\"msg\":\"missing value\"}\n");
+
+  ssize_t n;
+  do {
+    n = send(c->sock, frame, len, SEND_FLAGS | MSG_DONTWAIT);
+  } while (n < 0 && errno == EINTR);
+
+  if (n < 0) {
+    frame_dropped(c);
+  } else {
+    if ((size_t)n < len) {
+      // Keep the tail so the stream stays well framed
+      memcpy(c->pending, frame + n, len - (size_t)n);
+      c->pending_off = 0;
+      c->pending_len = len - (size_t)n;
     }
+    atomic_fetch_add_explicit(&c->frames_sent, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&g_stream.frames_sent, 1, memory_order_relaxed);
+  }
+  pthread_mutex_unlock(&c->tx_lock);
+}
+
+// Frames built this tick, one per distinct (channel mask, mode)
+typedef struct {
+  uint32_t mask;
+  int mode;
+  int len;
+  char buf[FRAME_BUF_SZ];
+} stream_frame_t;
+
+static void *stream_thread(void *unused) {
+  (void)unused;
+  static stream_frame_t frames[QNX_MAX_CLIENTS];
+  const long period_ns = 1000000000L / CMD_STREAM_MAX_HZ;
+  uint32_t seq = 0;
+
+  struct timespec next;
+  clock_gettime(CLOCK_MONOTONIC, &next);
+
+  while (g_server_running) {
+    next.tv_nsec += period_ns;
+    if (next.tv_nsec >= 1000000000L) {
+      next.tv_sec++;
+      next.tv_nsec -= 1000000000L;
+    }
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) == EINTR)
+      ;
+    seq++;
+    publish_mailbox_state();
+
+    double values[CMD_CH_COUNT];
+    int have_values = 0;
+    int nframes = 0;
+
+    for (int i = 0; i < QNX_MAX_CLIENTS; i++) {
+      cmd_conn_t *c = &g_conns[i];
+      if (!atomic_load_explicit(&c->in_use, memory_order_acquire))
+        continue;
+      uint32_t mask = atomic_load(&c->sub_mask);
+      int period = atomic_load(&c->sub_period);
+      if (mask == 0 || period <= 0 || seq % (uint32_t)period != 0)
+        continue;
+      int mode = atomic_load(&c->sub_mode);
+
+      // Snapshot once per tick, serialize once per (mask, mode)
+      if (!have_values) {
+        load_channels(values);
+        have_values = 1;
+      }
+      stream_frame_t *f = NULL;
+      for (int k = 0; k < nframes; k++) {
+        if (frames[k].mask == mask && frames[k].mode == mode) {
+          f = &frames[k];
+          break;
+        }
+      }
+      if (!f) {
+        f = &frames[nframes++];
+        f->mask = mask;
+        f->mode = mode;
+        f->len = mode == CMD_STREAM_BINARY
+                     ? cmd_format_frame_binary(f->buf, sizeof(f->buf), seq,
+                                               mask, values)
+                     : cmd_format_frame_json(f->buf, sizeof(f->buf), seq, mask,
+                                             values);
+      }
+      if (f->len > 0)
+        conn_push_frame(c, f->buf, (size_t)f->len);
+    }
+
+    // Fell behind (e.g. suspended): resync instead of bursting
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (now.tv_sec > next.tv_sec + 1)
+      next = now;
+  }
+  return NULL;
+}
+
+// Binary mode for the rest of the connection. Replies to every complete
+// record from one recv go out in a single send, which is what lets test
+// drivers pipeline hundreds of thousands of commands per second.
+static void binary_session(cmd_conn_t *c, const char *pending, size_t npending) {
+  uint8_t buf[BUF_SZ];
+  uint8_t resp[(BUF_SZ / SIM_MSG_WIRE_SZ) * SIM_REPLY_WIRE_SZ];
+  size_t used = npending;
+  memcpy(buf, pending, npending);
+
+  uint8_t magic = SIM_WIRE_MAGIC;
+  if (conn_reply(c, (const char *)&magic, 1) != 0)
     return;
+
+  for (;;) {
+    uint64_t recv_ns = cmd_trace_now_ns();
+    size_t nrec = used / SIM_MSG_WIRE_SZ;
+    for (size_t i = 0; i < nrec; i++)
+      handle_binary(buf + i * SIM_MSG_WIRE_SZ, recv_ns,
+                    resp + i * SIM_REPLY_WIRE_SZ);
+    if (nrec > 0) {
+      if (conn_reply(c, (const char *)resp, nrec * SIM_REPLY_WIRE_SZ) != 0)
+        return;
+      size_t consumed = nrec * SIM_MSG_WIRE_SZ;
+      memmove(buf, buf + consumed, used - consumed);
+      used -= consumed;
+    }
+
+    if (!g_server_running)
+      return;
+    ssize_t n = recv(c->sock, buf + used, sizeof(buf) - used, 0);
+    if (n < 0 && errno == EINTR)
+      n = 0;
+    else if (n <= 0)
+      return;
+    used += (size_t)n;
+  }
+}
+
+// Receive one seqpacket message into an empty buffer. *truncated is set if
+// the message did not fit; the rest of it is gone. Returns the recvmsg()
+// result, which on Linux is the full message length even when truncated.
+static ssize_t recv_message(int sock, char *buf, size_t size, int *truncated) {
+  struct iovec iov = {.iov_base = buf, .iov_len = size};
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+
+  ssize_t n;
+  do {
+    n = recvmsg(sock, &msg, MSG_TRUNC);
+  } while (n < 0 && errno == EINTR);
+  *truncated = n > 0 && ((msg.msg_flags & MSG_TRUNC) || (size_t)n > size);
+  return n;
+}
+
+// Answer nrec binary records with ok = 0, without executing any of them
+static int reject_binary(cmd_conn_t *c, size_t nrec) {
+  uint8_t resp[(BUF_SZ / SIM_MSG_WIRE_SZ) * SIM_REPLY_WIRE_SZ];
+  const size_t per_send = sizeof(resp) / SIM_REPLY_WIRE_SZ;
+  sim_reply_t reply = {.ok = 0,
+                       .mission_go = atomic_load(&g_commanded.mission_go),
+                       .throttle = atomic_load(&g_commanded.engine_throttle)};
+  for (size_t i = 0; i < per_send; i++)
+    sim_reply_encode(&reply, resp + i * SIM_REPLY_WIRE_SZ);
+
+  while (nrec > 0) {
+    size_t k = nrec < per_send ? nrec : per_send;
+    if (conn_reply(c, (const char *)resp, k * SIM_REPLY_WIRE_SZ) != 0)
+      return -1;
+    nrec -= k;
   }
+  return 0;
+}
+
+// One binary seqpacket message: whole records, replies in one send. A
+// trailing partial record gets an ok = 0 reply of its own.
+static int seqpacket_binary(cmd_conn_t *c, const uint8_t *data, size_t len,
+                            uint64_t recv_ns) {
+  uint8_t resp[(BUF_SZ / SIM_MSG_WIRE_SZ) * SIM_REPLY_WIRE_SZ];
+  size_t nrec = len / SIM_MSG_WIRE_SZ;
+  for (size_t i = 0; i < nrec; i++)
+    handle_binary(data + i * SIM_MSG_WIRE_SZ, recv_ns,
+                  resp + i * SIM_REPLY_WIRE_SZ);
+  if (nrec > 0 &&
+      conn_reply(c, (const char *)resp, nrec * SIM_REPLY_WIRE_SZ) != 0)
+    return -1;
+  return len % SIM_MSG_WIRE_SZ ? reject_binary(c, 1) : 0;
+}
 
-  snprintf(out, out_sz, "{\"type\":\"error\",\"msg\":\"unknown cmd\"}\n");
+// One text seqpacket message: every line is a command, the last one with
+// or without its newline
+static int seqpacket_text(cmd_conn_t *c, const char *data, size_t len,
+                          uint64_t recv_ns) {
+  char resp[REPLY_SZ];
+  while (len > 0) {
+    const char *nl = memchr(data, '\n', len);
+    size_t line = nl ? (size_t)(nl - data) : len;
+    size_t next = nl ? line + 1 : len;
+    if (line > 0 && data[line - 1] == '\r')
+      line--;
+    if (line > 0) {
+      handle_command(c, data, line, recv_ns, resp, sizeof(resp));
+      if (conn_reply(c, resp, strlen(resp)) != 0)
+        return -1;
+    }
+    data += next;
+    len -= next;
+  }
+  return 0;
+}
+
+// Unix seqpacket connections are handled a message at a time: nothing is
+// carried over between messages, and a message larger than BUF_SZ is
+// rejected as a whole instead of being silently cut
+static void seqpacket_session(cmd_conn_t *c) {
+  char buf[BUF_SZ];
+  char resp[REPLY_SZ];
+  int first = 1;
+  int binary = 0;
+
+  while (g_server_running) {
+    int truncated;
+    ssize_t n = recv_message(c->sock, buf, sizeof(buf), &truncated);
+    if (n <= 0)
+      return;
+    uint64_t recv_ns = cmd_trace_now_ns();
+    size_t len = truncated ? sizeof(buf) : (size_t)n;
+    size_t skip = 0;
+
+    // The first byte of a connection picks the protocol
+    if (first) {
+      first = 0;
+      if ((uint8_t)buf[0] == SIM_WIRE_MAGIC) {
+        uint8_t magic = SIM_WIRE_MAGIC;
+        if (conn_reply(c, (const char *)&magic, 1) != 0)
+          return;
+        binary = 1;
+        skip = 1;
+      }
+    }
+
+    int rc;
+    if (truncated && binary) {
+      // One failed reply per record sent, so the client is not left waiting;
+      // if the full length is unknown, per record received
+      size_t total = ((size_t)n > sizeof(buf) ? (size_t)n : len) - skip;
+      rc = reject_binary(c, (total + SIM_MSG_WIRE_SZ - 1) / SIM_MSG_WIRE_SZ);
+    } else if (truncated) {
+      cmd_format_error(resp, sizeof(resp), NULL, "message too long");
+      rc = conn_reply(c, resp, strlen(resp));
+    } else if (binary) {
+      rc = seqpacket_binary(c, (const uint8_t *)buf + skip, len - skip, recv_ns);
+    } else {
+      rc = seqpacket_text(c, buf, len, recv_ns);
+    }
+    if (rc != 0)
+      return;
+  }
 }
 
 static void *client_thread(void *arg) {
-  int sock = *(int *)arg;
-  free(arg);
+  cmd_conn_t *c = (cmd_conn_t *)arg;
+  int sock = c->sock;
   char buf[BUF_SZ];
-  char resp[BUF_SZ];
+  char resp[REPLY_SZ];
+  size_t used = 0;
+  int discarding = 0; // inside an over-long line, drop until newline
+  int first = 1;
+
+  if (c->seqpacket) {
+    seqpacket_session(c);
+    goto done;
+  }
 
   while (g_server_running) {
-    ssize_t n = recv(sock, buf, sizeof(buf) - 1, 0);
+    ssize_t n = recv(sock, buf + used, sizeof(buf) - used, 0);
+    if (n < 0 && errno == EINTR)
+      continue;
     if (n <= 0)
       break;
-    buf[n] = 0;
-    // process line-by-line
-    char *saveptr = NULL;
-    char *line = strtok_r(buf, "\n", &saveptr);
-    while (line) {
-      handle_command(line, resp, sizeof(resp));
-      send(sock, resp, strlen(resp), 0);
-      line = strtok_r(NULL, "\n", &saveptr);
+    used += (size_t)n;
+    uint64_t recv_ns = cmd_trace_now_ns();
+
+    // The first byte of a connection picks the protocol
+    if (first) {
+      first = 0;
+      if ((uint8_t)buf[0] == SIM_WIRE_MAGIC) {
+        binary_session(c, buf + 1, used - 1);
+        goto done;
+      }
+    }
+
+    // Process every complete line; keep a partial tail for the next recv
+    size_t start = 0;
+    for (;;) {
+      char *nl = memchr(buf + start, '\n', used - start);
+      if (!nl)
+        break;
+      size_t len = (size_t)(nl - (buf + start));
+      if (len > 0 && buf[start + len - 1] == '\r')
+        len--;
+      if (discarding) {
+        discarding = 0;
+      } else if (len > 0) {
+        handle_command(c, buf + start, len, recv_ns, resp, sizeof(resp));
+        if (conn_reply(c, resp, strlen(resp)) != 0)
+          goto done;
+      }
+      start = (size_t)(nl - buf) + 1;
+    }
+
+    if (start > 0) {
+      memmove(buf, buf + start, used - start);
+      used -= start;
+    } else if (used == sizeof(buf)) {
+      // No newline in a full buffer: reject the line and resync
+      if (!discarding) {
+        cmd_format_error(resp, sizeof(resp), NULL, "line too long");
+        if (conn_reply(c, resp, strlen(resp)) != 0)
+          break;
+      }
+      discarding = 1;
+      used = 0;
     }
   }
+done:
+  atomic_store(&c->sub_mask, 0u);
+  if (atomic_load(&c->frames_dropped) > 0)
+    sls_log(LOG_LEVEL_INFO, "CMD", "client closed: %lu frames sent, %lu dropped",
+            atomic_load(&c->frames_sent), atomic_load(&c->frames_dropped));
+  pthread_mutex_lock(&c->tx_lock);
   close(sock);
+  c->sock = -1;
+  c->pending_off = c->pending_len = 0;
+  pthread_mutex_unlock(&c->tx_lock);
+  atomic_store_explicit(&c->in_use, 0, memory_order_release);
   return NULL;
 }
 
+static cmd_conn_t *claim_conn(int sock, int seqpacket) {
+  for (int i = 0; i < QNX_MAX_CLIENTS; i++) {
+    int expected = 0;
+    if (atomic_compare_exchange_strong(&g_conns[i].in_use, &expected, 1)) {
+      cmd_conn_t *c = &g_conns[i];
+      c->sock = sock;
+      c->seqpacket = seqpacket;
+      c->pending_off = c->pending_len = 0;
+      atomic_store(&c->sub_mask, 0u);
+      atomic_store(&c->frames_sent, 0ul);
+      atomic_store(&c->frames_dropped, 0ul);
+      return c;
+    }
+  }
+  return NULL;
+}
+
+// Accept loop shared by the TCP and Unix listeners
+static void accept_loop(int s, int is_tcp) {
+  while (g_server_running) {
+    int sock = accept(s, NULL, NULL);
+    if (sock < 0) {
+      if (!g_server_running)
+        break;
+      continue;
+    }
+    if (is_tcp) {
+      // Replies are small and latency matters more than packet count
+      int nodelay = 1;
+      setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+    }
+
+    cmd_conn_t *c = claim_conn(sock, !is_tcp);
+    if (!c) {
+      char resp[128];
+      int len = cmd_format_error(resp, sizeof(resp), NULL, "server full");
+      if (len > 0)
+        send_all(sock, resp, (size_t)len);
+      close(sock);
+      continue;
+    }
+    pthread_t t;
+    if (pthread_create(&t, NULL, client_thread, c) != 0) {
+      close(sock);
+      c->sock = -1;
+      atomic_store_explicit(&c->in_use, 0, memory_order_release);
+      continue;
+    }
+    pthread_detach(t);
+  }
+}
+
 static void *server_thread(void *unused) {
   (void)unused;
 
@@ -137,24 +800,7 @@ static void *server_thread(void *unused) {
   }
 
   sls_log(LOG_LEVEL_INFO, "CMD", "listening on 127.0.0.1:%d", CMD_PORT);
-
-  while (g_server_running) {
-    int c = accept(s, NULL, NULL);
-    if (c < 0) {
-      if (!g_server_running)
-        break;
-      continue;
-    }
-    int *pc = (int *)malloc(sizeof(int));
-    if (!pc) {
-      close(c);
-      continue;
-    }
-    *pc = c;
-    pthread_t t;
-    pthread_create(&t, NULL, client_thread, pc);
-    pthread_detach(t);
-  }
+  accept_loop(s, 1);
 
   if (g_listen_fd >= 0)
     close(g_listen_fd);
@@ -162,9 +808,70 @@ static void *server_thread(void *unused) {
   return NULL;
 }
 
+// Local listener: SOCK_SEQPACKET keeps message boundaries, so a client's
+// send is exactly one recv here and no stream reassembly is involved. A
+// message holds complete lines or records and must fit in BUF_SZ bytes;
+// larger ones are answered with an error (see seqpacket_session).
+static void *unix_server_thread(void *unused) {
+  (void)unused;
+
+  int s = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+  if (s < 0) {
+    sls_log(LOG_LEVEL_WARNING, "CMD", "unix socket failed: %s", strerror(errno));
+    return NULL;
+  }
+
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, CMD_UNIX_PATH, sizeof(addr.sun_path) - 1);
+  unlink(CMD_UNIX_PATH); // Left behind by a previous run
+
+  if (bind(s, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(s, 8) < 0) {
+    sls_log(LOG_LEVEL_WARNING, "CMD", "unix listen failed: %s", strerror(errno));
+    close(s);
+    return NULL;
+  }
+  g_unix_fd = s;
+
+  sls_log(LOG_LEVEL_INFO, "CMD", "listening on %s", CMD_UNIX_PATH);
+  accept_loop(s, 0);
+
+  close(s);
+  g_unix_fd = -1;
+  unlink(CMD_UNIX_PATH);
+  return NULL;
+}
+
+static double frames_sent_metric(void *arg) {
+  (void)arg;
+  return (double)atomic_load(&g_stream.frames_sent);
+}
+
+static double frames_dropped_metric(void *arg) {
+  (void)arg;
+  return (double)atomic_load(&g_stream.frames_dropped);
+}
+
 int cmd_server_start(void) {
   if (g_server_running)
     return 0;
+  g_cmds_rejected = sls_metrics_counter("sls_commands_total", "result=\"rejected\"",
+                                        "Operator commands submitted, by outcome");
+  g_cmds_accepted = sls_metrics_counter("sls_commands_total", "result=\"accepted\"",
+                                        "Operator commands submitted, by outcome");
+  sls_metrics_callback("sls_stream_frames_sent_total", NULL, "Stream frames sent",
+                       SLS_METRIC_COUNTER, frames_sent_metric, NULL);
+  sls_metrics_callback("sls_stream_frames_dropped_total", NULL,
+                       "Stream frames dropped for slow subscribers",
+                       SLS_METRIC_COUNTER, frames_dropped_metric, NULL);
+  if (!g_conns_initialized) {
+    for (int i = 0; i < QNX_MAX_CLIENTS; i++) {
+      pthread_mutex_init(&g_conns[i].tx_lock, NULL);
+      g_conns[i].sock = -1;
+    }
+    g_conns_initialized = 1;
+  }
   g_server_running = 1;
   pthread_t t;
   int rc = pthread_create(&t, NULL, server_thread, NULL);
@@ -174,6 +881,18 @@ int cmd_server_start(void) {
     return -1;
   }
   pthread_detach(t);
+  rc = pthread_create(&t, NULL, stream_thread, NULL);
+  if (rc != 0) {
+    sls_log(LOG_LEVEL_WARNING, "CMD", "stream thread failed: %d", rc);
+  } else {
+    pthread_detach(t);
+  }
+
+  // Local transports are optional; TCP alone still serves every client
+  if (pthread_create(&t, NULL, unix_server_thread, NULL) == 0)
+    pthread_detach(t);
+  if (cmd_mailbox_server_start(mailbox_handler) == 0)
+    publish_mailbox_state();
   return 0;
 }
 
@@ -182,4 +901,8 @@ void cmd_server_stop(void) {
   if (g_listen_fd >= 0) {
     shutdown(g_listen_fd, SHUT_RDWR);
   }
+  if (g_unix_fd >= 0) {
+    shutdown(g_unix_fd, SHUT_RDWR);
+  }
+  cmd_mailbox_server_stop();
 }
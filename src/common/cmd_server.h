@@ -2,6 +2,10 @@
 #ifndef CMD_SERVER_H
 #define CMD_SERVER_H
 
+#include <stdint.h>
+
+#include "cmd_protocol.h"
+
 int cmd_server_start(void);
 void cmd_server_stop(void);
 
@@ -9,4 +13,11 @@ void cmd_server_stop(void);
 int cmd_get_mission_go(void);
 int cmd_get_engine_throttle(void);
 
+// Publish the latest value of a telemetry channel for streaming subscribers.
+// Lock-free; safe to call from any subsystem thread every tick.
+void cmd_publish_channel(cmd_channel_t ch, double value);
+
+// Totals across all connections since start
+void cmd_get_stream_stats(uint64_t *frames_sent, uint64_t *frames_dropped);
+
 #endif // CMD_SERVER_H
@@ -0,0 +1,174 @@
+// cmd_trace.c — per command type log2 latency histograms
+
+#include <stdatomic.h>
+#include <time.h>
+
+#include "cmd_trace.h"
+#include "sls_json.h"
+
+#define NUM_OPS (CMD_OP_SET_THROTTLE + 1)
+
+typedef struct {
+  atomic_uint_least64_t buckets[CMD_TRACE_BUCKETS];
+  atomic_uint_least64_t count;
+  atomic_uint_least64_t max_ns;
+} latency_hist_t;
+
+typedef struct {
+  atomic_uint_least64_t traces;
+  latency_hist_t seg[CMD_SEG_COUNT];
+} op_hist_t;
+
+static op_hist_t g_hist[NUM_OPS];
+
+static const char *const k_seg_names[CMD_SEG_COUNT] = {
+    [CMD_SEG_PARSE] = "parse",   [CMD_SEG_ENQUEUE] = "enqueue",
+    [CMD_SEG_PICKUP] = "pickup", [CMD_SEG_EFFECT] = "effect",
+    [CMD_SEG_TOTAL] = "total",
+};
+
+static const char *const k_op_names[NUM_OPS] = {
+    [CMD_OP_NONE] = "none",   [CMD_OP_GO] = "go",
+    [CMD_OP_NOGO] = "nogo",   [CMD_OP_ABORT] = "abort",
+    [CMD_OP_SET_THROTTLE] = "set_throttle",
+};
+
+uint64_t cmd_trace_now_ns(void) {
+  return (uint64_t)sls_time_monotonic_ns();
+}
+
+static int bucket_of(uint64_t ns) {
+  int b = ns ? 64 - __builtin_clzll(ns) : 0;
+  return b < CMD_TRACE_BUCKETS ? b : CMD_TRACE_BUCKETS - 1;
+}
+
+static void hist_add(latency_hist_t *h, uint64_t ns) {
+  atomic_fetch_add_explicit(&h->buckets[bucket_of(ns)], 1, memory_order_relaxed);
+  atomic_fetch_add_explicit(&h->count, 1, memory_order_relaxed);
+  uint64_t max = atomic_load_explicit(&h->max_ns, memory_order_relaxed);
+  while (ns > max &&
+         !atomic_compare_exchange_weak_explicit(&h->max_ns, &max, ns,
+                                                memory_order_relaxed,
+                                                memory_order_relaxed))
+    ;
+}
+
+void cmd_trace_record(const command_t *cmd) {
+  if ((int)cmd->opcode < 0 || cmd->opcode >= NUM_OPS)
+    return;
+  op_hist_t *oh = &g_hist[cmd->opcode];
+  atomic_fetch_add_explicit(&oh->traces, 1, memory_order_relaxed);
+
+  const uint64_t *t = cmd->stage_ns;
+  for (int s = CMD_STAGE_PARSE; s < CMD_STAGE_COUNT; s++) {
+    if (t[s] && t[s - 1] && t[s] >= t[s - 1])
+      hist_add(&oh->seg[s], t[s] - t[s - 1]);
+  }
+  if (t[CMD_STAGE_RECV] && t[CMD_STAGE_EFFECT] >= t[CMD_STAGE_RECV])
+    hist_add(&oh->seg[CMD_SEG_TOTAL], t[CMD_STAGE_EFFECT] - t[CMD_STAGE_RECV]);
+}
+
+uint64_t cmd_trace_count(command_opcode_t op) {
+  if ((int)op < 0 || op >= NUM_OPS)
+    return 0;
+  return atomic_load_explicit(&g_hist[op].traces, memory_order_relaxed);
+}
+
+uint64_t cmd_trace_percentile_ns(command_opcode_t op, cmd_trace_segment_t seg,
+                                 double pct) {
+  if ((int)op < 0 || op >= NUM_OPS || (int)seg < CMD_SEG_PARSE ||
+      seg >= CMD_SEG_COUNT)
+    return 0;
+  latency_hist_t *h = &g_hist[op].seg[seg];
+
+  uint64_t counts[CMD_TRACE_BUCKETS];
+  uint64_t total = 0;
+  for (int b = 0; b < CMD_TRACE_BUCKETS; b++) {
+    counts[b] = atomic_load_explicit(&h->buckets[b], memory_order_relaxed);
+    total += counts[b];
+  }
+  if (total == 0)
+    return 0;
+
+  uint64_t rank = (uint64_t)((pct / 100.0) * (double)total + 0.5);
+  if (rank < 1)
+    rank = 1;
+  // Bucket upper bound, but never above the largest sample actually seen
+  uint64_t max = atomic_load_explicit(&h->max_ns, memory_order_relaxed);
+  uint64_t seen = 0;
+  for (int b = 0; b < CMD_TRACE_BUCKETS; b++) {
+    seen += counts[b];
+    if (seen >= rank) {
+      uint64_t upper = b ? (1ULL << b) - 1 : 0;
+      return upper < max ? upper : max;
+    }
+  }
+  return max;
+}
+
+uint64_t cmd_trace_max_ns(command_opcode_t op, cmd_trace_segment_t seg) {
+  if ((int)op < 0 || op >= NUM_OPS || (int)seg < CMD_SEG_PARSE ||
+      seg >= CMD_SEG_COUNT)
+    return 0;
+  return atomic_load_explicit(&g_hist[op].seg[seg].max_ns, memory_order_relaxed);
+}
+
+void cmd_trace_reset(void) {
+  for (int op = 0; op < NUM_OPS; op++) {
+    atomic_store(&g_hist[op].traces, 0);
+    for (int s = 0; s < CMD_SEG_COUNT; s++) {
+      latency_hist_t *h = &g_hist[op].seg[s];
+      for (int b = 0; b < CMD_TRACE_BUCKETS; b++)
+        atomic_store(&h->buckets[b], 0);
+      atomic_store(&h->count, 0);
+      atomic_store(&h->max_ns, 0);
+    }
+  }
+}
+
+int cmd_trace_format_json(char *out, size_t out_sz, const cmd_request_t *req) {
+  sls_json_writer_t w;
+  sls_json_writer_init(&w, out, out_sz);
+  sls_json_begin_object(&w);
+  sls_json_write_key(&w, "type");
+  sls_json_write_string(&w, "latency");
+  if (req && (req->fields & CMD_FIELD_ID)) {
+    sls_json_write_key(&w, "id");
+    sls_json_write_uint(&w, req->id);
+  }
+  sls_json_write_key(&w, "unit");
+  sls_json_write_string(&w, "us");
+
+  // {"set_throttle":{"count":N,"total":{"p50":..,"p90":..,"p99":..,"max":..},
+  //  "parse":{...},...},...}; commands never traced are left out
+  sls_json_write_key(&w, "cmds");
+  sls_json_begin_object(&w);
+  for (int op = CMD_OP_GO; op < NUM_OPS; op++) {
+    uint64_t n = cmd_trace_count((command_opcode_t)op);
+    if (n == 0)
+      continue;
+    sls_json_write_key(&w, k_op_names[op]);
+    sls_json_begin_object(&w);
+    sls_json_write_key(&w, "count");
+    sls_json_write_uint(&w, n);
+    for (int s = CMD_SEG_PARSE; s < CMD_SEG_COUNT; s++) {
+      command_opcode_t o = (command_opcode_t)op;
+      cmd_trace_segment_t seg = (cmd_trace_segment_t)s;
+      sls_json_write_key(&w, k_seg_names[s]);
+      sls_json_begin_object(&w);
+      sls_json_write_key(&w, "p50");
+      sls_json_write_double(&w, cmd_trace_percentile_ns(o, seg, 50.0) / 1e3, 1);
+      sls_json_write_key(&w, "p90");
+      sls_json_write_double(&w, cmd_trace_percentile_ns(o, seg, 90.0) / 1e3, 1);
+      sls_json_write_key(&w, "p99");
+      sls_json_write_double(&w, cmd_trace_percentile_ns(o, seg, 99.0) / 1e3, 1);
+      sls_json_write_key(&w, "max");
+      sls_json_write_double(&w, cmd_trace_max_ns(o, seg) / 1e3, 1);
+      sls_json_end_object(&w);
+    }
+    sls_json_end_object(&w);
+  }
+  sls_json_end_object(&w);
+  sls_json_end_object(&w);
+  return sls_json_writer_finish_line(&w);
+}
@@ -0,0 +1,54 @@
+// cmd_trace.h — command-to-effect latency tracing for operator commands
+#ifndef CMD_TRACE_H
+#define CMD_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cmd_protocol.h"
+#include "sls_types.h"
+
+// A command's trace ID is its command_id; the stage timestamps travel with
+// the command_t itself (stage_ns), so nothing is shared until the trace
+// completes and lands in the histograms below.
+
+// Latency segments: each ends at the stage of the same index, TOTAL spans
+// receive to effect
+typedef enum {
+  CMD_SEG_PARSE = CMD_STAGE_PARSE,     // recv -> parse
+  CMD_SEG_ENQUEUE = CMD_STAGE_ENQUEUE, // parse -> enqueue
+  CMD_SEG_PICKUP = CMD_STAGE_PICKUP,   // enqueue -> subsystem pickup
+  CMD_SEG_EFFECT = CMD_STAGE_EFFECT,   // pickup -> telemetry shows it
+  CMD_SEG_TOTAL = CMD_STAGE_COUNT,     // recv -> effect
+  CMD_SEG_COUNT
+} cmd_trace_segment_t;
+
+// log2 buckets: bucket b holds latencies in [2^(b-1), 2^b) ns
+#define CMD_TRACE_BUCKETS 40 // up to ~9 minutes
+
+uint64_t cmd_trace_now_ns(void);
+
+// Stamp one stage with the current time
+static inline void cmd_trace_mark(command_t *cmd, command_stage_t stage) {
+  cmd->stage_ns[stage] = cmd_trace_now_ns();
+}
+
+// Fold a completed trace into the per-opcode histograms (any thread).
+// Stages never reached (0) are left out of the affected segments.
+void cmd_trace_record(const command_t *cmd);
+
+// Number of traces recorded for an opcode, and the latency at percentile
+// pct (0-100) of a segment, as the upper bound of its log2 bucket in ns
+// (capped at the segment's max).
+// Returns 0 when no samples exist.
+uint64_t cmd_trace_count(command_opcode_t op);
+uint64_t cmd_trace_percentile_ns(command_opcode_t op, cmd_trace_segment_t seg,
+                                 double pct);
+uint64_t cmd_trace_max_ns(command_opcode_t op, cmd_trace_segment_t seg);
+
+void cmd_trace_reset(void);
+
+// {"type":"latency",...} reply with per command type distributions
+int cmd_trace_format_json(char *out, size_t out_sz, const cmd_request_t *req);
+
+#endif // CMD_TRACE_H
@@ -0,0 +1,917 @@
+/**
+ * @file qnx_mock.c
+ * @brief Linux implementation of QNX Neutrino message passing
+ *
+ * Each channel is a POSIX shared memory object ("/sls_qnx_<pid>_<chid>")
+ * holding a doorbell futex, a bounded pulse queue and a fixed array of
+ * send slots. MsgSend claims a slot, copies the message in, rings the
+ * doorbell and blocks on the slot's state futex; MsgReceive takes the
+ * oldest sent slot and MsgReply copies the reply back and wakes the
+ * sender. Every mapping (channel owner or connection) is private to the
+ * process that made it, so tearing down one side never unmaps memory the
+ * other side is still using.
+ */
+
+#include "qnx_mock.h"
+
+#ifdef MOCK_QNX_BUILD
+
+#include <fcntl.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+
+#define CHANNEL_MAGIC 0x514e5843U   // "QNXC"
+#define SEND_RECHECK_SEC 1          // how often a blocked sender checks the server is alive
+
+_Static_assert((QNX_MOCK_PULSE_SLOTS & (QNX_MOCK_PULSE_SLOTS - 1)) == 0,
+               "pulse queue size must be a power of two");
+_Static_assert(QNX_MOCK_MAX_CHANNELS < 255 && QNX_MOCK_SEND_SLOTS <= 256,
+               "rcvid encoding holds an 8-bit channel index and slot index");
+_Static_assert(sizeof(void *) >= 8, "timer pulses pack coid/code/value into sival_ptr");
+
+// Send slot states (the slot's futex word)
+enum
+{
+    SLOT_FREE = 0,
+    SLOT_FILLING,
+    SLOT_SENT,
+    SLOT_RECEIVED,
+    SLOT_REPLIED
+};
+
+typedef struct
+{
+    _Alignas(64) _Atomic uint32_t state;
+    uint32_t generation;    // bumped per receive, guards stale rcvids
+    uint64_t ticket;        // send order
+    pid_t sender_pid;
+    int32_t status;         // MsgReply status
+    int32_t error;          // MsgError code, 0 for a normal reply
+    uint32_t msg_len;
+    uint32_t reply_cap;     // bytes the sender can take
+    uint32_t reply_len;
+    uint8_t msg[QNX_MOCK_MAX_MSG];
+    uint8_t reply[QNX_MOCK_MAX_MSG];
+} mock_send_slot_t;
+
+typedef struct
+{
+    _Atomic size_t sequence;
+    struct _pulse pulse;
+} mock_pulse_cell_t;
+
+typedef struct
+{
+    uint32_t magic;
+    pid_t owner_pid;
+    int32_t chid;
+    _Atomic uint32_t destroyed;
+    _Alignas(64) _Atomic uint32_t doorbell; // futex: bumped per send or pulse
+    _Atomic uint32_t receivers_waiting;
+    _Alignas(64) _Atomic uint64_t next_ticket;
+    _Alignas(64) _Atomic size_t pulse_enqueue;
+    _Alignas(64) _Atomic size_t pulse_dequeue;
+    mock_pulse_cell_t pulses[QNX_MOCK_PULSE_SLOTS];
+    mock_send_slot_t slots[QNX_MOCK_SEND_SLOTS];
+} mock_channel_shm_t;
+
+// Process-local reference to a mapped channel: an owned channel or a
+// connection. users counts calls in flight so teardown can wait them out.
+typedef enum
+{
+    REF_FREE = 0,
+    REF_LIVE,
+    REF_CLOSING
+} mock_ref_state_t;
+
+typedef struct
+{
+    _Atomic int state;
+    _Atomic int users;
+    mock_channel_shm_t *shm;
+    pid_t pid;
+    int chid;
+} mock_ref_t;
+
+// Global message passing state
+static mock_ref_t g_channels[QNX_MOCK_MAX_CHANNELS];       // index = chid - 1
+static mock_ref_t g_connections[QNX_MOCK_MAX_CONNECTIONS]; // index = coid - 1
+static char g_names[QNX_MOCK_MAX_CHANNELS][NAME_MAX];      // name_attach'd names by chid
+
+// Internal function declarations
+static long futex_wait(_Atomic uint32_t *addr, uint32_t expected, const struct timespec *timeout);
+static void futex_wake(_Atomic uint32_t *addr, int count);
+static void shm_channel_name(char *out, size_t size, pid_t pid, int chid);
+static mock_channel_shm_t *map_channel(pid_t pid, int chid, bool create);
+static mock_ref_t *claim_ref(mock_ref_t *table, int count, int *index);
+static mock_ref_t *acquire_ref(mock_ref_t *table, int count, int id);
+static void release_ref(mock_ref_t *ref);
+static void close_ref(mock_ref_t *ref);
+static void ring_doorbell(mock_channel_shm_t *shm);
+static bool pulse_pop(mock_channel_shm_t *shm, struct _pulse *out);
+static mock_send_slot_t *claim_send_slot(mock_channel_shm_t *shm);
+static mock_send_slot_t *take_oldest_sent(mock_channel_shm_t *shm, int *slot_index);
+static bool process_gone(pid_t pid);
+static int namespace_path(char *out, size_t size, const char *name);
+
+/* Channels */
+
+chid_t ChannelCreate(unsigned flags)
+{
+    (void)flags;
+    int index;
+    mock_ref_t *ref = claim_ref(g_channels, QNX_MOCK_MAX_CHANNELS, &index);
+    if (!ref)
+    {
+        errno = EAGAIN;
+        return -1;
+    }
+
+    int chid = index + 1;
+    ref->shm = map_channel(getpid(), chid, true);
+    if (!ref->shm)
+    {
+        atomic_store(&ref->state, REF_FREE);
+        return -1;
+    }
+    ref->pid = getpid();
+    ref->chid = chid;
+    atomic_store_explicit(&ref->state, REF_LIVE, memory_order_release);
+    return chid;
+}
+
+int ChannelDestroy(chid_t chid)
+{
+    mock_ref_t *ref = acquire_ref(g_channels, QNX_MOCK_MAX_CHANNELS, chid);
+    if (!ref)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+    mock_channel_shm_t *shm = ref->shm;
+
+    // Fail everyone blocked on the channel, in this process or another
+    atomic_store(&shm->destroyed, 1);
+    atomic_fetch_add(&shm->doorbell, 1);
+    futex_wake(&shm->doorbell, INT_MAX);
+    for (int i = 0; i < QNX_MOCK_SEND_SLOTS; i++)
+    {
+        futex_wake(&shm->slots[i].state, INT_MAX);
+    }
+
+    char name[64];
+    shm_channel_name(name, sizeof(name), ref->pid, ref->chid);
+    shm_unlink(name);
+
+    release_ref(ref);
+    close_ref(ref);
+    return 0;
+}
+
+int qnx_mock_channel_pending(chid_t chid)
+{
+    mock_ref_t *ref = acquire_ref(g_channels, QNX_MOCK_MAX_CHANNELS, chid);
+    if (!ref)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+    mock_channel_shm_t *shm = ref->shm;
+    size_t dequeued = atomic_load(&shm->pulse_dequeue); // first, so enqueued >= it
+    size_t pulses = atomic_load(&shm->pulse_enqueue) - dequeued;
+    int pending = (int)(pulses > QNX_MOCK_PULSE_SLOTS ? QNX_MOCK_PULSE_SLOTS : pulses);
+    for (int i = 0; i < QNX_MOCK_SEND_SLOTS; i++)
+    {
+        if (atomic_load_explicit(&shm->slots[i].state, memory_order_relaxed) == SLOT_SENT)
+        {
+            pending++;
+        }
+    }
+    release_ref(ref);
+    return pending;
+}
+
+coid_t ConnectAttach(uint32_t nd, pid_t pid, chid_t chid, unsigned index, int flags)
+{
+    (void)nd;
+    (void)index;
+    (void)flags;
+    if (pid == 0)
+    {
+        pid = getpid();
+    }
+
+    int slot;
+    mock_ref_t *ref = claim_ref(g_connections, QNX_MOCK_MAX_CONNECTIONS, &slot);
+    if (!ref)
+    {
+        errno = EAGAIN;
+        return -1;
+    }
+
+    ref->shm = map_channel(pid, chid, false);
+    if (!ref->shm)
+    {
+        atomic_store(&ref->state, REF_FREE);
+        errno = ESRCH;
+        return -1;
+    }
+    ref->pid = pid;
+    ref->chid = chid;
+    atomic_store_explicit(&ref->state, REF_LIVE, memory_order_release);
+    return slot + 1;
+}
+
+int ConnectDetach(coid_t coid)
+{
+    mock_ref_t *ref = acquire_ref(g_connections, QNX_MOCK_MAX_CONNECTIONS, coid);
+    if (!ref)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+    release_ref(ref);
+    close_ref(ref);
+    return 0;
+}
+
+/* Message passing */
+
+int MsgSend(coid_t coid, const void *smsg, size_t sbytes, void *rmsg, size_t rbytes)
+{
+    if (sbytes > QNX_MOCK_MAX_MSG)
+    {
+        errno = E2BIG;
+        return -1;
+    }
+    mock_ref_t *ref = acquire_ref(g_connections, QNX_MOCK_MAX_CONNECTIONS, coid);
+    if (!ref)
+    {
+        errno = EBADF;
+        return -1;
+    }
+    mock_channel_shm_t *shm = ref->shm;
+
+    mock_send_slot_t *slot = claim_send_slot(shm);
+    if (!slot)
+    {
+        release_ref(ref);
+        errno = atomic_load(&shm->destroyed) ? ESRCH : EAGAIN;
+        return -1;
+    }
+
+    slot->sender_pid = getpid();
+    slot->msg_len = (uint32_t)sbytes;
+    slot->reply_cap = (uint32_t)(rbytes < QNX_MOCK_MAX_MSG ? rbytes : QNX_MOCK_MAX_MSG);
+    slot->reply_len = 0;
+    slot->status = 0;
+    slot->error = 0;
+    if (sbytes > 0)
+    {
+        memcpy(slot->msg, smsg, sbytes);
+    }
+    slot->ticket = atomic_fetch_add(&shm->next_ticket, 1);
+    atomic_store_explicit(&slot->state, SLOT_SENT, memory_order_release);
+    ring_doorbell(shm);
+
+    // Send-blocked, then reply-blocked, until the server replies or dies.
+    // Liveness is only checked when a wait times out, off the fast path.
+    int result = 0;
+    bool check_server = false;
+    for (;;)
+    {
+        uint32_t state = atomic_load_explicit(&slot->state, memory_order_acquire);
+        if (state == SLOT_REPLIED)
+        {
+            break;
+        }
+        if (atomic_load(&shm->destroyed) || (check_server && process_gone(ref->pid)))
+        {
+            // Unblocked by teardown; the slot is abandoned with the channel
+            release_ref(ref);
+            errno = ESRCH;
+            return -1;
+        }
+        struct timespec recheck = {SEND_RECHECK_SEC, 0};
+        check_server = futex_wait(&slot->state, state, &recheck) != 0 && errno == ETIMEDOUT;
+    }
+
+    if (slot->error != 0)
+    {
+        errno = slot->error;
+        result = -1;
+    }
+    else
+    {
+        if (slot->reply_len > 0 && rmsg)
+        {
+            memcpy(rmsg, slot->reply, slot->reply_len);
+        }
+        result = slot->status;
+    }
+    atomic_store_explicit(&slot->state, SLOT_FREE, memory_order_release);
+    release_ref(ref);
+    return result;
+}
+
+int MsgSendPulse(coid_t coid, int priority, int code, int value)
+{
+    (void)priority;
+    mock_ref_t *ref = acquire_ref(g_connections, QNX_MOCK_MAX_CONNECTIONS, coid);
+    if (!ref)
+    {
+        errno = EBADF;
+        return -1;
+    }
+    mock_channel_shm_t *shm = ref->shm;
+    if (atomic_load(&shm->destroyed))
+    {
+        release_ref(ref);
+        errno = ESRCH;
+        return -1;
+    }
+
+    // Bounded MPMC queue (Vyukov): claim a cell whose sequence matches
+    size_t pos = atomic_load_explicit(&shm->pulse_enqueue, memory_order_relaxed);
+    mock_pulse_cell_t *cell;
+    for (;;)
+    {
+        cell = &shm->pulses[pos & (QNX_MOCK_PULSE_SLOTS - 1)];
+        size_t seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&shm->pulse_enqueue, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            release_ref(ref);
+            errno = EAGAIN; // Receiver is this many pulses behind
+            return -1;
+        }
+        else
+        {
+            pos = atomic_load_explicit(&shm->pulse_enqueue, memory_order_relaxed);
+        }
+    }
+
+    memset(&cell->pulse, 0, sizeof(cell->pulse));
+    cell->pulse.type = _PULSE_TYPE;
+    cell->pulse.subtype = _PULSE_SUBTYPE;
+    cell->pulse.code = (int8_t)code;
+    cell->pulse.value.sival_int = value;
+    cell->pulse.scoid = coid;
+    atomic_store_explicit(&cell->sequence, pos + 1, memory_order_release);
+
+    ring_doorbell(shm);
+    release_ref(ref);
+    return 0;
+}
+
+rcvid_t MsgReceive(chid_t chid, void *msg, size_t bytes, struct _msg_info *info)
+{
+    mock_ref_t *ref = acquire_ref(g_channels, QNX_MOCK_MAX_CHANNELS, chid);
+    if (!ref)
+    {
+        errno = ESRCH;
+        return -1;
+    }
+    mock_channel_shm_t *shm = ref->shm;
+
+    for (;;)
+    {
+        if (atomic_load(&shm->destroyed))
+        {
+            release_ref(ref);
+            errno = ESRCH;
+            return -1;
+        }
+        uint32_t bell = atomic_load(&shm->doorbell);
+
+        struct _pulse pulse;
+        if (pulse_pop(shm, &pulse))
+        {
+            memcpy(msg, &pulse, bytes < sizeof(pulse) ? bytes : sizeof(pulse));
+            if (info)
+            {
+                memset(info, 0, sizeof(*info));
+                info->chid = chid;
+                info->scoid = pulse.scoid;
+                info->msglen = info->srcmsglen = sizeof(pulse);
+            }
+            release_ref(ref);
+            return 0;
+        }
+
+        int slot_index;
+        mock_send_slot_t *slot = take_oldest_sent(shm, &slot_index);
+        if (slot)
+        {
+            size_t copied = slot->msg_len < bytes ? slot->msg_len : bytes;
+            if (copied > 0)
+            {
+                memcpy(msg, slot->msg, copied);
+            }
+            if (info)
+            {
+                memset(info, 0, sizeof(*info));
+                info->pid = slot->sender_pid;
+                info->chid = chid;
+                info->priority = 10;
+                info->msglen = (uint32_t)copied;
+                info->srcmsglen = slot->msg_len;
+                info->dstmsglen = slot->reply_cap;
+            }
+            rcvid_t rcvid = (rcvid_t)(((slot->generation & 0x7fffU) << 16) |
+                                      ((uint32_t)chid << 8) | (uint32_t)slot_index);
+            release_ref(ref);
+            return rcvid;
+        }
+
+        // Nothing queued: sleep until the doorbell moves past what we saw
+        atomic_fetch_add(&shm->receivers_waiting, 1);
+        long rc = futex_wait(&shm->doorbell, bell, NULL);
+        int wait_errno = errno;
+        atomic_fetch_sub(&shm->receivers_waiting, 1);
+        if (rc != 0 && wait_errno == EINTR)
+        {
+            release_ref(ref);
+            errno = EINTR;
+            return -1;
+        }
+    }
+}
+
+// Finish a received message: copy the reply (or error) and unblock the sender
+static int complete_receive(rcvid_t rcvid, int status, int error, const void *msg, size_t bytes)
+{
+    int chid = (rcvid >> 8) & 0xff;
+    int slot_index = rcvid & 0xff;
+    uint32_t generation = ((uint32_t)rcvid >> 16) & 0x7fffU;
+    if (rcvid <= 0 || slot_index >= QNX_MOCK_SEND_SLOTS)
+    {
+        errno = ESRCH;
+        return -1;
+    }
+
+    mock_ref_t *ref = acquire_ref(g_channels, QNX_MOCK_MAX_CHANNELS, chid);
+    if (!ref)
+    {
+        errno = ESRCH;
+        return -1;
+    }
+    mock_send_slot_t *slot = &ref->shm->slots[slot_index];
+    if (atomic_load_explicit(&slot->state, memory_order_acquire) != SLOT_RECEIVED ||
+        (slot->generation & 0x7fffU) != generation)
+    {
+        release_ref(ref);
+        errno = ESRCH;
+        return -1;
+    }
+
+    if (error == 0)
+    {
+        size_t copied = bytes < slot->reply_cap ? bytes : slot->reply_cap;
+        if (copied > 0 && msg)
+        {
+            memcpy(slot->reply, msg, copied);
+        }
+        slot->reply_len = (uint32_t)copied;
+        slot->status = status;
+    }
+    slot->error = error;
+    atomic_store_explicit(&slot->state, SLOT_REPLIED, memory_order_release);
+    futex_wake(&slot->state, 1);
+    release_ref(ref);
+    return 0;
+}
+
+int MsgReply(rcvid_t rcvid, int status, const void *msg, size_t bytes)
+{
+    return complete_receive(rcvid, status, 0, msg, bytes);
+}
+
+int MsgError(rcvid_t rcvid, int error)
+{
+    return complete_receive(rcvid, -1, error != 0 ? error : EIO, NULL, 0);
+}
+
+/* Names */
+
+name_attach_t *name_attach(dispatch_t *dpp, const char *path, unsigned flags)
+{
+    (void)flags;
+    char entry[PATH_MAX];
+    if (!path || namespace_path(entry, sizeof(entry), path) != 0)
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    // Refuse a name a live server already holds; reclaim a dead one's
+    FILE *existing = fopen(entry, "r");
+    if (existing)
+    {
+        int pid = 0, chid = 0;
+        int fields = fscanf(existing, "%d %d", &pid, &chid);
+        fclose(existing);
+        if (fields == 2 && !process_gone((pid_t)pid))
+        {
+            errno = EEXIST;
+            return NULL;
+        }
+    }
+
+    name_attach_t *attach = calloc(1, sizeof(*attach));
+    if (!attach)
+    {
+        return NULL;
+    }
+    attach->dpp = dpp;
+    attach->chid = ChannelCreate(0);
+    if (attach->chid == -1)
+    {
+        free(attach);
+        return NULL;
+    }
+
+    // Publish atomically so name_open never reads a half-written entry
+    char tmp[PATH_MAX + 16];
+    snprintf(tmp, sizeof(tmp), "%s.%d", entry, (int)getpid());
+    FILE *out = fopen(tmp, "w");
+    bool written = out && fprintf(out, "%d %d\n", (int)getpid(), attach->chid) > 0;
+    if (out && fclose(out) != 0)
+    {
+        written = false;
+    }
+    if (!written || rename(tmp, entry) != 0)
+    {
+        int saved = errno;
+        unlink(tmp);
+        ChannelDestroy(attach->chid);
+        free(attach);
+        errno = saved;
+        return NULL;
+    }
+    snprintf(g_names[attach->chid - 1], sizeof(g_names[0]), "%s", path);
+    return attach;
+}
+
+int name_detach(name_attach_t *attach, unsigned flags)
+{
+    (void)flags;
+    if (!attach)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    // Only remove the entry if it still points at this channel
+    const char *name = g_names[attach->chid - 1];
+    char entry[PATH_MAX];
+    if (attach->chid > 0 && attach->chid <= QNX_MOCK_MAX_CHANNELS && name[0] &&
+        namespace_path(entry, sizeof(entry), name) == 0)
+    {
+        FILE *in = fopen(entry, "r");
+        int pid = 0, chid = 0;
+        if (in)
+        {
+            if (fscanf(in, "%d %d", &pid, &chid) == 2 && pid == (int)getpid() &&
+                chid == attach->chid)
+            {
+                unlink(entry);
+            }
+            fclose(in);
+        }
+        g_names[attach->chid - 1][0] = '\0';
+    }
+
+    ChannelDestroy(attach->chid);
+    free(attach);
+    return 0;
+}
+
+int name_open(const char *name, int flags)
+{
+    (void)flags;
+    char entry[PATH_MAX];
+    if (!name || namespace_path(entry, sizeof(entry), name) != 0)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    FILE *in = fopen(entry, "r");
+    if (!in)
+    {
+        errno = ENOENT;
+        return -1;
+    }
+    int pid = 0, chid = 0;
+    int fields = fscanf(in, "%d %d", &pid, &chid);
+    fclose(in);
+    if (fields != 2 || process_gone((pid_t)pid))
+    {
+        errno = ENOENT;
+        return -1;
+    }
+    return ConnectAttach(ND_LOCAL_NODE, (pid_t)pid, chid, _NTO_SIDE_CHANNEL, 0);
+}
+
+int name_close(int coid)
+{
+    return ConnectDetach(coid);
+}
+
+/* Timer pulses */
+
+static void pulse_notify(union sigval sv)
+{
+    uintptr_t packed = (uintptr_t)sv.sival_ptr;
+    int coid = (int)((packed >> 40) & 0xffffffU);
+    int code = (int)(int8_t)((packed >> 32) & 0xffU);
+    int value = (int)(uint32_t)packed;
+    MsgSendPulse(coid, SIGEV_PULSE_PRIO_INHERIT, code, value);
+}
+
+void qnx_mock_sigev_pulse_init(struct sigevent *event, int coid, int priority,
+                               int code, int value)
+{
+    (void)priority;
+    memset(event, 0, sizeof(*event));
+    event->sigev_notify = SIGEV_THREAD;
+    event->sigev_notify_function = pulse_notify;
+    event->sigev_notify_attributes = NULL;
+    event->sigev_value.sival_ptr =
+        (void *)(((uintptr_t)((unsigned)coid & 0xffffffU) << 40) |
+                 ((uintptr_t)((uint8_t)code) << 32) | (uintptr_t)(uint32_t)value);
+}
+
+/* Internal helpers */
+
+static long futex_wait(_Atomic uint32_t *addr, uint32_t expected, const struct timespec *timeout)
+{
+    // Shared (not PRIVATE) futexes: the word may be mapped by several processes
+    return syscall(SYS_futex, (uint32_t *)addr, FUTEX_WAIT, expected, timeout, NULL, 0);
+}
+
+static void futex_wake(_Atomic uint32_t *addr, int count)
+{
+    syscall(SYS_futex, (uint32_t *)addr, FUTEX_WAKE, count, NULL, NULL, 0);
+}
+
+static void shm_channel_name(char *out, size_t size, pid_t pid, int chid)
+{
+    snprintf(out, size, "/sls_qnx_%d_%d", (int)pid, chid);
+}
+
+static mock_channel_shm_t *map_channel(pid_t pid, int chid, bool create)
+{
+    char name[64];
+    shm_channel_name(name, sizeof(name), pid, chid);
+
+    int fd;
+    if (create)
+    {
+        shm_unlink(name); // Left by an earlier process with the same pid
+        fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    }
+    else
+    {
+        fd = shm_open(name, O_RDWR, 0);
+    }
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    if (create && ftruncate(fd, sizeof(mock_channel_shm_t)) != 0)
+    {
+        close(fd);
+        shm_unlink(name);
+        return NULL;
+    }
+
+    mock_channel_shm_t *shm = mmap(NULL, sizeof(*shm), PROT_READ | PROT_WRITE,
+                                   MAP_SHARED, fd, 0);
+    close(fd);
+    if (shm == MAP_FAILED)
+    {
+        if (create)
+        {
+            shm_unlink(name);
+        }
+        return NULL;
+    }
+
+    if (create)
+    {
+        // ftruncate zero-filled the object; only non-zero fields need setting
+        shm->owner_pid = pid;
+        shm->chid = chid;
+        for (size_t i = 0; i < QNX_MOCK_PULSE_SLOTS; i++)
+        {
+            atomic_init(&shm->pulses[i].sequence, i);
+        }
+        atomic_thread_fence(memory_order_release);
+        shm->magic = CHANNEL_MAGIC;
+    }
+    else if (shm->magic != CHANNEL_MAGIC || atomic_load(&shm->destroyed))
+    {
+        munmap(shm, sizeof(*shm));
+        return NULL;
+    }
+    return shm;
+}
+
+static mock_ref_t *claim_ref(mock_ref_t *table, int count, int *index)
+{
+    for (int i = 0; i < count; i++)
+    {
+        int expected = REF_FREE;
+        // CLOSING doubles as "being set up" so lookups skip the entry
+        if (atomic_compare_exchange_strong(&table[i].state, &expected, REF_CLOSING))
+        {
+            *index = i;
+            return &table[i];
+        }
+    }
+    return NULL;
+}
+
+static mock_ref_t *acquire_ref(mock_ref_t *table, int count, int id)
+{
+    if (id <= 0 || id > count)
+    {
+        return NULL;
+    }
+    mock_ref_t *ref = &table[id - 1];
+    atomic_fetch_add(&ref->users, 1);
+    if (atomic_load(&ref->state) != REF_LIVE)
+    {
+        atomic_fetch_sub(&ref->users, 1);
+        return NULL;
+    }
+    return ref;
+}
+
+static void release_ref(mock_ref_t *ref)
+{
+    atomic_fetch_sub_explicit(&ref->users, 1, memory_order_release);
+}
+
+// Stop new lookups, wait for calls in flight to leave, then unmap
+static void close_ref(mock_ref_t *ref)
+{
+    int expected = REF_LIVE;
+    if (!atomic_compare_exchange_strong(&ref->state, &expected, REF_CLOSING))
+    {
+        return; // Someone else is closing it
+    }
+    while (atomic_load_explicit(&ref->users, memory_order_acquire) > 0)
+    {
+        // Blocked receivers were woken by ChannelDestroy; senders notice
+        // within SEND_RECHECK_SEC
+        if (ref->shm)
+        {
+            futex_wake(&ref->shm->doorbell, INT_MAX);
+        }
+        sched_yield();
+    }
+    munmap(ref->shm, sizeof(*ref->shm));
+    ref->shm = NULL;
+    atomic_store_explicit(&ref->state, REF_FREE, memory_order_release);
+}
+
+static void ring_doorbell(mock_channel_shm_t *shm)
+{
+    // Paired with the receiver's waiting++ then futex_wait(doorbell): either
+    // it sees the new doorbell value or we see it waiting
+    atomic_fetch_add(&shm->doorbell, 1);
+    if (atomic_load(&shm->receivers_waiting) > 0)
+    {
+        futex_wake(&shm->doorbell, 1);
+    }
+}
+
+static bool pulse_pop(mock_channel_shm_t *shm, struct _pulse *out)
+{
+    size_t pos = atomic_load_explicit(&shm->pulse_dequeue, memory_order_relaxed);
+    for (;;)
+    {
+        mock_pulse_cell_t *cell = &shm->pulses[pos & (QNX_MOCK_PULSE_SLOTS - 1)];
+        size_t seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (diff == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&shm->pulse_dequeue, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed))
+            {
+                *out = cell->pulse;
+                atomic_store_explicit(&cell->sequence, pos + QNX_MOCK_PULSE_SLOTS,
+                                      memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0)
+        {
+            return false;
+        }
+        else
+        {
+            pos = atomic_load_explicit(&shm->pulse_dequeue, memory_order_relaxed);
+        }
+    }
+}
+
+static mock_send_slot_t *claim_send_slot(mock_channel_shm_t *shm)
+{
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (int i = 0; i < QNX_MOCK_SEND_SLOTS; i++)
+        {
+            mock_send_slot_t *slot = &shm->slots[i];
+            uint32_t state = atomic_load(&slot->state);
+            // Second pass: reclaim replies nobody is waiting for any more
+            if (pass == 1 && state == SLOT_REPLIED && process_gone(slot->sender_pid))
+            {
+                atomic_compare_exchange_strong(&slot->state, &state, SLOT_FREE);
+                state = SLOT_FREE;
+            }
+            if (state == SLOT_FREE &&
+                atomic_compare_exchange_strong(&slot->state, &state, SLOT_FILLING))
+            {
+                return slot;
+            }
+        }
+    }
+    return NULL;
+}
+
+// QNX queues same-priority senders FIFO; the ticket keeps that order
+static mock_send_slot_t *take_oldest_sent(mock_channel_shm_t *shm, int *slot_index)
+{
+    for (;;)
+    {
+        int oldest = -1;
+        for (int i = 0; i < QNX_MOCK_SEND_SLOTS; i++)
+        {
+            mock_send_slot_t *slot = &shm->slots[i];
+            if (atomic_load_explicit(&slot->state, memory_order_acquire) == SLOT_SENT &&
+                (oldest < 0 || slot->ticket < shm->slots[oldest].ticket))
+            {
+                oldest = i;
+            }
+        }
+        if (oldest < 0)
+        {
+            return NULL;
+        }
+        mock_send_slot_t *slot = &shm->slots[oldest];
+        uint32_t expected = SLOT_SENT;
+        if (atomic_compare_exchange_strong(&slot->state, &expected, SLOT_RECEIVED))
+        {
+            slot->generation++;
+            *slot_index = oldest;
+            return slot;
+        }
+        // Another receive thread took it; rescan
+    }
+}
+
+static bool process_gone(pid_t pid)
+{
+    return pid > 0 && kill(pid, 0) != 0 && errno == ESRCH;
+}
+
+static int namespace_path(char *out, size_t size, const char *name)
+{
+    const char *dir = getenv(QNX_MOCK_NAMESPACE_ENV);
+    if (!dir || !*dir)
+    {
+        dir = QNX_MOCK_NAMESPACE_DIR;
+    }
+    if (!*name || strchr(name, '/'))
+    {
+        return -1;
+    }
+    mkdir(dir, 0777); // May already exist
+    int n = snprintf(out, size, "%s/%s", dir, name);
+    return (n > 0 && (size_t)n < size) ? 0 : -1;
+}
+
+#endif // MOCK_QNX_BUILD
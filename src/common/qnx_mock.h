@@ -3,16 +3,27 @@
 
 /**
  * @file qnx_mock.h
- * @brief Mock QNX functions for Linux development and testing
+ * @brief QNX Neutrino message passing for Linux development and testing
  *
- * This file provides mock implementations of QNX-specific functions
- * to allow development and testing on Linux systems without QNX.
+ * Declares a Linux implementation (qnx_mock.c) of the QNX kernel calls the
+ * simulator uses: channels, connections, synchronous MsgSend/MsgReceive/
+ * MsgReply, pulses, name_attach/name_open and pulse-delivering timers.
+ * Channels live in POSIX shared memory and the rendezvous blocks on
+ * futexes, so servers and clients may sit in different processes exactly
+ * as on target. src/compat/sys/ maps the QNX system headers onto this file
+ * so QNX-only sources (qnx/ipc.c, ui/console.c) build unmodified.
+ *
+ * Limits of the stand-in: at most QNX_MOCK_MAX_MSG bytes per message and
+ * reply, QNX_MOCK_SEND_SLOTS concurrently send-blocked clients per channel,
+ * pulses are delivered ahead of messages rather than by priority, and the
+ * node descriptor is ignored (everything is local).
  */
 
 #ifdef MOCK_QNX_BUILD
 
 #include <stdint.h>
 #include <pthread.h>
+#include <signal.h>
 #include <unistd.h>
 #include <errno.h>
 #include <sys/types.h>
@@ -25,6 +36,28 @@ typedef int rcvid_t;
 // Mock message codes
 #define _IO_MAX 0x100
 
+#ifndef EOK
+#define EOK 0
+#endif
+
+// Stand-in limits
+#define QNX_MOCK_MAX_CHANNELS 32    // per process
+#define QNX_MOCK_MAX_CONNECTIONS 64 // per process
+#define QNX_MOCK_SEND_SLOTS 32      // send-blocked clients per channel
+#define QNX_MOCK_PULSE_SLOTS 64     // queued pulses per channel (power of 2)
+#define QNX_MOCK_MAX_MSG 1024       // bytes per message or reply
+
+// Namespace directory for name_attach (QNX: /dev/name/local)
+#define QNX_MOCK_NAMESPACE_ENV "SLS_QNX_NAMESPACE"
+#define QNX_MOCK_NAMESPACE_DIR "/tmp/sls_qnx_names"
+
+// Connection and node constants
+#define ND_LOCAL_NODE 0
+#define _NTO_SIDE_CHANNEL 0x40000000
+#define _PULSE_TYPE 0
+#define _PULSE_SUBTYPE 0
+#define SIGEV_PULSE_PRIO_INHERIT (-1)
+
 // Mock message info structure (declare before use)
 struct _msg_info
 {
@@ -42,69 +75,59 @@ struct _msg_info
     int16_t zero[3];
 };
 
-// Mock QNX functions
-static inline chid_t ChannelCreate(unsigned flags)
+// Pulse as delivered by MsgReceive (returns rcvid 0)
+struct _pulse
 {
-    (void)flags;
-    static int next_chid = 1;
-    return next_chid++;
-}
-
-static inline int ChannelDestroy(chid_t chid)
-{
-    (void)chid;
-    return 0;
-}
-
-static inline coid_t ConnectAttach(uint32_t nd, pid_t pid, chid_t chid,
-                                   unsigned index, int flags)
-{
-    (void)nd;
-    (void)pid;
-    (void)chid;
-    (void)index;
-    (void)flags;
-    static int next_coid = 1;
-    return next_coid++;
-}
-
-static inline int ConnectDetach(coid_t coid)
-{
-    (void)coid;
-    return 0;
-}
-
-static inline rcvid_t MsgReceive(chid_t chid, void *msg, size_t bytes,
-                                 struct _msg_info *info)
-{
-    (void)chid;
-    (void)msg;
-    (void)bytes;
-    (void)info;
-    // Mock: no message available
-    errno = ETIMEDOUT;
-    return -1;
-}
-
-static inline int MsgReply(rcvid_t rcvid, int status, const void *msg, size_t bytes)
-{
-    (void)rcvid;
-    (void)status;
-    (void)msg;
-    (void)bytes;
-    return 0;
-}
+    uint16_t type;
+    uint16_t subtype;
+    int8_t code;
+    uint8_t zero[3];
+    union sigval value;
+    int32_t scoid;
+};
 
-static inline int MsgSend(coid_t coid, const void *smsg, size_t sbytes,
-                          void *rmsg, size_t rbytes)
+// name_attach handle
+typedef struct _dispatch dispatch_t;
+typedef struct _name_attach
 {
-    (void)coid;
-    (void)smsg;
-    (void)sbytes;
-    (void)rmsg;
-    (void)rbytes;
-    return 0;
-}
+    dispatch_t *dpp;
+    int chid;
+    int mntid;
+    int zero[2];
+} name_attach_t;
+
+// Channels and connections
+chid_t ChannelCreate(unsigned flags);
+int ChannelDestroy(chid_t chid);
+coid_t ConnectAttach(uint32_t nd, pid_t pid, chid_t chid, unsigned index, int flags);
+int ConnectDetach(coid_t coid);
+
+// Synchronous message passing. MsgSend returns the status passed to
+// MsgReply, or -1 with errno set (the MsgError code, ESRCH if the server
+// went away, E2BIG above QNX_MOCK_MAX_MSG).
+rcvid_t MsgReceive(chid_t chid, void *msg, size_t bytes, struct _msg_info *info);
+int MsgReply(rcvid_t rcvid, int status, const void *msg, size_t bytes);
+int MsgError(rcvid_t rcvid, int error);
+int MsgSend(coid_t coid, const void *smsg, size_t sbytes, void *rmsg, size_t rbytes);
+int MsgSendPulse(coid_t coid, int priority, int code, int value);
+
+// Names
+name_attach_t *name_attach(dispatch_t *dpp, const char *path, unsigned flags);
+int name_detach(name_attach_t *attach, unsigned flags);
+int name_open(const char *name, int flags);
+int name_close(int coid);
+
+// Messages waiting on one of this process's channels: send-blocked clients
+// not yet received plus queued pulses. Stand-in only (QNX has no such
+// call); -1 with EINVAL for an unknown chid.
+int qnx_mock_channel_pending(chid_t chid);
+
+// Timer pulses: a SIGEV_THREAD notification that sends the pulse, so
+// timer_create() with this sigevent behaves like a QNX pulse timer
+void qnx_mock_sigev_pulse_init(struct sigevent *event, int coid, int priority,
+                               int code, int value);
+#define SIGEV_PULSE_INIT(__e, __coid, __prio, __code, __val) \
+    qnx_mock_sigev_pulse_init((__e), (__coid), (__prio), (__code), (__val))
 
 // Mock thread naming (only if not already available)
 #ifdef __linux__
@@ -0,0 +1,113 @@
+#ifndef SLS_SIM_PROTO_H
+#define SLS_SIM_PROTO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Portable simulator command records, shared by QNX message passing
+// (qnx/ipc.h) and the binary mode of the TCP command server, and the
+// telemetry record served by /dev/sls_telemetry. Only C library headers
+// (stdio.h for sim_telem_format), no OS ones.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Simple command protocol
+typedef enum {
+    CMD_STATUS = 1,
+    CMD_GO = 2,
+    CMD_NOGO = 3,
+    CMD_ABORT = 4,
+    CMD_SET_THROTTLE = 5,
+    CMD_BATCH = 6,       // value = count; count sim_msg_t follow (QNX IPC only)
+    PULSE_TICK = 100,
+    PULSE_SHUTDOWN = 101 // stops one receive thread (qnx/ipc.c)
+} cmd_t;
+
+typedef struct {
+    int32_t type;   // cmd_t
+    int32_t value;  // throttle percent or extra data
+} sim_msg_t;
+
+typedef struct {
+    int32_t ok;         // 0/1
+    int32_t mission_go; // 0/1
+    int32_t throttle;   // 0-100
+} sim_reply_t;
+
+// Wire format. A TCP client selects binary mode by sending SIM_WIRE_MAGIC as
+// the first byte of the connection; the server echoes it once. After that the
+// client sends sim_msg_t records and gets one sim_reply_t per record, in
+// order, each field a little-endian int32 with no padding.
+#define SIM_WIRE_MAGIC 0xA5
+#define SIM_MSG_WIRE_SZ 8
+#define SIM_REPLY_WIRE_SZ 12
+
+static inline void sim_put_le32(uint8_t* p, int32_t v) {
+    uint32_t u = (uint32_t)v;
+    p[0] = (uint8_t)u; p[1] = (uint8_t)(u >> 8);
+    p[2] = (uint8_t)(u >> 16); p[3] = (uint8_t)(u >> 24);
+}
+
+static inline int32_t sim_get_le32(const uint8_t* p) {
+    return (int32_t)((uint32_t)p[0] | (uint32_t)p[1] << 8 |
+                     (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24);
+}
+
+static inline void sim_msg_encode(const sim_msg_t* m, uint8_t out[SIM_MSG_WIRE_SZ]) {
+    sim_put_le32(out, m->type);
+    sim_put_le32(out + 4, m->value);
+}
+
+static inline void sim_msg_decode(const uint8_t in[SIM_MSG_WIRE_SZ], sim_msg_t* m) {
+    m->type = sim_get_le32(in);
+    m->value = sim_get_le32(in + 4);
+}
+
+static inline void sim_reply_encode(const sim_reply_t* r, uint8_t out[SIM_REPLY_WIRE_SZ]) {
+    sim_put_le32(out, r->ok);
+    sim_put_le32(out + 4, r->mission_go);
+    sim_put_le32(out + 8, r->throttle);
+}
+
+static inline void sim_reply_decode(const uint8_t in[SIM_REPLY_WIRE_SZ], sim_reply_t* r) {
+    r->ok = sim_get_le32(in);
+    r->mission_go = sim_get_le32(in + 4);
+    r->throttle = sim_get_le32(in + 8);
+}
+
+// Telemetry sample, one per sim tick. This is what the /dev/sls_telemetry
+// ring stores and what a binary-mode open reads (native byte order; the
+// device is local). Distances are in centimetres so the text form below
+// reproduces "%.2f" exactly; 64 bits, since the demo sim keeps accelerating
+// well past the 21,474 km an int32 holds. seq counts samples, so a reader
+// can spot records it lost to a ring overrun.
+typedef struct {
+    int64_t timestamp_ns;  // CLOCK_REALTIME
+    int64_t altitude_cm;
+    int64_t velocity_cms;
+    uint32_t seq;
+    uint8_t throttle;      // 0-100
+    uint8_t mission_go;    // 0/1
+    uint8_t abort_req;     // 0/1
+    uint8_t reserved;
+} sim_telem_record_t;
+
+#define SIM_TELEM_LINE_MAX 96 // longest line sim_telem_format() produces
+
+// Text form of a record, as text-mode reads of /dev/sls_telemetry return it:
+// "<sec>.<ms>,alt=<m>,vel=<m/s>,thr=<pct>,go=<0|1>\n". Returns the length.
+static inline int sim_telem_format(const sim_telem_record_t* r, char* buf, size_t len) {
+    long long sec = r->timestamp_ns / 1000000000LL;
+    long long ms = (r->timestamp_ns % 1000000000LL) / 1000000LL;
+    return snprintf(buf, len, "%lld.%03lld,alt=%.2f,vel=%.2f,thr=%d,go=%d\n", sec, ms,
+                    r->altitude_cm / 100.0, r->velocity_cms / 100.0, r->throttle, r->mission_go);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SLS_SIM_PROTO_H
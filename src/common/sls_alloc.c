@@ -0,0 +1,441 @@
+/**
+ * @file sls_alloc.c
+ * @brief Accounted heap allocation and the steady-state no-allocation rule
+ */
+
+#include "sls_alloc.h"
+#include "sls_logging.h"
+#include "sls_metrics.h"
+
+#include <errno.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define ALLOC_MAGIC 0x534c5341u // "SLSA"
+#define MIN_ALIGN 16
+#define STARTUP_ALIGN 64
+#define HUGE_PAGE_SIZE (2u * 1024 * 1024)
+
+// Stored just below every block handed out
+typedef struct
+{
+    void *base; // what malloc returned
+    size_t size;
+    int owner;
+    uint32_t magic;
+} alloc_header_t;
+
+// One cache line per owner: owners allocate from different threads
+typedef struct
+{
+    _Alignas(64) _Atomic uint64_t allocations;
+    _Atomic uint64_t frees;
+    _Atomic uint64_t failures;
+    _Atomic uint64_t bytes_in_use;
+    _Atomic uint64_t peak_bytes;
+    _Atomic uint64_t after_seal;
+} owner_stats_t;
+
+static owner_stats_t g_stats[SLS_ALLOC_OWNERS];
+static atomic_bool g_sealed = false;
+static atomic_int g_policy = SLS_ALLOC_POLICY_LOG;
+static _Thread_local bool tls_steady = false;
+
+static _Atomic uint64_t g_total_allocations;
+static _Atomic uint64_t g_tick_mark;
+
+typedef struct
+{
+    unsigned char *base;
+    size_t size;
+    atomic_size_t used;
+    bool huge_pages;
+    bool locked;
+} arena_t;
+
+static alignas(4096) unsigned char g_bootstrap[SLS_ALLOC_BOOTSTRAP_BYTES];
+static arena_t g_bootstrap_arena = {.base = g_bootstrap, .size = sizeof(g_bootstrap)};
+static arena_t g_mapped_arena;
+static _Atomic(arena_t *) g_arena = &g_bootstrap_arena;
+static atomic_bool g_arena_full_warned = false;
+
+static const char *const g_owner_names[SLS_ALLOC_OWNERS] = {
+    "flight_control", "engine_control", "telemetry", "environmental", "ground_support",
+    "navigation",     "power",          "thermal",   "core"};
+
+static int clamp_owner(int owner)
+{
+    return (owner >= 0 && owner < SLS_ALLOC_OWNERS) ? owner : SLS_ALLOC_CORE;
+}
+
+/**
+ * @brief Apply the policy to an allocation made after the seal
+ */
+static void check_seal(int owner, size_t size)
+{
+    if (!tls_steady || !atomic_load_explicit(&g_sealed, memory_order_relaxed))
+    {
+        return;
+    }
+
+    uint64_t n = atomic_fetch_add_explicit(&g_stats[owner].after_seal, 1, memory_order_relaxed);
+    int policy = atomic_load_explicit(&g_policy, memory_order_relaxed);
+    if (policy == SLS_ALLOC_POLICY_ALLOW)
+    {
+        return;
+    }
+    if (n < SLS_ALLOC_LOG_LIMIT || policy == SLS_ALLOC_POLICY_ABORT)
+    {
+        sls_log(LOG_LEVEL_ERROR, "ALLOC", "%s allocated %zu bytes in steady state%s",
+                g_owner_names[owner], size,
+                n + 1 == SLS_ALLOC_LOG_LIMIT ? " (further reports suppressed)" : "");
+    }
+    if (policy == SLS_ALLOC_POLICY_ABORT)
+    {
+        sls_logging_flush();
+        abort();
+    }
+}
+
+static void account_alloc(int owner, size_t size)
+{
+    owner_stats_t *s = &g_stats[owner];
+    atomic_fetch_add_explicit(&s->allocations, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&g_total_allocations, 1, memory_order_relaxed);
+
+    uint64_t in_use = atomic_fetch_add_explicit(&s->bytes_in_use, size, memory_order_relaxed) + size;
+    uint64_t peak = atomic_load_explicit(&s->peak_bytes, memory_order_relaxed);
+    while (in_use > peak &&
+           !atomic_compare_exchange_weak_explicit(&s->peak_bytes, &peak, in_use,
+                                                  memory_order_relaxed, memory_order_relaxed))
+    {
+    }
+}
+
+void *sls_alloc_aligned(int owner, size_t alignment, size_t size)
+{
+    owner = clamp_owner(owner);
+    if (size == 0)
+    {
+        return NULL;
+    }
+    if (alignment < MIN_ALIGN)
+    {
+        alignment = MIN_ALIGN;
+    }
+    check_seal(owner, size);
+
+    size_t total = size + sizeof(alloc_header_t) + alignment - 1;
+    void *base = (total > size) ? malloc(total) : NULL;
+    if (!base)
+    {
+        atomic_fetch_add_explicit(&g_stats[owner].failures, 1, memory_order_relaxed);
+        sls_log(LOG_LEVEL_ERROR, "ALLOC", "%s: failed to allocate %zu bytes",
+                g_owner_names[owner], size);
+        return NULL;
+    }
+
+    uintptr_t p = ((uintptr_t)base + sizeof(alloc_header_t) + alignment - 1) &
+                  ~(uintptr_t)(alignment - 1);
+    alloc_header_t *h = (alloc_header_t *)p - 1;
+    h->base = base;
+    h->size = size;
+    h->owner = owner;
+    h->magic = ALLOC_MAGIC;
+
+    account_alloc(owner, size);
+    return (void *)p;
+}
+
+void *sls_alloc(int owner, size_t size)
+{
+    return sls_alloc_aligned(owner, MIN_ALIGN, size);
+}
+
+void *sls_calloc(int owner, size_t count, size_t size)
+{
+    if (size != 0 && count > SIZE_MAX / size)
+    {
+        return NULL;
+    }
+    void *p = sls_alloc_aligned(owner, MIN_ALIGN, count * size);
+    if (p)
+    {
+        memset(p, 0, count * size);
+    }
+    return p;
+}
+
+void *sls_realloc(int owner, void *ptr, size_t size)
+{
+    if (!ptr)
+    {
+        return sls_alloc(owner, size);
+    }
+    if (size == 0)
+    {
+        sls_free(ptr);
+        return NULL;
+    }
+
+    alloc_header_t *h = (alloc_header_t *)ptr - 1;
+    void *grown = sls_alloc(h->owner, size);
+    if (grown)
+    {
+        memcpy(grown, ptr, h->size < size ? h->size : size);
+        sls_free(ptr);
+    }
+    return grown;
+}
+
+void sls_free(void *ptr)
+{
+    if (!ptr)
+    {
+        return;
+    }
+
+    alloc_header_t *h = (alloc_header_t *)ptr - 1;
+    if (h->magic != ALLOC_MAGIC)
+    {
+        sls_log(LOG_LEVEL_CRITICAL, "ALLOC", "sls_free of a block it did not allocate (%p)", ptr);
+        abort();
+    }
+    owner_stats_t *s = &g_stats[h->owner];
+    atomic_fetch_add_explicit(&s->frees, 1, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&s->bytes_in_use, h->size, memory_order_relaxed);
+
+    h->magic = 0;
+    free(h->base);
+}
+
+void *sls_alloc_startup(int owner, size_t size)
+{
+    owner = clamp_owner(owner);
+    if (size == 0)
+    {
+        return NULL;
+    }
+
+    arena_t *arena = atomic_load_explicit(&g_arena, memory_order_acquire);
+    size_t rounded = (size + STARTUP_ALIGN - 1) & ~(size_t)(STARTUP_ALIGN - 1);
+    size_t offset = atomic_fetch_add_explicit(&arena->used, rounded, memory_order_relaxed);
+    if (offset + rounded > arena->size || offset + rounded < offset)
+    {
+        // Exhausted: later callers fail too, so the arena never has holes
+        if (!atomic_exchange(&g_arena_full_warned, true))
+        {
+            sls_log(LOG_LEVEL_WARNING, "ALLOC",
+                    "Startup arena full (%zu bytes), %s and later owners use the heap",
+                    arena->size, g_owner_names[owner]);
+        }
+        void *p = sls_alloc_aligned(owner, STARTUP_ALIGN, size);
+        if (!p)
+        {
+            sls_logging_flush();
+            abort();
+        }
+        return memset(p, 0, size);
+    }
+
+    check_seal(owner, size);
+    account_alloc(owner, rounded);
+    return arena->base + offset;
+}
+
+/**
+ * @brief Explicit huge pages, else normal pages with transparent huge pages advised
+ */
+static void *map_arena(size_t *bytes, bool huge_pages, bool *got_huge)
+{
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    void *p = MAP_FAILED;
+
+    *got_huge = false;
+#ifdef MAP_HUGETLB
+    if (huge_pages)
+    {
+        size_t huge = (*bytes + HUGE_PAGE_SIZE - 1) & ~(size_t)(HUGE_PAGE_SIZE - 1);
+        p = mmap(NULL, huge, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                 -1, 0);
+        if (p != MAP_FAILED)
+        {
+            *bytes = huge;
+            *got_huge = true;
+            return p;
+        }
+    }
+#endif
+
+    *bytes = (*bytes + page - 1) & ~(page - 1);
+    p = mmap(NULL, *bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+#ifdef MADV_HUGEPAGE
+    if (p != MAP_FAILED && huge_pages)
+    {
+        madvise(p, *bytes, MADV_HUGEPAGE);
+    }
+#endif
+    return p == MAP_FAILED ? NULL : p;
+}
+
+int sls_alloc_arena_init(size_t bytes, bool huge_pages, bool lock)
+{
+    if (g_mapped_arena.base || bytes == 0)
+    {
+        return -1;
+    }
+
+    bool got_huge = false;
+    unsigned char *base = map_arena(&bytes, huge_pages, &got_huge);
+    if (!base)
+    {
+        sls_log(LOG_LEVEL_ERROR, "ALLOC", "Cannot map a %zu byte startup arena: %s", bytes,
+                strerror(errno));
+        return -1;
+    }
+
+    // Touch every page now, from this thread: no first-use faults later, and
+    // the pages land on this thread's NUMA node
+    memset(base, 0, bytes);
+
+    bool locked = false;
+    if (lock)
+    {
+        locked = mlock(base, bytes) == 0 && mlock(g_bootstrap, sizeof(g_bootstrap)) == 0;
+        if (!locked)
+        {
+            sls_log(LOG_LEVEL_WARNING, "ALLOC",
+                    "Cannot lock the startup arena (%s); check RLIMIT_MEMLOCK", strerror(errno));
+        }
+    }
+
+    g_mapped_arena.base = base;
+    g_mapped_arena.size = bytes;
+    g_mapped_arena.huge_pages = got_huge;
+    g_mapped_arena.locked = locked;
+    atomic_store_explicit(&g_arena, &g_mapped_arena, memory_order_release);
+
+    sls_log(LOG_LEVEL_INFO, "ALLOC", "Startup arena: %zu KB, %s pages, %s", bytes / 1024,
+            got_huge ? "huge" : "normal", locked ? "locked" : "not locked");
+    return 0;
+}
+
+void sls_alloc_arena_info(sls_alloc_arena_info_t *info)
+{
+    const arena_t *arena = atomic_load_explicit(&g_arena, memory_order_acquire);
+    size_t used = atomic_load(&arena->used);
+
+    info->size = arena == &g_mapped_arena ? arena->size : 0;
+    info->used = used < arena->size ? used : arena->size;
+    info->huge_pages = arena->huge_pages;
+    info->locked = arena->locked;
+}
+
+void sls_alloc_seal(void)
+{
+    const arena_t *arena = atomic_load_explicit(&g_arena, memory_order_acquire);
+    size_t used = atomic_load(&arena->used);
+
+    atomic_store(&g_sealed, true);
+    sls_log(LOG_LEVEL_INFO, "ALLOC",
+            "Steady state: control loops must not allocate (startup arena %zu/%zu bytes)",
+            used < arena->size ? used : arena->size, arena->size);
+}
+
+bool sls_alloc_sealed(void)
+{
+    return atomic_load(&g_sealed);
+}
+
+void sls_alloc_steady_thread(void)
+{
+    tls_steady = true;
+}
+
+void sls_alloc_set_policy(sls_alloc_policy_t policy)
+{
+    atomic_store(&g_policy, (int)policy);
+}
+
+int sls_alloc_set_policy_name(const char *name)
+{
+    static const char *const names[] = {"allow", "log", "abort"};
+    for (int i = 0; i < 3; i++)
+    {
+        if (name && strcasecmp(name, names[i]) == 0)
+        {
+            sls_alloc_set_policy((sls_alloc_policy_t)i);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+uint64_t sls_alloc_tick(void)
+{
+    uint64_t total = atomic_load_explicit(&g_total_allocations, memory_order_relaxed);
+    return total - atomic_exchange_explicit(&g_tick_mark, total, memory_order_relaxed);
+}
+
+void sls_alloc_get_stats(int owner, sls_alloc_stats_t *stats)
+{
+    const owner_stats_t *s = &g_stats[clamp_owner(owner)];
+    stats->allocations = atomic_load(&s->allocations);
+    stats->frees = atomic_load(&s->frees);
+    stats->failures = atomic_load(&s->failures);
+    stats->bytes_in_use = atomic_load(&s->bytes_in_use);
+    stats->peak_bytes = atomic_load(&s->peak_bytes);
+    stats->after_seal = atomic_load(&s->after_seal);
+}
+
+const char *sls_alloc_owner_name(int owner)
+{
+    return g_owner_names[clamp_owner(owner)];
+}
+
+static double bytes_in_use_metric(void *arg)
+{
+    return (double)atomic_load(&((owner_stats_t *)arg)->bytes_in_use);
+}
+
+static double allocations_metric(void *arg)
+{
+    return (double)atomic_load(&((owner_stats_t *)arg)->allocations);
+}
+
+static double after_seal_metric(void *arg)
+{
+    return (double)atomic_load(&((owner_stats_t *)arg)->after_seal);
+}
+
+static double arena_used_metric(void *arg)
+{
+    (void)arg;
+    sls_alloc_arena_info_t info;
+    sls_alloc_arena_info(&info);
+    return (double)info.used;
+}
+
+void sls_alloc_register_metrics(void)
+{
+    sls_metrics_callback("sls_alloc_arena_bytes_used", NULL, "Startup arena bytes carved",
+                         SLS_METRIC_GAUGE, arena_used_metric, NULL);
+    for (int i = 0; i < SLS_ALLOC_OWNERS; i++)
+    {
+        char labels[48];
+        snprintf(labels, sizeof(labels), "owner=\"%s\"", g_owner_names[i]);
+        sls_metrics_callback("sls_alloc_bytes_in_use", labels, "Heap bytes held, by owner",
+                             SLS_METRIC_GAUGE, bytes_in_use_metric, &g_stats[i]);
+        sls_metrics_callback("sls_alloc_allocations_total", labels, "Allocations, by owner",
+                             SLS_METRIC_COUNTER, allocations_metric, &g_stats[i]);
+        sls_metrics_callback("sls_alloc_steady_state_total", labels,
+                             "Allocations by control loops after STATE_ACTIVE, by owner",
+                             SLS_METRIC_COUNTER, after_seal_metric, &g_stats[i]);
+    }
+}
@@ -0,0 +1,145 @@
+#ifndef SLS_ALLOC_H
+#define SLS_ALLOC_H
+
+/**
+ * @file sls_alloc.h
+ * @brief Accounted heap allocation and the steady-state no-allocation rule
+ *
+ * Every simulator allocation names an owner (a subsystem_type_t, or
+ * SLS_ALLOC_CORE for shared infrastructure) and is counted per owner:
+ * allocations, frees, failures, bytes in use and the high-water mark.
+ *
+ * Once the system reaches STATE_ACTIVE it calls sls_alloc_seal(). From
+ * then on an allocation made by a thread that has entered its control loop
+ * (sls_alloc_steady_thread()) is a violation: it is counted and, depending
+ * on the policy, logged or fatal. Background threads (configuration
+ * reload, metrics and command servers) are accounted but never violate.
+ *
+ * Data that lives for the whole run (subsystem state, telemetry history,
+ * metric shards) is carved from the startup arena with sls_alloc_startup():
+ * 64-byte aligned, never freed, no heap header. main maps the arena once
+ * configuration is loaded (sls_alloc_arena_init()), backed by huge pages
+ * when the system has them, prefaulted from the main thread so the pages
+ * are local to its NUMA node, and mlock()ed so a control loop never takes
+ * a page fault on it. Until then, carving uses a small static bootstrap
+ * block (logging sets up its metrics before the configuration is read).
+ *
+ * Tracing buffers (sls_trace.c) and the QNX mock deliberately use the C
+ * allocator directly.
+ */
+
+#include "sls_types.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SLS_ALLOC_CORE (SUBSYS_THERMAL + 1) // logging, IPC, config, metrics, servers
+#define SLS_ALLOC_OWNERS (SLS_ALLOC_CORE + 1)
+#define SLS_ALLOC_BOOTSTRAP_BYTES (64 * 1024)  // startup memory before the arena is mapped
+#define SLS_ALLOC_ARENA_DEFAULT_KB 2048         // one 2 MB huge page
+#define SLS_ALLOC_LOG_LIMIT 16 // violations logged per owner; all are counted
+
+typedef enum
+{
+    SLS_ALLOC_POLICY_ALLOW = 0, // count only
+    SLS_ALLOC_POLICY_LOG,       // count and log (default)
+    SLS_ALLOC_POLICY_ABORT      // log and abort()
+} sls_alloc_policy_t;
+
+typedef struct
+{
+    size_t size; // bytes mapped (0 while only the bootstrap block exists)
+    size_t used;
+    bool huge_pages;
+    bool locked;
+} sls_alloc_arena_info_t;
+
+typedef struct
+{
+    uint64_t allocations;
+    uint64_t frees;
+    uint64_t failures;
+    uint64_t bytes_in_use;
+    uint64_t peak_bytes;
+    uint64_t after_seal; // violations
+} sls_alloc_stats_t;
+
+/**
+ * @brief Allocate for an owner; sizes of 0 return NULL
+ */
+void *sls_alloc(int owner, size_t size);
+void *sls_calloc(int owner, size_t count, size_t size);
+void *sls_alloc_aligned(int owner, size_t alignment, size_t size);
+
+/**
+ * @brief Resize; the block keeps its owner (owner is used when ptr is NULL)
+ */
+void *sls_realloc(int owner, void *ptr, size_t size);
+
+/**
+ * @brief Free memory from sls_alloc*(); NULL is ignored
+ */
+void sls_free(void *ptr);
+
+/**
+ * @brief Whole-run memory from the startup arena, 64-byte aligned and zeroed
+ *
+ * Falls back to the heap when the arena is exhausted. Never returns NULL
+ * for a non-zero size: without startup memory the simulator cannot run,
+ * so if the heap fails too the process aborts.
+ */
+void *sls_alloc_startup(int owner, size_t size);
+
+/**
+ * @brief Map, prefault and optionally lock the startup arena; call once
+ * @param bytes Arena size, rounded up to the page (or huge page) size
+ * @param huge_pages Try explicit huge pages, then transparent ones
+ * @param lock mlock() the arena and the bootstrap block
+ * @return 0 on success (a failed mlock only warns), -1 if it cannot be mapped
+ *         or is already mapped; carving then continues in the bootstrap block
+ */
+int sls_alloc_arena_init(size_t bytes, bool huge_pages, bool lock);
+void sls_alloc_arena_info(sls_alloc_arena_info_t *info);
+
+/**
+ * @brief Start enforcing the no-allocation rule (at STATE_ACTIVE)
+ */
+void sls_alloc_seal(void);
+bool sls_alloc_sealed(void);
+
+/**
+ * @brief Mark the calling thread as a control loop in steady state
+ */
+void sls_alloc_steady_thread(void);
+
+void sls_alloc_set_policy(sls_alloc_policy_t policy);
+
+/**
+ * @brief Parse "allow", "log" or "abort"
+ * @return 0 on success, -1 if the name is unknown (policy unchanged)
+ */
+int sls_alloc_set_policy_name(const char *name);
+
+/**
+ * @brief Allocations (all owners) since the previous call; call once per tick
+ */
+uint64_t sls_alloc_tick(void);
+
+void sls_alloc_get_stats(int owner, sls_alloc_stats_t *stats);
+const char *sls_alloc_owner_name(int owner);
+
+/**
+ * @brief Export per-owner series through sls_metrics
+ */
+void sls_alloc_register_metrics(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SLS_ALLOC_H
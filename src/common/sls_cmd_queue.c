@@ -0,0 +1,227 @@
+/**
+ * @file sls_cmd_queue.c
+ * @brief Implementation of the per-subsystem lock-free command queues
+ */
+
+#include "sls_cmd_queue.h"
+#include "sls_logging.h"
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+
+_Static_assert((SLS_CMD_QUEUE_CAPACITY & (SLS_CMD_QUEUE_CAPACITY - 1)) == 0,
+               "SLS_CMD_QUEUE_CAPACITY must be a power of two");
+
+// Global command queue state
+static sls_cmd_queue_t g_cmd_queues[MAX_SUBSYSTEMS];
+static pthread_once_t g_cmd_queues_once = PTHREAD_ONCE_INIT;
+static atomic_uint_least32_t g_next_command_id = 1;
+
+// Internal function declarations
+static void init_all_queues(void);
+
+/**
+ * @brief Initialize an empty queue
+ */
+void sls_cmd_queue_init(sls_cmd_queue_t *queue)
+{
+    for (size_t i = 0; i < SLS_CMD_QUEUE_CAPACITY; i++)
+    {
+        atomic_init(&queue->slots[i].sequence, i);
+    }
+    atomic_init(&queue->enqueue_pos, 0);
+    atomic_init(&queue->dequeue_pos, 0);
+    atomic_init(&queue->submitted, 0);
+    atomic_init(&queue->rejected, 0);
+    atomic_init(&queue->acknowledged, 0);
+    atomic_init(&queue->latency_total_ns, 0);
+    atomic_init(&queue->latency_max_ns, 0);
+}
+
+/**
+ * @brief Enqueue a copy of a command (any thread)
+ * @return 0 on success, -1 if the queue is full
+ */
+int sls_cmd_queue_push(sls_cmd_queue_t *queue, const command_t *cmd)
+{
+    size_t pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+
+    for (;;)
+    {
+        sls_cmd_slot_t *slot = &queue->slots[pos & (SLS_CMD_QUEUE_CAPACITY - 1)];
+        size_t seq = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+        if (diff == 0)
+        {
+            // Slot is free for this lap; claim it
+            if (atomic_compare_exchange_weak_explicit(&queue->enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed))
+            {
+                slot->cmd = *cmd;
+                atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release);
+                atomic_fetch_add_explicit(&queue->submitted, 1, memory_order_relaxed);
+                return 0;
+            }
+        }
+        else if (diff < 0)
+        {
+            // Consumer has not freed this slot yet
+            atomic_fetch_add_explicit(&queue->rejected, 1, memory_order_relaxed);
+            return -1;
+        }
+        else
+        {
+            pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief Dequeue the oldest command (owning subsystem thread only)
+ * @return true if a command was copied to cmd
+ */
+bool sls_cmd_queue_pop(sls_cmd_queue_t *queue, command_t *cmd)
+{
+    size_t pos = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+    sls_cmd_slot_t *slot = &queue->slots[pos & (SLS_CMD_QUEUE_CAPACITY - 1)];
+    size_t seq = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+
+    if ((intptr_t)seq - (intptr_t)(pos + 1) < 0)
+    {
+        return false; // Empty, or producer still copying
+    }
+
+    *cmd = slot->cmd;
+    atomic_store_explicit(&queue->dequeue_pos, pos + 1, memory_order_relaxed);
+    atomic_store_explicit(&slot->sequence, pos + SLS_CMD_QUEUE_CAPACITY, memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Approximate number of queued commands
+ */
+size_t sls_cmd_queue_depth(const sls_cmd_queue_t *queue)
+{
+    size_t head = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+    return tail > head ? tail - head : 0;
+}
+
+/**
+ * @brief Snapshot queue counters
+ */
+void sls_cmd_queue_get_stats(const sls_cmd_queue_t *queue, sls_cmd_queue_stats_t *stats)
+{
+    stats->submitted = atomic_load_explicit(&queue->submitted, memory_order_relaxed);
+    stats->rejected = atomic_load_explicit(&queue->rejected, memory_order_relaxed);
+    stats->acknowledged = atomic_load_explicit(&queue->acknowledged, memory_order_relaxed);
+    stats->latency_total_ns = atomic_load_explicit(&queue->latency_total_ns, memory_order_relaxed);
+    stats->latency_max_ns = atomic_load_explicit(&queue->latency_max_ns, memory_order_relaxed);
+}
+
+/**
+ * @brief Initialize all subsystem queues (optional; done lazily otherwise)
+ */
+void sls_cmd_queues_init(void)
+{
+    pthread_once(&g_cmd_queues_once, init_all_queues);
+}
+
+/**
+ * @brief Get the command queue owned by a subsystem
+ */
+sls_cmd_queue_t *sls_cmd_queue_for(subsystem_type_t subsystem)
+{
+    if ((int)subsystem < 0 || subsystem >= MAX_SUBSYSTEMS)
+    {
+        return NULL;
+    }
+    pthread_once(&g_cmd_queues_once, init_all_queues);
+    return &g_cmd_queues[subsystem];
+}
+
+/**
+ * @brief Build and enqueue a command for a subsystem
+ * @return The command's sequence number, or 0 if it could not be queued
+ */
+uint32_t sls_cmd_submit(subsystem_type_t dest, command_opcode_t opcode, double value)
+{
+    command_t cmd;
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.target_subsystem = dest;
+    cmd.opcode = opcode;
+    cmd.value = value;
+    return sls_cmd_submit_command(&cmd);
+}
+
+/**
+ * @brief Enqueue a caller-built command
+ *
+ * Assigns the sequence number, priority and submit timestamps; any trace
+ * stages the caller already filled in (receive, parse) are kept.
+ * @return The command's sequence number, or 0 if it could not be queued
+ */
+uint32_t sls_cmd_submit_command(command_t *cmd)
+{
+    sls_cmd_queue_t *queue = sls_cmd_queue_for(cmd->target_subsystem);
+    if (!queue)
+    {
+        return 0;
+    }
+
+    cmd->priority = (cmd->opcode == CMD_OP_ABORT) ? PRIORITY_EMERGENCY : PRIORITY_HIGH;
+    cmd->urgent = (cmd->opcode == CMD_OP_ABORT);
+    cmd->command_id = atomic_fetch_add_explicit(&g_next_command_id, 1, memory_order_relaxed);
+    if (cmd->command_id == 0)
+    {
+        cmd->command_id = atomic_fetch_add_explicit(&g_next_command_id, 1, memory_order_relaxed);
+    }
+    cmd->timestamp_ns = sls_time_monotonic_ns();
+    cmd->stage_ns[CMD_STAGE_ENQUEUE] = (uint64_t)cmd->timestamp_ns;
+
+    if (sls_cmd_queue_push(queue, cmd) != 0)
+    {
+        sls_log(LOG_LEVEL_WARNING, "CMDQ", "Command queue for subsystem %d full, command %u rejected",
+                cmd->target_subsystem, cmd->command_id);
+        return 0;
+    }
+    return cmd->command_id;
+}
+
+/**
+ * @brief Mark a dequeued command as applied and record its latency
+ */
+void sls_cmd_acknowledge(command_t *cmd)
+{
+    sls_cmd_queue_t *queue = sls_cmd_queue_for(cmd->target_subsystem);
+
+    cmd->ack_timestamp_ns = sls_time_monotonic_ns();
+    if (!queue)
+    {
+        return;
+    }
+
+    sls_time_ns_t elapsed = cmd->ack_timestamp_ns - cmd->timestamp_ns;
+    uint64_t latency = elapsed > 0 ? (uint64_t)elapsed : 0;
+    atomic_fetch_add_explicit(&queue->acknowledged, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&queue->latency_total_ns, latency, memory_order_relaxed);
+
+    uint64_t max = atomic_load_explicit(&queue->latency_max_ns, memory_order_relaxed);
+    while (latency > max &&
+           !atomic_compare_exchange_weak_explicit(&queue->latency_max_ns, &max, latency,
+                                                  memory_order_relaxed, memory_order_relaxed))
+    {
+    }
+}
+
+// Internal helper functions
+
+static void init_all_queues(void)
+{
+    for (int i = 0; i < MAX_SUBSYSTEMS; i++)
+    {
+        sls_cmd_queue_init(&g_cmd_queues[i]);
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef SLS_CMD_QUEUE_H
+#define SLS_CMD_QUEUE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sls_types.h"
+
+/**
+ * @file sls_cmd_queue.h
+ * @brief Bounded lock-free command queues, one per subsystem
+ *
+ * Any thread may submit; only the owning subsystem thread drains its queue,
+ * at the top of its tick. Each slot carries a sequence counter (Vyukov's
+ * bounded queue), so producers claim slots with a single CAS and never block
+ * each other or the consumer.
+ */
+
+#define SLS_CMD_QUEUE_CAPACITY 64 // Must be a power of two
+
+// Queue slot
+typedef struct
+{
+    atomic_size_t sequence;
+    command_t cmd;
+} sls_cmd_slot_t;
+
+// Counters, readable from any thread
+typedef struct
+{
+    uint64_t submitted;
+    uint64_t rejected; // Queue full
+    uint64_t acknowledged;
+    uint64_t latency_total_ns; // Submit to acknowledge
+    uint64_t latency_max_ns;
+} sls_cmd_queue_stats_t;
+
+// Bounded MPSC queue
+typedef struct
+{
+    _Alignas(SLS_CACHE_LINE) atomic_size_t enqueue_pos;
+    _Alignas(SLS_CACHE_LINE) atomic_size_t dequeue_pos;
+    _Alignas(SLS_CACHE_LINE) atomic_uint_least64_t submitted;
+    atomic_uint_least64_t rejected;
+    atomic_uint_least64_t acknowledged;
+    atomic_uint_least64_t latency_total_ns;
+    atomic_uint_least64_t latency_max_ns;
+    sls_cmd_slot_t slots[SLS_CMD_QUEUE_CAPACITY];
+} sls_cmd_queue_t;
+
+// Single queue operations
+void sls_cmd_queue_init(sls_cmd_queue_t *queue);
+int sls_cmd_queue_push(sls_cmd_queue_t *queue, const command_t *cmd);
+bool sls_cmd_queue_pop(sls_cmd_queue_t *queue, command_t *cmd);
+size_t sls_cmd_queue_depth(const sls_cmd_queue_t *queue);
+void sls_cmd_queue_get_stats(const sls_cmd_queue_t *queue, sls_cmd_queue_stats_t *stats);
+
+// Per-subsystem queues
+void sls_cmd_queues_init(void);
+sls_cmd_queue_t *sls_cmd_queue_for(subsystem_type_t subsystem);
+uint32_t sls_cmd_submit(subsystem_type_t dest, command_opcode_t opcode, double value);
+uint32_t sls_cmd_submit_command(command_t *cmd);
+void sls_cmd_acknowledge(command_t *cmd);
+
+#endif // SLS_CMD_QUEUE_H
@@ -0,0 +1,579 @@
+/**
+ * @file sls_config_loader.c
+ * @brief INI configuration compiled into a perfect-hash table, with hot reload
+ */
+
+#include "sls_config_loader.h"
+#include "sls_alloc.h"
+#include "sls_logging.h"
+#include "sls_utils.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+#define MAX_KEYS 1024
+#define SEED_TRIES 4096 // seeds tried per table size before doubling it
+#define WATCH_POLL_MS 200
+
+typedef struct
+{
+    uint64_t hash; // 0 marks an empty slot
+    const char *key;
+    const char *str;
+    double dbl;
+    long lng;
+    bool is_number;
+} config_entry_t;
+
+typedef struct config_table
+{
+    uint64_t generation;
+    uint32_t seed;
+    uint32_t mask; // slots - 1
+    uint32_t count;
+    config_entry_t *slots;
+    char *strings;              // keys and values, NUL separated
+    struct config_table *older; // replaced tables, freed on unload
+} config_table_t;
+
+typedef struct
+{
+    char *key;
+    char *value;
+} raw_pair_t;
+
+static _Atomic(config_table_t *) g_table = NULL;
+static pthread_mutex_t g_load_lock = PTHREAD_MUTEX_INITIALIZER; // serialises writers
+static uint64_t g_next_generation = 1;
+static char g_path[PATH_MAX];
+
+static pthread_t g_watch_thread;
+static atomic_bool g_watching = false;
+
+/**
+ * @brief Seeded 64-bit FNV-1a with a final mix so the low bits are usable
+ */
+static uint64_t config_hash(const char *key, uint32_t seed)
+{
+    uint64_t h = 14695981039346656037ULL ^ ((uint64_t)seed * 0x9E3779B97F4A7C15ULL);
+    for (const unsigned char *p = (const unsigned char *)key; *p; p++)
+    {
+        h ^= *p;
+        h *= 1099511628211ULL;
+    }
+    h ^= h >> 32;
+    h *= 0xD6E8FEB86659FD93ULL;
+    h ^= h >> 32;
+    return h ? h : 1; // 0 is reserved for empty slots
+}
+
+static char *trim(char *s)
+{
+    while (isspace((unsigned char)*s))
+    {
+        s++;
+    }
+    char *end = s + strlen(s);
+    while (end > s && isspace((unsigned char)end[-1]))
+    {
+        *--end = '\0';
+    }
+    return s;
+}
+
+static void parse_value(config_entry_t *e)
+{
+    const char *s = e->str;
+    char *end;
+    // Decimal unless the value says 0x: a leading zero is padding, not octal
+    const char *digits = s + (*s == '+' || *s == '-');
+    int base = digits[0] == '0' && (digits[1] == 'x' || digits[1] == 'X') ? 16 : 10;
+    errno = 0;
+    long l = strtol(s, &end, base);
+    if (*s && *end == '\0' && errno == 0)
+    {
+        e->lng = l;
+        e->dbl = (double)l;
+        e->is_number = true;
+        return;
+    }
+    double d = strtod(s, &end);
+    if (*s && *end == '\0')
+    {
+        e->dbl = d;
+        e->lng = (long)d;
+        e->is_number = true;
+        return;
+    }
+    if (!strcasecmp(s, "true") || !strcasecmp(s, "yes") || !strcasecmp(s, "on"))
+    {
+        e->lng = 1;
+        e->dbl = 1.0;
+        e->is_number = true;
+    }
+    else if (!strcasecmp(s, "false") || !strcasecmp(s, "no") || !strcasecmp(s, "off"))
+    {
+        e->is_number = true;
+    }
+}
+
+/**
+ * @brief Place every key with a seed that gives each its own slot
+ */
+static int place_keys(config_table_t *t, const raw_pair_t *pairs, uint32_t count)
+{
+    uint32_t size = 8;
+    while (size < count * 4)
+    {
+        size <<= 1;
+    }
+
+    for (;; size <<= 1)
+    {
+        config_entry_t *slots = sls_calloc(SLS_ALLOC_CORE, size, sizeof(*slots));
+        if (!slots)
+        {
+            return -1;
+        }
+        for (uint32_t seed = 1; seed <= SEED_TRIES; seed++)
+        {
+            uint32_t placed = 0;
+            for (; placed < count; placed++)
+            {
+                uint64_t h = config_hash(pairs[placed].key, seed);
+                config_entry_t *e = &slots[h & (size - 1)];
+                if (e->hash)
+                {
+                    break;
+                }
+                e->hash = h;
+                e->key = pairs[placed].key;
+                e->str = pairs[placed].value;
+            }
+            if (placed == count)
+            {
+                t->seed = seed;
+                t->mask = size - 1;
+                t->count = count;
+                t->slots = slots;
+                for (uint32_t i = 0; i < size; i++)
+                {
+                    if (slots[i].hash)
+                    {
+                        parse_value(&slots[i]);
+                    }
+                }
+                return 0;
+            }
+            memset(slots, 0, size * sizeof(*slots));
+        }
+        sls_free(slots);
+    }
+}
+
+static void free_table(config_table_t *t)
+{
+    if (t)
+    {
+        sls_free(t->slots);
+        sls_free(t->strings);
+        sls_free(t);
+    }
+}
+
+/**
+ * @brief Parse an INI file into a new, unpublished table
+ */
+static config_table_t *compile_file(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (!f)
+    {
+        return NULL;
+    }
+
+    // Keys and values go into one growing buffer, referenced by offset
+    // until it stops moving
+    size_t cap = 4096, used = 0;
+    char *strings = sls_alloc(SLS_ALLOC_CORE, cap);
+    size_t offsets[MAX_KEYS][2];
+    uint32_t count = 0;
+    char section[SLS_CONFIG_MAX_KEY] = "";
+    char line[SLS_CONFIG_MAX_LINE];
+    int lineno = 0;
+
+    while (strings && fgets(line, sizeof(line), f))
+    {
+        lineno++;
+        char *s = trim(line);
+        if (*s == '\0' || *s == '#' || *s == ';')
+        {
+            continue;
+        }
+        if (*s == '[')
+        {
+            char *close = strchr(s, ']');
+            if (!close)
+            {
+                sls_log(LOG_LEVEL_WARNING, "CONFIG", "%s:%d: unterminated section", path, lineno);
+                continue;
+            }
+            *close = '\0';
+            sls_safe_strncpy(section, trim(s + 1), sizeof(section));
+            continue;
+        }
+        char *eq = strchr(s, '=');
+        if (!eq)
+        {
+            sls_log(LOG_LEVEL_WARNING, "CONFIG", "%s:%d: expected key = value", path, lineno);
+            continue;
+        }
+        *eq = '\0';
+        char *key = trim(s);
+        char *value = trim(eq + 1);
+
+        char full[SLS_CONFIG_MAX_KEY];
+        int klen = snprintf(full, sizeof(full), "%s%s%s", section, *section ? "." : "", key);
+        if (*key == '\0' || klen >= (int)sizeof(full))
+        {
+            sls_log(LOG_LEVEL_WARNING, "CONFIG", "%s:%d: bad key", path, lineno);
+            continue;
+        }
+
+        // A repeated key keeps the last value
+        uint32_t idx = count;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (strcmp(strings + offsets[i][0], full) == 0)
+            {
+                idx = i;
+                break;
+            }
+        }
+        if (idx == count && count == MAX_KEYS)
+        {
+            sls_log(LOG_LEVEL_WARNING, "CONFIG", "%s:%d: more than %d keys", path, lineno,
+                    MAX_KEYS);
+            continue;
+        }
+
+        size_t need = (size_t)klen + 1 + strlen(value) + 1;
+        if (used + need > cap)
+        {
+            while (used + need > cap)
+            {
+                cap *= 2;
+            }
+            char *grown = sls_realloc(SLS_ALLOC_CORE, strings, cap);
+            if (!grown)
+            {
+                sls_free(strings);
+                strings = NULL;
+                break;
+            }
+            strings = grown;
+        }
+        offsets[idx][0] = used;
+        memcpy(strings + used, full, (size_t)klen + 1);
+        used += (size_t)klen + 1;
+        offsets[idx][1] = used;
+        strcpy(strings + used, value);
+        used += strlen(value) + 1;
+        if (idx == count)
+        {
+            count++;
+        }
+    }
+    fclose(f);
+
+    config_table_t *t = sls_calloc(SLS_ALLOC_CORE, 1, sizeof(*t));
+    raw_pair_t *pairs = sls_calloc(SLS_ALLOC_CORE, count ? count : 1, sizeof(*pairs));
+    if (!strings || !t || !pairs)
+    {
+        sls_free(strings);
+        sls_free(t);
+        sls_free(pairs);
+        return NULL;
+    }
+    for (uint32_t i = 0; i < count; i++)
+    {
+        pairs[i].key = strings + offsets[i][0];
+        pairs[i].value = strings + offsets[i][1];
+    }
+    t->strings = strings;
+    int rc = place_keys(t, pairs, count);
+    sls_free(pairs);
+    if (rc != 0)
+    {
+        sls_free(t->strings);
+        sls_free(t);
+        return NULL;
+    }
+    return t;
+}
+
+static const config_entry_t *table_find(const config_table_t *t, const char *key)
+{
+    if (!t)
+    {
+        return NULL;
+    }
+    uint64_t h = config_hash(key, t->seed);
+    const config_entry_t *e = &t->slots[h & t->mask];
+    return e->hash == h && strcmp(e->key, key) == 0 ? e : NULL;
+}
+
+int sls_config_load(const char *path)
+{
+    pthread_mutex_lock(&g_load_lock);
+    config_table_t *t = compile_file(path);
+    if (!t)
+    {
+        pthread_mutex_unlock(&g_load_lock);
+        sls_log(LOG_LEVEL_WARNING, "CONFIG", "Cannot load %s: %s", path, strerror(errno));
+        return -1;
+    }
+    t->generation = g_next_generation++;
+    t->older = atomic_load_explicit(&g_table, memory_order_relaxed);
+    if (path != g_path)
+    {
+        sls_safe_strncpy(g_path, path, sizeof(g_path));
+    }
+    atomic_store_explicit(&g_table, t, memory_order_release);
+    pthread_mutex_unlock(&g_load_lock);
+
+    sls_log(LOG_LEVEL_INFO, "CONFIG", "Loaded %u keys from %s (generation %llu, seed %u)",
+            t->count, path, (unsigned long long)t->generation, t->seed);
+    return (int)t->count;
+}
+
+static uint64_t mono_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL;
+}
+
+static void *watch_thread(void *arg)
+{
+    (void)arg;
+    char path[PATH_MAX];
+    sls_safe_strncpy(path, g_path, sizeof(path));
+    const char *slash = strrchr(path, '/');
+    const char *base = slash ? slash + 1 : path;
+    uint64_t pending = 0; // when the last change was seen
+
+#ifdef __linux__
+    char dir[PATH_MAX];
+    if (slash)
+    {
+        snprintf(dir, sizeof(dir), "%.*s", (int)(slash - path), path);
+    }
+    else
+    {
+        strcpy(dir, ".");
+    }
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0 ||
+        inotify_add_watch(fd, *dir ? dir : "/", IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0)
+    {
+        sls_log(LOG_LEVEL_WARNING, "CONFIG", "inotify unavailable (%s), hot reload off",
+                strerror(errno));
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return NULL;
+    }
+
+    while (atomic_load(&g_watching))
+    {
+        struct pollfd pfd = {.fd = fd, .events = POLLIN};
+        int timeout = pending ? SLS_CONFIG_RELOAD_MS : WATCH_POLL_MS;
+        if (poll(&pfd, 1, timeout) > 0)
+        {
+            _Alignas(struct inotify_event) char buf[4096];
+            ssize_t n;
+            while ((n = read(fd, buf, sizeof(buf))) > 0)
+            {
+                for (char *p = buf; p < buf + n;)
+                {
+                    struct inotify_event *ev = (struct inotify_event *)p;
+                    if (ev->len && strcmp(ev->name, base) == 0)
+                    {
+                        pending = mono_ms();
+                    }
+                    p += sizeof(*ev) + ev->len;
+                }
+            }
+        }
+        // Let an editor finish writing before parsing
+        if (pending && mono_ms() - pending >= SLS_CONFIG_RELOAD_MS)
+        {
+            pending = 0;
+            sls_config_load(path);
+        }
+    }
+    close(fd);
+#else
+    (void)base;
+    struct stat st;
+    struct timespec last = {0};
+    if (stat(path, &st) == 0)
+    {
+        last = st.st_mtim;
+    }
+    while (atomic_load(&g_watching))
+    {
+        usleep((pending ? SLS_CONFIG_RELOAD_MS : WATCH_POLL_MS) * 1000);
+        if (stat(path, &st) == 0 &&
+            (st.st_mtim.tv_sec != last.tv_sec || st.st_mtim.tv_nsec != last.tv_nsec))
+        {
+            last = st.st_mtim;
+            pending = mono_ms();
+        }
+        if (pending && mono_ms() - pending >= SLS_CONFIG_RELOAD_MS)
+        {
+            pending = 0;
+            sls_config_load(path);
+        }
+    }
+#endif
+    return NULL;
+}
+
+int sls_config_watch_start(void)
+{
+    if (atomic_load(&g_watching))
+    {
+        return 0;
+    }
+    if (!atomic_load(&g_table))
+    {
+        return -1;
+    }
+    atomic_store(&g_watching, true);
+    if (pthread_create(&g_watch_thread, NULL, watch_thread, NULL) != 0)
+    {
+        atomic_store(&g_watching, false);
+        return -1;
+    }
+    return 0;
+}
+
+void sls_config_watch_stop(void)
+{
+    if (atomic_exchange(&g_watching, false))
+    {
+        pthread_join(g_watch_thread, NULL);
+    }
+}
+
+void sls_config_unload(void)
+{
+    sls_config_watch_stop();
+    pthread_mutex_lock(&g_load_lock);
+    config_table_t *t = atomic_exchange(&g_table, NULL);
+    while (t)
+    {
+        config_table_t *older = t->older;
+        free_table(t);
+        t = older;
+    }
+    pthread_mutex_unlock(&g_load_lock);
+}
+
+uint64_t sls_config_generation(void)
+{
+    config_table_t *t = atomic_load_explicit(&g_table, memory_order_acquire);
+    return t ? t->generation : 0;
+}
+
+int sls_config_has(const char *key)
+{
+    return table_find(atomic_load_explicit(&g_table, memory_order_acquire), key) != NULL;
+}
+
+void sls_config_handle_init(sls_config_handle_t *handle, const char *key)
+{
+    sls_safe_strncpy(handle->key, key, sizeof(handle->key));
+    handle->generation = 0;
+    handle->slot = -1;
+}
+
+/**
+ * @brief Entry behind a handle in the current table, or NULL
+ */
+static const config_entry_t *handle_entry(sls_config_handle_t *handle)
+{
+    const config_table_t *t = atomic_load_explicit(&g_table, memory_order_acquire);
+    if (!t)
+    {
+        return NULL;
+    }
+    if (handle->generation != t->generation)
+    {
+        const config_entry_t *e = table_find(t, handle->key);
+        handle->slot = e ? (int32_t)(e - t->slots) : -1;
+        handle->generation = t->generation;
+    }
+    return handle->slot >= 0 ? &t->slots[handle->slot] : NULL;
+}
+
+int sls_config_handle_int(sls_config_handle_t *handle, int default_value)
+{
+    const config_entry_t *e = handle_entry(handle);
+    return e && e->is_number ? (int)e->lng : default_value;
+}
+
+double sls_config_handle_double(sls_config_handle_t *handle, double default_value)
+{
+    const config_entry_t *e = handle_entry(handle);
+    return e && e->is_number ? e->dbl : default_value;
+}
+
+const char *sls_config_handle_string(sls_config_handle_t *handle, const char *default_value)
+{
+    const config_entry_t *e = handle_entry(handle);
+    return e ? e->str : default_value;
+}
+
+// sls_utils.h configuration API
+
+int sls_load_config_file(const char *filename)
+{
+    return sls_config_load(filename) < 0 ? -1 : 0;
+}
+
+int sls_get_config_int(const char *key, int default_value)
+{
+    const config_entry_t *e = table_find(atomic_load_explicit(&g_table, memory_order_acquire), key);
+    return e && e->is_number ? (int)e->lng : default_value;
+}
+
+double sls_get_config_double(const char *key, double default_value)
+{
+    const config_entry_t *e = table_find(atomic_load_explicit(&g_table, memory_order_acquire), key);
+    return e && e->is_number ? e->dbl : default_value;
+}
+
+const char *sls_get_config_string(const char *key, const char *default_value)
+{
+    const config_entry_t *e = table_find(atomic_load_explicit(&g_table, memory_order_acquire), key);
+    return e ? e->str : default_value;
+}
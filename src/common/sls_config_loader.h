@@ -0,0 +1,103 @@
+#ifndef SLS_CONFIG_LOADER_H
+#define SLS_CONFIG_LOADER_H
+
+/**
+ * @file sls_config_loader.h
+ * @brief INI configuration compiled into a perfect-hash table, with hot reload
+ *
+ * config/system.conf ("[section]" headers, "key = value" lines, '#' or ';'
+ * comments) is parsed into a read-only table addressed as "section.key".
+ * Every value is parsed once at load time into its string, integer and
+ * floating-point forms, and the keys are placed with a seeded FNV-1a hash
+ * whose seed is searched until no two keys share a slot, so a lookup is
+ * one hash and one slot.
+ *
+ * Hot paths resolve a key once into an sls_config_handle_t; reading through
+ * the handle is a pointer load and a generation compare, with no hashing or
+ * string compares. A reload builds a complete new table and publishes it
+ * with one atomic pointer store (RCU style): readers never lock and always
+ * see either the old table or the new one. Replaced tables are kept until
+ * sls_config_unload(), so strings returned by the getters stay valid.
+ *
+ * The sls_load_config_file()/sls_get_config_*() functions declared in
+ * sls_utils.h are implemented on top of this.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SLS_CONFIG_MAX_LINE 512
+#define SLS_CONFIG_MAX_KEY 96      // "section.key"
+#define SLS_CONFIG_RELOAD_MS 50    // settle time after a file change
+
+/**
+ * @brief Resolve-once reference to a configuration key
+ *
+ * Initialise with sls_config_handle_init(); not shared between threads.
+ */
+typedef struct
+{
+    char key[SLS_CONFIG_MAX_KEY];
+    uint64_t generation; // table the slot below belongs to
+    int32_t slot;        // -1 if the key is not in that table
+} sls_config_handle_t;
+
+/**
+ * @brief Parse a file and publish it as the current configuration
+ * @return Number of keys loaded, or -1 if the file cannot be read (the
+ *         current configuration is kept)
+ */
+int sls_config_load(const char *path);
+
+/**
+ * @brief Reload the last loaded file whenever it changes on disk
+ *
+ * Uses inotify on the file's directory on Linux (editors often replace the
+ * file rather than rewrite it) and polls the modification time elsewhere.
+ *
+ * @return 0 on success, -1 if nothing is loaded or the watcher cannot start
+ */
+int sls_config_watch_start(void);
+
+/**
+ * @brief Stop the reload watcher
+ */
+void sls_config_watch_stop(void);
+
+/**
+ * @brief Stop watching and free every table
+ */
+void sls_config_unload(void);
+
+/**
+ * @brief Generation of the current table; changes on every (re)load, 0 if none
+ */
+uint64_t sls_config_generation(void);
+
+/**
+ * @brief Whether the current configuration has a key
+ */
+int sls_config_has(const char *key);
+
+/**
+ * @brief Prepare a handle for "section.key"
+ */
+void sls_config_handle_init(sls_config_handle_t *handle, const char *key);
+
+/**
+ * @brief Read through a handle, re-resolving only after a reload
+ *
+ * Booleans (true/false, yes/no, on/off) read as 1/0 through the int getter.
+ */
+int sls_config_handle_int(sls_config_handle_t *handle, int default_value);
+double sls_config_handle_double(sls_config_handle_t *handle, double default_value);
+const char *sls_config_handle_string(sls_config_handle_t *handle, const char *default_value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SLS_CONFIG_LOADER_H
@@ -6,11 +6,16 @@
 #include "qnx_mock.h" // Must be first for QNX compatibility
 #include "sls_ipc.h"
 #include "sls_logging.h"
+#include "sls_metrics.h"
+#include "sls_trace.h"
 #include "sls_utils.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <unistd.h>
 
 #ifndef MOCK_QNX_BUILD
@@ -40,11 +45,31 @@ static int g_num_channels = 0;
 static message_handler_t g_message_handlers[16];
 static int g_num_handlers = 0;
 
+// Messages created, by message_type_t
+#define NUM_MSG_TYPES (MSG_LOG + 1)
+static sls_metric_t *g_msg_counters[NUM_MSG_TYPES];
+static sls_metric_t *g_telemetry_points;
+
+// Largest payload sent through sls_ipc
+typedef union
+{
+    telemetry_point_t telemetry;
+    command_t command;
+    status_message_t status;
+    sls_time_ns_t heartbeat;
+} ipc_payload_t;
+
+// Messages are built in a per-thread buffer instead of the heap; a message
+// is only valid until the same thread builds the next one
+static _Thread_local _Alignas(max_align_t) unsigned char
+    tls_msg_buf[sizeof(ipc_message_t) + sizeof(ipc_payload_t)];
+
 // Internal function declarations
 static int find_channel_by_name(const char *name);
-static int create_ipc_message(message_type_t type, subsystem_type_t source,
-                              subsystem_type_t dest, const void *data,
-                              size_t data_size, ipc_message_t **msg);
+static ipc_message_t *create_ipc_message(message_type_t type, subsystem_type_t source,
+                                         subsystem_type_t dest, const void *data,
+                                         size_t data_size);
+static double channel_queue_depth(void *arg);
 
 /**
  * @brief Initialize IPC subsystem
@@ -64,6 +89,17 @@ int sls_ipc_init(void)
     memset(g_message_handlers, 0, sizeof(g_message_handlers));
     g_num_handlers = 0;
 
+    static const char *const type_labels[NUM_MSG_TYPES] = {
+        "type=\"telemetry\"", "type=\"command\"",   "type=\"status\"",
+        "type=\"alarm\"",     "type=\"heartbeat\"", "type=\"log\""};
+    for (int i = 0; i < NUM_MSG_TYPES; i++)
+    {
+        g_msg_counters[i] = sls_metrics_counter("sls_ipc_messages_total", type_labels[i],
+                                                "IPC messages sent, by type");
+    }
+    g_telemetry_points = sls_metrics_counter("sls_ipc_telemetry_points_total", NULL,
+                                             "Telemetry points broadcast");
+
     sls_log(LOG_LEVEL_INFO, "IPC", "IPC subsystem initialized");
     g_ipc_initialized = true;
     return 0;
@@ -132,6 +168,11 @@ int sls_ipc_create_channel(const char *channel_name)
 
     g_num_channels++;
 
+    char labels[MAX_NAME_LENGTH + 16];
+    snprintf(labels, sizeof(labels), "channel=\"%s\"", channel->name);
+    sls_metrics_callback("sls_ipc_queue_depth", labels, "Messages waiting on an IPC channel",
+                         SLS_METRIC_GAUGE, channel_queue_depth, (void *)(intptr_t)chid);
+
     sls_log(LOG_LEVEL_INFO, "IPC", "Created channel: %s (chid=%d)", channel_name, chid);
     return chid;
 }
@@ -186,19 +227,16 @@ int sls_ipc_send_telemetry(subsystem_type_t dest, const telemetry_point_t *data)
         return -1;
     }
 
-    ipc_message_t *msg;
-    int result = create_ipc_message(MSG_TELEMETRY, SUBSYS_TELEMETRY, dest,
-                                    data, sizeof(telemetry_point_t), &msg);
-    if (result != 0)
+    if (!create_ipc_message(MSG_TELEMETRY, SUBSYS_TELEMETRY, dest,
+                            data, sizeof(telemetry_point_t)))
     {
-        return result;
+        return -1;
     }
 
     // For simulation, we'll just log the telemetry
     sls_log(LOG_LEVEL_DEBUG, "IPC", "Telemetry: %s = %.2f %s",
             data->name, data->value, data->units);
 
-    free(msg);
     return 0;
 }
 
@@ -212,18 +250,15 @@ int sls_ipc_send_command(subsystem_type_t dest, const command_t *cmd)
         return -1;
     }
 
-    ipc_message_t *msg;
-    int result = create_ipc_message(MSG_COMMAND, SUBSYS_GROUND_SUPPORT, dest,
-                                    cmd, sizeof(command_t), &msg);
-    if (result != 0)
+    if (!create_ipc_message(MSG_COMMAND, SUBSYS_GROUND_SUPPORT, dest,
+                            cmd, sizeof(command_t)))
     {
-        return result;
+        return -1;
     }
 
     sls_log(LOG_LEVEL_INFO, "IPC", "Command sent to %s: %s",
             sls_subsystem_type_to_string(dest), cmd->command);
 
-    free(msg);
     return 0;
 }
 
@@ -237,18 +272,15 @@ int sls_ipc_send_status(subsystem_type_t dest, const status_message_t *status)
         return -1;
     }
 
-    ipc_message_t *msg;
-    int result = create_ipc_message(MSG_STATUS, status->source, dest,
-                                    status, sizeof(status_message_t), &msg);
-    if (result != 0)
+    if (!create_ipc_message(MSG_STATUS, status->source, dest,
+                            status, sizeof(status_message_t)))
     {
-        return result;
+        return -1;
     }
 
     sls_log(LOG_LEVEL_INFO, "IPC", "Status from %s: %s",
             sls_subsystem_type_to_string(status->source), status->message);
 
-    free(msg);
     return 0;
 }
 
@@ -257,21 +289,17 @@ int sls_ipc_send_status(subsystem_type_t dest, const status_message_t *status)
  */
 int sls_ipc_send_heartbeat(subsystem_type_t source)
 {
-    struct timespec timestamp;
-    clock_gettime(CLOCK_REALTIME, &timestamp);
+    sls_time_ns_t timestamp = sls_time_realtime_ns();
 
-    ipc_message_t *msg;
-    int result = create_ipc_message(MSG_HEARTBEAT, source, SUBSYS_FLIGHT_CONTROL,
-                                    &timestamp, sizeof(timestamp), &msg);
-    if (result != 0)
+    if (!create_ipc_message(MSG_HEARTBEAT, source, SUBSYS_FLIGHT_CONTROL,
+                            &timestamp, sizeof(timestamp)))
     {
-        return result;
+        return -1;
     }
 
     sls_log(LOG_LEVEL_DEBUG, "IPC", "Heartbeat from %s",
             sls_subsystem_type_to_string(source));
 
-    free(msg);
     return 0;
 }
 
@@ -306,11 +334,18 @@ int sls_ipc_reply_message(int rcvid, int reply_code, const void *reply_data, siz
  */
 int sls_ipc_broadcast_telemetry(const telemetry_point_t *data)
 {
+    SLS_TRACE_SCOPE("sls_ipc_broadcast_telemetry");
+
     if (!data)
     {
         return -1;
     }
 
+    if (g_telemetry_points)
+    {
+        sls_metric_inc(g_telemetry_points);
+    }
+
     // Broadcast to key subsystems that need telemetry
     subsystem_type_t targets[] = {
         SUBSYS_FLIGHT_CONTROL,
@@ -377,7 +412,7 @@ int sls_ipc_broadcast_emergency(const char *emergency_msg)
 
     sls_safe_strncpy(emergency_status.message, emergency_msg,
                      sizeof(emergency_status.message));
-    clock_gettime(CLOCK_REALTIME, &emergency_status.timestamp);
+    emergency_status.timestamp_ns = sls_time_realtime_ns();
 
     sls_log(LOG_LEVEL_CRITICAL, "IPC", "EMERGENCY BROADCAST: %s", emergency_msg);
 
@@ -431,35 +466,56 @@ static int find_channel_by_name(const char *name)
 }
 
 /**
- * @brief Create IPC message structure
+ * @brief Build an IPC message in the calling thread's message buffer
  */
-static int create_ipc_message(message_type_t type, subsystem_type_t source,
-                              subsystem_type_t dest, const void *data,
-                              size_t data_size, ipc_message_t **msg)
+static ipc_message_t *create_ipc_message(message_type_t type, subsystem_type_t source,
+                                         subsystem_type_t dest, const void *data,
+                                         size_t data_size)
 {
-    if (!data || !msg)
+    if (!data || data_size > sizeof(ipc_payload_t))
     {
-        return -1;
+        return NULL;
     }
 
-    size_t total_size = sizeof(ipc_message_t) + data_size;
-    *msg = (ipc_message_t *)malloc(total_size);
-    if (!*msg)
+    ipc_message_t *msg = (ipc_message_t *)tls_msg_buf;
+    msg->type = type;
+    msg->source = source;
+    msg->destination = dest;
+    msg->sequence_number = 0; // Would be incremented in real implementation
+    msg->data_length = data_size;
+    msg->timestamp_ns = sls_time_realtime_ns();
+
+    memcpy(msg->data, data, data_size);
+
+    if ((unsigned)type < NUM_MSG_TYPES && g_msg_counters[type])
     {
-        sls_log(LOG_LEVEL_ERROR, "IPC", "Failed to allocate message memory");
-        return -1;
+        sls_metric_inc(g_msg_counters[type]);
     }
+    return msg;
+}
 
-    (*msg)->type = type;
-    (*msg)->source = source;
-    (*msg)->destination = dest;
-    (*msg)->sequence_number = 0; // Would be incremented in real implementation
-    (*msg)->data_length = data_size;
-    clock_gettime(CLOCK_REALTIME, &(*msg)->timestamp);
-
-    memcpy((*msg)->data, data, data_size);
+/**
+ * @brief Messages waiting on a channel
+ */
+int sls_ipc_get_queue_depth(int chid)
+{
+#ifdef MOCK_QNX_BUILD
+    return qnx_mock_channel_pending(chid);
+#else
+    // Neutrino keeps no count of a channel's send-blocked clients
+    (void)chid;
+    errno = ENOSYS;
+    return -1;
+#endif
+}
 
-    return 0;
+/**
+ * @brief sls_ipc_queue_depth gauge; closed channels drop out of the scrape
+ */
+static double channel_queue_depth(void *arg)
+{
+    int depth = sls_ipc_get_queue_depth((int)(intptr_t)arg);
+    return depth < 0 ? NAN : (double)depth;
 }
 
 /**
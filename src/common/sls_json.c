@@ -0,0 +1,837 @@
+/**
+ * @file sls_json.c
+ * @brief Implementation of the zero-allocation JSON tokenizer and writer
+ */
+
+#include "sls_json.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static inline bool is_whitespace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static inline bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// Internal helpers
+static sls_json_token_type_t reader_fail(sls_json_reader_t *reader, sls_json_token_t *token);
+static int scan_string(const char **cursor, const char *end, sls_json_token_t *token);
+static int scan_number(const char **cursor, const char *end);
+static int scan_literal(const char **cursor, const char *end, const char *literal, size_t length);
+static int hex_value(char c);
+static void writer_append(sls_json_writer_t *writer, const char *data, size_t length);
+static void writer_separator(sls_json_writer_t *writer);
+
+/**
+ * @brief Initialize a reader over a buffer (need not be NUL terminated)
+ */
+void sls_json_reader_init(sls_json_reader_t *reader, const char *buf, size_t length)
+{
+    memset(reader, 0, sizeof(*reader));
+    reader->cur = buf;
+    reader->end = buf + length;
+}
+
+/**
+ * @brief Return the next token, validating structure as it goes
+ *
+ * Works on a local cursor and writes the reader state back once per token;
+ * this is the per-command hot path of the command server.
+ */
+sls_json_token_type_t sls_json_next(sls_json_reader_t *reader, sls_json_token_t *token)
+{
+    if (reader->failed)
+    {
+        token->type = SLS_JSON_ERROR;
+        return SLS_JSON_ERROR;
+    }
+
+    const char *p = reader->cur;
+    const char *end = reader->end;
+    int depth = reader->depth;
+    bool in_object = depth > 0 && !(reader->array_mask & (1u << (depth - 1)));
+
+    while (p < end && is_whitespace(*p))
+    {
+        p++;
+    }
+
+    if (p >= end)
+    {
+        reader->cur = p;
+        if (depth != 0)
+        {
+            return reader_fail(reader, token);
+        }
+        token->type = SLS_JSON_END;
+        token->start = p;
+        token->length = 0;
+        return SLS_JSON_END;
+    }
+
+    char c = *p;
+
+    // Container close
+    if (c == '}' || c == ']')
+    {
+        if (depth == 0 || (c == '}') != in_object ||
+            (in_object && !reader->expect_key && !reader->need_separator))
+        {
+            return reader_fail(reader, token); // Mismatch or key without value
+        }
+        token->type = (c == '}') ? SLS_JSON_OBJECT_END : SLS_JSON_ARRAY_END;
+        token->start = p;
+        token->length = 1;
+        token->escaped = false;
+        reader->cur = p + 1;
+        reader->depth = depth - 1;
+        reader->need_separator = true;
+        reader->expect_key = false;
+        return token->type;
+    }
+
+    // Element separator
+    if (reader->need_separator)
+    {
+        if (depth == 0 || c != ',')
+        {
+            return reader_fail(reader, token);
+        }
+        p++;
+        while (p < end && is_whitespace(*p))
+        {
+            p++;
+        }
+        if (p >= end || *p == '}' || *p == ']')
+        {
+            return reader_fail(reader, token); // Trailing comma
+        }
+        c = *p;
+        reader->need_separator = false;
+        reader->expect_key = in_object;
+    }
+
+    // Object key
+    if (in_object && reader->expect_key)
+    {
+        if (c != '"' || scan_string(&p, end, token) != 0)
+        {
+            return reader_fail(reader, token);
+        }
+        while (p < end && is_whitespace(*p))
+        {
+            p++;
+        }
+        if (p >= end || *p != ':')
+        {
+            return reader_fail(reader, token);
+        }
+        reader->cur = p + 1;
+        reader->expect_key = false;
+        token->type = SLS_JSON_KEY;
+        return SLS_JSON_KEY;
+    }
+
+    // Value
+    token->escaped = false;
+    token->start = p;
+    switch (c)
+    {
+    case '{':
+    case '[':
+        if (depth >= SLS_JSON_MAX_DEPTH)
+        {
+            return reader_fail(reader, token);
+        }
+        if (c == '[')
+        {
+            reader->array_mask |= (1u << depth);
+        }
+        else
+        {
+            reader->array_mask &= ~(1u << depth);
+        }
+        token->type = (c == '{') ? SLS_JSON_OBJECT_BEGIN : SLS_JSON_ARRAY_BEGIN;
+        token->length = 1;
+        reader->cur = p + 1;
+        reader->depth = depth + 1;
+        reader->expect_key = (c == '{');
+        reader->need_separator = false;
+        return token->type;
+
+    case '"':
+        if (scan_string(&p, end, token) != 0)
+        {
+            return reader_fail(reader, token);
+        }
+        token->type = SLS_JSON_STRING;
+        break;
+
+    case 't':
+        if (scan_literal(&p, end, "true", 4) != 0)
+        {
+            return reader_fail(reader, token);
+        }
+        token->type = SLS_JSON_TRUE;
+        break;
+
+    case 'f':
+        if (scan_literal(&p, end, "false", 5) != 0)
+        {
+            return reader_fail(reader, token);
+        }
+        token->type = SLS_JSON_FALSE;
+        break;
+
+    case 'n':
+        if (scan_literal(&p, end, "null", 4) != 0)
+        {
+            return reader_fail(reader, token);
+        }
+        token->type = SLS_JSON_NULL;
+        break;
+
+    default:
+        if (scan_number(&p, end) != 0)
+        {
+            return reader_fail(reader, token);
+        }
+        token->type = SLS_JSON_NUMBER;
+        break;
+    }
+
+    if (token->type != SLS_JSON_STRING)
+    {
+        token->length = (size_t)(p - token->start);
+    }
+    reader->cur = p;
+    reader->need_separator = true;
+    return token->type;
+}
+
+/**
+ * @brief Skip the remainder of a value whose first token has been read
+ *
+ * Scalars are already complete; containers are consumed up to and
+ * including their matching close token.
+ */
+int sls_json_skip_value(sls_json_reader_t *reader, const sls_json_token_t *token)
+{
+    if (token->type != SLS_JSON_OBJECT_BEGIN && token->type != SLS_JSON_ARRAY_BEGIN)
+    {
+        return token->type == SLS_JSON_ERROR ? -1 : 0;
+    }
+
+    int target_depth = reader->depth - 1;
+    sls_json_token_t inner;
+    while (reader->depth > target_depth)
+    {
+        sls_json_token_type_t type = sls_json_next(reader, &inner);
+        if (type == SLS_JSON_ERROR || type == SLS_JSON_END)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Compare a string/key token with a NUL terminated literal
+ */
+bool sls_json_token_equals(const sls_json_token_t *token, const char *literal)
+{
+    if (!token->escaped)
+    {
+        size_t length = strlen(literal);
+        return token->length == length && memcmp(token->start, literal, length) == 0;
+    }
+
+    char decoded[128];
+    size_t length = sls_json_token_copy_string(token, decoded, sizeof(decoded));
+    if (length >= sizeof(decoded) - 1)
+    {
+        return false;
+    }
+    return strcmp(decoded, literal) == 0;
+}
+
+/**
+ * @brief Convert a number token to a long (fractions are truncated)
+ */
+int sls_json_token_to_long(const sls_json_token_t *token, long *value)
+{
+    if (token->type != SLS_JSON_NUMBER || token->length == 0)
+    {
+        return -1;
+    }
+
+    const char *p = token->start;
+    const char *end = token->start + token->length;
+    bool negative = (*p == '-');
+    if (negative)
+    {
+        p++;
+    }
+
+    // Up to 18 decimal digits cannot overflow a 64-bit long, so the common
+    // case needs no per-digit overflow check (and no division)
+    long result = 0;
+    bool check_overflow = (end - p) > 18;
+    for (; p < end; p++)
+    {
+        if (*p < '0' || *p > '9')
+        {
+            // Fraction or exponent: fall back to the floating-point path
+            double d;
+            if (sls_json_token_to_double(token, &d) != 0 || d > (double)LONG_MAX ||
+                d < (double)LONG_MIN)
+            {
+                return -1;
+            }
+            *value = (long)d;
+            return 0;
+        }
+        if (check_overflow && result > (LONG_MAX - (*p - '0')) / 10)
+        {
+            return -1;
+        }
+        result = result * 10 + (*p - '0');
+    }
+
+    *value = negative ? -result : result;
+    return 0;
+}
+
+/**
+ * @brief Convert a number token to a double
+ */
+int sls_json_token_to_double(const sls_json_token_t *token, double *value)
+{
+    char tmp[64];
+    if (token->type != SLS_JSON_NUMBER || token->length >= sizeof(tmp))
+    {
+        return -1;
+    }
+
+    memcpy(tmp, token->start, token->length);
+    tmp[token->length] = '\0';
+
+    char *endptr = NULL;
+    *value = strtod(tmp, &endptr);
+    return (endptr == tmp + token->length) ? 0 : -1;
+}
+
+/**
+ * @brief Copy a string token into dest, decoding escapes
+ *
+ * Returns the decoded length (truncated to dest_size - 1).
+ */
+size_t sls_json_token_copy_string(const sls_json_token_t *token, char *dest, size_t dest_size)
+{
+    if (dest_size == 0)
+    {
+        return 0;
+    }
+
+    size_t out = 0;
+    const char *p = token->start;
+    const char *end = token->start + token->length;
+
+    while (p < end && out < dest_size - 1)
+    {
+        char c = *p++;
+        if (c != '\\' || p >= end)
+        {
+            dest[out++] = c;
+            continue;
+        }
+
+        c = *p++;
+        switch (c)
+        {
+        case 'b':
+            dest[out++] = '\b';
+            break;
+        case 'f':
+            dest[out++] = '\f';
+            break;
+        case 'n':
+            dest[out++] = '\n';
+            break;
+        case 'r':
+            dest[out++] = '\r';
+            break;
+        case 't':
+            dest[out++] = '\t';
+            break;
+        case 'u':
+        {
+            unsigned cp = 0;
+            for (int i = 0; i < 4 && p < end; i++)
+            {
+                cp = (cp << 4) | (unsigned)hex_value(*p++);
+            }
+            // Encode BMP code points as UTF-8; surrogates are not paired
+            if (cp < 0x80)
+            {
+                dest[out++] = (char)cp;
+            }
+            else if (cp < 0x800 && out + 2 < dest_size)
+            {
+                dest[out++] = (char)(0xC0 | (cp >> 6));
+                dest[out++] = (char)(0x80 | (cp & 0x3F));
+            }
+            else if (out + 3 < dest_size)
+            {
+                dest[out++] = (char)(0xE0 | (cp >> 12));
+                dest[out++] = (char)(0x80 | ((cp >> 6) & 0x3F));
+                dest[out++] = (char)(0x80 | (cp & 0x3F));
+            }
+            else
+            {
+                p = end;
+            }
+            break;
+        }
+        default: // '"', '\\', '/'
+            dest[out++] = c;
+            break;
+        }
+    }
+
+    dest[out] = '\0';
+    return out;
+}
+
+/**
+ * @brief Initialize a writer over a caller-owned buffer
+ */
+void sls_json_writer_init(sls_json_writer_t *writer, char *buf, size_t capacity)
+{
+    memset(writer, 0, sizeof(*writer));
+    writer->buf = buf;
+    writer->capacity = capacity;
+    writer->first_mask = 1u;
+    if (capacity > 0)
+    {
+        buf[0] = '\0';
+    }
+}
+
+void sls_json_begin_object(sls_json_writer_t *writer)
+{
+    writer_separator(writer);
+    writer_append(writer, "{", 1);
+    if (writer->depth < SLS_JSON_MAX_DEPTH)
+    {
+        writer->depth++;
+        writer->first_mask |= (1u << writer->depth);
+    }
+    else
+    {
+        writer->overflow = true;
+    }
+}
+
+void sls_json_end_object(sls_json_writer_t *writer)
+{
+    writer_append(writer, "}", 1);
+    if (writer->depth > 0)
+    {
+        writer->depth--;
+    }
+}
+
+void sls_json_begin_array(sls_json_writer_t *writer)
+{
+    writer_separator(writer);
+    writer_append(writer, "[", 1);
+    if (writer->depth < SLS_JSON_MAX_DEPTH)
+    {
+        writer->depth++;
+        writer->first_mask |= (1u << writer->depth);
+    }
+    else
+    {
+        writer->overflow = true;
+    }
+}
+
+void sls_json_end_array(sls_json_writer_t *writer)
+{
+    writer_append(writer, "]", 1);
+    if (writer->depth > 0)
+    {
+        writer->depth--;
+    }
+}
+
+/**
+ * @brief Write an object key
+ *
+ * Keys are identifiers chosen by the caller, so they are emitted without
+ * escaping in a single append.
+ */
+void sls_json_write_key(sls_json_writer_t *writer, const char *key)
+{
+    char tmp[64];
+    size_t length = strlen(key);
+    if (length + 3 > sizeof(tmp))
+    {
+        sls_json_write_string(writer, key);
+        writer_append(writer, ":", 1);
+        writer->after_key = true;
+        return;
+    }
+
+    tmp[0] = '"';
+    memcpy(tmp + 1, key, length);
+    tmp[length + 1] = '"';
+    tmp[length + 2] = ':';
+
+    writer_separator(writer);
+    writer_append(writer, tmp, length + 3);
+    writer->after_key = true;
+}
+
+/**
+ * @brief Write a quoted string, escaping quotes and control characters
+ */
+void sls_json_write_string(sls_json_writer_t *writer, const char *value)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    writer_separator(writer);
+    writer_append(writer, "\"", 1);
+
+    // Fast path: nothing to escape
+    const char *p = value;
+    while ((unsigned char)*p >= 0x20 && *p != '"' && *p != '\\')
+    {
+        p++;
+    }
+    if (*p == '\0')
+    {
+        writer_append(writer, value, (size_t)(p - value));
+        writer_append(writer, "\"", 1);
+        return;
+    }
+
+    const char *run = value;
+    for (p = value; *p; p++)
+    {
+        unsigned char c = (unsigned char)*p;
+        if (c >= 0x20 && c != '"' && c != '\\')
+        {
+            continue;
+        }
+
+        writer_append(writer, run, (size_t)(p - run));
+        run = p + 1;
+
+        char esc[6] = {'\\', 0, 0, 0, 0, 0};
+        size_t esc_len = 2;
+        switch (c)
+        {
+        case '"':
+            esc[1] = '"';
+            break;
+        case '\\':
+            esc[1] = '\\';
+            break;
+        case '\n':
+            esc[1] = 'n';
+            break;
+        case '\r':
+            esc[1] = 'r';
+            break;
+        case '\t':
+            esc[1] = 't';
+            break;
+        default:
+            esc[1] = 'u';
+            esc[2] = '0';
+            esc[3] = '0';
+            esc[4] = hex[c >> 4];
+            esc[5] = hex[c & 0x0F];
+            esc_len = 6;
+            break;
+        }
+        writer_append(writer, esc, esc_len);
+    }
+    writer_append(writer, run, strlen(run));
+    writer_append(writer, "\"", 1);
+}
+
+void sls_json_write_int(sls_json_writer_t *writer, long value)
+{
+    if (value < 0)
+    {
+        writer_separator(writer);
+        writer_append(writer, "-", 1);
+        writer->after_key = true; // Suppress the separator for the digits
+        sls_json_write_uint(writer, (uint64_t)0 - (uint64_t)value);
+        return;
+    }
+    sls_json_write_uint(writer, (uint64_t)value);
+}
+
+void sls_json_write_uint(sls_json_writer_t *writer, uint64_t value)
+{
+    char digits[20];
+    size_t n = sizeof(digits);
+    do
+    {
+        digits[--n] = (char)('0' + (value % 10));
+        value /= 10;
+    } while (value != 0);
+
+    writer_separator(writer);
+    writer_append(writer, digits + n, sizeof(digits) - n);
+}
+
+void sls_json_write_double(sls_json_writer_t *writer, double value, int decimals)
+{
+    char tmp[48];
+    int n = snprintf(tmp, sizeof(tmp), "%.*f", decimals, value);
+    if (n < 0 || (size_t)n >= sizeof(tmp) || !(value == value) ||
+        value > 1e300 || value < -1e300)
+    {
+        // NaN/Inf are not representable in JSON
+        writer_separator(writer);
+        writer_append(writer, "null", 4);
+        return;
+    }
+    writer_separator(writer);
+    writer_append(writer, tmp, (size_t)n);
+}
+
+void sls_json_write_bool(sls_json_writer_t *writer, bool value)
+{
+    writer_separator(writer);
+    if (value)
+    {
+        writer_append(writer, "true", 4);
+    }
+    else
+    {
+        writer_append(writer, "false", 5);
+    }
+}
+
+/**
+ * @brief Terminate the document with a newline
+ *
+ * Returns the line length including the newline, or -1 if the buffer
+ * overflowed at any point.
+ */
+int sls_json_writer_finish_line(sls_json_writer_t *writer)
+{
+    writer_append(writer, "\n", 1);
+    if (writer->capacity > 0)
+    {
+        writer->buf[writer->length] = '\0';
+    }
+    if (writer->overflow)
+    {
+        return -1;
+    }
+    return (int)writer->length;
+}
+
+static sls_json_token_type_t reader_fail(sls_json_reader_t *reader, sls_json_token_t *token)
+{
+    reader->failed = true;
+    token->type = SLS_JSON_ERROR;
+    return SLS_JSON_ERROR;
+}
+
+static int scan_string(const char **cursor, const char *end, sls_json_token_t *token)
+{
+    const char *p = *cursor + 1; // Skip opening quote
+    token->start = p;
+    token->escaped = false;
+
+    while (p < end)
+    {
+        unsigned char c = (unsigned char)*p;
+        if (c == '"')
+        {
+            token->length = (size_t)(p - token->start);
+            *cursor = p + 1;
+            return 0;
+        }
+        if (c < 0x20)
+        {
+            return -1;
+        }
+        if (c == '\\')
+        {
+            token->escaped = true;
+            if (++p >= end)
+            {
+                return -1;
+            }
+            switch (*p)
+            {
+            case '"':
+            case '\\':
+            case '/':
+            case 'b':
+            case 'f':
+            case 'n':
+            case 'r':
+            case 't':
+                break;
+            case 'u':
+                if (end - p < 5)
+                {
+                    return -1;
+                }
+                for (int i = 1; i <= 4; i++)
+                {
+                    if (hex_value(p[i]) < 0)
+                    {
+                        return -1;
+                    }
+                }
+                p += 4;
+                break;
+            default:
+                return -1;
+            }
+        }
+        p++;
+    }
+    return -1; // Unterminated
+}
+
+static int scan_number(const char **cursor, const char *end)
+{
+    const char *p = *cursor;
+
+    if (p < end && *p == '-')
+    {
+        p++;
+    }
+    if (p >= end || !is_digit(*p))
+    {
+        return -1;
+    }
+    if (*p == '0')
+    {
+        p++;
+    }
+    else
+    {
+        while (p < end && is_digit(*p))
+        {
+            p++;
+        }
+    }
+    if (p < end && *p == '.')
+    {
+        p++;
+        if (p >= end || !is_digit(*p))
+        {
+            return -1;
+        }
+        while (p < end && is_digit(*p))
+        {
+            p++;
+        }
+    }
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        p++;
+        if (p < end && (*p == '+' || *p == '-'))
+        {
+            p++;
+        }
+        if (p >= end || !is_digit(*p))
+        {
+            return -1;
+        }
+        while (p < end && is_digit(*p))
+        {
+            p++;
+        }
+    }
+
+    *cursor = p;
+    return 0;
+}
+
+static int scan_literal(const char **cursor, const char *end, const char *literal, size_t length)
+{
+    if ((size_t)(end - *cursor) < length || memcmp(*cursor, literal, length) != 0)
+    {
+        return -1;
+    }
+    *cursor += length;
+    return 0;
+}
+
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+static void writer_append(sls_json_writer_t *writer, const char *data, size_t length)
+{
+    if (writer->overflow)
+    {
+        return;
+    }
+    if (writer->length + length + 1 > writer->capacity)
+    {
+        writer->overflow = true;
+        return;
+    }
+    // Replies are built from many short fragments; copying those inline is
+    // cheaper than a memcpy call each
+    char *dst = writer->buf + writer->length;
+    if (length <= 16)
+    {
+        for (size_t i = 0; i < length; i++)
+        {
+            dst[i] = data[i];
+        }
+    }
+    else
+    {
+        memcpy(dst, data, length);
+    }
+    writer->length += length;
+}
+
+static void writer_separator(sls_json_writer_t *writer)
+{
+    if (writer->after_key)
+    {
+        writer->after_key = false;
+        return;
+    }
+    uint32_t bit = 1u << writer->depth;
+    if (writer->first_mask & bit)
+    {
+        writer->first_mask &= ~bit;
+        return;
+    }
+    if (writer->depth > 0)
+    {
+        writer_append(writer, ",", 1);
+    }
+}
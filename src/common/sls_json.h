@@ -0,0 +1,96 @@
+#ifndef SLS_JSON_H
+#define SLS_JSON_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file sls_json.h
+ * @brief Zero-allocation streaming JSON tokenizer and writer
+ *
+ * The reader walks a caller-owned buffer one token at a time; tokens point
+ * back into that buffer, so nothing is copied or allocated while parsing.
+ * The writer appends into a caller-owned buffer and tracks comma placement
+ * and overflow itself. Both are sized for the small line-oriented messages
+ * exchanged with GUI clients, not for general-purpose documents.
+ */
+
+#define SLS_JSON_MAX_DEPTH 16
+
+// Token types returned by sls_json_next()
+typedef enum
+{
+    SLS_JSON_END = 0,
+    SLS_JSON_OBJECT_BEGIN,
+    SLS_JSON_OBJECT_END,
+    SLS_JSON_ARRAY_BEGIN,
+    SLS_JSON_ARRAY_END,
+    SLS_JSON_KEY,
+    SLS_JSON_STRING,
+    SLS_JSON_NUMBER,
+    SLS_JSON_TRUE,
+    SLS_JSON_FALSE,
+    SLS_JSON_NULL,
+    SLS_JSON_ERROR
+} sls_json_token_type_t;
+
+// Token view into the source buffer (strings exclude the quotes)
+typedef struct
+{
+    sls_json_token_type_t type;
+    const char *start;
+    size_t length;
+    bool escaped; // String contains backslash escapes
+} sls_json_token_t;
+
+// Tokenizer state
+typedef struct
+{
+    const char *cur;
+    const char *end;
+    int depth;
+    uint32_t array_mask; // Bit per depth level: 1 = array, 0 = object
+    bool expect_key;     // Next string inside an object is a key
+    bool need_separator; // A value was completed at this level
+    bool failed;
+} sls_json_reader_t;
+
+// Writer state
+typedef struct
+{
+    char *buf;
+    size_t capacity;
+    size_t length;
+    int depth;
+    uint32_t first_mask; // Bit per depth level: 1 = no element written yet
+    bool after_key;
+    bool overflow;
+} sls_json_writer_t;
+
+// Reader
+void sls_json_reader_init(sls_json_reader_t *reader, const char *buf, size_t length);
+sls_json_token_type_t sls_json_next(sls_json_reader_t *reader, sls_json_token_t *token);
+int sls_json_skip_value(sls_json_reader_t *reader, const sls_json_token_t *token);
+
+// Token helpers
+bool sls_json_token_equals(const sls_json_token_t *token, const char *literal);
+int sls_json_token_to_long(const sls_json_token_t *token, long *value);
+int sls_json_token_to_double(const sls_json_token_t *token, double *value);
+size_t sls_json_token_copy_string(const sls_json_token_t *token, char *dest, size_t dest_size);
+
+// Writer
+void sls_json_writer_init(sls_json_writer_t *writer, char *buf, size_t capacity);
+void sls_json_begin_object(sls_json_writer_t *writer);
+void sls_json_end_object(sls_json_writer_t *writer);
+void sls_json_begin_array(sls_json_writer_t *writer);
+void sls_json_end_array(sls_json_writer_t *writer);
+void sls_json_write_key(sls_json_writer_t *writer, const char *key);
+void sls_json_write_string(sls_json_writer_t *writer, const char *value);
+void sls_json_write_int(sls_json_writer_t *writer, long value);
+void sls_json_write_uint(sls_json_writer_t *writer, uint64_t value);
+void sls_json_write_double(sls_json_writer_t *writer, double value, int decimals);
+void sls_json_write_bool(sls_json_writer_t *writer, bool value);
+int sls_json_writer_finish_line(sls_json_writer_t *writer);
+
+#endif // SLS_JSON_H
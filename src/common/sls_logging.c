@@ -4,6 +4,9 @@
  */
 
 #include "sls_logging.h"
+#include "sls_metrics.h"
+#include "sls_time.h"
+#include "sls_trace.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -34,6 +37,10 @@ static bool g_colors_enabled = true;
 static pthread_mutex_t g_log_mutex = PTHREAD_MUTEX_INITIALIZER;
 static bool g_logging_initialized = false;
 
+// Metrics: entries written per level, and entries a destination failed to take
+static sls_metric_t *g_level_metrics[LOG_LEVEL_CRITICAL + 1];
+static sls_metric_t *g_dropped_metric;
+
 // Internal functions
 static const char *log_level_to_string(log_level_t level);
 static const char *log_level_to_color(log_level_t level);
@@ -78,6 +85,17 @@ int sls_logging_init(const char *log_file_path)
     g_logging_initialized = true;
     pthread_mutex_unlock(&g_log_mutex);
 
+    static const char *const level_labels[] = {"level=\"debug\"", "level=\"info\"",
+                                               "level=\"warning\"", "level=\"error\"",
+                                               "level=\"critical\""};
+    for (int i = 0; i <= LOG_LEVEL_CRITICAL; i++)
+    {
+        g_level_metrics[i] =
+            sls_metrics_counter("sls_log_messages_total", level_labels[i], "Log entries written");
+    }
+    g_dropped_metric = sls_metrics_counter("sls_log_dropped_total", NULL,
+                                           "Log entries a destination failed to write");
+
     // Log initialization message
     sls_log(LOG_LEVEL_INFO, "LOGGING", "Logging system initialized");
     if (log_file_path)
@@ -93,6 +111,9 @@ int sls_logging_init(const char *log_file_path)
  */
 void sls_logging_cleanup(void)
 {
+    // Logged before taking the mutex: write_log_entry() takes it too
+    sls_log(LOG_LEVEL_INFO, "LOGGING", "Shutting down logging system");
+
     pthread_mutex_lock(&g_log_mutex);
 
     if (!g_logging_initialized)
@@ -101,8 +122,6 @@ void sls_logging_cleanup(void)
         return;
     }
 
-    sls_log(LOG_LEVEL_INFO, "LOGGING", "Shutting down logging system");
-
     if (g_log_file)
     {
         fclose(g_log_file);
@@ -360,10 +379,16 @@ static const char *log_level_to_color(log_level_t level)
 }
 
 /**
- * @brief Format timestamp string
+ * @brief Format timestamp string; call with g_log_mutex held
+ *
+ * The broken-down time is recomputed only when the second changes:
+ * localtime() takes the time zone lock on every call.
  */
 static void format_timestamp(char *buffer, size_t buffer_size)
 {
+    static time_t cached_sec = (time_t)-1;
+    static struct tm cached_tm;
+
     if (!g_timestamps_enabled)
     {
         buffer[0] = '\0';
@@ -371,11 +396,15 @@ static void format_timestamp(char *buffer, size_t buffer_size)
     }
 
     struct timespec ts;
-    clock_gettime(CLOCK_REALTIME, &ts);
+    sls_time_to_timespec(sls_time_realtime_ns(), &ts);
+    if (ts.tv_sec != cached_sec)
+    {
+        localtime_r(&ts.tv_sec, &cached_tm);
+        cached_sec = ts.tv_sec;
+    }
 
-    struct tm *tm_info = localtime(&ts.tv_sec);
     snprintf(buffer, buffer_size, "%02d:%02d:%02d.%03ld",
-             tm_info->tm_hour, tm_info->tm_min, tm_info->tm_sec,
+             cached_tm.tm_hour, cached_tm.tm_min, cached_tm.tm_sec,
              ts.tv_nsec / 1000000);
 }
 
@@ -384,6 +413,8 @@ static void format_timestamp(char *buffer, size_t buffer_size)
  */
 static void write_log_entry(log_level_t level, const char *component, const char *message)
 {
+    SLS_TRACE_SCOPE("write_log_entry");
+
     pthread_mutex_lock(&g_log_mutex);
 
     char timestamp[32];
@@ -409,14 +440,25 @@ static void write_log_entry(log_level_t level, const char *component, const char
         const char *reset = g_colors_enabled ? COLOR_RESET : "";
 
         FILE *output = (level >= LOG_LEVEL_ERROR) ? stderr : stdout;
-        fprintf(output, "%s%s%s\n", color, log_line, reset);
+        if (fprintf(output, "%s%s%s\n", color, log_line, reset) < 0 && g_dropped_metric)
+        {
+            sls_metric_inc(g_dropped_metric);
+        }
     }
 
     // Write to file
     if ((g_log_destination & LOG_DEST_FILE) && g_log_file)
     {
-        fprintf(g_log_file, "%s\n", log_line);
-        fflush(g_log_file);
+        if ((fprintf(g_log_file, "%s\n", log_line) < 0 || fflush(g_log_file) != 0) &&
+            g_dropped_metric)
+        {
+            sls_metric_inc(g_dropped_metric);
+        }
+    }
+
+    if (level <= LOG_LEVEL_CRITICAL && g_level_metrics[level])
+    {
+        sls_metric_inc(g_level_metrics[level]);
     }
 
     pthread_mutex_unlock(&g_log_mutex);
@@ -0,0 +1,498 @@
+/**
+ * @file sls_metrics.c
+ * @brief Counters, gauges and histograms served as Prometheus text
+ */
+
+#include "sls_metrics.h"
+#include "sls_alloc.h"
+#include "sls_logging.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#define ACCEPT_POLL_MS 200
+
+typedef struct
+{
+    _Alignas(64) _Atomic uint64_t value;
+} counter_shard_t;
+
+typedef struct
+{
+    _Alignas(64) _Atomic uint64_t count;
+    _Atomic uint64_t sum;
+    _Atomic uint64_t buckets[SLS_METRICS_MAX_BUCKETS + 1]; // last one is +Inf
+} hist_shard_t;
+
+struct sls_metric
+{
+    char name[64];
+    char labels[96];
+    char help[128];
+    sls_metric_type_t type;
+    sls_metric_fn_t fn; // callback metrics only
+    void *arg;
+    _Atomic uint64_t gauge_bits; // double, for set gauges
+    int num_bounds;
+    uint64_t bounds[SLS_METRICS_MAX_BUCKETS];
+    double scale;
+    counter_shard_t *counters; // SLS_METRICS_SHARDS, counters
+    hist_shard_t *hist;        // SLS_METRICS_SHARDS, histograms
+};
+
+static sls_metric_t g_metrics[SLS_METRICS_MAX];
+static atomic_int g_num_metrics = 0;
+static pthread_mutex_t g_register_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Target of updates once the registry is full; never rendered
+static counter_shard_t g_overflow_counters[SLS_METRICS_SHARDS];
+static hist_shard_t g_overflow_hist[SLS_METRICS_SHARDS];
+static sls_metric_t g_overflow = {.counters = g_overflow_counters, .hist = g_overflow_hist};
+
+static atomic_uint g_next_shard = 0;
+static _Thread_local int tls_shard = -1;
+
+static pthread_t g_server_thread;
+static int g_listen_fd = -1;
+static atomic_bool g_serving = false;
+
+static inline int my_shard(void)
+{
+    if (tls_shard < 0)
+    {
+        tls_shard = (int)(atomic_fetch_add(&g_next_shard, 1) % SLS_METRICS_SHARDS);
+    }
+    return tls_shard;
+}
+
+static sls_metric_t *register_metric(const char *name, const char *labels, const char *help,
+                                     sls_metric_type_t type, const uint64_t *bounds,
+                                     int num_bounds, double scale, sls_metric_fn_t fn, void *arg)
+{
+    if (!labels)
+    {
+        labels = "";
+    }
+
+    pthread_mutex_lock(&g_register_lock);
+    int n = atomic_load_explicit(&g_num_metrics, memory_order_relaxed);
+    for (int i = 0; i < n; i++)
+    {
+        if (strcmp(g_metrics[i].name, name) == 0 && strcmp(g_metrics[i].labels, labels) == 0)
+        {
+            pthread_mutex_unlock(&g_register_lock);
+            return &g_metrics[i];
+        }
+    }
+    if (n == SLS_METRICS_MAX || strlen(name) >= sizeof(g_metrics[0].name) ||
+        strlen(labels) >= sizeof(g_metrics[0].labels) || num_bounds > SLS_METRICS_MAX_BUCKETS)
+    {
+        pthread_mutex_unlock(&g_register_lock);
+        sls_log(LOG_LEVEL_WARNING, "METRICS", "Cannot register %s{%s}", name, labels);
+        return &g_overflow;
+    }
+
+    sls_metric_t *m = &g_metrics[n];
+    memset(m, 0, sizeof(*m));
+    snprintf(m->name, sizeof(m->name), "%s", name);
+    snprintf(m->labels, sizeof(m->labels), "%s", labels);
+    snprintf(m->help, sizeof(m->help), "%s", help ? help : "");
+    m->type = type;
+    m->fn = fn;
+    m->arg = arg;
+    m->scale = scale;
+    if (!fn && type == SLS_METRIC_COUNTER)
+    {
+        m->counters = sls_alloc_startup(SLS_ALLOC_CORE, sizeof(counter_shard_t) * SLS_METRICS_SHARDS);
+        if (m->counters)
+        {
+            memset(m->counters, 0, sizeof(counter_shard_t) * SLS_METRICS_SHARDS);
+        }
+    }
+    else if (type == SLS_METRIC_HISTOGRAM)
+    {
+        m->num_bounds = num_bounds;
+        memcpy(m->bounds, bounds, (size_t)num_bounds * sizeof(bounds[0]));
+        m->hist = sls_alloc_startup(SLS_ALLOC_CORE, sizeof(hist_shard_t) * SLS_METRICS_SHARDS);
+        if (m->hist)
+        {
+            memset(m->hist, 0, sizeof(hist_shard_t) * SLS_METRICS_SHARDS);
+        }
+    }
+    if ((type == SLS_METRIC_COUNTER && !fn && !m->counters) ||
+        (type == SLS_METRIC_HISTOGRAM && !m->hist))
+    {
+        pthread_mutex_unlock(&g_register_lock);
+        return &g_overflow;
+    }
+
+    // Published last: the renderer only reads the first g_num_metrics entries
+    atomic_store_explicit(&g_num_metrics, n + 1, memory_order_release);
+    pthread_mutex_unlock(&g_register_lock);
+    return m;
+}
+
+sls_metric_t *sls_metrics_counter(const char *name, const char *labels, const char *help)
+{
+    return register_metric(name, labels, help, SLS_METRIC_COUNTER, NULL, 0, 1.0, NULL, NULL);
+}
+
+sls_metric_t *sls_metrics_gauge(const char *name, const char *labels, const char *help)
+{
+    return register_metric(name, labels, help, SLS_METRIC_GAUGE, NULL, 0, 1.0, NULL, NULL);
+}
+
+sls_metric_t *sls_metrics_histogram(const char *name, const char *labels, const char *help,
+                                    const uint64_t *bounds, int num_bounds, double scale)
+{
+    return register_metric(name, labels, help, SLS_METRIC_HISTOGRAM, bounds, num_bounds, scale,
+                           NULL, NULL);
+}
+
+sls_metric_t *sls_metrics_callback(const char *name, const char *labels, const char *help,
+                                   sls_metric_type_t type, sls_metric_fn_t fn, void *arg)
+{
+    if (type == SLS_METRIC_HISTOGRAM || !fn)
+    {
+        return &g_overflow;
+    }
+    return register_metric(name, labels, help, type, NULL, 0, 1.0, fn, arg);
+}
+
+void sls_metric_add(sls_metric_t *metric, uint64_t n)
+{
+    if (metric->counters)
+    {
+        atomic_fetch_add_explicit(&metric->counters[my_shard()].value, n, memory_order_relaxed);
+    }
+}
+
+void sls_metric_inc(sls_metric_t *metric)
+{
+    sls_metric_add(metric, 1);
+}
+
+void sls_metric_set(sls_metric_t *metric, double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    atomic_store_explicit(&metric->gauge_bits, bits, memory_order_relaxed);
+}
+
+void sls_metric_observe(sls_metric_t *metric, uint64_t value)
+{
+    if (!metric->hist)
+    {
+        return;
+    }
+    int b = 0;
+    while (b < metric->num_bounds && value > metric->bounds[b])
+    {
+        b++;
+    }
+    hist_shard_t *s = &metric->hist[my_shard()];
+    atomic_fetch_add_explicit(&s->buckets[b], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&s->sum, value, memory_order_relaxed);
+    atomic_fetch_add_explicit(&s->count, 1, memory_order_relaxed);
+}
+
+static uint64_t sum_counter(const sls_metric_t *m)
+{
+    uint64_t total = 0;
+    for (int i = 0; i < SLS_METRICS_SHARDS; i++)
+    {
+        total += atomic_load_explicit(&m->counters[i].value, memory_order_relaxed);
+    }
+    return total;
+}
+
+double sls_metric_value(const sls_metric_t *metric)
+{
+    if (metric->fn)
+    {
+        return metric->fn(metric->arg);
+    }
+    switch (metric->type)
+    {
+    case SLS_METRIC_COUNTER:
+        return metric->counters ? (double)sum_counter(metric) : 0.0;
+    case SLS_METRIC_GAUGE:
+    {
+        uint64_t bits = atomic_load_explicit(&metric->gauge_bits, memory_order_relaxed);
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    case SLS_METRIC_HISTOGRAM:
+    {
+        uint64_t count = 0;
+        for (int i = 0; metric->hist && i < SLS_METRICS_SHARDS; i++)
+        {
+            count += atomic_load_explicit(&metric->hist[i].count, memory_order_relaxed);
+        }
+        return (double)count;
+    }
+    }
+    return 0.0;
+}
+
+/**
+ * @brief snprintf that keeps counting once the buffer is full
+ */
+typedef struct
+{
+    char *buf;
+    size_t size;
+    size_t len;
+} out_t;
+
+static void out_printf(out_t *o, const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    size_t room = o->len < o->size ? o->size - o->len : 0;
+    int n = vsnprintf(room ? o->buf + o->len : NULL, room, fmt, ap);
+    va_end(ap);
+    if (n > 0)
+    {
+        o->len += (size_t)n;
+    }
+}
+
+static void render_series(out_t *o, const sls_metric_t *m)
+{
+    const char *open = m->labels[0] ? "{" : "";
+    const char *close = m->labels[0] ? "}" : "";
+
+    if (m->type != SLS_METRIC_HISTOGRAM)
+    {
+        if (!m->fn && m->type == SLS_METRIC_COUNTER)
+        {
+            out_printf(o, "%s%s%s%s %llu\n", m->name, open, m->labels, close,
+                       (unsigned long long)sum_counter(m));
+            return;
+        }
+        double v = sls_metric_value(m);
+        if (!isnan(v))
+        {
+            out_printf(o, "%s%s%s%s %.17g\n", m->name, open, m->labels, close, v);
+        }
+        return;
+    }
+
+    uint64_t buckets[SLS_METRICS_MAX_BUCKETS + 1] = {0};
+    uint64_t sum = 0, count = 0;
+    for (int i = 0; i < SLS_METRICS_SHARDS; i++)
+    {
+        const hist_shard_t *s = &m->hist[i];
+        for (int b = 0; b <= m->num_bounds; b++)
+        {
+            buckets[b] += atomic_load_explicit(&s->buckets[b], memory_order_relaxed);
+        }
+        sum += atomic_load_explicit(&s->sum, memory_order_relaxed);
+    }
+    const char *sep = m->labels[0] ? "," : "";
+    for (int b = 0; b <= m->num_bounds; b++)
+    {
+        count += buckets[b]; // cumulative, and consistent with the buckets
+        if (b < m->num_bounds)
+        {
+            out_printf(o, "%s_bucket{%s%sle=\"%.10g\"} %llu\n", m->name, m->labels, sep,
+                       (double)m->bounds[b] * m->scale, (unsigned long long)count);
+        }
+        else
+        {
+            out_printf(o, "%s_bucket{%s%sle=\"+Inf\"} %llu\n", m->name, m->labels, sep,
+                       (unsigned long long)count);
+        }
+    }
+    out_printf(o, "%s_sum%s%s%s %.17g\n", m->name, open, m->labels, close, (double)sum * m->scale);
+    out_printf(o, "%s_count%s%s%s %llu\n", m->name, open, m->labels, close,
+               (unsigned long long)count);
+}
+
+size_t sls_metrics_render(char *out, size_t out_size)
+{
+    static const char *const type_names[] = {"counter", "gauge", "histogram"};
+    out_t o = {out, out_size, 0};
+    int n = atomic_load_explicit(&g_num_metrics, memory_order_acquire);
+
+    for (int i = 0; i < n; i++)
+    {
+        // A family's series are written together, under the first one's HELP
+        bool seen = false;
+        for (int j = 0; j < i && !seen; j++)
+        {
+            seen = strcmp(g_metrics[j].name, g_metrics[i].name) == 0;
+        }
+        if (seen)
+        {
+            continue;
+        }
+        out_printf(&o, "# HELP %s %s\n# TYPE %s %s\n", g_metrics[i].name, g_metrics[i].help,
+                   g_metrics[i].name, type_names[g_metrics[i].type]);
+        for (int j = i; j < n; j++)
+        {
+            if (strcmp(g_metrics[j].name, g_metrics[i].name) == 0)
+            {
+                render_series(&o, &g_metrics[j]);
+            }
+        }
+    }
+    if (out_size > 0 && o.len >= out_size)
+    {
+        out[out_size - 1] = '\0';
+    }
+    return o.len;
+}
+
+static void send_all(int fd, const char *data, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n <= 0)
+        {
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            return;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+}
+
+static void serve_client(int fd)
+{
+    struct timeval tv = {.tv_sec = 1, .tv_usec = 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    char req[1024];
+    size_t len = 0;
+    while (len < sizeof(req) - 1)
+    {
+        ssize_t n = recv(fd, req + len, sizeof(req) - 1 - len, 0);
+        if (n <= 0)
+        {
+            break;
+        }
+        len += (size_t)n;
+        req[len] = '\0';
+        if (strstr(req, "\r\n\r\n") || strstr(req, "\n\n"))
+        {
+            break;
+        }
+    }
+    req[len] = '\0';
+
+    char header[160];
+    if (strncmp(req, "GET /metrics ", 13) != 0 && strncmp(req, "GET / ", 6) != 0)
+    {
+        static const char not_found[] = "HTTP/1.0 404 Not Found\r\nContent-Length: 0\r\n"
+                                        "Connection: close\r\n\r\n";
+        send_all(fd, not_found, sizeof(not_found) - 1);
+        return;
+    }
+
+    size_t size = sls_metrics_render(NULL, 0) + 1;
+    char *body = sls_alloc(SLS_ALLOC_CORE, size);
+    if (!body)
+    {
+        return;
+    }
+    size_t body_len = sls_metrics_render(body, size);
+    if (body_len >= size)
+    {
+        body_len = size - 1; // registered between the two passes
+    }
+    int hlen = snprintf(header, sizeof(header),
+                        "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                        "Content-Length: %zu\r\nConnection: close\r\n\r\n",
+                        body_len);
+    send_all(fd, header, (size_t)hlen);
+    send_all(fd, body, body_len);
+    sls_free(body);
+}
+
+static void *server_thread(void *arg)
+{
+    (void)arg;
+    while (atomic_load(&g_serving))
+    {
+        struct pollfd pfd = {.fd = g_listen_fd, .events = POLLIN};
+        if (poll(&pfd, 1, ACCEPT_POLL_MS) <= 0)
+        {
+            continue;
+        }
+        int fd = accept(g_listen_fd, NULL, NULL);
+        if (fd >= 0)
+        {
+            serve_client(fd);
+            close(fd);
+        }
+    }
+    return NULL;
+}
+
+int sls_metrics_server_start(int port)
+{
+    if (atomic_load(&g_serving))
+    {
+        return 0;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr = {.sin_family = AF_INET,
+                               .sin_port = htons((uint16_t)port),
+                               .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, 8) != 0)
+    {
+        sls_log(LOG_LEVEL_ERROR, "METRICS", "Cannot listen on 127.0.0.1:%d: %s", port,
+                strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    g_listen_fd = fd;
+    atomic_store(&g_serving, true);
+    if (pthread_create(&g_server_thread, NULL, server_thread, NULL) != 0)
+    {
+        atomic_store(&g_serving, false);
+        close(fd);
+        g_listen_fd = -1;
+        return -1;
+    }
+    sls_log(LOG_LEVEL_INFO, "METRICS", "Serving http://127.0.0.1:%d/metrics", port);
+    return 0;
+}
+
+void sls_metrics_server_stop(void)
+{
+    if (atomic_exchange(&g_serving, false))
+    {
+        pthread_join(g_server_thread, NULL);
+        close(g_listen_fd);
+        g_listen_fd = -1;
+    }
+}
@@ -0,0 +1,107 @@
+#ifndef SLS_METRICS_H
+#define SLS_METRICS_H
+
+/**
+ * @file sls_metrics.h
+ * @brief Counters, gauges and histograms served as Prometheus text
+ *
+ * Metrics are registered once (usually at subsystem start-up) and updated
+ * from any thread. Counter and histogram updates go to one of
+ * SLS_METRICS_SHARDS cache-line-sized cells picked per thread, so threads
+ * bumping the same metric do not bounce a cache line between them; an
+ * update is one relaxed atomic add. Shards are summed only when metrics
+ * are rendered.
+ *
+ * Values that already exist elsewhere (a queue depth, a counter kept by
+ * another module) are registered as callbacks and read at render time.
+ *
+ * sls_metrics_server_start() serves GET /metrics in the Prometheus text
+ * exposition format on 127.0.0.1, from its own thread.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SLS_METRICS_MAX 128        // registered series
+#define SLS_METRICS_SHARDS 16      // per-thread cells per counter/histogram
+#define SLS_METRICS_MAX_BUCKETS 16 // histogram bounds, +Inf not included
+#define SLS_METRICS_DEFAULT_PORT 9464
+
+typedef enum
+{
+    SLS_METRIC_COUNTER = 0,
+    SLS_METRIC_GAUGE,
+    SLS_METRIC_HISTOGRAM
+} sls_metric_type_t;
+
+typedef struct sls_metric sls_metric_t;
+
+/**
+ * @brief Read a callback metric; return NAN to leave it out of this scrape
+ */
+typedef double (*sls_metric_fn_t)(void *arg);
+
+/**
+ * @brief Register (or look up) a series
+ *
+ * name and labels identify the series; labels is the text between the
+ * braces (e.g. "level=\"error\"") or NULL. Registering the same series
+ * again returns the existing one. Never returns NULL: when the registry
+ * is full the updates go to a metric that is not exported.
+ */
+sls_metric_t *sls_metrics_counter(const char *name, const char *labels, const char *help);
+sls_metric_t *sls_metrics_gauge(const char *name, const char *labels, const char *help);
+
+/**
+ * @brief Register a histogram
+ *
+ * Observations are integers in the caller's unit (e.g. ns); bounds are
+ * the inclusive upper bucket bounds in that unit, ascending. scale
+ * converts the unit to the exported one (1e-9 for ns exported as seconds).
+ */
+sls_metric_t *sls_metrics_histogram(const char *name, const char *labels, const char *help,
+                                    const uint64_t *bounds, int num_bounds, double scale);
+
+/**
+ * @brief Register a counter or gauge whose value is read by a callback
+ */
+sls_metric_t *sls_metrics_callback(const char *name, const char *labels, const char *help,
+                                   sls_metric_type_t type, sls_metric_fn_t fn, void *arg);
+
+void sls_metric_add(sls_metric_t *metric, uint64_t n);
+void sls_metric_inc(sls_metric_t *metric);
+void sls_metric_set(sls_metric_t *metric, double value);
+void sls_metric_observe(sls_metric_t *metric, uint64_t value);
+
+/**
+ * @brief Current value (summed over shards; count for a histogram)
+ */
+double sls_metric_value(const sls_metric_t *metric);
+
+/**
+ * @brief Render every metric in the Prometheus text format
+ * @return Length written (excluding the NUL), or the length needed if it
+ *         does not fit in out_size
+ */
+size_t sls_metrics_render(char *out, size_t out_size);
+
+/**
+ * @brief Serve /metrics on 127.0.0.1:port
+ * @return 0 on success, -1 if the port cannot be bound
+ */
+int sls_metrics_server_start(int port);
+
+/**
+ * @brief Stop the server thread
+ */
+void sls_metrics_server_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SLS_METRICS_H
@@ -0,0 +1,187 @@
+/**
+ * @file sls_mission_config.c
+ * @brief Subsystem table and mission timeline loaded from configuration
+ */
+
+#include "sls_mission_config.h"
+#include "sls_config_loader.h"
+#include "sls_logging.h"
+#include "sls_utils.h"
+
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <strings.h>
+
+#define MAX_PHASES 16
+
+// Configuration names, indexed by subsystem_type_t and mission_phase_t
+static const char *const subsystem_keys[] = {
+    "flight_control", "engine_control", "telemetry", "environmental",
+    "ground_support", "navigation",     "power",     "thermal"};
+static const char *const phase_keys[] = {
+    "prelaunch",        "ignition",        "liftoff",         "ascent",
+    "stage_separation", "orbit_insertion", "mission_complete"};
+
+static subsystem_config_t g_subsystems[MAX_SUBSYSTEMS];
+static int g_num_subsystems;
+static phase_config_t g_phases[MAX_PHASES];
+static int g_num_phases;
+
+static int parse_priority(const char *s, priority_level_t *out)
+{
+    static const struct
+    {
+        const char *name;
+        priority_level_t level;
+    } names[] = {{"low", PRIORITY_LOW},
+                 {"normal", PRIORITY_NORMAL},
+                 {"high", PRIORITY_HIGH},
+                 {"critical", PRIORITY_CRITICAL}};
+
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+    {
+        if (strcasecmp(s, names[i].name) == 0)
+        {
+            *out = names[i].level;
+            return 0;
+        }
+    }
+    char *end;
+    long v = strtol(s, &end, 10);
+    if (*s && *end == '\0' && v >= 1 && v <= PRIORITY_EMERGENCY)
+    {
+        *out = (priority_level_t)v;
+        return 0;
+    }
+    return -1;
+}
+
+static void load_subsystems(void)
+{
+    const subsystem_config_t defaults[] = DEFAULT_SUBSYSTEM_CONFIGS;
+    char key[SLS_CONFIG_MAX_KEY];
+
+    g_num_subsystems = 0;
+    for (size_t i = 0; i < sizeof(defaults) / sizeof(defaults[0]); i++)
+    {
+        subsystem_config_t cfg = defaults[i];
+        const char *name = subsystem_keys[cfg.type];
+
+        snprintf(key, sizeof(key), "subsystem.%s.enabled", name);
+        if (!sls_get_config_int(key, 1))
+        {
+            sls_log(LOG_LEVEL_INFO, "CONFIG", "Subsystem %s disabled", cfg.name);
+            continue;
+        }
+
+        snprintf(key, sizeof(key), "subsystem.%s.rate_hz", name);
+        int rate = sls_get_config_int(key, (int)cfg.update_rate_hz);
+        if (rate >= 1 && rate <= 1000)
+        {
+            cfg.update_rate_hz = (uint32_t)rate;
+        }
+        else
+        {
+            sls_log(LOG_LEVEL_WARNING, "CONFIG", "%s = %d out of range, using %u", key, rate,
+                    cfg.update_rate_hz);
+        }
+
+        snprintf(key, sizeof(key), "subsystem.%s.priority", name);
+        const char *prio = sls_get_config_string(key, NULL);
+        if (prio && parse_priority(prio, &cfg.priority) != 0)
+        {
+            sls_log(LOG_LEVEL_WARNING, "CONFIG", "%s = %s not understood, using %d", key, prio,
+                    cfg.priority);
+        }
+
+        if (g_num_subsystems < MAX_SUBSYSTEMS)
+        {
+            g_subsystems[g_num_subsystems++] = cfg;
+        }
+    }
+}
+
+static void load_timeline(void)
+{
+    const phase_config_t defaults[] = DEFAULT_MISSION_PHASES;
+    char key[SLS_CONFIG_MAX_KEY];
+
+    g_num_phases = 0;
+    for (size_t i = 0; i < sizeof(defaults) / sizeof(defaults[0]) && i < MAX_PHASES; i++)
+    {
+        phase_config_t phase = defaults[i];
+        snprintf(key, sizeof(key), "timeline.%s", phase_keys[phase.phase]);
+        phase.start_time = sls_get_config_double(key, phase.start_time);
+
+        // Insertion sort by start time; equal starts keep table order
+        int j = g_num_phases++;
+        while (j > 0 && g_phases[j - 1].start_time > phase.start_time)
+        {
+            g_phases[j] = g_phases[j - 1];
+            j--;
+        }
+        g_phases[j] = phase;
+    }
+
+    // A phase lasts until the next one starts
+    for (int i = 0; i + 1 < g_num_phases; i++)
+    {
+        g_phases[i].duration = g_phases[i + 1].start_time - g_phases[i].start_time;
+    }
+}
+
+int sls_mission_config_load(void)
+{
+    load_subsystems();
+    load_timeline();
+
+    sls_log(LOG_LEVEL_INFO, "CONFIG", "%d subsystems, %d phases from T%+.1f to T%+.1f",
+            g_num_subsystems, g_num_phases, g_phases[0].start_time,
+            g_phases[g_num_phases - 1].start_time);
+    return 0;
+}
+
+const subsystem_config_t *sls_subsystem_table(int *count)
+{
+    *count = g_num_subsystems;
+    return g_subsystems;
+}
+
+const phase_config_t *sls_mission_timeline(int *count)
+{
+    *count = g_num_phases;
+    return g_phases;
+}
+
+void sls_timeline_cursor_init(sls_timeline_cursor_t *cursor)
+{
+    cursor->index = -1;
+    cursor->start = -DBL_MAX;
+    cursor->next_boundary = g_num_phases > 0 ? g_phases[0].start_time : DBL_MAX;
+}
+
+mission_phase_t sls_timeline_phase(sls_timeline_cursor_t *cursor, double mission_time)
+{
+    if (mission_time < cursor->start || mission_time >= cursor->next_boundary)
+    {
+        int i = cursor->index;
+        while (i + 1 < g_num_phases && mission_time >= g_phases[i + 1].start_time)
+        {
+            i++;
+        }
+        while (i >= 0 && mission_time < g_phases[i].start_time)
+        {
+            i--;
+        }
+        cursor->index = i;
+        cursor->start = i >= 0 ? g_phases[i].start_time : -DBL_MAX;
+        cursor->next_boundary = i + 1 < g_num_phases ? g_phases[i + 1].start_time : DBL_MAX;
+    }
+    return cursor->index >= 0 ? g_phases[cursor->index].phase : PHASE_UNKNOWN;
+}
+
+const phase_config_t *sls_timeline_current(const sls_timeline_cursor_t *cursor)
+{
+    return cursor->index >= 0 ? &g_phases[cursor->index] : NULL;
+}
@@ -0,0 +1,85 @@
+#ifndef SLS_MISSION_CONFIG_H
+#define SLS_MISSION_CONFIG_H
+
+/**
+ * @file sls_mission_config.h
+ * @brief Subsystem table and mission timeline loaded from configuration
+ *
+ * Both tables start from the DEFAULT_SUBSYSTEM_CONFIGS and
+ * DEFAULT_MISSION_PHASES values in sls_config.h, are overridden by the
+ * loaded configuration once at start-up and are read-only afterwards, so
+ * subsystem threads can keep pointers into them and the control loop never
+ * rebuilds them.
+ *
+ * Configuration keys:
+ *   [subsystem.<name>]  rate_hz, priority (low/normal/high/critical or a
+ *                       number), enabled
+ *   [timeline]          <phase> = start time in mission seconds
+ *
+ * The timeline is kept sorted by start time and each phase lasts until the
+ * next one starts; the last phase never ends. A cursor remembers the
+ * current phase and the time of the next boundary, so looking up the phase
+ * for a steadily increasing mission time is a single compare per tick.
+ */
+
+#include "sls_config.h"
+#include "sls_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Position in the timeline, owned by one caller
+ */
+typedef struct
+{
+    int index;            // current phase, -1 before the first one
+    double start;         // start of the current phase
+    double next_boundary; // start of the following phase
+} sls_timeline_cursor_t;
+
+/**
+ * @brief Build both tables from defaults and the current configuration
+ *
+ * Must not be called while subsystem threads are running.
+ *
+ * @return 0 on success (invalid settings are logged and left at default)
+ */
+int sls_mission_config_load(void);
+
+/**
+ * @brief Enabled subsystems in start-up order
+ */
+const subsystem_config_t *sls_subsystem_table(int *count);
+
+/**
+ * @brief Mission phases sorted by start time
+ */
+const phase_config_t *sls_mission_timeline(int *count);
+
+/**
+ * @brief Place a cursor before the first phase
+ */
+void sls_timeline_cursor_init(sls_timeline_cursor_t *cursor);
+
+/**
+ * @brief Phase in effect at a mission time
+ *
+ * O(1) while the time stays within the current phase; crossing boundaries
+ * walks the cursor forward (or back) one phase at a time.
+ *
+ * @return The phase, or PHASE_UNKNOWN before the first phase starts
+ */
+mission_phase_t sls_timeline_phase(sls_timeline_cursor_t *cursor, double mission_time);
+
+/**
+ * @brief Phase table entry the cursor points at, or NULL before the first
+ */
+const phase_config_t *sls_timeline_current(const sls_timeline_cursor_t *cursor);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SLS_MISSION_CONFIG_H
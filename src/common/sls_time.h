@@ -0,0 +1,108 @@
+#ifndef SLS_TIME_H
+#define SLS_TIME_H
+
+/**
+ * @file sls_time.h
+ * @brief Integer nanosecond timestamps and the clocks that produce them
+ *
+ * Every simulator timestamp is an sls_time_ns_t: signed 64-bit nanoseconds,
+ * 8 bytes instead of a 16-byte timespec, good for +/-292 years around the
+ * epoch without losing a nanosecond (a double holding CLOCK_REALTIME
+ * seconds resolves only ~240 ns today). Differences are integer
+ * subtractions; convert to seconds once, at the point a physics step or a
+ * display needs them.
+ *
+ * Two clocks:
+ * - sls_time_realtime_ns(): CLOCK_REALTIME, for records that leave the
+ *   process or are shown to people (telemetry, IPC headers, logs).
+ * - sls_time_monotonic_ns(): loop timing, latency and timeouts. On QNX it
+ *   scales ClockCycles() by the system page's cycles_per_sec instead of
+ *   trapping into the kernel; elsewhere clock_gettime(CLOCK_MONOTONIC) is
+ *   served from the vDSO without a system call. Only differences between
+ *   two readings are meaningful; its origin is not CLOCK_MONOTONIC's on QNX.
+ */
+
+#include <stdint.h>
+#include <time.h>
+
+#ifdef __QNX__
+#include <sys/neutrino.h>
+#include <sys/syspage.h>
+#endif
+
+typedef int64_t sls_time_ns_t;
+
+#define SLS_NS_PER_SEC 1000000000LL
+#define SLS_NS_PER_MS 1000000LL
+#define SLS_NS_PER_US 1000LL
+
+static inline sls_time_ns_t sls_time_from_timespec(const struct timespec *ts)
+{
+    return (sls_time_ns_t)ts->tv_sec * SLS_NS_PER_SEC + ts->tv_nsec;
+}
+
+/**
+ * @brief Split into a normalized timespec (0 <= tv_nsec < 1 s, also when negative)
+ */
+static inline void sls_time_to_timespec(sls_time_ns_t t, struct timespec *ts)
+{
+    sls_time_ns_t sec = t / SLS_NS_PER_SEC;
+    sls_time_ns_t nsec = t % SLS_NS_PER_SEC;
+    if (nsec < 0)
+    {
+        sec--;
+        nsec += SLS_NS_PER_SEC;
+    }
+    ts->tv_sec = (time_t)sec;
+    ts->tv_nsec = (long)nsec;
+}
+
+/**
+ * @brief Seconds as a double; exact for intervals, not for epoch-scale times
+ */
+static inline double sls_time_to_seconds(sls_time_ns_t t)
+{
+    return (double)t * 1e-9;
+}
+
+static inline sls_time_ns_t sls_time_from_seconds(double seconds)
+{
+    double ns = seconds * 1e9;
+    return (sls_time_ns_t)(ns < 0.0 ? ns - 0.5 : ns + 0.5);
+}
+
+static inline sls_time_ns_t sls_time_realtime_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return sls_time_from_timespec(&ts);
+}
+
+static inline sls_time_ns_t sls_time_monotonic_ns(void)
+{
+#ifdef __QNX__
+    uint64_t cycles = ClockCycles();
+    uint64_t cps = SYSPAGE_ENTRY(qtime)->cycles_per_sec;
+    return (sls_time_ns_t)((cycles / cps) * (uint64_t)SLS_NS_PER_SEC +
+                           (cycles % cps) * (uint64_t)SLS_NS_PER_SEC / cps);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return sls_time_from_timespec(&ts);
+#endif
+}
+
+/**
+ * @brief Relative sleep; zero or negative durations return at once
+ */
+static inline void sls_time_sleep_ns(sls_time_ns_t duration)
+{
+    if (duration > 0)
+    {
+        struct timespec ts;
+        sls_time_to_timespec(duration, &ts);
+        nanosleep(&ts, NULL);
+    }
+}
+
+#endif // SLS_TIME_H
@@ -0,0 +1,277 @@
+/**
+ * @file sls_trace.c
+ * @brief Per-thread event tracing exported as Chrome trace JSON
+ */
+
+#include "sls_trace.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __QNX__
+#include <sys/neutrino.h>
+#include <sys/syspage.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TRACE_USE_TSC 1
+#endif
+
+typedef struct
+{
+    uint64_t ts; // trace_now() units
+    const char *name;
+    double value;
+    uint32_t type;
+} trace_event_t;
+
+typedef struct
+{
+    _Atomic uint32_t count; // published events; the owner is the only writer
+    _Atomic uint64_t dropped;
+    int tid;
+    char thread_name[32];
+    trace_event_t events[SLS_TRACE_EVENTS_PER_THREAD];
+} trace_buffer_t;
+
+atomic_bool g_sls_trace_enabled = false;
+
+static _Atomic(trace_buffer_t *) g_buffers[SLS_TRACE_MAX_THREADS];
+static atomic_int g_num_buffers = 0;
+static _Atomic uint64_t g_unregistered_drops = 0; // threads beyond SLS_TRACE_MAX_THREADS
+static atomic_uint g_epoch = 1;                   // bumped by cleanup
+static uint64_t g_start_ts;                       // trace_now() at sls_trace_start()
+#ifdef TRACE_USE_TSC
+static uint64_t g_start_mono_ns; // CLOCK_MONOTONIC at sls_trace_start(), for calibration
+#endif
+
+static _Thread_local trace_buffer_t *tls_buffer;
+static _Thread_local unsigned tls_epoch;
+
+static uint64_t mono_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Event timestamp: the cycle counter where there is a cheap one
+ *
+ * clock_gettime() alone can cost 40 ns in a VM; the TSC is a few ns and
+ * is converted to time at export.
+ */
+static inline uint64_t trace_now(void)
+{
+#if defined(__QNX__)
+    return ClockCycles();
+#elif defined(TRACE_USE_TSC)
+    return __rdtsc();
+#else
+    return mono_ns();
+#endif
+}
+
+/**
+ * @brief Timestamp units per microsecond
+ */
+static double ticks_per_us(void)
+{
+#if defined(__QNX__)
+    return (double)SYSPAGE_ENTRY(qtime)->cycles_per_sec / 1e6;
+#elif defined(TRACE_USE_TSC)
+    // Calibrated over the whole trace (an invariant TSC is assumed)
+    uint64_t ticks = __rdtsc() - g_start_ts;
+    uint64_t ns = mono_ns() - g_start_mono_ns;
+    return ns > 0 ? (double)ticks * 1000.0 / (double)ns : 1000.0;
+#else
+    return 1000.0;
+#endif
+}
+
+/**
+ * @brief Allocate and publish the calling thread's buffer
+ */
+static trace_buffer_t *register_thread(unsigned epoch)
+{
+    tls_epoch = epoch;
+    tls_buffer = NULL;
+
+    int idx = atomic_fetch_add(&g_num_buffers, 1);
+    if (idx >= SLS_TRACE_MAX_THREADS)
+    {
+        return NULL;
+    }
+    // Plain malloc: tracing is opt-in diagnostics and may start mid-run,
+    // so its buffers are outside sls_alloc's steady-state rule
+    trace_buffer_t *buf = malloc(sizeof(*buf));
+    if (!buf)
+    {
+        return NULL;
+    }
+    memset(buf, 0, sizeof(*buf)); // fault the pages in now, not mid-trace
+    buf->tid = idx + 1;
+    if (pthread_getname_np(pthread_self(), buf->thread_name, sizeof(buf->thread_name)) != 0 ||
+        buf->thread_name[0] == '\0')
+    {
+        snprintf(buf->thread_name, sizeof(buf->thread_name), "thread-%d", buf->tid);
+    }
+    atomic_store_explicit(&g_buffers[idx], buf, memory_order_release);
+    tls_buffer = buf;
+    return buf;
+}
+
+void sls_trace_record(sls_trace_type_t type, const char *name, double value)
+{
+    uint64_t now = trace_now();
+    trace_buffer_t *buf = tls_buffer;
+    unsigned epoch = atomic_load_explicit(&g_epoch, memory_order_relaxed);
+    if (tls_epoch != epoch)
+    {
+        buf = register_thread(epoch);
+    }
+    if (!buf)
+    {
+        atomic_fetch_add_explicit(&g_unregistered_drops, 1, memory_order_relaxed);
+        return;
+    }
+
+    uint32_t n = atomic_load_explicit(&buf->count, memory_order_relaxed);
+    if (n >= SLS_TRACE_EVENTS_PER_THREAD)
+    {
+        atomic_store_explicit(&buf->dropped,
+                              atomic_load_explicit(&buf->dropped, memory_order_relaxed) + 1,
+                              memory_order_relaxed);
+        return;
+    }
+    trace_event_t *ev = &buf->events[n];
+    ev->ts = now;
+    ev->name = name;
+    ev->value = value;
+    ev->type = (uint32_t)type;
+    atomic_store_explicit(&buf->count, n + 1, memory_order_release);
+}
+
+void sls_trace_start(void)
+{
+    if (!atomic_load(&g_sls_trace_enabled))
+    {
+#ifdef TRACE_USE_TSC
+        g_start_mono_ns = mono_ns();
+#endif
+        g_start_ts = trace_now();
+        atomic_store(&g_sls_trace_enabled, true);
+    }
+}
+
+void sls_trace_stop(void)
+{
+    atomic_store(&g_sls_trace_enabled, false);
+}
+
+static void write_json_string(FILE *f, const char *s)
+{
+    fputc('"', f);
+    for (; *s; s++)
+    {
+        if (*s == '"' || *s == '\\')
+        {
+            fputc('\\', f);
+        }
+        if ((unsigned char)*s >= 0x20)
+        {
+            fputc(*s, f);
+        }
+    }
+    fputc('"', f);
+}
+
+long sls_trace_export(const char *path)
+{
+    FILE *f = fopen(path, "w");
+    if (!f)
+    {
+        return -1;
+    }
+
+    static const char phases[] = {'B', 'E', 'C'};
+    double per_us = ticks_per_us();
+    int pid = (int)getpid();
+    long written = 0;
+    int nbuf = atomic_load(&g_num_buffers);
+    if (nbuf > SLS_TRACE_MAX_THREADS)
+    {
+        nbuf = SLS_TRACE_MAX_THREADS;
+    }
+
+    fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    fprintf(f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":0,"
+               "\"args\":{\"name\":\"sls\"}}",
+            pid);
+    for (int i = 0; i < nbuf; i++)
+    {
+        trace_buffer_t *buf = atomic_load_explicit(&g_buffers[i], memory_order_acquire);
+        if (!buf)
+        {
+            continue;
+        }
+        fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":",
+                pid, buf->tid);
+        write_json_string(f, buf->thread_name);
+        fprintf(f, "}}");
+
+        uint32_t n = atomic_load_explicit(&buf->count, memory_order_acquire);
+        for (uint32_t j = 0; j < n; j++)
+        {
+            const trace_event_t *ev = &buf->events[j];
+            double ts = ev->ts >= g_start_ts ? (double)(ev->ts - g_start_ts) / per_us : 0.0;
+            fprintf(f, ",\n{\"name\":");
+            write_json_string(f, ev->name);
+            fprintf(f, ",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d", phases[ev->type], ts, pid,
+                    buf->tid);
+            if (ev->type == SLS_TRACE_COUNTER_EV)
+            {
+                fprintf(f, ",\"args\":{\"value\":%.17g}", ev->value);
+            }
+            fputc('}', f);
+            written++;
+        }
+    }
+    fprintf(f, "\n]}\n");
+
+    if (fclose(f) != 0)
+    {
+        return -1;
+    }
+    return written;
+}
+
+uint64_t sls_trace_dropped(void)
+{
+    uint64_t total = atomic_load(&g_unregistered_drops);
+    int nbuf = atomic_load(&g_num_buffers);
+    for (int i = 0; i < nbuf && i < SLS_TRACE_MAX_THREADS; i++)
+    {
+        trace_buffer_t *buf = atomic_load_explicit(&g_buffers[i], memory_order_acquire);
+        if (buf)
+        {
+            total += atomic_load_explicit(&buf->dropped, memory_order_relaxed);
+        }
+    }
+    return total;
+}
+
+void sls_trace_cleanup(void)
+{
+    sls_trace_stop();
+    atomic_fetch_add(&g_epoch, 1);
+    int nbuf = atomic_exchange(&g_num_buffers, 0);
+    for (int i = 0; i < nbuf && i < SLS_TRACE_MAX_THREADS; i++)
+    {
+        free(atomic_exchange(&g_buffers[i], NULL));
+    }
+    atomic_store(&g_unregistered_drops, 0);
+}
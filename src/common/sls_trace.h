@@ -0,0 +1,119 @@
+#ifndef SLS_TRACE_H
+#define SLS_TRACE_H
+
+/**
+ * @file sls_trace.h
+ * @brief Per-thread event tracing exported as Chrome trace JSON
+ *
+ * Instrumented code marks the begin and end of hot sections and samples
+ * counters. Each thread appends to its own buffer, allocated on its first
+ * event and never shared with other writers, so recording an event is a
+ * timestamp read and a few stores: no locks and no atomic read-modify-write.
+ * A buffer that fills up drops further events and counts them.
+ *
+ * sls_trace_export() can run at any time from any thread. It reads the
+ * buffers without stopping their writers and writes the JSON object format
+ * that chrome://tracing and ui.perfetto.dev load, with one track per
+ * thread.
+ *
+ * The macros compile to nothing unless SLS_TRACE is defined (make
+ * TRACE=1). When compiled in, nothing is recorded until sls_trace_start(),
+ * and an idle macro costs one relaxed load.
+ *
+ * Event names must be string literals (or other storage that outlives the
+ * export); only the pointer is recorded.
+ */
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SLS_TRACE_EVENTS_PER_THREAD 65536
+#define SLS_TRACE_MAX_THREADS 64
+
+typedef enum
+{
+    SLS_TRACE_BEGIN_EV = 0,
+    SLS_TRACE_END_EV,
+    SLS_TRACE_COUNTER_EV
+} sls_trace_type_t;
+
+extern atomic_bool g_sls_trace_enabled;
+
+/**
+ * @brief Record one event for the calling thread (use the macros)
+ */
+void sls_trace_record(sls_trace_type_t type, const char *name, double value);
+
+static inline void sls_trace_event(sls_trace_type_t type, const char *name, double value)
+{
+    if (atomic_load_explicit(&g_sls_trace_enabled, memory_order_relaxed))
+    {
+        sls_trace_record(type, name, value);
+    }
+}
+
+/**
+ * @brief Start recording
+ */
+void sls_trace_start(void);
+
+/**
+ * @brief Stop recording; buffers are kept for export
+ */
+void sls_trace_stop(void);
+
+/**
+ * @brief Write everything recorded so far as Chrome trace JSON
+ * @return Number of events written, or -1 if the file cannot be written
+ */
+long sls_trace_export(const char *path);
+
+/**
+ * @brief Events dropped because a thread's buffer was full
+ */
+uint64_t sls_trace_dropped(void);
+
+/**
+ * @brief Free every buffer
+ *
+ * Only once no thread can record any more (after the threads have been
+ * joined); a thread that records again gets a new buffer.
+ */
+void sls_trace_cleanup(void);
+
+#ifdef SLS_TRACE
+#define SLS_TRACE_BEGIN(name) sls_trace_event(SLS_TRACE_BEGIN_EV, (name), 0.0)
+#define SLS_TRACE_END(name) sls_trace_event(SLS_TRACE_END_EV, (name), 0.0)
+#define SLS_TRACE_COUNTER(name, value) sls_trace_event(SLS_TRACE_COUNTER_EV, (name), (value))
+
+static inline void sls_trace_scope_end(const char **name)
+{
+    sls_trace_event(SLS_TRACE_END_EV, *name, 0.0);
+}
+
+#define SLS_TRACE_CONCAT_(a, b) a##b
+#define SLS_TRACE_CONCAT(a, b) SLS_TRACE_CONCAT_(a, b)
+
+/** Trace from here to the end of the enclosing block, on any return path */
+#define SLS_TRACE_SCOPE(name)                                                       \
+    const char *SLS_TRACE_CONCAT(sls_trace_scope_, __LINE__)                        \
+        __attribute__((cleanup(sls_trace_scope_end), unused)) = (name);             \
+    SLS_TRACE_BEGIN(name)
+#else
+#define SLS_TRACE_BEGIN(name) ((void)0)
+#define SLS_TRACE_END(name) ((void)0)
+#define SLS_TRACE_COUNTER(name, value) ((void)0)
+#define SLS_TRACE_SCOPE(name) ((void)0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SLS_TRACE_H
@@ -5,6 +5,8 @@
 #include <stdbool.h>
 #include <time.h>
 
+#include "sls_time.h"
+
 /**
  * @file sls_types.h
  * @brief Common data types and structures for Space Launch System simulation
@@ -16,6 +18,7 @@
 #define MAX_TELEMETRY_POINTS 256
 #define MAX_NAME_LENGTH 64
 #define MAX_MESSAGE_LENGTH 512
+#define SLS_CACHE_LINE 64 // Padding unit for state written by one thread and read by others
 
 // Mission phases
 typedef enum
@@ -92,7 +95,7 @@ typedef struct
     double min_value;
     double max_value;
     char units[16];
-    struct timespec timestamp;
+    sls_time_ns_t timestamp_ns; // CLOCK_REALTIME
     bool valid;
     uint32_t quality;
 } telemetry_point_t;
@@ -108,19 +111,44 @@ typedef struct
     double calibration_offset;
     double calibration_scale;
     bool fault_detected;
-    struct timespec last_update;
+    sls_time_ns_t last_update_ns; // CLOCK_REALTIME
 } sensor_data_t;
 
+// Command opcodes understood by subsystem command handlers
+typedef enum
+{
+    CMD_OP_NONE = 0,
+    CMD_OP_GO,
+    CMD_OP_NOGO,
+    CMD_OP_ABORT,
+    CMD_OP_SET_THROTTLE
+} command_opcode_t;
+
+// Command latency trace stages, in order
+typedef enum
+{
+    CMD_STAGE_RECV = 0, // Bytes received from the client
+    CMD_STAGE_PARSE,    // Request parsed
+    CMD_STAGE_ENQUEUE,  // Pushed to the target's queue
+    CMD_STAGE_PICKUP,   // Dequeued by the target subsystem
+    CMD_STAGE_EFFECT,   // First telemetry reflecting the change published
+    CMD_STAGE_COUNT
+} command_stage_t;
+
 // Command structure
 typedef struct
 {
-    uint32_t command_id;
+    uint32_t command_id; // Sequence number, assigned on submit
     subsystem_type_t target_subsystem;
+    command_opcode_t opcode;
+    double value; // Opcode argument (e.g. throttle percent)
     char command[MAX_NAME_LENGTH];
     void *parameters;
     size_t param_size;
     priority_level_t priority;
-    struct timespec timestamp;
+    sls_time_ns_t timestamp_ns;     // Submitted (sls_time_monotonic_ns)
+    sls_time_ns_t ack_timestamp_ns; // Applied by the target (sls_time_monotonic_ns)
+    uint64_t stage_ns[CMD_STAGE_COUNT]; // Latency trace (sls_time_monotonic_ns, 0 = not reached)
     bool urgent;
 } command_t;
 
@@ -132,7 +160,7 @@ typedef struct
     mission_phase_t phase;
     char message[MAX_MESSAGE_LENGTH];
     priority_level_t priority;
-    struct timespec timestamp;
+    sls_time_ns_t timestamp_ns; // CLOCK_REALTIME
     uint32_t error_code;
 } status_message_t;
 
@@ -157,7 +185,7 @@ typedef struct
     double dynamic_pressure; // Pascal
     double mach_number;      // Mach
 
-    struct timespec timestamp;
+    sls_time_ns_t timestamp_ns; // CLOCK_REALTIME
 } vehicle_state_t;
 
 // Engine parameters
@@ -170,7 +198,7 @@ typedef struct
     double nozzle_temperature; // Kelvin
     bool ignition_enabled;
     bool throttle_enabled;
-    struct timespec timestamp;
+    sls_time_ns_t timestamp_ns; // CLOCK_REALTIME
 } engine_state_t;
 
 // Environmental conditions
@@ -182,7 +210,7 @@ typedef struct
     double wind_speed;     // m/s
     double wind_direction; // Degrees
     double precipitation;  // mm/hr
-    struct timespec timestamp;
+    sls_time_ns_t timestamp_ns; // CLOCK_REALTIME
 } environmental_data_t;
 
 // Communication message types
@@ -204,7 +232,7 @@ typedef struct
     subsystem_type_t destination;
     uint32_t sequence_number;
     size_t data_length;
-    struct timespec timestamp;
+    sls_time_ns_t timestamp_ns; // CLOCK_REALTIME
     uint8_t data[]; // Variable length data
 } ipc_message_t;
 
@@ -217,8 +245,8 @@ typedef struct
     priority_level_t severity;
     bool recoverable;
     bool operator_action_required;
-    struct timespec detected_time;
-    struct timespec resolved_time;
+    sls_time_ns_t detected_time_ns; // CLOCK_REALTIME
+    sls_time_ns_t resolved_time_ns;
 } fault_info_t;
 
 // Go/No-Go status
@@ -227,7 +255,7 @@ typedef struct
     subsystem_type_t subsystem;
     bool go_status;
     char reason[MAX_MESSAGE_LENGTH];
-    struct timespec timestamp;
+    sls_time_ns_t timestamp_ns; // CLOCK_REALTIME
 } go_nogo_status_t;
 
 #endif // SLS_TYPES_H
@@ -5,6 +5,7 @@
 
 #include "qnx_mock.h"
 #include "sls_utils.h"
+#include "sls_alloc.h"
 #include "sls_config.h"
 #include "sls_logging.h"
 #include <stdio.h>
@@ -66,29 +67,27 @@ double sls_time_to_double(const struct timespec *ts)
  */
 void sls_double_to_time(double seconds, struct timespec *ts)
 {
-    ts->tv_sec = (time_t)seconds;
-    ts->tv_nsec = (long)((seconds - (double)ts->tv_sec) * 1000000000.0);
+    sls_time_to_timespec(sls_time_from_seconds(seconds), ts);
 }
 
 /**
  * @brief Calculate time difference in seconds
+ *
+ * Subtracts in integer nanoseconds first, so the result keeps full
+ * precision however far the operands are from the epoch.
  */
 double sls_time_diff(const struct timespec *start, const struct timespec *end)
 {
-    return sls_time_to_double(end) - sls_time_to_double(start);
+    return sls_time_to_seconds(sls_time_from_timespec(end) - sls_time_from_timespec(start));
 }
 
 /**
- * @brief Add milliseconds to timespec
+ * @brief Add milliseconds (possibly negative) to timespec
  */
 void sls_time_add_ms(struct timespec *ts, long milliseconds)
 {
-    ts->tv_nsec += milliseconds * 1000000L;
-    if (ts->tv_nsec >= 1000000000L)
-    {
-        ts->tv_sec += ts->tv_nsec / 1000000000L;
-        ts->tv_nsec %= 1000000000L;
-    }
+    sls_time_to_timespec(sls_time_from_timespec(ts) + (sls_time_ns_t)milliseconds * SLS_NS_PER_MS,
+                         ts);
 }
 
 /**
@@ -305,10 +304,8 @@ bool sls_validate_telemetry_point(const telemetry_point_t *point)
     }
 
     // Check timestamp is reasonable (not too old or in future)
-    struct timespec now;
-    clock_gettime(CLOCK_REALTIME, &now);
-    double age = sls_time_diff(&point->timestamp, &now);
-    if (age > 10.0 || age < -1.0)
+    sls_time_ns_t age = sls_time_realtime_ns() - point->timestamp_ns;
+    if (age > SLS_TELEMETRY_MAX_AGE_NS || age < -SLS_TELEMETRY_MAX_LEAD_NS)
     { // More than 10 seconds old or 1 second in future
         return false;
     }
@@ -316,6 +313,73 @@ bool sls_validate_telemetry_point(const telemetry_point_t *point)
     return true;
 }
 
+// Four lanes per operation: two SSE2 or one AVX register, or NEON pairs
+typedef double sls_v4d_t __attribute__((vector_size(32)));
+typedef int64_t sls_v4i_t __attribute__((vector_size(32)));
+typedef uint64_t sls_v4u_t __attribute__((vector_size(32)));
+
+// SSE2 has no 64-bit integer compare, so x86-64 hosts also get an AVX2 build
+// of the batch validator, picked at load time
+#if defined(__x86_64__) && defined(__linux__) && defined(__GNUC__)
+#define SLS_BATCH_TARGETS __attribute__((target_clones("avx2", "default")))
+#else
+#define SLS_BATCH_TARGETS
+#endif
+
+/**
+ * @brief Validate a batch of points in structure-of-arrays form
+ */
+SLS_BATCH_TARGETS
+size_t sls_validate_telemetry_batch(const double *values, const double *min_values,
+                                    const double *max_values, const sls_time_ns_t *timestamps_ns,
+                                    size_t count, sls_time_ns_t now_ns, uint64_t *valid_mask)
+{
+    const sls_v4i_t now = {now_ns, now_ns, now_ns, now_ns};
+    const sls_v4i_t max_age = {SLS_TELEMETRY_MAX_AGE_NS, SLS_TELEMETRY_MAX_AGE_NS,
+                               SLS_TELEMETRY_MAX_AGE_NS, SLS_TELEMETRY_MAX_AGE_NS};
+    const sls_v4i_t max_lead = -(sls_v4i_t){SLS_TELEMETRY_MAX_LEAD_NS, SLS_TELEMETRY_MAX_LEAD_NS,
+                                            SLS_TELEMETRY_MAX_LEAD_NS, SLS_TELEMETRY_MAX_LEAD_NS};
+    const sls_v4i_t lane_bit = {1, 2, 4, 8};
+    size_t valid = 0;
+
+    // One mask word per 64 points; the compares leave each lane all ones or zero
+    for (size_t base = 0; base < count; base += 64)
+    {
+        size_t n = count - base < 64 ? count - base : 64;
+        uint64_t word = 0;
+        size_t i = 0;
+
+        for (; i + 4 <= n; i += 4)
+        {
+            sls_v4d_t v, lo, hi;
+            sls_v4i_t ts;
+            memcpy(&v, values + base + i, sizeof(v));
+            memcpy(&lo, min_values + base + i, sizeof(lo));
+            memcpy(&hi, max_values + base + i, sizeof(hi));
+            memcpy(&ts, timestamps_ns + base + i, sizeof(ts));
+
+            // Ages wrap modulo 2^64 in both loops: no signed overflow, and the
+            // tail below agrees with the lanes on out-of-range timestamps
+            sls_v4i_t age = (sls_v4i_t)((sls_v4u_t)now - (sls_v4u_t)ts);
+            sls_v4i_t ok = (v >= lo) & (v <= hi) & (age <= max_age) & (age >= max_lead);
+            ok &= lane_bit;
+            word |= (uint64_t)(ok[0] | ok[1] | ok[2] | ok[3]) << i;
+        }
+        for (; i < n; i++)
+        {
+            size_t k = base + i;
+            sls_time_ns_t age = (sls_time_ns_t)((uint64_t)now_ns - (uint64_t)timestamps_ns[k]);
+            bool ok = values[k] >= min_values[k] && values[k] <= max_values[k] &&
+                      age <= SLS_TELEMETRY_MAX_AGE_NS && age >= -SLS_TELEMETRY_MAX_LEAD_NS;
+            word |= (uint64_t)ok << i;
+        }
+
+        valid_mask[base / 64] = word;
+        valid += (size_t)__builtin_popcountll(word);
+    }
+    return valid;
+}
+
 /**
  * @brief Validate sensor data
  */
@@ -384,12 +448,7 @@ bool sls_validate_vehicle_state(const vehicle_state_t *state)
  */
 void *sls_safe_malloc(size_t size)
 {
-    void *ptr = malloc(size);
-    if (!ptr && size > 0)
-    {
-        sls_log(LOG_LEVEL_ERROR, "UTILS", "Failed to allocate %zu bytes", size);
-    }
-    return ptr;
+    return sls_alloc(SLS_ALLOC_CORE, size); // logs failures
 }
 
 /**
@@ -397,12 +456,7 @@ void *sls_safe_malloc(size_t size)
  */
 void *sls_safe_calloc(size_t count, size_t size)
 {
-    void *ptr = calloc(count, size);
-    if (!ptr && count > 0 && size > 0)
-    {
-        sls_log(LOG_LEVEL_ERROR, "UTILS", "Failed to allocate %zu * %zu bytes", count, size);
-    }
-    return ptr;
+    return sls_calloc(SLS_ALLOC_CORE, count, size);
 }
 
 /**
@@ -412,7 +466,7 @@ void sls_safe_free(void **ptr)
 {
     if (ptr && *ptr)
     {
-        free(*ptr);
+        sls_free(*ptr);
         *ptr = NULL;
     }
 }
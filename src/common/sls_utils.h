@@ -14,7 +14,7 @@
 int sls_utils_init(void);
 void sls_utils_cleanup(void);
 
-// Time utilities
+// Time utilities (timespec); new code uses sls_time_ns_t from sls_time.h
 double sls_time_to_double(const struct timespec *ts);
 void sls_double_to_time(double seconds, struct timespec *ts);
 double sls_time_diff(const struct timespec *start, const struct timespec *end);
@@ -39,13 +39,29 @@ bool sls_simulate_sensor_fault(double fault_probability);
 double sls_apply_sensor_calibration(double raw_value, double offset, double scale);
 
 // Data validation
+#define SLS_TELEMETRY_MAX_AGE_NS 10000000000LL // older points are stale
+#define SLS_TELEMETRY_MAX_LEAD_NS 1000000000LL // further in the future is a bad clock
 bool sls_validate_telemetry_point(const telemetry_point_t *point);
+
+/**
+ * Validate count points held as parallel arrays (replay, ground-side ingest).
+ * A point is valid if min <= value <= max (NaN fails) and its CLOCK_REALTIME
+ * timestamp (ns) is within the same age limits as sls_validate_telemetry_point
+ * relative to now_ns, read once by the caller for the whole batch. Bit i of
+ * valid_mask (ceil(count / 64) words) is set if point i is valid.
+ * Returns the number of valid points.
+ */
+size_t sls_validate_telemetry_batch(const double *values, const double *min_values,
+                                    const double *max_values, const sls_time_ns_t *timestamps_ns,
+                                    size_t count, sls_time_ns_t now_ns, uint64_t *valid_mask);
 bool sls_validate_sensor_data(const sensor_data_t *sensor);
 bool sls_validate_vehicle_state(const vehicle_state_t *state);
 
 // Global system state access (for simulation)
 mission_phase_t sls_get_current_mission_phase(void);
 double sls_get_mission_time(void);
+void sls_request_mission_abort(const char *reason);
+bool sls_shutdown_requested(void);
 
 // Configuration utilities
 int sls_load_config_file(const char *filename);
@@ -53,7 +69,7 @@ int sls_get_config_int(const char *key, int default_value);
 double sls_get_config_double(const char *key, double default_value);
 const char *sls_get_config_string(const char *key, const char *default_value);
 
-// Memory utilities
+// Memory utilities (accounted as SLS_ALLOC_CORE, see sls_alloc.h)
 void *sls_safe_malloc(size_t size);
 void *sls_safe_calloc(size_t count, size_t size);
 void sls_safe_free(void **ptr);
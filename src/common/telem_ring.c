@@ -0,0 +1,282 @@
+/**
+ * @file telem_ring.c
+ * @brief Single-producer, multi-consumer telemetry record ring
+ *
+ * Readers validate like a seqlock: the writer first invalidates the
+ * descriptor it is about to reuse and publishes the byte range it is about
+ * to overwrite (reserved), then copies the record. A reader copies a record
+ * and afterwards checks that the descriptor still carries the same record
+ * number and that reserved has not advanced over the record's bytes; if
+ * either changed the copy is discarded and the record counted as lost.
+ */
+
+#include "telem_ring.h"
+
+#include <string.h>
+
+_Static_assert((TELEM_RING_DATA_SIZE & (TELEM_RING_DATA_SIZE - 1)) == 0,
+               "telemetry ring data size must be a power of two");
+_Static_assert((TELEM_RING_RECORDS & (TELEM_RING_RECORDS - 1)) == 0,
+               "telemetry ring record count must be a power of two");
+_Static_assert(TELEM_RING_MAX_RECORD <= TELEM_RING_DATA_SIZE / 4,
+               "telemetry records must be small relative to the ring");
+
+#define DATA_MASK ((uint64_t)TELEM_RING_DATA_SIZE - 1)
+#define DESC_MASK ((uint64_t)TELEM_RING_RECORDS - 1)
+
+void telem_ring_init(telem_ring_t *ring)
+{
+    memset(ring, 0, sizeof(*ring));
+}
+
+int telem_ring_append(telem_ring_t *ring, const void *rec, size_t len)
+{
+    if (len == 0 || len > TELEM_RING_MAX_RECORD)
+    {
+        return -1;
+    }
+
+    // Keep the record contiguous: skip the tail of the area if it won't fit
+    uint64_t pos = ring->wpos;
+    uint64_t off = pos & DATA_MASK;
+    if (off + len > TELEM_RING_DATA_SIZE)
+    {
+        pos += TELEM_RING_DATA_SIZE - off;
+    }
+    uint64_t end = pos + len;
+
+    uint64_t n = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    telem_ring_desc_t *d = &ring->desc[n & DESC_MASK];
+
+    // Invalidate before overwriting anything a reader may be copying
+    atomic_store_explicit(&d->seq, 0, memory_order_relaxed);
+    atomic_store_explicit(&ring->reserved, end, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    memcpy(ring->data + (pos & DATA_MASK), rec, len);
+    atomic_store_explicit(&d->pos, pos, memory_order_relaxed);
+    atomic_store_explicit(&d->len, (uint32_t)len, memory_order_relaxed);
+    atomic_store_explicit(&d->seq, n + 1, memory_order_release);
+    atomic_store_explicit(&ring->head, n + 1, memory_order_release);
+    ring->wpos = end;
+    return 0;
+}
+
+// Whether record n is still published in its descriptor with its bytes intact
+static int record_intact(const telem_ring_t *ring, uint64_t n, uint64_t pos)
+{
+    const telem_ring_desc_t *d = &ring->desc[n & DESC_MASK];
+    return atomic_load_explicit(&d->seq, memory_order_relaxed) == n + 1 &&
+           atomic_load_explicit(&ring->reserved, memory_order_relaxed) - pos <=
+               TELEM_RING_DATA_SIZE;
+}
+
+void telem_cursor_init(const telem_ring_t *ring, telem_cursor_t *cur, int from_oldest)
+{
+    uint64_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    memset(cur, 0, sizeof(*cur));
+    cur->next = head;
+    if (!from_oldest)
+    {
+        return;
+    }
+
+    // Oldest record whose descriptor and bytes have not been reused; once
+    // one is intact every later one is too
+    uint64_t n = head > TELEM_RING_RECORDS ? head - TELEM_RING_RECORDS : 0;
+    for (; n < head; n++)
+    {
+        const telem_ring_desc_t *d = &ring->desc[n & DESC_MASK];
+        if (atomic_load_explicit(&d->seq, memory_order_acquire) == n + 1 &&
+            record_intact(ring, n, atomic_load_explicit(&d->pos, memory_order_relaxed)))
+        {
+            break;
+        }
+    }
+    cur->next = n;
+}
+
+size_t telem_ring_read(const telem_ring_t *ring, telem_cursor_t *cur, void *buf, size_t len)
+{
+    char *out = buf;
+    size_t got = 0;
+
+    while (got < len)
+    {
+        uint64_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        if (cur->next >= head)
+        {
+            break;
+        }
+        if (head - cur->next > TELEM_RING_RECORDS)
+        {
+            // Descriptors already reused: jump to the oldest that may survive
+            cur->lost += head - TELEM_RING_RECORDS - cur->next;
+            cur->next = head - TELEM_RING_RECORDS;
+            cur->offset = 0;
+        }
+
+        const telem_ring_desc_t *d = &ring->desc[cur->next & DESC_MASK];
+        if (atomic_load_explicit(&d->seq, memory_order_acquire) != cur->next + 1)
+        {
+            cur->lost++;
+            cur->next++;
+            cur->offset = 0;
+            continue;
+        }
+        uint64_t pos = atomic_load_explicit(&d->pos, memory_order_relaxed);
+        uint32_t rec_len = atomic_load_explicit(&d->len, memory_order_relaxed);
+        if (cur->offset >= rec_len)
+        {
+            cur->offset = 0; // cannot happen unless the record was replaced
+        }
+
+        size_t n = rec_len - cur->offset;
+        if (n > len - got)
+        {
+            n = len - got;
+        }
+        memcpy(out + got, ring->data + ((pos + cur->offset) & DATA_MASK), n);
+        atomic_thread_fence(memory_order_acquire);
+        if (!record_intact(ring, cur->next, pos))
+        {
+            // Overwritten while copying: drop what was copied of it
+            cur->lost++;
+            cur->next++;
+            cur->offset = 0;
+            continue;
+        }
+
+        got += n;
+        cur->offset += (uint32_t)n;
+        if (cur->offset == rec_len)
+        {
+            cur->next++;
+            cur->offset = 0;
+        }
+    }
+    return got;
+}
+
+size_t telem_ring_peek(const telem_ring_t *ring, const telem_cursor_t *cur, size_t len,
+                       size_t slack, telem_ring_span_t *span)
+{
+    memset(span, 0, sizeof(*span));
+    telem_cursor_t c = *cur;
+    uint64_t end = 0; // byte position following the last byte in the span
+    size_t got = 0;
+
+    while (got < len)
+    {
+        uint64_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        if (c.next >= head)
+        {
+            break;
+        }
+        if (head - c.next > TELEM_RING_RECORDS)
+        {
+            if (span->nseg > 0)
+            {
+                break; // overrun behind a span already started
+            }
+            c.lost += head - TELEM_RING_RECORDS - c.next;
+            c.next = head - TELEM_RING_RECORDS;
+            c.offset = 0;
+        }
+
+        const telem_ring_desc_t *d = &ring->desc[c.next & DESC_MASK];
+        if (atomic_load_explicit(&d->seq, memory_order_acquire) != c.next + 1)
+        {
+            if (span->nseg > 0)
+            {
+                break;
+            }
+            c.lost++;
+            c.next++;
+            c.offset = 0;
+            continue;
+        }
+        uint64_t pos = atomic_load_explicit(&d->pos, memory_order_relaxed);
+        uint32_t rec_len = atomic_load_explicit(&d->len, memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&d->seq, memory_order_relaxed) != c.next + 1)
+        {
+            continue; // descriptor reused under us; the check above skips it
+        }
+        if (c.offset >= rec_len)
+        {
+            c.offset = 0;
+        }
+        uint64_t from = pos + c.offset;
+        if (span->nseg == 0)
+        {
+            uint64_t reserved = atomic_load_explicit(&ring->reserved, memory_order_relaxed);
+            if (reserved - from + slack > TELEM_RING_DATA_SIZE)
+            {
+                break; // too close to the writer for a zero-copy reply
+            }
+            span->start = from;
+        }
+
+        size_t n = rec_len - c.offset;
+        if (n > len - got)
+        {
+            n = len - got;
+        }
+        if (span->nseg > 0 && from == end)
+        {
+            span->seg[span->nseg - 1].len += n; // records are back to back
+        }
+        else if (span->nseg < 2)
+        {
+            span->seg[span->nseg].base = ring->data + (from & DATA_MASK);
+            span->seg[span->nseg].len = n;
+            span->nseg++;
+        }
+        else
+        {
+            break;
+        }
+        end = from + n;
+        got += n;
+        c.offset += (uint32_t)n;
+        if (c.offset == rec_len)
+        {
+            c.next++;
+            c.offset = 0;
+        }
+    }
+
+    if (got == 0)
+    {
+        memset(span, 0, sizeof(*span));
+        return 0;
+    }
+    span->after = c;
+    return got;
+}
+
+int telem_ring_commit(const telem_ring_t *ring, telem_cursor_t *cur, const telem_ring_span_t *span)
+{
+    if (span->nseg == 0)
+    {
+        return 0;
+    }
+    atomic_thread_fence(memory_order_acquire);
+    int intact = atomic_load_explicit(&ring->reserved, memory_order_relaxed) - span->start <=
+                 TELEM_RING_DATA_SIZE;
+    uint64_t skipped = span->after.next - cur->next;
+    *cur = span->after;
+    if (!intact)
+    {
+        cur->lost += skipped;
+        return -1;
+    }
+    return 0;
+}
+
+uint64_t telem_ring_pending(const telem_ring_t *ring, const telem_cursor_t *cur)
+{
+    uint64_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    return head > cur->next ? head - cur->next : 0;
+}
@@ -0,0 +1,149 @@
+#ifndef TELEM_RING_H
+#define TELEM_RING_H
+
+/**
+ * @file telem_ring.h
+ * @brief Single-producer, multi-consumer telemetry record ring
+ *
+ * Backs /dev/sls_telemetry (qnx/rmgr_telemetry.c). The simulation loop
+ * appends whole records (one telemetry line each) with a single memcpy;
+ * any number of readers follow with their own cursor and never block or
+ * slow the writer. Records are stored contiguously in a byte area (the
+ * writer skips to the start rather than split one across the end) and
+ * located through a ring of descriptors stamped with the record number.
+ *
+ * A reader that falls more than the ring's capacity behind loses the
+ * oldest records: the cursor skips to the oldest record still intact and
+ * counts what it missed in telem_cursor_t::lost. Records are never
+ * returned torn.
+ *
+ * Portable C11 (stdatomic), so the same code runs in the QNX resource
+ * manager, the unit tests and bench/bench_telem_ring.c.
+ */
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TELEM_RING_DATA_SIZE 65536 // record bytes (power of 2)
+#define TELEM_RING_RECORDS 4096    // descriptors (power of 2): data-bound for records >= 16 bytes
+#define TELEM_RING_MAX_RECORD 512  // bytes per record
+
+/**
+ * @brief Record descriptor
+ *
+ * seq is the record number + 1 once the record is published and 0 while
+ * the slot is being rewritten, so a reader can tell a stale descriptor
+ * from the one it is looking for.
+ */
+typedef struct
+{
+    _Atomic uint64_t seq;
+    _Atomic uint64_t pos; // monotonic byte position of the record
+    _Atomic uint32_t len;
+} telem_ring_desc_t;
+
+/**
+ * @brief Ring state; zero-initialised storage is an empty ring
+ */
+typedef struct
+{
+    _Alignas(64) _Atomic uint64_t head; // records published
+    _Atomic uint64_t reserved;          // end of the bytes being written (monotonic)
+    uint64_t wpos;                      // writer only: next byte position
+    _Alignas(64) telem_ring_desc_t desc[TELEM_RING_RECORDS];
+    _Alignas(64) char data[TELEM_RING_DATA_SIZE];
+} telem_ring_t;
+
+/**
+ * @brief Per-reader position
+ */
+typedef struct
+{
+    uint64_t next;   // record number to read next
+    uint32_t offset; // bytes of that record already returned
+    uint64_t lost;   // records overwritten before this reader got to them
+} telem_cursor_t;
+
+/**
+ * @brief Bytes after a cursor as at most two ranges of ring memory
+ *
+ * Filled by telem_ring_peek() so a server can reply straight from the ring
+ * (e.g. MsgReplyv with two iovs when the range crosses the end of the data
+ * area) and then advance the cursor with telem_ring_commit().
+ */
+typedef struct
+{
+    struct
+    {
+        const char *base;
+        size_t len;
+    } seg[2];
+    int nseg;
+    uint64_t start;       // byte position of the first byte
+    telem_cursor_t after; // cursor once the bytes are consumed
+} telem_ring_span_t;
+
+/**
+ * @brief Reset a ring to empty (not safe against concurrent readers)
+ */
+void telem_ring_init(telem_ring_t *ring);
+
+/**
+ * @brief Append one record; single writer
+ * @return 0 on success, -1 if len is 0 or above TELEM_RING_MAX_RECORD
+ */
+int telem_ring_append(telem_ring_t *ring, const void *rec, size_t len);
+
+/**
+ * @brief Position a new cursor
+ * @param from_oldest Non-zero to start at the oldest intact record,
+ *                    zero to return only records appended from now on
+ */
+void telem_cursor_init(const telem_ring_t *ring, telem_cursor_t *cur, int from_oldest);
+
+/**
+ * @brief Copy records after the cursor into buf and advance it
+ *
+ * Whole records are copied while they fit. A record larger than the space
+ * left is split across calls (the cursor remembers the offset), so any
+ * read size makes progress.
+ *
+ * @return Bytes copied, 0 if nothing new
+ */
+size_t telem_ring_read(const telem_ring_t *ring, telem_cursor_t *cur, void *buf, size_t len);
+
+/**
+ * @brief Locate up to len bytes after the cursor without copying
+ *
+ * Returns 0 (and leaves the span empty) if nothing is pending or if the
+ * writer would reach the first byte within slack more appended bytes; the
+ * caller then falls back to telem_ring_read(). With a generous slack the
+ * writer cannot lap the span while it is being sent.
+ *
+ * @return Bytes covered by the span
+ */
+size_t telem_ring_peek(const telem_ring_t *ring, const telem_cursor_t *cur, size_t len,
+                       size_t slack, telem_ring_span_t *span);
+
+/**
+ * @brief Advance the cursor past a span returned by telem_ring_peek()
+ * @return 0 if the bytes were still intact, -1 if the writer overwrote
+ *         them in the meantime (the span's records are counted as lost)
+ */
+int telem_ring_commit(const telem_ring_t *ring, telem_cursor_t *cur, const telem_ring_span_t *span);
+
+/**
+ * @brief Records published after the cursor (lost ones included)
+ */
+uint64_t telem_ring_pending(const telem_ring_t *ring, const telem_cursor_t *cur);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TELEM_RING_H
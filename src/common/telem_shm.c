@@ -0,0 +1,247 @@
+/**
+ * @file telem_shm.c
+ * @brief Telemetry exported as a read-only shared-memory object
+ */
+
+#include "telem_shm.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+_Static_assert((TELEM_SHM_HISTORY & (TELEM_SHM_HISTORY - 1)) == 0,
+               "telemetry history length must be a power of two");
+_Static_assert(sizeof(telem_shm_value_t) == 64, "one value cell per cache line");
+
+#define VALUES_OFFSET ((sizeof(telem_shm_header_t) + 63) & ~(size_t)63)
+#define HISTORY_OFFSET (VALUES_OFFSET + TELEM_SHM_CHANNELS * sizeof(telem_shm_value_t))
+#define TOTAL_SIZE (HISTORY_OFFSET + TELEM_SHM_HISTORY * sizeof(telem_shm_sample_t))
+
+static void set_sections(telem_shm_t *shm)
+{
+    char *base = (char *)shm->hdr;
+    shm->values = (telem_shm_value_t *)(base + shm->hdr->values_offset);
+    shm->history = (telem_shm_sample_t *)(base + shm->hdr->history_offset);
+}
+
+int telem_shm_create(telem_shm_t *shm, const char *name, const telem_shm_channel_t *channels,
+                     int num_channels)
+{
+    memset(shm, 0, sizeof(*shm));
+    if (num_channels < 1 || num_channels > TELEM_SHM_CHANNELS)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    shm_unlink(name); // stale export from a previous run
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    if (ftruncate(fd, (off_t)TOTAL_SIZE) != 0)
+    {
+        int err = errno;
+        close(fd);
+        shm_unlink(name);
+        errno = err;
+        return -1;
+    }
+    void *base = mmap(NULL, TOTAL_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+    {
+        int err = errno;
+        shm_unlink(name);
+        errno = err;
+        return -1;
+    }
+
+    telem_shm_header_t *hdr = base;
+    memset(hdr, 0, TOTAL_SIZE);
+    hdr->version_major = TELEM_SHM_VERSION_MAJOR;
+    hdr->version_minor = TELEM_SHM_VERSION_MINOR;
+    hdr->header_size = sizeof(*hdr);
+    hdr->total_size = (uint32_t)TOTAL_SIZE;
+    hdr->num_channels = (uint32_t)num_channels;
+    hdr->values_offset = (uint32_t)VALUES_OFFSET;
+    hdr->history_offset = (uint32_t)HISTORY_OFFSET;
+    hdr->history_len = TELEM_SHM_HISTORY;
+    hdr->writer_pid = (int32_t)getpid();
+    for (int i = 0; i < num_channels; i++)
+    {
+        snprintf(hdr->channels[i].name, sizeof(hdr->channels[i].name), "%s", channels[i].name);
+        snprintf(hdr->channels[i].unit, sizeof(hdr->channels[i].unit), "%s", channels[i].unit);
+    }
+    atomic_store_explicit(&hdr->magic, TELEM_SHM_MAGIC, memory_order_release);
+
+    shm->hdr = hdr;
+    shm->size = TOTAL_SIZE;
+    shm->writer = 1;
+    snprintf(shm->name, sizeof(shm->name), "%s", name);
+    set_sections(shm);
+    return 0;
+}
+
+void telem_shm_publish(telem_shm_t *shm, const double *values, int64_t timestamp_ns)
+{
+    telem_shm_header_t *hdr = shm->hdr;
+    int n = (int)hdr->num_channels;
+
+    for (int i = 0; i < n; i++)
+    {
+        telem_shm_value_t *v = &shm->values[i];
+        uint32_t seq = atomic_load_explicit(&v->seq, memory_order_relaxed);
+        atomic_store_explicit(&v->seq, seq + 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        v->timestamp_ns = timestamp_ns;
+        v->value = values[i];
+        v->updates++;
+        atomic_store_explicit(&v->seq, seq + 2, memory_order_release);
+    }
+
+    uint64_t head = atomic_load_explicit(&hdr->history_head, memory_order_relaxed);
+    telem_shm_sample_t *s = &shm->history[head & (TELEM_SHM_HISTORY - 1)];
+    atomic_store_explicit(&s->seq, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    s->timestamp_ns = timestamp_ns;
+    memcpy(s->values, values, (size_t)n * sizeof(values[0]));
+    atomic_store_explicit(&s->seq, head + 1, memory_order_release);
+    atomic_store_explicit(&hdr->history_head, head + 1, memory_order_release);
+}
+
+int telem_shm_open(telem_shm_t *shm, const char *name)
+{
+    memset(shm, 0, sizeof(*shm));
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(telem_shm_header_t))
+    {
+        close(fd);
+        errno = EPROTO;
+        return -1;
+    }
+    void *base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+    {
+        return -1;
+    }
+
+    telem_shm_header_t *hdr = base;
+    if (atomic_load_explicit(&hdr->magic, memory_order_acquire) != TELEM_SHM_MAGIC ||
+        hdr->version_major != TELEM_SHM_VERSION_MAJOR || hdr->total_size > (size_t)st.st_size ||
+        hdr->num_channels > TELEM_SHM_CHANNELS ||
+        hdr->values_offset + TELEM_SHM_CHANNELS * sizeof(telem_shm_value_t) > hdr->total_size ||
+        hdr->history_offset + (size_t)hdr->history_len * sizeof(telem_shm_sample_t) >
+            hdr->total_size ||
+        hdr->history_len == 0 || (hdr->history_len & (hdr->history_len - 1)) != 0)
+    {
+        munmap(base, (size_t)st.st_size);
+        errno = EPROTO;
+        return -1;
+    }
+
+    shm->hdr = hdr;
+    shm->size = (size_t)st.st_size;
+    snprintf(shm->name, sizeof(shm->name), "%s", name);
+    set_sections(shm);
+    return 0;
+}
+
+void telem_shm_close(telem_shm_t *shm)
+{
+    if (!shm->hdr)
+    {
+        return;
+    }
+    munmap(shm->hdr, shm->size);
+    if (shm->writer)
+    {
+        shm_unlink(shm->name);
+    }
+    memset(shm, 0, sizeof(*shm));
+}
+
+int telem_shm_find(const telem_shm_t *shm, const char *channel)
+{
+    for (uint32_t i = 0; i < shm->hdr->num_channels; i++)
+    {
+        if (strncmp(shm->hdr->channels[i].name, channel, TELEM_SHM_NAME_LEN) == 0)
+        {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+int telem_shm_read(const telem_shm_t *shm, int channel, double *value, int64_t *timestamp_ns)
+{
+    if (channel < 0 || (uint32_t)channel >= shm->hdr->num_channels)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+    const telem_shm_value_t *v = &shm->values[channel];
+    for (int attempt = 0; attempt < TELEM_SHM_READ_RETRIES; attempt++)
+    {
+        if (attempt >= TELEM_SHM_READ_SPINS)
+        {
+            sched_yield(); // let a preempted writer finish
+        }
+        uint32_t s1 = atomic_load_explicit(&v->seq, memory_order_acquire);
+        if (s1 & 1u)
+        {
+            continue;
+        }
+        double val = v->value;
+        int64_t ts = v->timestamp_ns;
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&v->seq, memory_order_relaxed) == s1)
+        {
+            *value = val;
+            if (timestamp_ns)
+            {
+                *timestamp_ns = ts;
+            }
+            return 0;
+        }
+    }
+
+    // The writer died mid-update (or is stalled): the cell stays odd
+    errno = EAGAIN;
+    return -1;
+}
+
+uint64_t telem_shm_history_head(const telem_shm_t *shm)
+{
+    return atomic_load_explicit(&shm->hdr->history_head, memory_order_acquire);
+}
+
+int telem_shm_history_get(const telem_shm_t *shm, uint64_t n, telem_shm_sample_t *out)
+{
+    const telem_shm_sample_t *s = &shm->history[n & (shm->hdr->history_len - 1)];
+    if (atomic_load_explicit(&s->seq, memory_order_acquire) != n + 1)
+    {
+        return -1;
+    }
+    out->timestamp_ns = s->timestamp_ns;
+    memcpy(out->values, s->values, sizeof(out->values));
+    atomic_thread_fence(memory_order_acquire);
+    if (atomic_load_explicit(&s->seq, memory_order_relaxed) != n + 1)
+    {
+        return -1;
+    }
+    atomic_store_explicit(&out->seq, n + 1, memory_order_relaxed);
+    return 0;
+}
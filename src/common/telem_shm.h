@@ -0,0 +1,170 @@
+#ifndef TELEM_SHM_H
+#define TELEM_SHM_H
+
+/**
+ * @file telem_shm.h
+ * @brief Telemetry exported as a read-only shared-memory object
+ *
+ * The simulator publishes the latest value of every telemetry channel and
+ * a history ring of per-tick snapshots into a POSIX shared-memory object
+ * (TELEM_SHM_NAME). Local displays and analysis tools mmap it read-only
+ * and read values with no syscalls and no formatting or parsing: each
+ * channel has its own seqlock, and history samples are stamped with their
+ * sample number so a reader can tell a sample it has lost to wrap-around
+ * from one it is still allowed to use.
+ *
+ * Layout: a versioned header, then TELEM_SHM_CHANNELS value cells (one
+ * cache line each), then the history ring. Readers locate the sections
+ * through the offsets in the header, so fields appended in later minor
+ * versions do not break them; a different major version is rejected.
+ */
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TELEM_SHM_NAME "/sls_telemetry"
+#define TELEM_SHM_MAGIC 0x534c5354U // "SLST"
+#define TELEM_SHM_VERSION_MAJOR 1
+#define TELEM_SHM_VERSION_MINOR 0
+#define TELEM_SHM_CHANNELS 16      // channel cells in the table
+#define TELEM_SHM_HISTORY 1024     // samples in the history ring (power of 2)
+#define TELEM_SHM_NAME_LEN 24
+#define TELEM_SHM_UNIT_LEN 8
+#define TELEM_SHM_READ_SPINS 1024   // telem_shm_read retries before yielding
+#define TELEM_SHM_READ_RETRIES 4096 // then it fails with EAGAIN
+
+/**
+ * @brief Channel description as published in the header
+ */
+typedef struct
+{
+    char name[TELEM_SHM_NAME_LEN];
+    char unit[TELEM_SHM_UNIT_LEN];
+} telem_shm_channel_t;
+
+/**
+ * @brief Layout header at offset 0
+ *
+ * magic is stored last, so a reader that sees it also sees the rest.
+ */
+typedef struct
+{
+    _Atomic uint32_t magic;
+    uint16_t version_major;
+    uint16_t version_minor;
+    uint32_t header_size;    // sizeof(telem_shm_header_t) of the writer
+    uint32_t total_size;
+    uint32_t num_channels;   // channels in use
+    uint32_t values_offset;  // telem_shm_value_t[TELEM_SHM_CHANNELS]
+    uint32_t history_offset; // telem_shm_sample_t[history_len]
+    uint32_t history_len;
+    int32_t writer_pid;
+    uint32_t reserved0;
+    _Atomic uint64_t history_head; // samples published
+    telem_shm_channel_t channels[TELEM_SHM_CHANNELS];
+} telem_shm_header_t;
+
+/**
+ * @brief Latest value of one channel; seq is odd while it is being written
+ */
+typedef struct
+{
+    _Alignas(64) _Atomic uint32_t seq;
+    uint32_t reserved0;
+    int64_t timestamp_ns; // CLOCK_REALTIME
+    double value;
+    uint64_t updates;
+} telem_shm_value_t;
+
+/**
+ * @brief One history entry: every channel at one tick
+ *
+ * seq is the sample number + 1 once published and 0 while the entry is
+ * being rewritten.
+ */
+typedef struct
+{
+    _Atomic uint64_t seq;
+    int64_t timestamp_ns;
+    double values[TELEM_SHM_CHANNELS];
+} telem_shm_sample_t;
+
+/**
+ * @brief A mapping of the export (writer or reader side)
+ */
+typedef struct
+{
+    telem_shm_header_t *hdr;
+    telem_shm_value_t *values;
+    telem_shm_sample_t *history;
+    size_t size;
+    int writer;
+    char name[64];
+} telem_shm_t;
+
+/**
+ * @brief Create (or replace) the export and describe its channels
+ * @param name Shared-memory object name, e.g. TELEM_SHM_NAME
+ * @return 0 on success, -1 with errno set
+ */
+int telem_shm_create(telem_shm_t *shm, const char *name, const telem_shm_channel_t *channels,
+                     int num_channels);
+
+/**
+ * @brief Publish one tick: every channel's latest value and a history sample
+ *
+ * Single writer. values holds num_channels entries in channel order.
+ */
+void telem_shm_publish(telem_shm_t *shm, const double *values, int64_t timestamp_ns);
+
+/**
+ * @brief Map an existing export read-only
+ * @return 0 on success, -1 with errno set (ENOENT if there is no export,
+ *         EPROTO if the layout version is not understood)
+ */
+int telem_shm_open(telem_shm_t *shm, const char *name);
+
+/**
+ * @brief Unmap; the writer also removes the object
+ */
+void telem_shm_close(telem_shm_t *shm);
+
+/**
+ * @brief Channel index for a name, or -1
+ */
+int telem_shm_find(const telem_shm_t *shm, const char *channel);
+
+/**
+ * @brief Consistent snapshot of a channel's latest value
+ *
+ * Retries while the writer is mid-update: TELEM_SHM_READ_SPINS times
+ * back to back, then yielding, up to TELEM_SHM_READ_RETRIES in all. A
+ * writer that died mid-update leaves the cell unreadable, so the reader
+ * gives up instead of spinning forever.
+ * @return 0 on success, -1 with errno EINVAL for a bad channel index or
+ *         EAGAIN if no consistent value was seen within the retry limit
+ */
+int telem_shm_read(const telem_shm_t *shm, int channel, double *value, int64_t *timestamp_ns);
+
+/**
+ * @brief Samples published so far; the newest is number head - 1
+ */
+uint64_t telem_shm_history_head(const telem_shm_t *shm);
+
+/**
+ * @brief Copy history sample n
+ * @return 0 on success, -1 if n is not published yet or already overwritten
+ */
+int telem_shm_history_get(const telem_shm_t *shm, uint64_t n, telem_shm_sample_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TELEM_SHM_H
@@ -0,0 +1,13 @@
+#ifndef SLS_COMPAT_SYS_NETMGR_H
+#define SLS_COMPAT_SYS_NETMGR_H
+
+// Linux stand-in for QNX <sys/netmgr.h>: ND_LOCAL_NODE.
+// Only on the include path for host builds (-Isrc/compat, MOCK_QNX_BUILD).
+
+#ifndef MOCK_QNX_BUILD
+#error "src/compat is for Linux host builds; build with -DMOCK_QNX_BUILD"
+#endif
+
+#include "../../common/qnx_mock.h"
+
+#endif // SLS_COMPAT_SYS_NETMGR_H
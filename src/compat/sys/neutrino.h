@@ -0,0 +1,13 @@
+#ifndef SLS_COMPAT_SYS_NEUTRINO_H
+#define SLS_COMPAT_SYS_NEUTRINO_H
+
+// Linux stand-in for QNX <sys/neutrino.h>: Channels, connections, MsgSend/MsgReceive/MsgReply, pulses.
+// Only on the include path for host builds (-Isrc/compat, MOCK_QNX_BUILD).
+
+#ifndef MOCK_QNX_BUILD
+#error "src/compat is for Linux host builds; build with -DMOCK_QNX_BUILD"
+#endif
+
+#include "../../common/qnx_mock.h"
+
+#endif // SLS_COMPAT_SYS_NEUTRINO_H
@@ -0,0 +1,13 @@
+#ifndef SLS_COMPAT_SYS_SIGINFO_H
+#define SLS_COMPAT_SYS_SIGINFO_H
+
+// Linux stand-in for QNX <sys/siginfo.h>: SIGEV_PULSE_INIT and pulse priorities.
+// Only on the include path for host builds (-Isrc/compat, MOCK_QNX_BUILD).
+
+#ifndef MOCK_QNX_BUILD
+#error "src/compat is for Linux host builds; build with -DMOCK_QNX_BUILD"
+#endif
+
+#include "../../common/qnx_mock.h"
+
+#endif // SLS_COMPAT_SYS_SIGINFO_H
@@ -14,20 +14,48 @@
 #include <signal.h>
 #include <errno.h>
 #include <pthread.h>
+#include <stdatomic.h>
 
 #include "common/qnx_mock.h"
 #include "common/sls_types.h"
 #include "common/sls_config.h"
 #include "common/sls_utils.h"
+#include "common/sls_config_loader.h"
+#include "common/sls_mission_config.h"
+#include "common/sls_trace.h"
+#include "common/sls_metrics.h"
+#include "common/sls_alloc.h"
 #include "common/sls_ipc.h"
 #include "common/sls_logging.h"
 #include "common/cmd_server.h"
 
+// State read across threads. Each group has one writer and its own cache
+// line, so the main loop rewriting the mission clock every tick does not
+// invalidate the line other threads poll for shutdown or abort.
+typedef struct
+{
+    // Written by the main loop only; read by every subsystem
+    _Alignas(SLS_CACHE_LINE) _Atomic double mission_time;
+    _Atomic mission_phase_t current_phase;
+    _Atomic system_state_t system_state;
+
+    // Written once by the signal handler; polled by every loop
+    _Alignas(SLS_CACHE_LINE) atomic_bool shutdown_requested;
+
+    // Written by any thread (latched, never cleared); read by the main loop
+    _Alignas(SLS_CACHE_LINE) atomic_bool abort_requested;
+} shared_state_t;
+
+static shared_state_t g_shared = {
+    .mission_time = -7200.0, // Start at T-2 hours
+    .current_phase = PHASE_PRELAUNCH,
+    .system_state = STATE_INITIALIZING,
+};
+
 // Global system state
-static volatile bool g_shutdown_requested = false;
-static volatile mission_phase_t g_current_phase = PHASE_PRELAUNCH;
-static volatile system_state_t g_system_state = STATE_INITIALIZING;
-static double g_mission_time = -7200.0; // Start at T-2 hours
+static const char *g_config_path = CONFIG_FILE_PATH;
+static sls_timeline_cursor_t g_timeline; // Main loop only
+static const char *g_trace_path = NULL;  // --trace output, if any
 
 // Thread handles for subsystems
 static pthread_t subsystem_threads[MAX_SUBSYSTEMS];
@@ -36,6 +64,7 @@ static int active_subsystems = 0;
 // Function declarations for other modules to access global state
 mission_phase_t sls_get_current_mission_phase(void);
 double sls_get_mission_time(void);
+bool sls_shutdown_requested(void);
 
 // Forward declarations
 static void signal_handler(int signum);
@@ -56,7 +85,7 @@ static void signal_handler(int signum)
     case SIGINT:
     case SIGTERM:
         printf("\n[MAIN] Shutdown signal received (%d). Initiating graceful shutdown...\n", signum);
-        g_shutdown_requested = true;
+        atomic_store(&g_shared.shutdown_requested, true);
         break;
     default:
         break;
@@ -79,6 +108,47 @@ static int initialize_system(void)
 
     sls_log(LOG_LEVEL_INFO, "MAIN", "System initialization started");
 
+    if (g_trace_path)
+    {
+        sls_trace_start();
+    }
+
+    // Load configuration; built-in defaults apply to anything it lacks
+    if (sls_config_load(g_config_path) < 0)
+    {
+        sls_log(LOG_LEVEL_WARNING, "MAIN", "Using default configuration");
+    }
+    else if (sls_config_watch_start() != 0)
+    {
+        sls_log(LOG_LEVEL_WARNING, "MAIN", "Configuration hot reload unavailable");
+    }
+    sls_mission_config_load();
+
+    // Whole-run state lives in one locked arena; without it, it comes from the heap
+    int arena_kb = sls_get_config_int("memory.arena_kb", SLS_ALLOC_ARENA_DEFAULT_KB);
+    if (arena_kb <= 0 ||
+        sls_alloc_arena_init((size_t)arena_kb * 1024, sls_get_config_int("memory.huge_pages", 1),
+                             sls_get_config_int("memory.lock", 1)) != 0)
+    {
+        sls_log(LOG_LEVEL_WARNING, "MAIN", "Startup arena unavailable, subsystem state uses the heap");
+    }
+
+    // What to do when a control loop allocates after STATE_ACTIVE
+    const char *alloc_policy = sls_get_config_string("debug.alloc_after_active", "log");
+    if (sls_alloc_set_policy_name(alloc_policy) != 0)
+    {
+        sls_log(LOG_LEVEL_WARNING, "MAIN", "Unknown debug.alloc_after_active '%s', using 'log'",
+                alloc_policy);
+    }
+
+    // Metrics for local scrapers; metrics.port = 0 turns the endpoint off
+    int metrics_port = sls_get_config_int("metrics.port", SLS_METRICS_DEFAULT_PORT);
+    if (metrics_port > 0 && sls_metrics_server_start(metrics_port) != 0)
+    {
+        sls_log(LOG_LEVEL_WARNING, "MAIN", "Metrics endpoint unavailable");
+    }
+    sls_alloc_register_metrics();
+
     // Initialize IPC system
     if (sls_ipc_init() != 0)
     {
@@ -115,9 +185,9 @@ static int start_subsystems(void)
 {
     sls_log(LOG_LEVEL_INFO, "MAIN", "Starting subsystem threads...");
 
-    // Create subsystem configuration
-    subsystem_config_t configs[] = DEFAULT_SUBSYSTEM_CONFIGS;
-    int num_configs = sizeof(configs) / sizeof(configs[0]);
+    // Threads keep a pointer to their entry, so the table must outlive them
+    int num_configs;
+    const subsystem_config_t *configs = sls_subsystem_table(&num_configs);
 
     for (int i = 0; i < num_configs && i < MAX_SUBSYSTEMS; i++)
     {
@@ -140,9 +210,9 @@ static int start_subsystems(void)
         pthread_attr_setstacksize(&attr, QNX_THREAD_STACK_SIZE);
 
         // Create subsystem thread
-        if (pthread_create(&subsystem_threads[i], &attr,
+        if (pthread_create(&subsystem_threads[active_subsystems], &attr,
                            get_subsystem_thread_func(configs[i].type),
-                           &configs[i]) != 0)
+                           (void *)&configs[i]) != 0)
         {
             sls_log(LOG_LEVEL_ERROR, "MAIN", "Failed to create thread for subsystem %s",
                     configs[i].name);
@@ -176,37 +246,39 @@ static int start_subsystems(void)
 static void update_mission_phase(void)
 {
     static mission_phase_t last_phase = PHASE_UNKNOWN;
-    phase_config_t phases[] = DEFAULT_MISSION_PHASES;
-    int num_phases = sizeof(phases) / sizeof(phases[0]);
-
-    mission_phase_t new_phase = g_current_phase;
+    mission_phase_t new_phase = sls_get_current_mission_phase();
+    double mission_time = sls_get_mission_time();
 
-    for (int i = 0; i < num_phases; i++)
+    if (atomic_load(&g_shared.abort_requested))
+    {
+        // An abort overrides the timeline for the rest of the run
+        new_phase = PHASE_ABORT;
+    }
+    else
     {
-        if (g_mission_time >= phases[i].start_time &&
-            g_mission_time < (phases[i].start_time + phases[i].duration))
+        mission_phase_t scheduled = sls_timeline_phase(&g_timeline, mission_time);
+        if (scheduled != PHASE_UNKNOWN)
         {
-            new_phase = phases[i].phase;
-            break;
+            new_phase = scheduled;
         }
     }
 
     if (new_phase != last_phase)
     {
-        g_current_phase = new_phase;
+        atomic_store_explicit(&g_shared.current_phase, new_phase, memory_order_relaxed);
         sls_log(LOG_LEVEL_INFO, "MAIN", "Mission phase changed to: %d at T%+.1f",
-                new_phase, g_mission_time);
+                new_phase, mission_time);
 
         // Broadcast phase change to all subsystems
         status_message_t phase_msg = {
             .source = SUBSYS_FLIGHT_CONTROL,
-            .state = g_system_state,
+            .state = atomic_load_explicit(&g_shared.system_state, memory_order_relaxed),
             .phase = new_phase,
             .priority = PRIORITY_HIGH,
             .error_code = 0};
         snprintf(phase_msg.message, sizeof(phase_msg.message),
                  "Mission phase changed to %d", new_phase);
-        clock_gettime(CLOCK_REALTIME, &phase_msg.timestamp);
+        phase_msg.timestamp_ns = sls_time_realtime_ns();
 
         sls_ipc_broadcast_status(&phase_msg);
         last_phase = new_phase;
@@ -219,17 +291,38 @@ static void update_mission_phase(void)
 static int main_control_loop(void)
 {
     sls_log(LOG_LEVEL_INFO, "MAIN", "Entering main control loop");
-    g_system_state = STATE_ACTIVE;
-
-    struct timespec loop_start, loop_end, sleep_time;
-    const long loop_period_ns = MAIN_LOOP_PERIOD_MS * 1000000L; // Convert to nanoseconds
-
-    while (!g_shutdown_requested)
+    atomic_store_explicit(&g_shared.system_state, STATE_ACTIVE, memory_order_relaxed);
+
+    const sls_time_ns_t loop_period_ns = MAIN_LOOP_PERIOD_MS * SLS_NS_PER_MS;
+    sls_config_handle_t time_factor;
+    sls_config_handle_init(&time_factor, "system.real_time_factor");
+    sls_timeline_cursor_init(&g_timeline);
+
+    static const uint64_t tick_bounds_ns[] = {50000,   100000,  250000,  500000,  1000000,
+                                              2500000, 5000000, 10000000, 20000000};
+    sls_metric_t *tick_time = sls_metrics_histogram(
+        "sls_main_loop_duration_seconds", NULL, "Main loop work per tick", tick_bounds_ns,
+        (int)(sizeof(tick_bounds_ns) / sizeof(tick_bounds_ns[0])), 1e-9);
+    sls_metric_t *overruns =
+        sls_metrics_counter("sls_main_loop_overruns_total", NULL, "Ticks that overran the period");
+    sls_metric_t *mission_time =
+        sls_metrics_gauge("sls_mission_time_seconds", NULL, "Mission elapsed time (T+)");
+    sls_metric_t *tick_allocs = sls_metrics_gauge("sls_alloc_tick_allocations", NULL,
+                                                  "Allocations (all threads) during the last tick");
+
+    // Everything the loops need exists now; from here on they must not allocate
+    sls_alloc_seal();
+    sls_alloc_steady_thread();
+
+    while (!sls_shutdown_requested())
     {
-        clock_gettime(CLOCK_MONOTONIC, &loop_start);
+        sls_time_ns_t loop_start = sls_time_monotonic_ns();
+        SLS_TRACE_BEGIN("main_tick");
 
-        // Update mission time (real-time simulation)
-        g_mission_time += (double)MAIN_LOOP_PERIOD_MS / 1000.0;
+        // Update mission time (real-time simulation, scaled by the live config)
+        double now = sls_get_mission_time() + (double)MAIN_LOOP_PERIOD_MS / 1000.0 *
+                                                  sls_config_handle_double(&time_factor, 1.0);
+        atomic_store_explicit(&g_shared.mission_time, now, memory_order_relaxed);
 
         // Update mission phase
         update_mission_phase();
@@ -238,28 +331,31 @@ static int main_control_loop(void)
         sls_ipc_process_messages();
 
         // Check for system faults or emergency conditions
-        if (g_current_phase == PHASE_ABORT)
+        if (sls_get_current_mission_phase() == PHASE_ABORT &&
+            atomic_load_explicit(&g_shared.system_state, memory_order_relaxed) != STATE_EMERGENCY)
         {
             sls_log(LOG_LEVEL_CRITICAL, "MAIN", "Mission abort detected, initiating emergency procedures");
-            g_system_state = STATE_EMERGENCY;
+            atomic_store_explicit(&g_shared.system_state, STATE_EMERGENCY, memory_order_relaxed);
             // Emergency shutdown procedures would go here
         }
 
+        SLS_TRACE_END("main_tick");
+
         // Calculate sleep time to maintain loop period
-        clock_gettime(CLOCK_MONOTONIC, &loop_end);
-        long elapsed_ns = (loop_end.tv_sec - loop_start.tv_sec) * 1000000000L +
-                          (loop_end.tv_nsec - loop_start.tv_nsec);
+        sls_time_ns_t elapsed_ns = sls_time_monotonic_ns() - loop_start;
+        sls_metric_observe(tick_time, (uint64_t)elapsed_ns);
+        sls_metric_set(mission_time, now);
+        sls_metric_set(tick_allocs, (double)sls_alloc_tick());
 
         if (elapsed_ns < loop_period_ns)
         {
-            sleep_time.tv_sec = 0;
-            sleep_time.tv_nsec = loop_period_ns - elapsed_ns;
-            nanosleep(&sleep_time, NULL);
+            sls_time_sleep_ns(loop_period_ns - elapsed_ns);
         }
         else
         {
-            sls_log(LOG_LEVEL_WARNING, "MAIN", "Main loop overrun by %ld ns",
-                    elapsed_ns - loop_period_ns);
+            sls_metric_inc(overruns);
+            sls_log(LOG_LEVEL_WARNING, "MAIN", "Main loop overrun by %lld ns",
+                    (long long)(elapsed_ns - loop_period_ns));
         }
     }
 
@@ -276,7 +372,7 @@ static void *subsystem_monitor_thread(void *arg)
 
     sls_log(LOG_LEVEL_INFO, "MONITOR", "Subsystem monitor thread started");
 
-    while (!g_shutdown_requested)
+    while (!sls_shutdown_requested())
     {
         // Check subsystem health
         for (int i = 0; i < active_subsystems; i++)
@@ -299,20 +395,39 @@ static void *subsystem_monitor_thread(void *arg)
 static void shutdown_system(void)
 {
     sls_log(LOG_LEVEL_INFO, "MAIN", "Initiating system shutdown...");
-    g_system_state = STATE_SHUTDOWN;
+    // Every thread loop polls this; set it here too so the joins below
+    // return on paths that did not come through the signal handler
+    atomic_store(&g_shared.shutdown_requested, true);
+    atomic_store_explicit(&g_shared.system_state, STATE_SHUTDOWN, memory_order_relaxed);
 
     // Signal all subsystems to shutdown
     status_message_t shutdown_msg = {
         .source = SUBSYS_FLIGHT_CONTROL,
         .state = STATE_SHUTDOWN,
-        .phase = g_current_phase,
+        .phase = sls_get_current_mission_phase(),
         .priority = PRIORITY_CRITICAL,
         .error_code = 0};
     strcpy(shutdown_msg.message, "System shutdown initiated");
-    clock_gettime(CLOCK_REALTIME, &shutdown_msg.timestamp);
+    shutdown_msg.timestamp_ns = sls_time_realtime_ns();
 
     sls_ipc_broadcast_status(&shutdown_msg);
 
+    // Export before the joins; the buffers can be read while threads run
+    if (g_trace_path)
+    {
+        sls_trace_stop();
+        long events = sls_trace_export(g_trace_path);
+        if (events < 0)
+        {
+            sls_log(LOG_LEVEL_ERROR, "MAIN", "Failed to write trace to %s", g_trace_path);
+        }
+        else
+        {
+            sls_log(LOG_LEVEL_INFO, "MAIN", "Wrote %ld trace events to %s (%llu dropped)", events,
+                    g_trace_path, (unsigned long long)sls_trace_dropped());
+        }
+    }
+
     // Wait for subsystem threads to terminate
     for (int i = 0; i < active_subsystems; i++)
     {
@@ -325,9 +440,12 @@ static void shutdown_system(void)
     // Cleanup systems
     // Stop command server
     cmd_server_stop();
+    sls_metrics_server_stop();
+    sls_trace_cleanup();
 
     sls_ipc_cleanup();
     sls_utils_cleanup();
+    sls_config_unload();
     sls_logging_cleanup();
 
     printf("[MAIN] System shutdown complete.\n");
@@ -344,23 +462,42 @@ int main(int argc, char *argv[])
     printf("========================================\n\n");
 
     // Parse command line arguments
-    if (argc > 1)
+    for (int i = 1; i < argc; i++)
     {
-        if (strcmp(argv[1], "--help") == 0 || strcmp(argv[1], "-h") == 0)
+        if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0)
         {
             printf("Usage: %s [options]\n", argv[0]);
             printf("Options:\n");
             printf("  -h, --help     Show this help message\n");
             printf("  --version      Show version information\n");
             printf("  --config FILE  Use custom configuration file\n");
+            printf("  --trace FILE   Record a Chrome trace (build with TRACE=1)\n");
             return EXIT_SUCCESS;
         }
-        else if (strcmp(argv[1], "--version") == 0)
+        else if (strcmp(argv[i], "--version") == 0)
         {
             printf("Version: 1.0.0\n");
             printf("Build: %s %s\n", __DATE__, __TIME__);
             return EXIT_SUCCESS;
         }
+        else if (strcmp(argv[i], "--config") == 0)
+        {
+            if (++i >= argc)
+            {
+                fprintf(stderr, "--config requires a file name\n");
+                return EXIT_FAILURE;
+            }
+            g_config_path = argv[i];
+        }
+        else if (strcmp(argv[i], "--trace") == 0)
+        {
+            if (++i >= argc)
+            {
+                fprintf(stderr, "--trace requires a file name\n");
+                return EXIT_FAILURE;
+            }
+            g_trace_path = argv[i];
+        }
     }
 
     // Initialize system
@@ -395,7 +532,22 @@ cleanup:
  */
 mission_phase_t sls_get_current_mission_phase(void)
 {
-    return g_current_phase;
+    return atomic_load_explicit(&g_shared.current_phase, memory_order_relaxed);
+}
+
+/**
+ * @brief Request a mission abort (any thread)
+ *
+ * Latches PHASE_ABORT; the main loop applies it on its next pass.
+ */
+void sls_request_mission_abort(const char *reason)
+{
+    bool expected = false;
+    if (atomic_compare_exchange_strong(&g_shared.abort_requested, &expected, true))
+    {
+        sls_log(LOG_LEVEL_CRITICAL, "MAIN", "Mission abort requested: %s",
+                reason ? reason : "unspecified");
+    }
 }
 
 /**
@@ -403,5 +555,13 @@ mission_phase_t sls_get_current_mission_phase(void)
  */
 double sls_get_mission_time(void)
 {
-    return g_mission_time;
+    return atomic_load_explicit(&g_shared.mission_time, memory_order_relaxed);
+}
+
+/**
+ * @brief Whether shutdown has been requested (any thread; polled by every loop)
+ */
+bool sls_shutdown_requested(void)
+{
+    return atomic_load_explicit(&g_shared.shutdown_requested, memory_order_relaxed);
 }
@@ -5,137 +5,459 @@
 #include <time.h>
 #include <sys/netmgr.h>
 #include <sys/siginfo.h>
+#ifdef MOCK_QNX_BUILD
+#include <stdatomic.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
 
 typedef struct {
     int rcvid;
     struct _msg_info info;
 } recv_ctx_t;
 
+#define STATE_LOAD(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define STATE_STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+// Apply one command to the server state and fill its reply. Status is
+// lock-free; commands touching two fields (go, abort) must not interleave,
+// or a go racing an abort could leave both set.
+static void handle_msg(ipc_server_t* srv, const sim_msg_t* msg, sim_reply_t* reply) {
+    reply->ok = 1;
+    int locked = msg->type != CMD_STATUS;
+    if (locked) pthread_mutex_lock(&srv->state_mtx);
+    switch (msg->type) {
+        case CMD_STATUS:
+            // No state change
+            break;
+        case CMD_GO:
+            if (srv->mission_go) STATE_STORE(srv->mission_go, 1);
+            if (srv->abort_req) STATE_STORE(srv->abort_req, 0);
+            break;
+        case CMD_NOGO:
+            if (srv->mission_go) STATE_STORE(srv->mission_go, 0);
+            break;
+        case CMD_ABORT:
+            if (srv->abort_req) STATE_STORE(srv->abort_req, 1);
+            if (srv->mission_go) STATE_STORE(srv->mission_go, 0);
+            break;
+        case CMD_SET_THROTTLE:
+            if (srv->throttle) {
+                int v = msg->value;
+                if (v < 0) v = 0;
+                if (v > 100) v = 100;
+                STATE_STORE(srv->throttle, v);
+            }
+            break;
+        default:
+            reply->ok = 0;
+            break;
+    }
+
+    // Report state after handling
+    reply->mission_go = srv->mission_go ? STATE_LOAD(srv->mission_go) : 0;
+    reply->throttle   = srv->throttle ? STATE_LOAD(srv->throttle) : 0;
+    if (locked) pthread_mutex_unlock(&srv->state_mtx);
+}
+
+static void pool_grow(ipc_server_t* srv);
+
 static void* recv_loop(void* arg) {
     ipc_server_t* srv = (ipc_server_t*)arg;
     int chid = srv->chid;
 
-    sim_msg_t msg;
-    struct _pulse pulse;
+    // Large enough for a pulse or a full batch
+    union {
+        sim_msg_t msg;
+        struct _pulse pulse;
+        sim_msg_t batch[1 + IPC_MAX_BATCH];
+    } rx;
+    sim_reply_t replies[IPC_MAX_BATCH];
+    struct _msg_info info;
 
-    while (1) {
-        int rcvid = MsgReceive(chid, &msg, sizeof(msg), NULL);
+    while (!atomic_load(&srv->stopping)) {
+        atomic_fetch_add(&srv->nwaiting, 1);
+        int rcvid = MsgReceive(chid, &rx, sizeof(rx), &info);
+        int idle = atomic_fetch_sub(&srv->nwaiting, 1) - 1;
         if (rcvid == -1) {
             if (errno == EINTR) continue;
             break;
         }
         if (rcvid == 0) {
             // Pulse received
-            memcpy(&pulse, &msg, sizeof(pulse));
-            if (pulse.code == PULSE_TICK) {
-                // TICK pulse; nothing to reply
-                // Application can poll shared state in main loop
+            if (rx.pulse.code == PULSE_SHUTDOWN) break;
+            if (rx.pulse.code == PULSE_TICK) {
+                // TICK pulse: wake the sim loop (ipc_server_wait_tick)
+                pthread_mutex_lock(&srv->tick_mtx);
+                srv->ticks++;
+                pthread_cond_broadcast(&srv->tick_cv);
+                pthread_mutex_unlock(&srv->tick_mtx);
             }
             continue;
         }
 
-        // Message from client
-        sim_reply_t reply = { .ok = 1, .mission_go = srv->mission_go ? *srv->mission_go : 0,
-                              .throttle = srv->throttle ? *srv->throttle : 0 };
-
-        switch (msg.type) {
-            case CMD_STATUS:
-                // No state change
-                break;
-            case CMD_GO:
-                if (srv->mission_go) *srv->mission_go = 1;
-                if (srv->abort_req) *srv->abort_req = 0;
-                break;
-            case CMD_NOGO:
-                if (srv->mission_go) *srv->mission_go = 0;
-                break;
-            case CMD_ABORT:
-                if (srv->abort_req) *srv->abort_req = 1;
-                if (srv->mission_go) *srv->mission_go = 0;
-                break;
-            case CMD_SET_THROTTLE:
-                if (srv->throttle) {
-                    int v = msg.value;
-                    if (v < 0) v = 0; if (v > 100) v = 100;
-                    *srv->throttle = v;
-                }
-                break;
-            default:
-                reply.ok = 0;
-                break;
-        }
+        // Keep lo_water threads receiving while this one works
+        if (idle < srv->pool.lo_water) pool_grow(srv);
 
-        // Update reply state after handling
-        reply.mission_go = srv->mission_go ? *srv->mission_go : 0;
-        reply.throttle   = srv->throttle ? *srv->throttle : 0;
+        if (rx.msg.type == CMD_BATCH) {
+            // Header record, then value commands; answered in one reply
+            int count = rx.msg.value;
+            if (count < 1 || count > IPC_MAX_BATCH ||
+                info.msglen < (size_t)(1 + count) * sizeof(sim_msg_t)) {
+                MsgError(rcvid, EINVAL);
+                continue;
+            }
+            for (int i = 0; i < count; ++i) handle_msg(srv, &rx.batch[1 + i], &replies[i]);
+            MsgReply(rcvid, EOK, replies, (size_t)count * sizeof(sim_reply_t));
+        } else {
+            // Message from client
+            sim_reply_t reply;
+            handle_msg(srv, &rx.msg, &reply);
+            MsgReply(rcvid, EOK, &reply, sizeof(reply));
+        }
 
-        MsgReply(rcvid, EOK, &reply, sizeof(reply));
+        // Enough threads already waiting: retire this one
+        if (atomic_load(&srv->nwaiting) > srv->pool.hi_water &&
+            atomic_load(&srv->nthreads) > srv->pool.lo_water) break;
     }
 
+    pthread_mutex_lock(&srv->pool_mtx);
+    atomic_fetch_sub(&srv->nthreads, 1);
+    pthread_cond_broadcast(&srv->pool_cv);
+    pthread_mutex_unlock(&srv->pool_mtx);
     return NULL;
 }
 
+// Caller holds pool_mtx. Threads are detached; exit is tracked by nthreads.
+static int pool_spawn(ipc_server_t* srv) {
+    pthread_attr_t attr; pthread_attr_init(&attr);
+    struct sched_param sp = { .sched_priority = srv->prio };
+    pthread_attr_setschedpolicy(&attr, SCHED_RR);
+    pthread_attr_setschedparam(&attr, &sp);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+    pthread_t t;
+    atomic_fetch_add(&srv->nthreads, 1);
+    int rc = pthread_create(&t, &attr, recv_loop, srv);
+    pthread_attr_destroy(&attr);
+    if (rc != 0) atomic_fetch_sub(&srv->nthreads, 1);
+    return rc;
+}
+
+static void pool_grow(ipc_server_t* srv) {
+    pthread_mutex_lock(&srv->pool_mtx);
+    for (int i = 0; i < srv->pool.increment && !atomic_load(&srv->stopping) &&
+                    atomic_load(&srv->nthreads) < srv->pool.maximum; ++i) {
+        if (pool_spawn(srv) != 0) break;
+    }
+    pthread_mutex_unlock(&srv->pool_mtx);
+}
+
 int ipc_server_start(ipc_server_t* srv, const char* name,
                      volatile int* mission_go,
                      volatile int* throttle,
                      volatile int* abort_req,
                      int recv_thread_priority) {
+    return ipc_server_start_pool(srv, name, mission_go, throttle, abort_req,
+                                 recv_thread_priority, NULL);
+}
+
+int ipc_server_start_pool(ipc_server_t* srv, const char* name,
+                          volatile int* mission_go,
+                          volatile int* throttle,
+                          volatile int* abort_req,
+                          int recv_thread_priority,
+                          const ipc_pool_attr_t* pool) {
     if (!srv || !name) return -1;
     memset(srv, 0, sizeof(*srv));
 
+    static const ipc_pool_attr_t default_pool = IPC_POOL_DEFAULT;
+    srv->pool = pool ? *pool : default_pool;
+    if (srv->pool.lo_water < 1) srv->pool.lo_water = 1;
+    if (srv->pool.increment < 1) srv->pool.increment = 1;
+    if (srv->pool.maximum < srv->pool.lo_water) srv->pool.maximum = srv->pool.lo_water;
+    if (srv->pool.hi_water < srv->pool.lo_water) srv->pool.hi_water = srv->pool.lo_water;
+
     srv->attach = name_attach(NULL, name, 0);
     if (!srv->attach) {
         return -1;
     }
     srv->chid = srv->attach->chid;
+    srv->coid = ConnectAttach(ND_LOCAL_NODE, 0, srv->chid, _NTO_SIDE_CHANNEL, 0);
+    if (srv->coid == -1) {
+        name_detach(srv->attach, 0);
+        memset(srv, 0, sizeof(*srv));
+        return -1;
+    }
     srv->mission_go = mission_go;
     srv->throttle = throttle;
     srv->abort_req = abort_req;
     srv->prio = recv_thread_priority;
+    pthread_mutex_init(&srv->pool_mtx, NULL);
+    pthread_cond_init(&srv->pool_cv, NULL);
+    pthread_mutex_init(&srv->state_mtx, NULL);
+    pthread_mutex_init(&srv->tick_mtx, NULL);
+    pthread_condattr_t ca;
+    pthread_condattr_init(&ca);
+    pthread_condattr_setclock(&ca, CLOCK_MONOTONIC);
+    pthread_cond_init(&srv->tick_cv, &ca);
+    pthread_condattr_destroy(&ca);
 
-    // Receiver thread
-    pthread_attr_t attr; pthread_attr_init(&attr);
-    struct sched_param sp = { .sched_priority = recv_thread_priority };
-    pthread_attr_setschedpolicy(&attr, SCHED_RR);
-    pthread_attr_setschedparam(&attr, &sp);
-    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
-
-    int rc = pthread_create(&srv->thread, &attr, recv_loop, srv);
-    pthread_attr_destroy(&attr);
+    // Receiver threads
+    pthread_mutex_lock(&srv->pool_mtx);
+    int rc = 0;
+    for (int i = 0; i < srv->pool.lo_water && rc == 0; ++i) rc = pool_spawn(srv);
+    pthread_mutex_unlock(&srv->pool_mtx);
     if (rc != 0) {
-        name_detach(srv->attach, 0);
-        memset(srv, 0, sizeof(*srv));
+        ipc_server_stop(srv);
         return -1;
     }
     return 0;
 }
 
 void ipc_server_stop(ipc_server_t* srv) {
-    if (!srv) return;
-    if (srv->attach) {
-        name_detach(srv->attach, 0);
-        srv->attach = NULL;
+    if (!srv || !srv->attach) return;
+    atomic_store(&srv->stopping, 1);
+
+    // One shutdown pulse per receive thread. A thread busy with a message
+    // sees stopping instead and leaves its pulse queued, so a thread that
+    // grew meanwhile could miss out: resend if the pool has not drained.
+    pthread_mutex_lock(&srv->pool_mtx);
+    int resend = 1;
+    while (atomic_load(&srv->nthreads) > 0) {
+        if (resend) {
+            for (int i = atomic_load(&srv->nthreads); i > 0; --i)
+                MsgSendPulse(srv->coid, srv->prio, PULSE_SHUTDOWN, 0);
+        }
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += 50 * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) { deadline.tv_sec++; deadline.tv_nsec -= 1000000000L; }
+        resend = pthread_cond_timedwait(&srv->pool_cv, &srv->pool_mtx, &deadline) == ETIMEDOUT;
     }
-    if (srv->thread) {
-        pthread_cancel(srv->thread);
-        pthread_join(srv->thread, NULL);
-        srv->thread = 0;
+    pthread_mutex_unlock(&srv->pool_mtx);
+
+    // Release anyone waiting for a tick
+    pthread_mutex_lock(&srv->tick_mtx);
+    pthread_cond_broadcast(&srv->tick_cv);
+    pthread_mutex_unlock(&srv->tick_mtx);
+
+    ConnectDetach(srv->coid);
+    name_detach(srv->attach, 0);
+    srv->attach = NULL;
+    pthread_mutex_destroy(&srv->pool_mtx);
+    pthread_cond_destroy(&srv->pool_cv);
+    pthread_mutex_destroy(&srv->state_mtx);
+}
+
+int ipc_server_wait_tick(ipc_server_t* srv, uint64_t* seen, int timeout_ms) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) { deadline.tv_sec++; deadline.tv_nsec -= 1000000000L; }
+
+    pthread_mutex_lock(&srv->tick_mtx);
+    if (*seen == 0) *seen = srv->ticks; // First call: wait for the next tick
+    int rc = 0;
+    while (srv->ticks == *seen && !atomic_load(&srv->stopping) && rc == 0)
+        rc = pthread_cond_timedwait(&srv->tick_cv, &srv->tick_mtx, &deadline);
+    uint64_t elapsed = srv->ticks - *seen;
+    *seen = srv->ticks;
+    pthread_mutex_unlock(&srv->tick_mtx);
+    return (int)elapsed;
+}
+
+// Client connection cache: name_open once per server, not per message
+#define CONN_CACHE_SZ 8
+
+typedef struct {
+    char name[64];
+    int coid;
+} cached_conn_t;
+
+static cached_conn_t conn_cache[CONN_CACHE_SZ];
+static pthread_mutex_t conn_mtx = PTHREAD_MUTEX_INITIALIZER;
+
+// Cached coid for name, opening it on a miss; -1 if the server is not up.
+// *cached is 0 when the cache is full and the caller must close the coid.
+static int conn_get(const char* name, int* cached) {
+    *cached = 0;
+    if (strlen(name) >= sizeof(conn_cache[0].name)) return name_open(name, 0);
+
+    pthread_mutex_lock(&conn_mtx);
+    cached_conn_t* free_slot = NULL;
+    for (int i = 0; i < CONN_CACHE_SZ; ++i) {
+        cached_conn_t* c = &conn_cache[i];
+        if (c->name[0] && strcmp(c->name, name) == 0) {
+            int coid = c->coid;
+            pthread_mutex_unlock(&conn_mtx);
+            *cached = 1;
+            return coid;
+        }
+        if (!c->name[0] && !free_slot) free_slot = c;
+    }
+
+    int coid = name_open(name, 0);
+    if (coid != -1 && free_slot) {
+        strcpy(free_slot->name, name);
+        free_slot->coid = coid;
+        *cached = 1;
+    }
+    pthread_mutex_unlock(&conn_mtx);
+    return coid;
+}
+
+// Forget a connection that failed (server restarted or gone)
+static void conn_drop(const char* name, int coid) {
+    pthread_mutex_lock(&conn_mtx);
+    for (int i = 0; i < CONN_CACHE_SZ; ++i) {
+        cached_conn_t* c = &conn_cache[i];
+        if (c->name[0] && c->coid == coid && (!name || strcmp(c->name, name) == 0)) {
+            name_close(c->coid);
+            c->name[0] = 0;
+        }
+    }
+    pthread_mutex_unlock(&conn_mtx);
+}
+
+void ipc_client_disconnect(const char* name) {
+    pthread_mutex_lock(&conn_mtx);
+    for (int i = 0; i < CONN_CACHE_SZ; ++i) {
+        cached_conn_t* c = &conn_cache[i];
+        if (c->name[0] && (!name || strcmp(c->name, name) == 0)) {
+            name_close(c->coid);
+            c->name[0] = 0;
+        }
+    }
+    pthread_mutex_unlock(&conn_mtx);
+}
+
+// MsgSend over the cached connection. A stale connection (server restarted:
+// EBADF/ESRCH) is reopened and the send retried once; every sim command
+// sets state rather than toggling it, so a resend is harmless.
+static int conn_send(const char* name, const void* smsg, size_t sbytes,
+                     void* rmsg, size_t rbytes) {
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        int cached;
+        int coid = conn_get(name, &cached);
+        if (coid == -1) return -1;
+        int rc = MsgSend(coid, smsg, sbytes, rmsg, rbytes);
+        int err = errno;
+        if (!cached) name_close(coid);
+        if (rc != -1) return 0;
+        if (err != EBADF && err != ESRCH) { errno = err; return -1; }
+        if (cached) conn_drop(name, coid);
+        errno = err;
     }
+    return -1;
 }
 
 int ipc_client_send(const char* name, const sim_msg_t* msg, sim_reply_t* reply) {
     if (!name || !msg) return -1;
-    int coid = name_open(name, 0);
-    if (coid == -1) return -1;
-
     sim_reply_t rep = {0};
-    int rc = MsgSend(coid, msg, sizeof(*msg), &rep, sizeof(rep));
-    name_close(coid);
-    if (rc == -1) return -1;
+    if (conn_send(name, msg, sizeof(*msg), &rep, sizeof(rep)) != 0) return -1;
     if (reply) *reply = rep;
     return 0;
 }
 
+int ipc_client_send_batch(const char* name, const sim_msg_t* msgs, int count,
+                          sim_reply_t* replies) {
+    if (!name || !msgs || !replies || count < 1 || count > IPC_MAX_BATCH) {
+        errno = EINVAL;
+        return -1;
+    }
+    sim_msg_t out[1 + IPC_MAX_BATCH];
+    out[0].type = CMD_BATCH;
+    out[0].value = count;
+    memcpy(&out[1], msgs, (size_t)count * sizeof(*msgs));
+    return conn_send(name, out, (size_t)(1 + count) * sizeof(*msgs),
+                     replies, (size_t)count * sizeof(*replies));
+}
+
+#ifdef MOCK_QNX_BUILD
+// Linux: glibc has no pulse timers. A timerfd keeps the period in the
+// kernel and one thread turns each expiry into a pulse.
+typedef struct {
+    int fd;
+    int coid;
+    int code;
+    int value;
+    atomic_int stop;
+    pthread_t thread;
+} tick_timer_t;
+
+static void* tick_timer_thread(void* arg) {
+    tick_timer_t* t = (tick_timer_t*)arg;
+    uint64_t expirations;
+    while (!atomic_load(&t->stop)) {
+        if (read(t->fd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (atomic_load(&t->stop)) break;
+        // One pulse per expiry, as QNX queues them; a late thread catches up
+        for (uint64_t i = 0; i < expirations; ++i)
+            MsgSendPulse(t->coid, SIGEV_PULSE_PRIO_INHERIT, t->code, t->value);
+    }
+    return NULL;
+}
+
+int timer_pulse_start(int chid, int period_ms, int code, int value, timer_t* out_timer) {
+    if (chid <= 0 || period_ms <= 0) return 0;
+
+    tick_timer_t* t = calloc(1, sizeof(*t));
+    if (!t) return 0;
+    t->code = code;
+    t->value = value;
+    t->fd = -1;
+    t->coid = ConnectAttach(ND_LOCAL_NODE, 0, chid, _NTO_SIDE_CHANNEL, 0);
+    if (t->coid == -1) goto fail;
+    t->fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (t->fd == -1) goto fail;
+
+    struct itimerspec its;
+    its.it_value.tv_sec = period_ms / 1000;
+    its.it_value.tv_nsec = (period_ms % 1000) * 1000000L;
+    its.it_interval = its.it_value;
+    if (timerfd_settime(t->fd, 0, &its, NULL) == -1) goto fail;
+    if (pthread_create(&t->thread, NULL, tick_timer_thread, t) != 0) goto fail;
+
+    if (out_timer) *out_timer = (timer_t)t;
+    return 1;
+
+fail:
+    if (t->fd != -1) close(t->fd);
+    if (t->coid != -1) ConnectDetach(t->coid);
+    free(t);
+    return 0;
+}
+
+void timer_pulse_stop(timer_t timer) {
+    tick_timer_t* t = (tick_timer_t*)timer;
+    if (!t) return;
+    // Expire once more right away so the blocked read returns
+    atomic_store(&t->stop, 1);
+    struct itimerspec now = { .it_value = { 0, 1 } };
+    timerfd_settime(t->fd, 0, &now, NULL);
+    pthread_join(t->thread, NULL);
+    close(t->fd);
+    ConnectDetach(t->coid);
+    free(t);
+}
+
+#else
+// QNX: the kernel delivers the pulse itself. The timer's coid is kept in
+// a small table so timer_pulse_stop can release it.
+#define PULSE_TIMERS_MAX 8
+
+static struct {
+    timer_t timer;
+    int coid;
+} pulse_timers[PULSE_TIMERS_MAX];
+static pthread_mutex_t pulse_timers_mtx = PTHREAD_MUTEX_INITIALIZER;
+
 int timer_pulse_start(int chid, int period_ms, int code, int value, timer_t* out_timer) {
     if (chid <= 0 || period_ms <= 0) return 0;
 
@@ -145,8 +467,9 @@ int timer_pulse_start(int chid, int period_ms, int code, int value, timer_t* out
 
     SIGEV_PULSE_INIT(&sev, coid, SIGEV_PULSE_PRIO_INHERIT, code, value);
 
+    // Monotonic, so setting the wall clock does not bunch or skip ticks
     timer_t timerid;
-    if (timer_create(CLOCK_REALTIME, &sev, &timerid) == -1) {
+    if (timer_create(CLOCK_MONOTONIC, &sev, &timerid) == -1) {
         ConnectDetach(coid);
         return 0;
     }
@@ -162,6 +485,30 @@ int timer_pulse_start(int chid, int period_ms, int code, int value, timer_t* out
         return 0;
     }
 
+    pthread_mutex_lock(&pulse_timers_mtx);
+    for (int i = 0; i < PULSE_TIMERS_MAX; ++i) {
+        if (pulse_timers[i].coid == 0) {
+            pulse_timers[i].timer = timerid;
+            pulse_timers[i].coid = coid;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&pulse_timers_mtx);
+
     if (out_timer) *out_timer = timerid;
     return 1;
 }
+
+void timer_pulse_stop(timer_t timer) {
+    timer_delete(timer);
+    pthread_mutex_lock(&pulse_timers_mtx);
+    for (int i = 0; i < PULSE_TIMERS_MAX; ++i) {
+        if (pulse_timers[i].coid != 0 && pulse_timers[i].timer == timer) {
+            ConnectDetach(pulse_timers[i].coid);
+            pulse_timers[i].coid = 0;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&pulse_timers_mtx);
+}
+#endif
@@ -1,43 +1,49 @@
 #ifndef SLS_QNX_IPC_H
 #define SLS_QNX_IPC_H
 
+#include <stdatomic.h>
 #include <stdint.h>
 #include <sys/neutrino.h>
 #include <sys/dispatch.h>
 #include <pthread.h>
 
+#include "../common/sim_proto.h" // cmd_t, sim_msg_t, sim_reply_t
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-// Simple command protocol
-typedef enum {
-    CMD_STATUS = 1,
-    CMD_GO = 2,
-    CMD_NOGO = 3,
-    CMD_ABORT = 4,
-    CMD_SET_THROTTLE = 5,
-    PULSE_TICK = 100
-} cmd_t;
-
+// Receive thread pool sizing, after QNX thread_pool_attr_t: the pool keeps
+// at least lo_water threads blocked in MsgReceive, adding increment threads
+// (up to maximum) when fewer are waiting; a thread that finishes a message
+// while more than hi_water are waiting exits.
 typedef struct {
-    int32_t type;   // cmd_t
-    int32_t value;  // throttle percent or extra data
-} sim_msg_t;
+    int lo_water;
+    int hi_water;
+    int increment;
+    int maximum;
+} ipc_pool_attr_t;
 
-typedef struct {
-    int32_t ok;         // 0/1
-    int32_t mission_go; // 0/1
-    int32_t throttle;   // 0-100
-} sim_reply_t;
+#define IPC_POOL_DEFAULT { 2, 4, 1, 8 }
 
 // Server context
 typedef struct {
     name_attach_t* attach;   // name_attach handle for clients
     int chid;                // Channel ID
-    pthread_t thread;        // Receiver thread
-    int prio;                // Priority for receiver thread
-    // Application state pointers
+    int coid;                // Connection to our own channel (shutdown pulses)
+    int prio;                // Priority for receiver threads
+    ipc_pool_attr_t pool;
+    atomic_int nthreads;     // Receive threads alive
+    atomic_int nwaiting;     // ... of which blocked in MsgReceive
+    atomic_int stopping;
+    pthread_mutex_t pool_mtx; // Thread creation and exit accounting
+    pthread_cond_t pool_cv;   // Signalled as threads exit
+    pthread_mutex_t state_mtx; // Serializes commands that change state
+    pthread_mutex_t tick_mtx;  // PULSE_TICKs counted by the receive threads
+    pthread_cond_t tick_cv;    // (CLOCK_MONOTONIC) for ipc_server_wait_tick
+    uint64_t ticks;
+    // Application state pointers; written with atomic stores, so readers
+    // never see a torn value, and read with atomic loads
     volatile int* mission_go;
     volatile int* throttle;
     volatile int* abort_req;
@@ -51,17 +57,48 @@ int ipc_server_start(ipc_server_t* srv, const char* name,
                      volatile int* abort_req,
                      int recv_thread_priority);
 
-// Stop server
+// Same with an explicit receive pool (NULL: IPC_POOL_DEFAULT)
+int ipc_server_start_pool(ipc_server_t* srv, const char* name,
+                          volatile int* mission_go,
+                          volatile int* throttle,
+                          volatile int* abort_req,
+                          int recv_thread_priority,
+                          const ipc_pool_attr_t* pool);
+
+// Stop server: every receive thread gets a PULSE_SHUTDOWN and is waited
+// for before the name is detached
 void ipc_server_stop(ipc_server_t* srv);
 
-// Client helper: send a message to a named server and receive a reply
+// Most commands in one CMD_BATCH message
+#define IPC_MAX_BATCH 32
+
+// Client helper: send a message to a named server and receive a reply.
+// Connections are cached per name and reopened once if the server restarted.
 int ipc_client_send(const char* name, const sim_msg_t* msg, sim_reply_t* reply);
 
+// Send up to IPC_MAX_BATCH commands in one round trip; replies[i] answers
+// msgs[i]. Returns 0 on success, -1 on error.
+int ipc_client_send_batch(const char* name, const sim_msg_t* msgs, int count,
+                          sim_reply_t* replies);
+
+// Drop the cached connection for name (NULL: all of them)
+void ipc_client_disconnect(const char* name);
+
+// Block until a PULSE_TICK arrives after *seen (start with *seen = 0).
+// Returns the ticks since *seen, more than 1 when the caller missed some,
+// and updates *seen; 0 on timeout or when the server stops.
+int ipc_server_wait_tick(ipc_server_t* srv, uint64_t* seen, int timeout_ms);
+
 // Timer pulse: start periodic pulses delivered to the server channel
 // code: pulse code (e.g., PULSE_TICK), value: integer value passed with pulse
-// Returns a timer_t to manage lifetime; 0 on error
+// The period comes from a monotonic kernel timer (QNX timer_create; on
+// Linux a timerfd read by one pulse thread), so it does not drift.
+// Returns 1 and fills out_timer on success; 0 on error
 int timer_pulse_start(int chid, int period_ms, int code, int value, timer_t* out_timer);
 
+// Stop a timer from timer_pulse_start and release its connection
+void timer_pulse_stop(timer_t timer);
+
 #ifdef __cplusplus
 }
 #endif
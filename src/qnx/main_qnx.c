@@ -4,10 +4,15 @@
 #include <string.h>
 #include <unistd.h>
 #include <time.h>
+#include <math.h>
 #include <pthread.h>
 #include "ipc.h"
 #include "../common/slog.h"
 #include "rmgr_telemetry.h"
+#include "telem_shm.h"
+#include "sls_time.h"
+
+#define TICK_MS 100 // sim step period
 
 static volatile int g_mission_go = 0;
 static volatile int g_throttle = 0;   // 0..100
@@ -41,13 +46,32 @@ static void step_sim(double dt) {
     g_mission_time += dt;
 }
 
-static void append_telem_line(void) {
-    char buf[256];
-    struct timespec ts; clock_gettime(CLOCK_REALTIME, &ts);
-    // timestamp, altitude, velocity, throttle, status
-    snprintf(buf, sizeof(buf), "%ld.%03ld,alt=%.2f,vel=%.2f,thr=%d,go=%d\n",
-             ts.tv_sec, ts.tv_nsec/1000000, g_altitude, g_velocity, g_throttle, g_mission_go);
-    rmgr_telemetry_append(buf);
+// Channels of the shared-memory export (TELEM_SHM_NAME), in publish order
+enum { CH_MISSION_TIME, CH_ALTITUDE, CH_VELOCITY, CH_THROTTLE, CH_MISSION_GO, CH_ABORT, CH_COUNT };
+static const telem_shm_channel_t telem_channels[CH_COUNT] = {
+    { "mission_time", "s" }, { "altitude", "m" }, { "velocity", "m/s" },
+    { "throttle", "%" },     { "mission_go", "" }, { "abort_req", "" },
+};
+
+static void publish_telem(telem_shm_t* shm) {
+    double values[CH_COUNT] = { g_mission_time, g_altitude, g_velocity,
+                                g_throttle, g_mission_go, g_abort_req };
+    telem_shm_publish(shm, values, sls_time_realtime_ns());
+}
+
+// One fixed-size record per tick; text-mode readers format it themselves
+static void append_telem_record(void) {
+    static uint32_t seq = 0;
+    sim_telem_record_t rec = {
+        .timestamp_ns = sls_time_realtime_ns(),
+        .seq = seq++,
+        .altitude_cm = (int64_t)llround(g_altitude * 100.0),
+        .velocity_cms = (int64_t)llround(g_velocity * 100.0),
+        .throttle = (uint8_t)g_throttle,
+        .mission_go = (uint8_t)g_mission_go,
+        .abort_req = (uint8_t)g_abort_req,
+    };
+    rmgr_telemetry_append(&rec);
 }
 
 int main(void) {
@@ -63,25 +87,54 @@ int main(void) {
         SLOGI("RMGR", "Telemetry available at /dev/sls_telemetry");
     }
 
+    // Local consumers mmap this instead of parsing /dev/sls_telemetry
+    telem_shm_t telem;
+    int exporting = telem_shm_create(&telem, TELEM_SHM_NAME, telem_channels, CH_COUNT) == 0;
+    if (exporting) SLOGI("MAIN", "Telemetry exported at shm:%s", TELEM_SHM_NAME);
+    else SLOGW("MAIN", "Telemetry shm export unavailable");
+
     ipc_server_t server;
     if (ipc_server_start(&server, "sls_fcc", &g_mission_go, &g_throttle, &g_abort_req, 70) != 0) {
         SLOGE("IPC", "Failed to start IPC server");
         return 1;
     }
-    timer_t tick_timer = 0; // optional, simulation uses nanosleep here as well
-    timer_pulse_start(server.chid, 100, PULSE_TICK, 0, &tick_timer);
+    // The kernel timer paces the loop: each PULSE_TICK wakes it through
+    // the IPC server, and dt is measured rather than assumed
+    timer_t tick_timer = 0;
+    int ticking = timer_pulse_start(server.chid, TICK_MS, PULSE_TICK, 0, &tick_timer);
+    if (!ticking) SLOGW("MAIN", "Tick timer unavailable, falling back to nanosleep");
+
+    uint64_t seen_tick = 0;
+    unsigned long missed_ticks = 0;
+    sls_time_ns_t last = sls_time_monotonic_ns();
 
-    const double dt = 0.1; // 100ms
     while (!g_abort_req || g_altitude > 0.0 || g_velocity > 0.0) {
+        if (ticking) {
+            int ticks = ipc_server_wait_tick(&server, &seen_tick, 10 * TICK_MS);
+            if (ticks == 0) {
+                SLOGW("MAIN", "No tick within %d ms", 10 * TICK_MS);
+                continue;
+            }
+            missed_ticks += (unsigned long)(ticks - 1);
+        } else {
+            sls_time_sleep_ns(TICK_MS * SLS_NS_PER_MS);
+        }
+
+        sls_time_ns_t now = sls_time_monotonic_ns();
+        double dt = sls_time_to_seconds(now - last);
+        last = now;
+
         step_sim(dt);
-        append_telem_line();
+        if (exporting) publish_telem(&telem);
+        append_telem_record();
         if (g_mission_time > 36000) break; // safety stop
-        struct timespec req = { .tv_sec = 0, .tv_nsec = 100000000L };
-        nanosleep(&req, NULL);
     }
 
+    if (ticking) timer_pulse_stop(tick_timer);
+    SLOGI("MAIN", "Missed ticks: %lu", missed_ticks);
     SLOGI("MAIN", "SLS QNX demo shutting down");
     ipc_server_stop(&server);
     rmgr_telemetry_stop(&rctx);
+    if (exporting) telem_shm_close(&telem);
     return 0;
 }
@@ -1,88 +1,286 @@
+// Each open gets its own read cursor into the telemetry ring
+struct telem_ocb;
+#define IOFUNC_OCB_T struct telem_ocb
+
 #include "rmgr_telemetry.h"
+#include "telem_ring.h"
+#include <stdatomic.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <errno.h>
-#include <sys/dispatch.h>
 #include <sys/iofunc.h>
+#include <sys/dispatch.h>
+
+#define READ_MAX 4096 // bytes per read() on the copying path
+// Reply straight from the ring only while the writer is at least this many
+// bytes from lapping the reply; otherwise copy out under the ring's checks
+#define ZERO_COPY_SLACK (TELEM_RING_DATA_SIZE / 2)
 
-#define RBUF_SZ 8192
+struct telem_ocb {
+    iofunc_ocb_t hdr;
+    telem_cursor_t cursor;
+    int mode; // SLS_TELEM_MODE_*
+    // Text mode: the formatted line a short read() stopped in
+    char line[SIM_TELEM_LINE_MAX];
+    int line_off, line_len;
+    // Blocked read(): only touched by the resource manager thread
+    struct telem_ocb* next_waiter;
+    int rcvid;
+    size_t nbytes;
+    int blocked;
+};
 
-static char ring[RBUF_SZ];
-static size_t r_head = 0; // write position
-static size_t r_tail = 0; // read position
-static pthread_mutex_t rmtx = PTHREAD_MUTEX_INITIALIZER;
+// Fixed-size sim_telem_record_t records, written only by the sim loop; readers follow with per-OCB cursors and
+// take no lock, so any number of them cannot stall the writer
+static telem_ring_t ring;
+static pthread_mutex_t wmtx = PTHREAD_MUTEX_INITIALIZER; // serialises appenders
 
 static resmgr_connect_funcs_t cfuncs;
 static resmgr_io_funcs_t ifuncs;
 static iofunc_attr_t ioattr;
+static iofunc_notify_t notify[3];
+
+// Wakeup path from the appender to the resource manager thread: wake_armed
+// is set while a read is blocked or a select()/ionotify() is armed, and the
+// first append after that sends one pulse
+static struct telem_ocb* waiters;
+static atomic_int wake_armed;
+static int wake_coid = -1;
+static int wake_code = -1;
+
+static IOFUNC_OCB_T* ocb_calloc(resmgr_context_t* ctp, IOFUNC_ATTR_T* attr) {
+    (void)ctp; (void)attr;
+    struct telem_ocb* ocb = calloc(1, sizeof(*ocb));
+    if (ocb) telem_cursor_init(&ring, &ocb->cursor, 1);
+    return ocb;
+}
+
+static void ocb_free(IOFUNC_OCB_T* ocb) {
+    free(ocb);
+}
+
+static iofunc_funcs_t ocb_funcs = { _IOFUNC_NFUNCS, ocb_calloc, ocb_free };
+static iofunc_mount_t mountpoint = { 0, 0, 0, 0, &ocb_funcs };
+
+static int has_data(struct telem_ocb* ocb) {
+    return ocb->line_off < ocb->line_len || telem_ring_pending(&ring, &ocb->cursor) > 0;
+}
+
+// Text mode: format records into lines, carrying a partly sent line over
+// to the next read
+static int reply_text(int rcvid, struct telem_ocb* ocb, size_t nbytes) {
+    char buf[READ_MAX];
+    size_t want = nbytes < sizeof(buf) ? nbytes : sizeof(buf);
+    size_t n = 0;
+    while (n < want) {
+        if (ocb->line_off == ocb->line_len) {
+            sim_telem_record_t rec;
+            if (telem_ring_read(&ring, &ocb->cursor, &rec, sizeof(rec)) != sizeof(rec)) break;
+            ocb->line_len = sim_telem_format(&rec, ocb->line, sizeof(ocb->line));
+            ocb->line_off = 0;
+        }
+        size_t chunk = (size_t)(ocb->line_len - ocb->line_off);
+        if (chunk > want - n) chunk = want - n;
+        memcpy(buf + n, ocb->line + ocb->line_off, chunk);
+        ocb->line_off += (int)chunk;
+        n += chunk;
+    }
+    if (n == 0) return 0;
+    MsgReply(rcvid, n, buf, n);
+    return 1;
+}
+
+// Reply with up to nbytes after the OCB's cursor. Returns 0 if there was
+// nothing to send (no reply made)
+static int reply_data(int rcvid, struct telem_ocb* ocb, size_t nbytes) {
+    if (ocb->mode == SLS_TELEM_MODE_TEXT) return reply_text(rcvid, ocb, nbytes);
+
+    // Binary: whole records only
+    nbytes -= nbytes % sizeof(sim_telem_record_t);
+    telem_ring_span_t span;
+    size_t n = telem_ring_peek(&ring, &ocb->cursor, nbytes, ZERO_COPY_SLACK, &span);
+    if (n > 0) {
+        // One iov per contiguous range; two when the data wraps the ring
+        iov_t iov[2];
+        for (int i = 0; i < span.nseg; i++) SETIOV(&iov[i], span.seg[i].base, span.seg[i].len);
+        MsgReplyv(rcvid, n, iov, span.nseg);
+        telem_ring_commit(&ring, &ocb->cursor, &span);
+        return 1;
+    }
+    if (telem_ring_pending(&ring, &ocb->cursor) == 0) return 0;
+
+    // READ_MAX is not a multiple of the record size: cap at whole records
+    // too, or the cursor is left inside one
+    char buf[READ_MAX];
+    const size_t cap = sizeof(buf) - sizeof(buf) % sizeof(sim_telem_record_t);
+    n = telem_ring_read(&ring, &ocb->cursor, buf, nbytes < cap ? nbytes : cap);
+    if (n == 0) return 0;
+    MsgReply(rcvid, n, buf, n);
+    return 1;
+}
+
+static void waiter_remove(struct telem_ocb* ocb) {
+    for (struct telem_ocb** p = &waiters; *p; p = &(*p)->next_waiter) {
+        if (*p == ocb) {
+            *p = ocb->next_waiter;
+            break;
+        }
+    }
+    ocb->next_waiter = NULL;
+    ocb->blocked = 0;
+}
+
+// Answer every blocked reader that now has data, fire select()/ionotify()
+// and re-arm the appender's pulse if anyone is still waiting
+static void serve_waiters(void) {
+    struct telem_ocb** p = &waiters;
+    while (*p) {
+        struct telem_ocb* ocb = *p;
+        if (reply_data(ocb->rcvid, ocb, ocb->nbytes)) {
+            *p = ocb->next_waiter;
+            ocb->next_waiter = NULL;
+            ocb->blocked = 0;
+        } else {
+            p = &ocb->next_waiter;
+        }
+    }
+    if (IOFUNC_NOTIFY_INPUT_CHECK(notify, 1, 0)) iofunc_notify_trigger(notify, 1, IOFUNC_NOTIFY_INPUT);
+    if (waiters || notify[IOFUNC_NOTIFY_INPUT].list) atomic_store(&wake_armed, 1);
+}
+
+static int wake_pulse(message_context_t* ctp, int code, unsigned flags, void* handle) {
+    (void)ctp; (void)code; (void)flags; (void)handle;
+    serve_waiters();
+    return 0;
+}
 
 static int io_read(resmgr_context_t* ctp, io_read_t* msg, RESMGR_OCB_T* ocb) {
-    int nonblock = (ocb->ioflag & O_NONBLOCK);
+    int nonblock = (ocb->hdr.ioflag & O_NONBLOCK);
 
     _IO_SET_READ_NBYTES(ctp, 0);
 
     if (msg->i.xtype & _IO_XTYPE_MASK) return _RESMGR_ERR(EINVAL);
 
     if (msg->i.nbytes <= 0) return _RESMGR_ERR(EINVAL);
+    if (ocb->mode == SLS_TELEM_MODE_BINARY && (size_t)msg->i.nbytes < sizeof(sim_telem_record_t))
+        return _RESMGR_ERR(EINVAL);
 
-    pthread_mutex_lock(&rmtx);
-    size_t available = (r_head >= r_tail) ? (r_head - r_tail) : (RBUF_SZ - (r_tail - r_head));
-    if (available == 0) {
-        pthread_mutex_unlock(&rmtx);
-        if (nonblock) return _RESMGR_ERR(EAGAIN);
-        // For simplicity, return 0 (EOF-like) if no data yet
-        return _RESMGR_NOREPLY;
-    }
+    if (reply_data(ctp->rcvid, ocb, msg->i.nbytes)) return _RESMGR_NOREPLY;
+    if (nonblock) return _RESMGR_ERR(EAGAIN);
+    if (ocb->blocked) return _RESMGR_ERR(EBUSY); // one outstanding read per open
 
-    size_t to_copy = (available < msg->i.nbytes) ? available : msg->i.nbytes;
-    // Avoid splitting wrap-around for simplicity
-    size_t end = (r_tail + to_copy <= RBUF_SZ) ? (r_tail + to_copy) : RBUF_SZ;
-    int n1 = end - r_tail;
+    // Park the reader until the next append
+    ocb->rcvid = ctp->rcvid;
+    ocb->nbytes = msg->i.nbytes;
+    ocb->blocked = 1;
+    ocb->next_waiter = waiters;
+    waiters = ocb;
+    atomic_store(&wake_armed, 1);
+    // An append between the read attempt and arming sent no pulse
+    if (has_data(ocb)) serve_waiters();
+    return _RESMGR_NOREPLY;
+}
+
+static int io_notify(resmgr_context_t* ctp, io_notify_t* msg, RESMGR_OCB_T* ocb) {
+    int trig = has_data(ocb) ? _NOTIFY_COND_INPUT : 0;
+    int status = iofunc_notify(ctp, msg, notify, trig, NULL, NULL);
+    if (notify[IOFUNC_NOTIFY_INPUT].list) atomic_store(&wake_armed, 1);
+    return status;
+}
 
-    RESMGR_MSGREAD(ctp, ctp->msg, n1, sizeof(*msg));
-    memcpy(((char*)ctp->msg) + sizeof(*msg), ring + r_tail, n1);
+static int io_devctl(resmgr_context_t* ctp, io_devctl_t* msg, RESMGR_OCB_T* ocb) {
+    int status = iofunc_devctl_default(ctp, msg, ocb);
+    if (status != _RESMGR_DEFAULT) return status;
+    if (msg->i.dcmd != DCMD_SLS_TELEM_MODE) return _RESMGR_ERR(ENOSYS);
 
-    r_tail = (r_tail + n1) % RBUF_SZ;
+    if (msg->i.nbytes < sizeof(int)) return _RESMGR_ERR(EINVAL);
+    int mode = *(int*)_DEVCTL_DATA(msg->i);
+    if (mode != SLS_TELEM_MODE_TEXT && mode != SLS_TELEM_MODE_BINARY) return _RESMGR_ERR(EINVAL);
+    if (ocb->blocked) return _RESMGR_ERR(EBUSY);
+    ocb->mode = mode;
+    ocb->line_off = ocb->line_len = 0; // a half-sent line is dropped
 
-    _IO_SET_READ_NBYTES(ctp, n1);
-    pthread_mutex_unlock(&rmtx);
-    return _RESMGR_NPARTS(0);
+    memset(&msg->o, 0, sizeof(msg->o));
+    return _RESMGR_PTR(ctp, &msg->o, sizeof(msg->o));
+}
+
+// A blocked reader was interrupted by a signal or timeout
+static int io_unblock(resmgr_context_t* ctp, io_pulse_t* msg, RESMGR_OCB_T* ocb) {
+    if (ocb->blocked && ocb->rcvid == ctp->rcvid) {
+        waiter_remove(ocb);
+        MsgError(ctp->rcvid, EINTR);
+        return _RESMGR_NOREPLY;
+    }
+    return iofunc_unblock_default(ctp, msg, ocb);
+}
+
+static int io_close_ocb(resmgr_context_t* ctp, void* reserved, RESMGR_OCB_T* ocb) {
+    if (ocb->blocked) {
+        MsgError(ocb->rcvid, EBADF);
+        waiter_remove(ocb);
+    }
+    iofunc_notify_remove(ctp, notify);
+    return iofunc_close_ocb_default(ctp, reserved, ocb);
 }
 
 static int io_open(resmgr_context_t* ctp, io_open_t* msg, RESMGR_HANDLE_T* handle, void* extra) {
+    (void)handle;
     return iofunc_open_default(ctp, msg, &ioattr, extra);
 }
 
 static void* rmgr_thread(void* arg) {
     (void)arg;
-    resmgr_context_t* ctp = dispatch_create();
-    if (ctp == NULL) return NULL;
+    dispatch_t* dpp = dispatch_create();
+    if (dpp == NULL) return NULL;
 
     iofunc_attr_init(&ioattr, S_IFCHR | 0444, NULL, NULL);
+    ioattr.mount = &mountpoint;
+    IOFUNC_NOTIFY_INIT(notify);
 
     memset(&cfuncs, 0, sizeof(cfuncs));
     cfuncs.open = io_open;
 
     iofunc_func_init(_RESMGR_CONNECT_NFUNCS, &cfuncs, _RESMGR_IO_NFUNCS, &ifuncs);
     ifuncs.read = io_read;
+    ifuncs.notify = io_notify;
+    ifuncs.devctl = io_devctl;
+    ifuncs.unblock = io_unblock;
+    ifuncs.close_ocb = io_close_ocb;
 
     resmgr_attr_t rattr;
     memset(&rattr, 0, sizeof(rattr));
 
-    int id = resmgr_attach(ctp, &rattr, "/dev/sls_telemetry", _FTYPE_ANY, 0, &cfuncs, &ifuncs, &ioattr);
+    int id = resmgr_attach(dpp, &rattr, "/dev/sls_telemetry", _FTYPE_ANY, 0, &cfuncs, &ifuncs, &ioattr);
     if (id == -1) {
-        dispatch_destroy(ctp);
+        dispatch_destroy(dpp);
+        return NULL;
+    }
+
+    wake_code = pulse_attach(dpp, MSG_FLAG_ALLOC_PULSE, 0, wake_pulse, NULL);
+    wake_coid = wake_code == -1 ? -1 : message_connect(dpp, MSG_FLAG_SIDE_CHANNEL);
+    if (wake_coid == -1) {
+        resmgr_detach(dpp, id, 0);
+        dispatch_destroy(dpp);
+        return NULL;
+    }
+
+    dispatch_context_t* ctp = dispatch_context_alloc(dpp);
+    if (ctp == NULL) {
+        resmgr_detach(dpp, id, 0);
+        dispatch_destroy(dpp);
         return NULL;
     }
 
     while (1) {
-        resmgr_context_t* rc = dispatch_block(ctp);
+        dispatch_context_t* rc = dispatch_block(ctp);
         if (!rc) break;
-        dispatch_handler(rc);
+        ctp = rc;
+        dispatch_handler(ctp);
     }
 
-    dispatch_destroy(ctp);
+    dispatch_context_free(ctp);
+    dispatch_destroy(dpp);
     return NULL;
 }
 
@@ -104,16 +302,12 @@ void rmgr_telemetry_stop(rmgr_telemetry_t* ctx) {
     ctx->running = 0;
 }
 
-void rmgr_telemetry_append(const char* line) {
-    if (!line) return;
-    pthread_mutex_lock(&rmtx);
-    size_t len = strnlen(line, 512);
-    for (size_t i = 0; i < len; ++i) {
-        ring[r_head] = line[i];
-        r_head = (r_head + 1) % RBUF_SZ;
-        if (r_head == r_tail) { // overwrite oldest
-            r_tail = (r_tail + 1) % RBUF_SZ;
-        }
-    }
-    pthread_mutex_unlock(&rmtx);
+void rmgr_telemetry_append(const sim_telem_record_t* rec) {
+    if (!rec) return;
+    pthread_mutex_lock(&wmtx);
+    telem_ring_append(&ring, rec, sizeof(*rec));
+    pthread_mutex_unlock(&wmtx);
+    // Readers are parked or select() is armed: one pulse until re-armed
+    if (atomic_exchange(&wake_armed, 0) && wake_coid != -1)
+        MsgSendPulse(wake_coid, -1, wake_code, 0);
 }
@@ -3,6 +3,8 @@
 
 #include <stddef.h>
 #include <pthread.h>
+#include <devctl.h>
+#include "sim_proto.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -20,8 +22,21 @@ int rmgr_telemetry_start(rmgr_telemetry_t* ctx, const char* devname);
 // Stop resource manager
 void rmgr_telemetry_stop(rmgr_telemetry_t* ctx);
 
-// Append one telemetry line (thread-safe). Line should be '\n' terminated.
-void rmgr_telemetry_append(const char* line);
+// Read format, chosen per open with DCMD_SLS_TELEM_MODE. Text (the default)
+// returns one sim_telem_format() line per sample; binary returns whole
+// sim_telem_record_t records and needs reads of at least one record.
+#define SLS_TELEM_MODE_TEXT 0
+#define SLS_TELEM_MODE_BINARY 1
+
+// int mode = SLS_TELEM_MODE_BINARY;
+// devctl(fd, DCMD_SLS_TELEM_MODE, &mode, sizeof(mode), NULL);
+#define DCMD_SLS_TELEM_MODE __DIOT(_DCMD_MISC, 0x51, int)
+
+// Append one telemetry sample (thread-safe). Only the fixed-size record is
+// stored; text-mode readers format it when they read. Readers never see a
+// record torn, and one that falls behind skips the oldest records instead
+// of slowing this.
+void rmgr_telemetry_append(const sim_telem_record_t* rec);
 
 #ifdef __cplusplus
 }
@@ -11,7 +11,12 @@
 #include "../common/sls_utils.h"
 #include "../common/sls_ipc.h"
 #include "../common/sls_logging.h"
+#include "../common/sls_alloc.h"
 #include "../common/cmd_server.h"
+#include "../common/sls_cmd_queue.h"
+#include "../common/cmd_trace.h"
+#include "../common/sls_trace.h"
+#include "sls_subsystems.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -57,12 +62,14 @@ typedef struct
     double fuel_manifold_pressure;
     double oxidizer_manifold_pressure;
     double turbopump_speed[NUM_ENGINES];
-    struct timespec last_update;
+    double throttle_command; // Percent, from the command queue
+    command_t awaiting_effect[SLS_CMD_QUEUE_CAPACITY]; // Applied, not yet in telemetry
+    int num_awaiting_effect;
+    sls_time_ns_t last_update_ns; // sls_time_monotonic_ns
 } engine_control_state_t;
 
 // Global engine control state
-static engine_control_state_t g_ecs_state;
-static volatile bool g_ecs_shutdown = false;
+static engine_control_state_t *g_ecs_state; // carved from the startup arena
 
 // Internal function declarations
 static void initialize_engine_control(void);
@@ -76,6 +83,9 @@ static void monitor_engine_health(int engine_id);
 static void handle_engine_fault(int engine_id, const char *fault_msg);
 static double simulate_chamber_pressure(int engine_id);
 static double simulate_turbopump_speed(int engine_id);
+static void process_engine_commands(void);
+static void apply_engine_command(const command_t *cmd);
+static void complete_command_traces(void);
 
 /**
  * @brief Engine Control System thread main function
@@ -90,129 +100,117 @@ void *engine_control_thread(void *arg)
 
     initialize_engine_control();
 
-    struct timespec loop_start, loop_end, sleep_time;
-    const long loop_period_ns = (1000000000L / config->update_rate_hz);
+    const sls_time_ns_t loop_period_ns = SLS_NS_PER_SEC / config->update_rate_hz;
 
-    // Track last command state
-    int last_go = -1;
-
-    while (!g_ecs_shutdown)
+    sls_alloc_steady_thread();
+    while (!sls_shutdown_requested())
     {
-        clock_gettime(CLOCK_MONOTONIC, &loop_start);
+        sls_time_ns_t loop_start = sls_time_monotonic_ns();
 
         // Calculate time delta
-        double dt = sls_time_diff(&g_ecs_state.last_update, &loop_start);
-        g_ecs_state.last_update = loop_start;
+        double dt = sls_time_to_seconds(loop_start - g_ecs_state->last_update_ns);
+        g_ecs_state->last_update_ns = loop_start;
 
-        // Apply external commands from command server
-        int go_cmd = cmd_get_mission_go();
-        int throttle_cmd = cmd_get_engine_throttle();
+        engine_control_step(dt, sls_time_realtime_ns());
 
-        // Clamp throttle and map to thrust percentage
-        if (throttle_cmd < 0) throttle_cmd = 0;
-        if (throttle_cmd > 100) throttle_cmd = 100;
+        // Sleep for the rest of the period
+        sls_time_sleep_ns(loop_period_ns - (sls_time_monotonic_ns() - loop_start));
+    }
 
-        // Transition detection for go/nogo
-        if (last_go != go_cmd)
-        {
-            if (go_cmd)
-            {
-                // Start ignition sequence if not already running
-                if (!g_ecs_state.ignition_sequence_active && !g_ecs_state.shutdown_sequence_active)
-                {
-                    g_ecs_state.ignition_sequence_active = true;
-                    sls_log(LOG_LEVEL_INFO, "ECS", "Command: GO -> starting ignition sequence");
-                }
-            }
-            else
-            {
-                // If GO removed, initiate shutdown; treat as abort if throttle already zero
-                if (!g_ecs_state.shutdown_sequence_active)
-                {
-                    g_ecs_state.shutdown_sequence_active = true;
-                    sls_log(LOG_LEVEL_WARNING, "ECS", "Command: NOGO/ABORT -> initiating shutdown sequence");
-                }
-            }
-            last_go = go_cmd;
-        }
+    sls_log(LOG_LEVEL_INFO, "ECS", "Engine Control System thread terminated");
+    return NULL;
+}
 
-        // Apply throttle command to all engines' commanded thrust
-        for (int i = 0; i < NUM_ENGINES; i++)
-        {
-            g_ecs_state.engines[i].engine_params.thrust_percentage = (double)throttle_cmd;
-        }
+/**
+ * @brief Prepare engine control to be stepped from the caller's thread
+ */
+void engine_control_init(void)
+{
+    initialize_engine_control();
+}
 
-        // Process ignition sequence if active
-        if (g_ecs_state.ignition_sequence_active)
-        {
-            process_ignition_sequence(dt);
-        }
+/**
+ * @brief Run one engine control tick
+ */
+void engine_control_step(double dt, sls_time_ns_t now)
+{
+    // Apply queued external commands before anything else this tick
+    process_engine_commands();
 
-        // Process shutdown sequence if active
-        if (g_ecs_state.shutdown_sequence_active)
-        {
-            process_shutdown_sequence(dt);
-        }
+    // Apply throttle command to all engines' commanded thrust
+    for (int i = 0; i < NUM_ENGINES; i++)
+    {
+        g_ecs_state->engines[i].engine_params.thrust_percentage = g_ecs_state->throttle_command;
+    }
 
-        // Update each engine
-        for (int i = 0; i < NUM_ENGINES; i++)
-        {
-            update_engine_state(i, dt);
-            update_engine_sensors(i, dt);
-            monitor_engine_health(i);
-        }
+    // Process ignition sequence if active
+    if (g_ecs_state->ignition_sequence_active)
+    {
+        process_ignition_sequence(dt);
+    }
 
-        // Send telemetry for engines
-        for (int i = 0; i < NUM_ENGINES; i++)
-        {
-            engine_data_t *engine = &g_ecs_state.engines[i];
-
-            // Chamber pressure telemetry
-            telemetry_point_t chamber_pressure_telem = {
-                .id = 2000 + i * 10,
-                .type = SENSOR_PRESSURE,
-                .value = engine->engine_params.chamber_pressure,
-                .min_value = 0.0,
-                .max_value = ENGINE_MAX_CHAMBER_PRESSURE,
-                .timestamp = loop_start,
-                .valid = !engine->fault_detected,
-                .quality = engine->fault_detected ? 50 : 100};
-            snprintf(chamber_pressure_telem.name, sizeof(chamber_pressure_telem.name),
-                     "Engine%d_ChamberPressure", i + 1);
-            strcpy(chamber_pressure_telem.units, "Pa");
-            sls_ipc_broadcast_telemetry(&chamber_pressure_telem);
-
-            // Thrust percentage telemetry
-            telemetry_point_t thrust_telem = {
-                .id = 2001 + i * 10,
-                .type = SENSOR_FLOW_RATE,
-                .value = engine->engine_params.thrust_percentage,
-                .min_value = 0.0,
-                .max_value = 100.0,
-                .timestamp = loop_start,
-                .valid = !engine->fault_detected,
-                .quality = engine->fault_detected ? 50 : 100};
-            snprintf(thrust_telem.name, sizeof(thrust_telem.name),
-                     "Engine%d_ThrustPct", i + 1);
-            strcpy(thrust_telem.units, "%");
-            sls_ipc_broadcast_telemetry(&thrust_telem);
-        }
+    // Process shutdown sequence if active
+    if (g_ecs_state->shutdown_sequence_active)
+    {
+        process_shutdown_sequence(dt);
+    }
 
-        // Calculate sleep time
-        clock_gettime(CLOCK_MONOTONIC, &loop_end);
-        long elapsed_ns = (loop_end.tv_sec - loop_start.tv_sec) * 1000000000L +
-                          (loop_end.tv_nsec - loop_start.tv_nsec);
+    // Update each engine
+    for (int i = 0; i < NUM_ENGINES; i++)
+    {
+        update_engine_state(i, dt);
+        update_engine_sensors(i, dt);
+        monitor_engine_health(i);
+    }
 
-        if (elapsed_ns < loop_period_ns)
-        {
-            sleep_time.tv_sec = 0;
-            sleep_time.tv_nsec = loop_period_ns - elapsed_ns;
-            nanosleep(&sleep_time, NULL);
-        }
+    // Send telemetry for engines
+    for (int i = 0; i < NUM_ENGINES; i++)
+    {
+        engine_data_t *engine = &g_ecs_state->engines[i];
+
+        // Chamber pressure telemetry
+        telemetry_point_t chamber_pressure_telem = {
+            .id = 2000 + i * 10,
+            .type = SENSOR_PRESSURE,
+            .value = engine->engine_params.chamber_pressure,
+            .min_value = 0.0,
+            .max_value = ENGINE_MAX_CHAMBER_PRESSURE,
+            .timestamp_ns = now,
+            .valid = !engine->fault_detected,
+            .quality = engine->fault_detected ? 50 : 100};
+        snprintf(chamber_pressure_telem.name, sizeof(chamber_pressure_telem.name),
+                 "Engine%d_ChamberPressure", i + 1);
+        strcpy(chamber_pressure_telem.units, "Pa");
+        sls_ipc_broadcast_telemetry(&chamber_pressure_telem);
+
+        // Thrust percentage telemetry
+        telemetry_point_t thrust_telem = {
+            .id = 2001 + i * 10,
+            .type = SENSOR_FLOW_RATE,
+            .value = engine->engine_params.thrust_percentage,
+            .min_value = 0.0,
+            .max_value = 100.0,
+            .timestamp_ns = now,
+            .valid = !engine->fault_detected,
+            .quality = engine->fault_detected ? 50 : 100};
+        snprintf(thrust_telem.name, sizeof(thrust_telem.name),
+                 "Engine%d_ThrustPct", i + 1);
+        strcpy(thrust_telem.units, "%");
+        sls_ipc_broadcast_telemetry(&thrust_telem);
     }
 
-    sls_log(LOG_LEVEL_INFO, "ECS", "Engine Control System thread terminated");
-    return NULL;
+    // Cluster averages for command server subscribers
+    double chamber_sum = 0.0, thrust_sum = 0.0;
+    for (int i = 0; i < NUM_ENGINES; i++)
+    {
+        chamber_sum += g_ecs_state->engines[i].engine_params.chamber_pressure;
+        thrust_sum += g_ecs_state->engines[i].engine_params.thrust_percentage;
+    }
+    cmd_publish_channel(CMD_CH_CHAMBER_PRESSURE, chamber_sum / NUM_ENGINES);
+    cmd_publish_channel(CMD_CH_THROTTLE, thrust_sum / NUM_ENGINES);
+
+    // This tick's telemetry now reflects the commands applied above
+    complete_command_traces();
 }
 
 /**
@@ -220,7 +218,11 @@ void *engine_control_thread(void *arg)
  */
 static void initialize_engine_control(void)
 {
-    memset(&g_ecs_state, 0, sizeof(g_ecs_state));
+    if (!g_ecs_state)
+    {
+        g_ecs_state = sls_alloc_startup(SUBSYS_ENGINE_CONTROL, sizeof(*g_ecs_state));
+    }
+    memset(g_ecs_state, 0, sizeof(*g_ecs_state));
 
     // Initialize all engines
     for (int i = 0; i < NUM_ENGINES; i++)
@@ -228,11 +230,11 @@ static void initialize_engine_control(void)
         initialize_engine(i);
     }
 
-    g_ecs_state.current_phase = PHASE_PRELAUNCH;
-    g_ecs_state.fuel_manifold_pressure = 1000000.0;     // 1 MPa
-    g_ecs_state.oxidizer_manifold_pressure = 1200000.0; // 1.2 MPa
+    g_ecs_state->current_phase = PHASE_PRELAUNCH;
+    g_ecs_state->fuel_manifold_pressure = 1000000.0;     // 1 MPa
+    g_ecs_state->oxidizer_manifold_pressure = 1200000.0; // 1.2 MPa
 
-    clock_gettime(CLOCK_MONOTONIC, &g_ecs_state.last_update);
+    g_ecs_state->last_update_ns = sls_time_monotonic_ns();
 
     sls_log(LOG_LEVEL_INFO, "ECS", "Engine control system initialized - %d engines", NUM_ENGINES);
 }
@@ -247,7 +249,7 @@ static void initialize_engine(int engine_id)
         return;
     }
 
-    engine_data_t *engine = &g_ecs_state.engines[engine_id];
+    engine_data_t *engine = &g_ecs_state->engines[engine_id];
 
     engine->engine_id = engine_id + 1;
     engine->state = ENGINE_STATE_OFFLINE;
@@ -265,7 +267,7 @@ static void initialize_engine(int engine_id)
     engine->engine_params.throttle_enabled = true;
 
     // Initialize turbopump speed
-    g_ecs_state.turbopump_speed[engine_id] = 0.0;
+    g_ecs_state->turbopump_speed[engine_id] = 0.0;
 
     sls_log(LOG_LEVEL_DEBUG, "ECS", "Engine %d initialized", engine_id + 1);
 }
@@ -275,18 +277,20 @@ static void initialize_engine(int engine_id)
  */
 static void update_engine_sensors(int engine_id, double dt)
 {
+    SLS_TRACE_SCOPE("update_engine_sensors");
+
     if (engine_id >= NUM_ENGINES)
     {
         return;
     }
 
-    engine_data_t *engine = &g_ecs_state.engines[engine_id];
+    engine_data_t *engine = &g_ecs_state->engines[engine_id];
 
     // Simulate chamber pressure sensor
     engine->engine_params.chamber_pressure = simulate_chamber_pressure(engine_id);
 
     // Simulate turbopump speed
-    g_ecs_state.turbopump_speed[engine_id] = simulate_turbopump_speed(engine_id);
+    g_ecs_state->turbopump_speed[engine_id] = simulate_turbopump_speed(engine_id);
 
     // Simulate nozzle temperature
     if (engine->state == ENGINE_STATE_RUNNING)
@@ -303,7 +307,7 @@ static void update_engine_sensors(int engine_id, double dt)
     // Update fuel and oxidizer flow rates
     calculate_fuel_flow(engine_id);
 
-    clock_gettime(CLOCK_REALTIME, &engine->engine_params.timestamp);
+    engine->engine_params.timestamp_ns = sls_time_realtime_ns();
 }
 
 /**
@@ -321,7 +325,7 @@ static void process_ignition_sequence(double dt)
         sls_log(LOG_LEVEL_INFO, "ECS", "Ignition sequence: Purging and pressurizing");
         for (int i = 0; i < NUM_ENGINES; i++)
         {
-            g_ecs_state.engines[i].state = ENGINE_STATE_PRESTART;
+            g_ecs_state->engines[i].state = ENGINE_STATE_PRESTART;
         }
     }
     else if (sequence_timer < 3.0)
@@ -330,7 +334,7 @@ static void process_ignition_sequence(double dt)
         sls_log(LOG_LEVEL_INFO, "ECS", "Ignition sequence: Turbopump startup");
         for (int i = 0; i < NUM_ENGINES; i++)
         {
-            g_ecs_state.turbopump_speed[i] = (sequence_timer - 1.0) / 2.0 * 12000.0; // RPM
+            g_ecs_state->turbopump_speed[i] = (sequence_timer - 1.0) / 2.0 * 12000.0; // RPM
         }
     }
     else if (sequence_timer < 4.0)
@@ -339,8 +343,8 @@ static void process_ignition_sequence(double dt)
         sls_log(LOG_LEVEL_INFO, "ECS", "Ignition sequence: Engine ignition");
         for (int i = 0; i < NUM_ENGINES; i++)
         {
-            g_ecs_state.engines[i].state = ENGINE_STATE_IGNITION;
-            g_ecs_state.engines[i].engine_params.ignition_enabled = true;
+            g_ecs_state->engines[i].state = ENGINE_STATE_IGNITION;
+            g_ecs_state->engines[i].engine_params.ignition_enabled = true;
         }
     }
     else
@@ -349,12 +353,12 @@ static void process_ignition_sequence(double dt)
         sls_log(LOG_LEVEL_INFO, "ECS", "Ignition sequence: Thrust ramp-up");
         for (int i = 0; i < NUM_ENGINES; i++)
         {
-            if (g_ecs_state.engines[i].state == ENGINE_STATE_IGNITION)
+            if (g_ecs_state->engines[i].state == ENGINE_STATE_IGNITION)
             {
-                g_ecs_state.engines[i].state = ENGINE_STATE_RUNNING;
+                g_ecs_state->engines[i].state = ENGINE_STATE_RUNNING;
             }
         }
-        g_ecs_state.ignition_sequence_active = false;
+        g_ecs_state->ignition_sequence_active = false;
         sequence_timer = 0.0;
         sls_log(LOG_LEVEL_INFO, "ECS", "Ignition sequence complete - all engines running");
     }
@@ -374,9 +378,9 @@ static void process_shutdown_sequence(double dt)
         double thrust_factor = 1.0 - (sequence_timer / ENGINE_SHUTDOWN_TIME_S);
         for (int i = 0; i < NUM_ENGINES; i++)
         {
-            if (g_ecs_state.engines[i].state == ENGINE_STATE_RUNNING)
+            if (g_ecs_state->engines[i].state == ENGINE_STATE_RUNNING)
             {
-                g_ecs_state.engines[i].engine_params.thrust_percentage =
+                g_ecs_state->engines[i].engine_params.thrust_percentage =
                     VEHICLE_MIN_THROTTLE * thrust_factor;
             }
         }
@@ -386,11 +390,11 @@ static void process_shutdown_sequence(double dt)
         // Complete shutdown
         for (int i = 0; i < NUM_ENGINES; i++)
         {
-            g_ecs_state.engines[i].state = ENGINE_STATE_OFFLINE;
-            g_ecs_state.engines[i].engine_params.thrust_percentage = 0.0;
-            g_ecs_state.engines[i].engine_params.ignition_enabled = false;
+            g_ecs_state->engines[i].state = ENGINE_STATE_OFFLINE;
+            g_ecs_state->engines[i].engine_params.thrust_percentage = 0.0;
+            g_ecs_state->engines[i].engine_params.ignition_enabled = false;
         }
-        g_ecs_state.shutdown_sequence_active = false;
+        g_ecs_state->shutdown_sequence_active = false;
         sequence_timer = 0.0;
         sls_log(LOG_LEVEL_INFO, "ECS", "Engine shutdown sequence complete");
     }
@@ -406,7 +410,7 @@ static void update_engine_state(int engine_id, double dt)
         return;
     }
 
-    engine_data_t *engine = &g_ecs_state.engines[engine_id];
+    engine_data_t *engine = &g_ecs_state->engines[engine_id];
 
     switch (engine->state)
     {
@@ -434,7 +438,7 @@ static void update_engine_state(int engine_id, double dt)
 
     case ENGINE_STATE_RUNNING:
         // Normal operation - thrust can be commanded
-        if (g_ecs_state.current_phase >= PHASE_LIFTOFF)
+        if (g_ecs_state->current_phase >= PHASE_LIFTOFF)
         {
             // Ramp up to full thrust
             if (engine->engine_params.thrust_percentage < 100.0)
@@ -475,7 +479,7 @@ static void calculate_fuel_flow(int engine_id)
         return;
     }
 
-    engine_data_t *engine = &g_ecs_state.engines[engine_id];
+    engine_data_t *engine = &g_ecs_state->engines[engine_id];
 
     if (engine->state == ENGINE_STATE_RUNNING)
     {
@@ -500,12 +504,14 @@ static void calculate_fuel_flow(int engine_id)
  */
 static void monitor_engine_health(int engine_id)
 {
+    SLS_TRACE_SCOPE("monitor_engine_health");
+
     if (engine_id >= NUM_ENGINES)
     {
         return;
     }
 
-    engine_data_t *engine = &g_ecs_state.engines[engine_id];
+    engine_data_t *engine = &g_ecs_state->engines[engine_id];
 
     // Check chamber pressure limits
     if (engine->state == ENGINE_STATE_RUNNING)
@@ -526,7 +532,7 @@ static void monitor_engine_health(int engine_id)
     // Check turbopump speed
     if (engine->state == ENGINE_STATE_RUNNING)
     {
-        if (g_ecs_state.turbopump_speed[engine_id] < 8000.0)
+        if (g_ecs_state->turbopump_speed[engine_id] < 8000.0)
         { // RPM
             handle_engine_fault(engine_id, "Turbopump underspeed");
             return;
@@ -557,7 +563,7 @@ static void handle_engine_fault(int engine_id, const char *fault_msg)
         return;
     }
 
-    engine_data_t *engine = &g_ecs_state.engines[engine_id];
+    engine_data_t *engine = &g_ecs_state->engines[engine_id];
 
     if (!engine->fault_detected)
     {
@@ -572,12 +578,12 @@ static void handle_engine_fault(int engine_id, const char *fault_msg)
         status_message_t fault_status = {
             .source = SUBSYS_ENGINE_CONTROL,
             .state = STATE_FAULT,
-            .phase = g_ecs_state.current_phase,
+            .phase = g_ecs_state->current_phase,
             .priority = PRIORITY_CRITICAL,
             .error_code = 3000 + engine_id};
         snprintf(fault_status.message, sizeof(fault_status.message),
                  "Engine %d fault: %s", engine->engine_id, fault_msg);
-        clock_gettime(CLOCK_REALTIME, &fault_status.timestamp);
+        fault_status.timestamp_ns = sls_time_realtime_ns();
 
         sls_ipc_broadcast_status(&fault_status);
     }
@@ -593,7 +599,7 @@ static double simulate_chamber_pressure(int engine_id)
         return 101325.0;
     }
 
-    engine_data_t *engine = &g_ecs_state.engines[engine_id];
+    engine_data_t *engine = &g_ecs_state->engines[engine_id];
     double base_pressure = 101325.0; // Atmospheric
 
     if (engine->state == ENGINE_STATE_RUNNING)
@@ -617,7 +623,7 @@ static double simulate_turbopump_speed(int engine_id)
         return 0.0;
     }
 
-    engine_data_t *engine = &g_ecs_state.engines[engine_id];
+    engine_data_t *engine = &g_ecs_state->engines[engine_id];
     double base_speed = 0.0;
 
     if (engine->state == ENGINE_STATE_RUNNING)
@@ -629,3 +635,92 @@ static double simulate_turbopump_speed(int engine_id)
     // Add some noise
     return sls_simulate_sensor_noise(base_speed, base_speed * 0.05); // 5% noise
 }
+
+/**
+ * @brief Drain the engine command queue
+ */
+static void process_engine_commands(void)
+{
+    sls_cmd_queue_t *queue = sls_cmd_queue_for(SUBSYS_ENGINE_CONTROL);
+
+    // At most one queue's worth per tick keeps the tick bounded
+    while (g_ecs_state->num_awaiting_effect < SLS_CMD_QUEUE_CAPACITY)
+    {
+        command_t *cmd = &g_ecs_state->awaiting_effect[g_ecs_state->num_awaiting_effect];
+        if (!sls_cmd_queue_pop(queue, cmd))
+        {
+            break;
+        }
+        cmd_trace_mark(cmd, CMD_STAGE_PICKUP);
+        apply_engine_command(cmd);
+        sls_cmd_acknowledge(cmd);
+        g_ecs_state->num_awaiting_effect++;
+    }
+}
+
+/**
+ * @brief Close the latency traces of commands applied this tick
+ */
+static void complete_command_traces(void)
+{
+    if (g_ecs_state->num_awaiting_effect == 0)
+    {
+        return;
+    }
+
+    uint64_t now = cmd_trace_now_ns();
+    for (int i = 0; i < g_ecs_state->num_awaiting_effect; i++)
+    {
+        g_ecs_state->awaiting_effect[i].stage_ns[CMD_STAGE_EFFECT] = now;
+        cmd_trace_record(&g_ecs_state->awaiting_effect[i]);
+    }
+    g_ecs_state->num_awaiting_effect = 0;
+}
+
+/**
+ * @brief Apply one external command to the engine control state
+ */
+static void apply_engine_command(const command_t *cmd)
+{
+    switch (cmd->opcode)
+    {
+    case CMD_OP_GO:
+        // Start ignition sequence if not already running
+        if (!g_ecs_state->ignition_sequence_active && !g_ecs_state->shutdown_sequence_active)
+        {
+            g_ecs_state->ignition_sequence_active = true;
+            sls_log(LOG_LEVEL_INFO, "ECS", "Command %u: GO -> starting ignition sequence",
+                    cmd->command_id);
+        }
+        break;
+
+    case CMD_OP_NOGO:
+        if (!g_ecs_state->shutdown_sequence_active)
+        {
+            g_ecs_state->shutdown_sequence_active = true;
+            sls_log(LOG_LEVEL_WARNING, "ECS", "Command %u: NOGO -> initiating shutdown sequence",
+                    cmd->command_id);
+        }
+        break;
+
+    case CMD_OP_ABORT:
+        g_ecs_state->throttle_command = 0.0;
+        g_ecs_state->ignition_sequence_active = false;
+        if (!g_ecs_state->shutdown_sequence_active)
+        {
+            g_ecs_state->shutdown_sequence_active = true;
+            sls_log(LOG_LEVEL_CRITICAL, "ECS", "Command %u: ABORT -> emergency engine shutdown",
+                    cmd->command_id);
+        }
+        break;
+
+    case CMD_OP_SET_THROTTLE:
+        g_ecs_state->throttle_command = sls_clamp(cmd->value, 0.0, 100.0);
+        break;
+
+    default:
+        sls_log(LOG_LEVEL_WARNING, "ECS", "Command %u: unsupported opcode %d",
+                cmd->command_id, cmd->opcode);
+        break;
+    }
+}
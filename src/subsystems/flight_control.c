@@ -11,6 +11,10 @@
 #include "../common/sls_utils.h"
 #include "../common/sls_ipc.h"
 #include "../common/sls_logging.h"
+#include "../common/sls_alloc.h"
+#include "../common/cmd_server.h"
+#include "../common/sls_trace.h"
+#include "sls_subsystems.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -31,12 +35,12 @@ typedef struct
     double control_gains[3]; // PID gains
     double last_error[3];
     double integral_error[3];
-    struct timespec last_update;
+    double applied_accel[3]; // steering and drag for the next integration step
+    sls_time_ns_t last_update_ns; // sls_time_monotonic_ns
 } flight_control_state_t;
 
 // Global flight control state
-static flight_control_state_t g_fc_state;
-static volatile bool g_fc_shutdown = false;
+static flight_control_state_t *g_fc_state; // carved from the startup arena
 
 // Internal function declarations
 static void initialize_flight_control(void);
@@ -61,71 +65,99 @@ void *flight_control_thread(void *arg)
 
     initialize_flight_control();
 
-    struct timespec loop_start, loop_end, sleep_time;
-    const long loop_period_ns = (1000000000L / config->update_rate_hz);
+    const sls_time_ns_t loop_period_ns = SLS_NS_PER_SEC / config->update_rate_hz;
 
-    while (!g_fc_shutdown)
+    sls_alloc_steady_thread();
+    while (!sls_shutdown_requested())
     {
-        clock_gettime(CLOCK_MONOTONIC, &loop_start);
+        sls_time_ns_t loop_start = sls_time_monotonic_ns();
 
         // Calculate time delta
-        double dt = sls_time_diff(&g_fc_state.last_update, &loop_start);
-        g_fc_state.last_update = loop_start;
+        double dt = sls_time_to_seconds(loop_start - g_fc_state->last_update_ns);
+        g_fc_state->last_update_ns = loop_start;
 
-        // Process incoming status updates (including phase changes)
-        process_status_updates();
+        flight_control_step(dt, sls_time_realtime_ns());
 
-        // Update vehicle dynamics simulation
-        update_vehicle_dynamics(dt);
+        // Sleep for the rest of the period
+        sls_time_sleep_ns(loop_period_ns - (sls_time_monotonic_ns() - loop_start));
+    }
 
-        // Calculate guidance commands if in active flight
-        if (g_fc_state.current_phase >= PHASE_LIFTOFF &&
-            g_fc_state.current_phase <= PHASE_ORBIT_INSERTION)
-        {
-            calculate_guidance_commands();
-        }
+    sls_log(LOG_LEVEL_INFO, "FCC", "Flight Control Computer thread terminated");
+    return NULL;
+}
 
-        // Run autopilot if enabled
-        if (g_fc_state.autopilot_enabled)
-        {
-            update_autopilot(dt);
-        }
+/**
+ * @brief Prepare flight control to be stepped from the caller's thread
+ */
+void flight_control_init(void)
+{
+    initialize_flight_control();
+}
 
-        // Apply atmospheric effects
-        simulate_atmospheric_effects();
-
-        // Check flight safety constraints
-        check_flight_constraints();
-
-        // Send telemetry
-        telemetry_point_t telemetry = {
-            .id = 1000,
-            .type = SENSOR_POSITION,
-            .value = g_fc_state.vehicle_state.altitude,
-            .min_value = -1000.0,
-            .max_value = 1000000.0,
-            .timestamp = loop_start,
-            .valid = true,
-            .quality = 100};
-        strcpy(telemetry.name, "Altitude");
-        strcpy(telemetry.units, "m");
-        sls_ipc_broadcast_telemetry(&telemetry);
-
-        // Calculate sleep time
-        clock_gettime(CLOCK_MONOTONIC, &loop_end);
-        long elapsed_ns = (loop_end.tv_sec - loop_start.tv_sec) * 1000000000L +
-                          (loop_end.tv_nsec - loop_start.tv_nsec);
-
-        if (elapsed_ns < loop_period_ns)
-        {
-            sleep_time.tv_sec = 0;
-            sleep_time.tv_nsec = loop_period_ns - elapsed_ns;
-            nanosleep(&sleep_time, NULL);
-        }
+/**
+ * @brief Run one flight control tick
+ */
+void flight_control_step(double dt, sls_time_ns_t now)
+{
+    // Process incoming status updates (including phase changes)
+    process_status_updates();
+
+    // Update vehicle dynamics simulation
+    update_vehicle_dynamics(dt);
+
+    // Calculate guidance commands if in active flight
+    if (g_fc_state->current_phase >= PHASE_LIFTOFF &&
+        g_fc_state->current_phase <= PHASE_ORBIT_INSERTION)
+    {
+        calculate_guidance_commands();
     }
 
-    sls_log(LOG_LEVEL_INFO, "FCC", "Flight Control Computer thread terminated");
-    return NULL;
+    // Run autopilot if enabled
+    if (g_fc_state->autopilot_enabled)
+    {
+        update_autopilot(dt);
+    }
+
+    // Apply atmospheric effects
+    simulate_atmospheric_effects();
+
+    // Check flight safety constraints
+    check_flight_constraints();
+
+    // Send telemetry
+    telemetry_point_t telemetry = {
+        .id = 1000,
+        .type = SENSOR_POSITION,
+        .value = g_fc_state->vehicle_state.altitude,
+        .min_value = -1000.0,
+        .max_value = 1000000.0,
+        .timestamp_ns = now,
+        .valid = true,
+        .quality = 100};
+    strcpy(telemetry.name, "Altitude");
+    strcpy(telemetry.units, "m");
+    sls_ipc_broadcast_telemetry(&telemetry);
+    SLS_TRACE_COUNTER("altitude_m", telemetry.value);
+
+    // Update the snapshot streamed to command server subscribers
+    const vehicle_state_t *vs = &g_fc_state->vehicle_state;
+    cmd_publish_channel(CMD_CH_MISSION_TIME, vs->mission_time);
+    cmd_publish_channel(CMD_CH_ALTITUDE, vs->altitude);
+    cmd_publish_channel(CMD_CH_VELOCITY,
+                        sqrt(vs->velocity[0] * vs->velocity[0] +
+                             vs->velocity[1] * vs->velocity[1] +
+                             vs->velocity[2] * vs->velocity[2]));
+    cmd_publish_channel(CMD_CH_ACCELERATION, vs->acceleration[2]);
+    cmd_publish_channel(CMD_CH_FUEL, vs->fuel_remaining);
+    cmd_publish_channel(CMD_CH_THRUST, vs->thrust);
+}
+
+/**
+ * @brief Current vehicle state, for the thread stepping flight control
+ */
+const vehicle_state_t *flight_control_vehicle_state(void)
+{
+    return &g_fc_state->vehicle_state;
 }
 
 /**
@@ -133,36 +165,40 @@ void *flight_control_thread(void *arg)
  */
 static void initialize_flight_control(void)
 {
-    memset(&g_fc_state, 0, sizeof(g_fc_state));
+    if (!g_fc_state)
+    {
+        g_fc_state = sls_alloc_startup(SUBSYS_FLIGHT_CONTROL, sizeof(*g_fc_state));
+    }
+    memset(g_fc_state, 0, sizeof(*g_fc_state));
 
     // Initialize vehicle state at launch pad
-    g_fc_state.vehicle_state.position[0] = 0.0; // X (downrange)
-    g_fc_state.vehicle_state.position[1] = 0.0; // Y (crossrange)
-    g_fc_state.vehicle_state.position[2] = 0.0; // Z (altitude)
-    g_fc_state.vehicle_state.altitude = 0.0;
-    g_fc_state.vehicle_state.mass = VEHICLE_DRY_MASS_KG + VEHICLE_FUEL_MASS_KG;
-    g_fc_state.vehicle_state.fuel_remaining = 100.0;
+    g_fc_state->vehicle_state.position[0] = 0.0; // X (downrange)
+    g_fc_state->vehicle_state.position[1] = 0.0; // Y (crossrange)
+    g_fc_state->vehicle_state.position[2] = 0.0; // Z (altitude)
+    g_fc_state->vehicle_state.altitude = 0.0;
+    g_fc_state->vehicle_state.mass = VEHICLE_DRY_MASS_KG + VEHICLE_FUEL_MASS_KG;
+    g_fc_state->vehicle_state.fuel_remaining = 100.0;
 
     // Initialize orientation (pointing up)
-    g_fc_state.vehicle_state.quaternion[0] = 1.0; // w
-    g_fc_state.vehicle_state.quaternion[1] = 0.0; // x
-    g_fc_state.vehicle_state.quaternion[2] = 0.0; // y
-    g_fc_state.vehicle_state.quaternion[3] = 0.0; // z
+    g_fc_state->vehicle_state.quaternion[0] = 1.0; // w
+    g_fc_state->vehicle_state.quaternion[1] = 0.0; // x
+    g_fc_state->vehicle_state.quaternion[2] = 0.0; // y
+    g_fc_state->vehicle_state.quaternion[3] = 0.0; // z
 
     // Initialize control parameters
-    g_fc_state.autopilot_enabled = true;
-    g_fc_state.guidance_active = false;
-    g_fc_state.target_altitude = 400000.0; // 400 km target orbit
+    g_fc_state->autopilot_enabled = true;
+    g_fc_state->guidance_active = false;
+    g_fc_state->target_altitude = 400000.0; // 400 km target orbit
 
     // PID gains for altitude control
-    g_fc_state.control_gains[0] = 0.1;  // Proportional
-    g_fc_state.control_gains[1] = 0.01; // Integral
-    g_fc_state.control_gains[2] = 0.05; // Derivative
+    g_fc_state->control_gains[0] = 0.1;  // Proportional
+    g_fc_state->control_gains[1] = 0.01; // Integral
+    g_fc_state->control_gains[2] = 0.05; // Derivative
 
-    clock_gettime(CLOCK_MONOTONIC, &g_fc_state.last_update);
+    g_fc_state->last_update_ns = sls_time_monotonic_ns();
 
     sls_log(LOG_LEVEL_INFO, "FCC", "Flight control initialized - vehicle mass: %.0f kg",
-            g_fc_state.vehicle_state.mass);
+            g_fc_state->vehicle_state.mass);
 }
 
 /**
@@ -170,25 +206,27 @@ static void initialize_flight_control(void)
  */
 static void update_vehicle_dynamics(double dt)
 {
+    SLS_TRACE_SCOPE("update_vehicle_dynamics");
+
     if (dt <= 0.0 || dt > 1.0)
     { // Sanity check
         return;
     }
 
-    vehicle_state_t *vs = &g_fc_state.vehicle_state;
+    vehicle_state_t *vs = &g_fc_state->vehicle_state;
 
     // Update mission time
     vs->mission_time += dt;
 
     // Apply physics based on mission phase and ground support
-    if (g_fc_state.current_phase >= PHASE_LIFTOFF &&
-        g_fc_state.current_phase <= PHASE_ORBIT_INSERTION)
+    if (g_fc_state->current_phase >= PHASE_LIFTOFF &&
+        g_fc_state->current_phase <= PHASE_ORBIT_INSERTION)
     {
         // Vehicle is in flight - apply thrust and gravity
 
         // Calculate thrust based on mission phase
         double thrust_percentage = 100.0;
-        if (g_fc_state.current_phase == PHASE_ASCENT)
+        if (g_fc_state->current_phase == PHASE_ASCENT)
         {
             // Throttle down during atmospheric ascent
             thrust_percentage = 75.0;
@@ -196,9 +234,15 @@ static void update_vehicle_dynamics(double dt)
 
         vs->thrust = VEHICLE_MAX_THRUST_N * (thrust_percentage / 100.0);
 
-        // Calculate acceleration (F = ma)
+        // Calculate acceleration (F = ma): steering and drag from the last
+        // tick, plus thrust minus gravity. Rebuilt every step so nothing
+        // accumulates across ticks.
         double thrust_accel = vs->thrust / vs->mass;
-        vs->acceleration[2] = thrust_accel - 9.81; // Thrust minus gravity
+        for (int i = 0; i < 3; i++)
+        {
+            vs->acceleration[i] = g_fc_state->applied_accel[i];
+        }
+        vs->acceleration[2] += thrust_accel - 9.81;
 
         // Fuel consumption
         double fuel_flow_rate = 1000.0; // kg/s (simplified)
@@ -206,7 +250,7 @@ static void update_vehicle_dynamics(double dt)
         vs->fuel_remaining = ((vs->mass - VEHICLE_DRY_MASS_KG) / VEHICLE_FUEL_MASS_KG) * 100.0;
         vs->fuel_remaining = sls_clamp(vs->fuel_remaining, 0.0, 100.0);
     }
-    else if (g_fc_state.current_phase == PHASE_IGNITION)
+    else if (g_fc_state->current_phase == PHASE_IGNITION)
     {
         // Vehicle is igniting engines but still on ground support
         vs->thrust = VEHICLE_MAX_THRUST_N * 0.5; // 50% thrust during ignition
@@ -241,10 +285,11 @@ static void update_vehicle_dynamics(double dt)
         vs->altitude = 0.0;
     }
 
-    // Integrate velocity
+    // Integrate velocity; steering and drag are recomputed after this step
     for (int i = 0; i < 3; i++)
     {
         vs->velocity[i] += vs->acceleration[i] * dt;
+        g_fc_state->applied_accel[i] = 0.0;
     }
 
     // Integrate position
@@ -264,7 +309,7 @@ static void update_vehicle_dynamics(double dt)
     vs->dynamic_pressure = 0.5 * air_density * velocity_magnitude * velocity_magnitude;
     vs->mach_number = velocity_magnitude / 343.0; // Speed of sound at sea level
 
-    clock_gettime(CLOCK_REALTIME, &vs->timestamp);
+    vs->timestamp_ns = sls_time_realtime_ns();
 }
 
 /**
@@ -272,15 +317,15 @@ static void update_vehicle_dynamics(double dt)
  */
 static void calculate_guidance_commands(void)
 {
-    vehicle_state_t *vs = &g_fc_state.vehicle_state;
+    vehicle_state_t *vs = &g_fc_state->vehicle_state;
 
-    switch (g_fc_state.current_phase)
+    switch (g_fc_state->current_phase)
     {
     case PHASE_LIFTOFF:
         // Vertical ascent for first 10 seconds
-        g_fc_state.target_velocity[0] = 0.0;
-        g_fc_state.target_velocity[1] = 0.0;
-        g_fc_state.target_velocity[2] = 50.0; // 50 m/s upward
+        g_fc_state->target_velocity[0] = 0.0;
+        g_fc_state->target_velocity[1] = 0.0;
+        g_fc_state->target_velocity[2] = 50.0; // 50 m/s upward
         break;
 
     case PHASE_ASCENT:
@@ -291,22 +336,22 @@ static void calculate_guidance_commands(void)
             pitch_angle = sls_clamp(pitch_angle, 0.0, M_PI / 3);        // Max 60 degrees
 
             double target_speed = 200.0 + vs->altitude * 0.01; // Increase with altitude
-            g_fc_state.target_velocity[0] = target_speed * sin(pitch_angle);
-            g_fc_state.target_velocity[2] = target_speed * cos(pitch_angle);
+            g_fc_state->target_velocity[0] = target_speed * sin(pitch_angle);
+            g_fc_state->target_velocity[2] = target_speed * cos(pitch_angle);
         }
         break;
 
     case PHASE_ORBIT_INSERTION:
         // Horizontal acceleration for orbit
-        g_fc_state.target_velocity[0] = 7800.0; // Orbital velocity
-        g_fc_state.target_velocity[2] = 0.0;    // No vertical component
+        g_fc_state->target_velocity[0] = 7800.0; // Orbital velocity
+        g_fc_state->target_velocity[2] = 0.0;    // No vertical component
         break;
 
     default:
         break;
     }
 
-    g_fc_state.guidance_active = true;
+    g_fc_state->guidance_active = true;
 }
 
 /**
@@ -314,37 +359,37 @@ static void calculate_guidance_commands(void)
  */
 static void update_autopilot(double dt)
 {
-    if (!g_fc_state.guidance_active)
+    if (!g_fc_state->guidance_active)
     {
         return;
     }
 
-    vehicle_state_t *vs = &g_fc_state.vehicle_state;
+    vehicle_state_t *vs = &g_fc_state->vehicle_state;
 
     // Simple PID controller for velocity
     for (int axis = 0; axis < 3; axis++)
     {
-        double error = g_fc_state.target_velocity[axis] - vs->velocity[axis];
+        double error = g_fc_state->target_velocity[axis] - vs->velocity[axis];
 
         // Proportional term
-        double p_term = g_fc_state.control_gains[0] * error;
+        double p_term = g_fc_state->control_gains[0] * error;
 
         // Integral term
-        g_fc_state.integral_error[axis] += error * dt;
-        double i_term = g_fc_state.control_gains[1] * g_fc_state.integral_error[axis];
+        g_fc_state->integral_error[axis] += error * dt;
+        double i_term = g_fc_state->control_gains[1] * g_fc_state->integral_error[axis];
 
         // Derivative term
-        double d_error = (error - g_fc_state.last_error[axis]) / dt;
-        double d_term = g_fc_state.control_gains[2] * d_error;
+        double d_error = (error - g_fc_state->last_error[axis]) / dt;
+        double d_term = g_fc_state->control_gains[2] * d_error;
 
         // Control output (simplified - in reality this would command engine gimbaling)
         double control_output = p_term + i_term + d_term;
         control_output = sls_clamp(control_output, -10.0, 10.0);
 
-        // Apply control (simplified)
-        vs->acceleration[axis] += control_output;
+        // Apply control (simplified): takes effect at the next integration
+        g_fc_state->applied_accel[axis] += control_output;
 
-        g_fc_state.last_error[axis] = error;
+        g_fc_state->last_error[axis] = error;
     }
 }
 
@@ -353,7 +398,7 @@ static void update_autopilot(double dt)
  */
 static void simulate_atmospheric_effects(void)
 {
-    vehicle_state_t *vs = &g_fc_state.vehicle_state;
+    vehicle_state_t *vs = &g_fc_state->vehicle_state;
 
     if (vs->altitude < 100000.0)
     { // Below 100 km
@@ -374,7 +419,7 @@ static void simulate_atmospheric_effects(void)
             for (int i = 0; i < 3; i++)
             {
                 double drag_accel = -(drag_force / vs->mass) * (vs->velocity[i] / velocity_magnitude);
-                vs->acceleration[i] += drag_accel;
+                g_fc_state->applied_accel[i] += drag_accel;
             }
         }
     }
@@ -385,10 +430,10 @@ static void simulate_atmospheric_effects(void)
  */
 static void check_flight_constraints(void)
 {
-    vehicle_state_t *vs = &g_fc_state.vehicle_state;
+    vehicle_state_t *vs = &g_fc_state->vehicle_state;
 
     // Check altitude limits - only error if vehicle is in flight and below ground
-    if (vs->altitude < -10.0 && g_fc_state.current_phase >= PHASE_LIFTOFF)
+    if (vs->altitude < -10.0 && g_fc_state->current_phase >= PHASE_LIFTOFF)
     {
         sls_log(LOG_LEVEL_ERROR, "FCC", "Vehicle below ground level during flight: %.1f m", vs->altitude);
     }
@@ -398,7 +443,7 @@ static void check_flight_constraints(void)
     }
 
     // Check fuel levels
-    if (vs->fuel_remaining < 5.0 && g_fc_state.current_phase < PHASE_ORBIT_INSERTION)
+    if (vs->fuel_remaining < 5.0 && g_fc_state->current_phase < PHASE_ORBIT_INSERTION)
     {
         sls_log(LOG_LEVEL_WARNING, "FCC", "Low fuel warning: %.1f%% remaining",
                 vs->fuel_remaining);
@@ -426,13 +471,13 @@ static void check_flight_constraints(void)
  */
 static void handle_mission_phase_change(mission_phase_t new_phase)
 {
-    if (new_phase == g_fc_state.current_phase)
+    if (new_phase == g_fc_state->current_phase)
     {
         return;
     }
 
-    mission_phase_t old_phase = g_fc_state.current_phase;
-    g_fc_state.current_phase = new_phase;
+    mission_phase_t old_phase = g_fc_state->current_phase;
+    g_fc_state->current_phase = new_phase;
 
     sls_log(LOG_LEVEL_INFO, "FCC", "Mission phase change: %s -> %s",
             sls_mission_phase_to_string(old_phase),
@@ -446,7 +491,7 @@ static void handle_mission_phase_change(mission_phase_t new_phase)
 
     case PHASE_LIFTOFF:
         sls_log(LOG_LEVEL_INFO, "FCC", "LIFTOFF! Vehicle departing launch pad");
-        g_fc_state.guidance_active = true;
+        g_fc_state->guidance_active = true;
         break;
 
     case PHASE_ASCENT:
@@ -456,7 +501,7 @@ static void handle_mission_phase_change(mission_phase_t new_phase)
     case PHASE_STAGE_SEPARATION:
         sls_log(LOG_LEVEL_INFO, "FCC", "Stage separation event");
         // Simulate mass reduction
-        g_fc_state.vehicle_state.mass *= 0.3; // Upper stage is 30% of original mass
+        g_fc_state->vehicle_state.mass *= 0.3; // Upper stage is 30% of original mass
         break;
 
     case PHASE_ORBIT_INSERTION:
@@ -465,8 +510,8 @@ static void handle_mission_phase_change(mission_phase_t new_phase)
 
     case PHASE_ABORT:
         sls_log(LOG_LEVEL_CRITICAL, "FCC", "MISSION ABORT - Emergency procedures activated");
-        g_fc_state.autopilot_enabled = false;
-        g_fc_state.guidance_active = false;
+        g_fc_state->autopilot_enabled = false;
+        g_fc_state->guidance_active = false;
         break;
 
     default:
@@ -483,7 +528,7 @@ static void process_status_updates(void)
     mission_phase_t current_main_phase = sls_get_current_mission_phase();
 
     // Check if phase has changed
-    if (current_main_phase != g_fc_state.current_phase)
+    if (current_main_phase != g_fc_state->current_phase)
     {
         handle_mission_phase_change(current_main_phase);
     }
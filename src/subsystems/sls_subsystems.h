@@ -0,0 +1,33 @@
+#ifndef SLS_SUBSYSTEMS_H
+#define SLS_SUBSYSTEMS_H
+
+/**
+ * @file sls_subsystems.h
+ * @brief Single-threaded stepping of the flight, engine and telemetry subsystems
+ *
+ * Each subsystem thread is an init call followed by a paced loop around its
+ * step function. Headless and lockstep runs call the same functions from
+ * one thread instead, advancing simulated time as fast as the host allows.
+ * Do not mix the two for one subsystem.
+ */
+
+#include "../common/sls_types.h"
+#include <time.h>
+
+// Flight control: one guidance/dynamics tick of dt seconds; telemetry is
+// stamped with now (CLOCK_REALTIME ns)
+void flight_control_init(void);
+void flight_control_step(double dt, sls_time_ns_t now);
+const vehicle_state_t *flight_control_vehicle_state(void);
+
+// Engine control: commands, ignition/shutdown sequencing, per-engine update
+void engine_control_init(void);
+void engine_control_step(double dt, sls_time_ns_t now);
+
+// Telemetry: collect, transmit and log one packet. Stepped telemetry skips
+// the simulated link delay the thread applies.
+void telemetry_init(void);
+void telemetry_step(double dt);
+void telemetry_close_log(void);
+
+#endif // SLS_SUBSYSTEMS_H
@@ -22,7 +22,7 @@ void *environmental_thread(void *arg)
 
     struct timespec sleep_time = {1, 0}; // 1 second
 
-    while (1)
+    while (!sls_shutdown_requested())
     {
         // Simulate environmental monitoring
         nanosleep(&sleep_time, NULL);
@@ -40,7 +40,7 @@ void *ground_support_thread(void *arg)
 
     struct timespec sleep_time = {1, 0}; // 1 second
 
-    while (1)
+    while (!sls_shutdown_requested())
     {
         // Simulate ground support operations
         nanosleep(&sleep_time, NULL);
@@ -58,7 +58,7 @@ void *navigation_thread(void *arg)
 
     struct timespec sleep_time = {1, 0}; // 1 second
 
-    while (1)
+    while (!sls_shutdown_requested())
     {
         // Simulate navigation processing
         nanosleep(&sleep_time, NULL);
@@ -76,7 +76,7 @@ void *power_thread(void *arg)
 
     struct timespec sleep_time = {1, 0}; // 1 second
 
-    while (1)
+    while (!sls_shutdown_requested())
     {
         // Simulate power management
         nanosleep(&sleep_time, NULL);
@@ -94,7 +94,7 @@ void *thermal_thread(void *arg)
 
     struct timespec sleep_time = {1, 0}; // 1 second
 
-    while (1)
+    while (!sls_shutdown_requested())
     {
         // Simulate thermal control
         nanosleep(&sleep_time, NULL);
@@ -11,6 +11,10 @@
 #include "../common/sls_utils.h"
 #include "../common/sls_ipc.h"
 #include "../common/sls_logging.h"
+#include "../common/sls_alloc.h"
+#include "../common/sls_metrics.h"
+#include "../common/sls_trace.h"
+#include "sls_subsystems.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -22,22 +26,26 @@
 // Telemetry system state
 typedef struct
 {
-    telemetry_point_t telemetry_buffer[MAX_TELEMETRY_POINTS];
-    int buffer_count;
+    int buffer_count; // points waiting in g_telem_history
     int next_sequence_number;
     FILE *telemetry_log_file;
     bool logging_enabled;
     double mission_time;
     uint32_t packets_sent;
     uint32_t bytes_transmitted;
-    struct timespec last_transmission;
+    sls_time_ns_t last_transmission_ns; // CLOCK_REALTIME
 } telemetry_state_t;
 
 // Global telemetry state
-static telemetry_state_t g_telem_state;
-static volatile bool g_telem_shutdown = false;
+static telemetry_state_t *g_telem_state; // carved from the startup arena
+static telemetry_point_t *g_telem_history; // telemetry.history_points, ditto
+static int g_telem_history_len;
+static bool g_telem_stepped = false; // stepped headless: no simulated link delay
+static sls_metric_t *g_packets_metric;
+static sls_metric_t *g_bytes_metric;
 
 // Internal function declarations
+static void reserve_telemetry_state(void);
 static void initialize_telemetry(void);
 static void process_telemetry_data(double dt);
 static void format_telemetry_packet(void);
@@ -59,34 +67,23 @@ void *telemetry_thread(void *arg)
 
     initialize_telemetry();
 
-    struct timespec loop_start, loop_end, sleep_time;
-    const long loop_period_ns = (1000000000L / config->update_rate_hz);
+    const sls_time_ns_t loop_period_ns = SLS_NS_PER_SEC / config->update_rate_hz;
+    sls_time_ns_t last_update = 0;
 
-    while (!g_telem_shutdown)
+    sls_alloc_steady_thread();
+    while (!sls_shutdown_requested())
     {
-        clock_gettime(CLOCK_MONOTONIC, &loop_start);
+        sls_time_ns_t loop_start = sls_time_monotonic_ns();
 
         // Calculate time delta
-        static struct timespec last_update = {0};
         double dt = 0.0;
-        if (last_update.tv_sec != 0)
+        if (last_update != 0)
         {
-            dt = sls_time_diff(&last_update, &loop_start);
+            dt = sls_time_to_seconds(loop_start - last_update);
         }
         last_update = loop_start;
 
-        // Update mission time
-        g_telem_state.mission_time += dt;
-
-        // Process telemetry data
-        process_telemetry_data(dt);
-
-        // Format and transmit telemetry
-        format_telemetry_packet();
-        transmit_telemetry();
-
-        // Update communication status
-        update_communication_status();
+        telemetry_step(dt);
 
         // Send system status
         status_message_t status = {
@@ -97,8 +94,8 @@ void *telemetry_thread(void *arg)
             .error_code = 0};
         snprintf(status.message, sizeof(status.message),
                  "Telemetry active - %u packets sent, %u bytes",
-                 g_telem_state.packets_sent, g_telem_state.bytes_transmitted);
-        clock_gettime(CLOCK_REALTIME, &status.timestamp);
+                 g_telem_state->packets_sent, g_telem_state->bytes_transmitted);
+        status.timestamp_ns = sls_time_realtime_ns();
 
         // Send status every 10 seconds
         static int status_counter = 0;
@@ -108,48 +105,99 @@ void *telemetry_thread(void *arg)
             status_counter = 0;
         }
 
-        // Calculate sleep time
-        clock_gettime(CLOCK_MONOTONIC, &loop_end);
-        long elapsed_ns = (loop_end.tv_sec - loop_start.tv_sec) * 1000000000L +
-                          (loop_end.tv_nsec - loop_start.tv_nsec);
-
-        if (elapsed_ns < loop_period_ns)
-        {
-            sleep_time.tv_sec = 0;
-            sleep_time.tv_nsec = loop_period_ns - elapsed_ns;
-            nanosleep(&sleep_time, NULL);
-        }
+        // Sleep for the rest of the period
+        sls_time_sleep_ns(loop_period_ns - (sls_time_monotonic_ns() - loop_start));
     }
 
     // Cleanup
-    if (g_telem_state.telemetry_log_file)
-    {
-        fclose(g_telem_state.telemetry_log_file);
-    }
+    telemetry_close_log();
 
     sls_log(LOG_LEVEL_INFO, "TELEM", "Telemetry system thread terminated");
     return NULL;
 }
 
+/**
+ * @brief Prepare telemetry to be stepped from the caller's thread
+ */
+void telemetry_init(void)
+{
+    initialize_telemetry();
+    g_telem_stepped = true;
+}
+
+/**
+ * @brief Run one telemetry tick
+ */
+void telemetry_step(double dt)
+{
+    // Update mission time
+    g_telem_state->mission_time += dt;
+
+    // Process telemetry data
+    process_telemetry_data(dt);
+
+    // Format and transmit telemetry
+    format_telemetry_packet();
+    transmit_telemetry();
+
+    // Update communication status
+    update_communication_status();
+}
+
+/**
+ * @brief Flush and close the telemetry CSV
+ */
+void telemetry_close_log(void)
+{
+    if (g_telem_state->telemetry_log_file)
+    {
+        fclose(g_telem_state->telemetry_log_file);
+        g_telem_state->telemetry_log_file = NULL;
+    }
+}
+
+/**
+ * @brief Carve the state and the history buffer from the startup arena, once
+ */
+static void reserve_telemetry_state(void)
+{
+    if (g_telem_state)
+    {
+        return;
+    }
+
+    int len = sls_get_config_int("telemetry.history_points", MAX_TELEMETRY_POINTS);
+    g_telem_history_len = len > 0 ? len : MAX_TELEMETRY_POINTS;
+    g_telem_state = sls_alloc_startup(SUBSYS_TELEMETRY, sizeof(*g_telem_state));
+    g_telem_history = sls_alloc_startup(SUBSYS_TELEMETRY, sizeof(telemetry_point_t) *
+                                                              (size_t)g_telem_history_len);
+}
+
 /**
  * @brief Initialize telemetry system
  */
 static void initialize_telemetry(void)
 {
-    memset(&g_telem_state, 0, sizeof(g_telem_state));
+    reserve_telemetry_state();
+    memset(g_telem_state, 0, sizeof(*g_telem_state));
+
+    g_telem_state->logging_enabled = true;
+    g_telem_state->next_sequence_number = 1;
 
-    g_telem_state.logging_enabled = true;
-    g_telem_state.next_sequence_number = 1;
-    clock_gettime(CLOCK_REALTIME, &g_telem_state.last_transmission);
+    g_packets_metric = sls_metrics_counter("sls_telemetry_packets_sent_total", NULL,
+                                           "Telemetry packets transmitted");
+    g_bytes_metric = sls_metrics_counter("sls_telemetry_bytes_transmitted_total", NULL,
+                                         "Telemetry bytes transmitted");
+    g_telem_state->last_transmission_ns = sls_time_realtime_ns();
 
     // Open telemetry log file
-    g_telem_state.telemetry_log_file = fopen(TELEMETRY_FILE_PATH, "w");
-    if (g_telem_state.telemetry_log_file)
+    g_telem_state->telemetry_log_file = fopen(TELEMETRY_FILE_PATH, "w");
+    if (g_telem_state->telemetry_log_file)
     {
         // Write CSV header
-        fprintf(g_telem_state.telemetry_log_file,
+        fprintf(g_telem_state->telemetry_log_file,
                 "Timestamp,Mission_Time,Telemetry_ID,Name,Type,Value,Units,Quality\n");
-        fflush(g_telem_state.telemetry_log_file);
+        fflush(g_telem_state->telemetry_log_file);
     }
     else
     {
@@ -172,14 +220,14 @@ static void process_telemetry_data(double dt)
     telemetry_point_t vehicle_telem[] = {
         {.id = 1001,
          .type = SENSOR_ALTITUDE,
-         .value = 1000.0 + g_telem_state.mission_time * 50.0, // Rising altitude
+         .value = 1000.0 + g_telem_state->mission_time * 50.0, // Rising altitude
          .min_value = -1000.0,
          .max_value = 1000000.0,
          .valid = true,
          .quality = 100},
         {.id = 1002,
          .type = SENSOR_VELOCITY,
-         .value = g_telem_state.mission_time * 10.0, // Increasing velocity
+         .value = g_telem_state->mission_time * 10.0, // Increasing velocity
          .min_value = -1000.0,
          .max_value = 10000.0,
          .valid = true,
@@ -201,21 +249,20 @@ static void process_telemetry_data(double dt)
     strcpy(vehicle_telem[2].units, "m/s²");
 
     // Add timestamps
-    struct timespec now;
-    clock_gettime(CLOCK_REALTIME, &now);
+    sls_time_ns_t now = sls_time_realtime_ns();
     for (int i = 0; i < 3; i++)
     {
-        vehicle_telem[i].timestamp = now;
+        vehicle_telem[i].timestamp_ns = now;
     }
 
     // Store in buffer if space available
-    for (int i = 0; i < 3 && g_telem_state.buffer_count < MAX_TELEMETRY_POINTS; i++)
+    for (int i = 0; i < 3 && g_telem_state->buffer_count < g_telem_history_len; i++)
     {
-        g_telem_state.telemetry_buffer[g_telem_state.buffer_count] = vehicle_telem[i];
-        g_telem_state.buffer_count++;
+        g_telem_history[g_telem_state->buffer_count] = vehicle_telem[i];
+        g_telem_state->buffer_count++;
 
         // Log to file
-        if (g_telem_state.logging_enabled)
+        if (g_telem_state->logging_enabled)
         {
             log_telemetry_to_file(&vehicle_telem[i]);
         }
@@ -227,7 +274,7 @@ static void process_telemetry_data(double dt)
  */
 static void format_telemetry_packet(void)
 {
-    if (g_telem_state.buffer_count == 0)
+    if (g_telem_state->buffer_count == 0)
     {
         return;
     }
@@ -239,7 +286,7 @@ static void format_telemetry_packet(void)
     if (++format_counter % 100 == 0)
     { // Log every 100 packets
         sls_log(LOG_LEVEL_DEBUG, "TELEM", "Formatted telemetry packet with %d points",
-                g_telem_state.buffer_count);
+                g_telem_state->buffer_count);
     }
 }
 
@@ -248,32 +295,39 @@ static void format_telemetry_packet(void)
  */
 static void transmit_telemetry(void)
 {
-    if (g_telem_state.buffer_count == 0)
+    SLS_TRACE_SCOPE("transmit_telemetry");
+
+    if (g_telem_state->buffer_count == 0)
     {
         return;
     }
 
     // Simulate transmission delay
-    simulate_transmission_delay();
+    if (!g_telem_stepped)
+    {
+        simulate_transmission_delay();
+    }
 
     // Calculate packet size (simplified)
-    size_t packet_size = sizeof(telemetry_point_t) * g_telem_state.buffer_count + 64; // Header
+    size_t packet_size = sizeof(telemetry_point_t) * g_telem_state->buffer_count + 64; // Header
 
     // Update statistics
-    g_telem_state.packets_sent++;
-    g_telem_state.bytes_transmitted += packet_size;
-    clock_gettime(CLOCK_REALTIME, &g_telem_state.last_transmission);
+    g_telem_state->packets_sent++;
+    g_telem_state->bytes_transmitted += packet_size;
+    sls_metric_inc(g_packets_metric);
+    sls_metric_add(g_bytes_metric, packet_size);
+    g_telem_state->last_transmission_ns = sls_time_realtime_ns();
 
     // Log telemetry transmission
     static int tx_counter = 0;
     if (++tx_counter % 50 == 0)
     { // Log every 50 transmissions
         sls_log(LOG_LEVEL_DEBUG, "TELEM", "Transmitted packet #%u (%zu bytes, %d points)",
-                g_telem_state.packets_sent, packet_size, g_telem_state.buffer_count);
+                g_telem_state->packets_sent, packet_size, g_telem_state->buffer_count);
     }
 
     // Clear buffer after transmission
-    g_telem_state.buffer_count = 0;
+    g_telem_state->buffer_count = 0;
 }
 
 /**
@@ -281,30 +335,33 @@ static void transmit_telemetry(void)
  */
 static void log_telemetry_to_file(const telemetry_point_t *point)
 {
-    if (!g_telem_state.telemetry_log_file || !point)
+    if (!g_telem_state->telemetry_log_file || !point)
     {
         return;
     }
 
     // Format timestamp
     char timestamp_str[32];
-    struct tm *tm_info = localtime(&point->timestamp.tv_sec);
+    struct timespec ts;
+    struct tm tm_info;
+    sls_time_to_timespec(point->timestamp_ns, &ts);
+    localtime_r(&ts.tv_sec, &tm_info);
     snprintf(timestamp_str, sizeof(timestamp_str), "%04d-%02d-%02d %02d:%02d:%02d.%03ld",
-             tm_info->tm_year + 1900, tm_info->tm_mon + 1, tm_info->tm_mday,
-             tm_info->tm_hour, tm_info->tm_min, tm_info->tm_sec,
-             point->timestamp.tv_nsec / 1000000);
+             tm_info.tm_year + 1900, tm_info.tm_mon + 1, tm_info.tm_mday,
+             tm_info.tm_hour, tm_info.tm_min, tm_info.tm_sec,
+             ts.tv_nsec / 1000000);
 
     // Write CSV record
-    fprintf(g_telem_state.telemetry_log_file,
+    fprintf(g_telem_state->telemetry_log_file,
             "%s,%.3f,%u,%s,%d,%.6f,%s,%u\n",
-            timestamp_str, g_telem_state.mission_time, point->id, point->name,
+            timestamp_str, g_telem_state->mission_time, point->id, point->name,
             (int)point->type, point->value, point->units, point->quality);
 
     // Flush periodically
     static int flush_counter = 0;
     if (++flush_counter % 10 == 0)
     {
-        fflush(g_telem_state.telemetry_log_file);
+        fflush(g_telem_state->telemetry_log_file);
     }
 }
 
@@ -314,23 +371,22 @@ static void log_telemetry_to_file(const telemetry_point_t *point)
 static void update_communication_status(void)
 {
     // Check for communication health
-    struct timespec now;
-    clock_gettime(CLOCK_REALTIME, &now);
+    sls_time_ns_t now = sls_time_realtime_ns();
 
-    double time_since_tx = sls_time_diff(&g_telem_state.last_transmission, &now);
+    double time_since_tx = sls_time_to_seconds(now - g_telem_state->last_transmission_ns);
 
     // Generate communication telemetry
     telemetry_point_t comm_telem[] = {
         {.id = 3001,
          .type = SENSOR_FLOW_RATE,
-         .value = (double)g_telem_state.packets_sent,
+         .value = (double)g_telem_state->packets_sent,
          .min_value = 0.0,
          .max_value = 1000000.0,
          .valid = true,
          .quality = 100},
         {.id = 3002,
          .type = SENSOR_FLOW_RATE,
-         .value = (double)g_telem_state.bytes_transmitted,
+         .value = (double)g_telem_state->bytes_transmitted,
          .min_value = 0.0,
          .max_value = 1000000000.0,
          .valid = true,
@@ -350,19 +406,19 @@ static void update_communication_status(void)
     strcpy(comm_telem[2].name, "Comm_TimeSinceLastTx");
     strcpy(comm_telem[2].units, "s");
 
-    clock_gettime(CLOCK_REALTIME, &now);
+    now = sls_time_realtime_ns();
     for (int i = 0; i < 3; i++)
     {
-        comm_telem[i].timestamp = now;
+        comm_telem[i].timestamp_ns = now;
     }
 
     // Add to buffer if space available
-    for (int i = 0; i < 3 && g_telem_state.buffer_count < MAX_TELEMETRY_POINTS; i++)
+    for (int i = 0; i < 3 && g_telem_state->buffer_count < g_telem_history_len; i++)
     {
-        g_telem_state.telemetry_buffer[g_telem_state.buffer_count] = comm_telem[i];
-        g_telem_state.buffer_count++;
+        g_telem_history[g_telem_state->buffer_count] = comm_telem[i];
+        g_telem_state->buffer_count++;
 
-        if (g_telem_state.logging_enabled)
+        if (g_telem_state->logging_enabled)
         {
             log_telemetry_to_file(&comm_telem[i]);
         }
@@ -7,11 +7,33 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <errno.h>
 #include <time.h>
+#include <pthread.h>
+#include <math.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 
 #include "../src/common/sls_types.h"
 #include "../src/common/sls_utils.h"
 #include "../src/common/sls_logging.h"
+#include "../src/common/cmd_protocol.h"
+#include "../src/common/sls_cmd_queue.h"
+#include "../src/common/cmd_trace.h"
+#include "../src/common/sim_proto.h"
+#include "../src/common/cmd_mailbox.h"
+#include "../src/common/cmd_server.h"
+#include "../src/common/qnx_mock.h"
+#include "../src/common/telem_ring.h"
+#include "../src/common/telem_shm.h"
+#include "../src/common/sls_config_loader.h"
+#include "../src/common/sls_mission_config.h"
+#include "../src/common/sls_trace.h"
+#include "../src/common/sls_metrics.h"
+#include "../src/common/sls_alloc.h"
 
 // Test counter
 static int tests_run = 0;
@@ -54,6 +76,49 @@ int test_time_utilities()
     return 1;
 }
 
+// Integer nanosecond time: epoch-scale precision, negative values, conversions
+int test_ns_timestamps()
+{
+    // One nanosecond apart at a 2023 CLOCK_REALTIME value; doubles lose this
+    struct timespec a = {1700000000, 123456789};
+    struct timespec b = {1700000000, 123456790};
+    if (sls_time_from_timespec(&b) - sls_time_from_timespec(&a) != 1)
+        return 0;
+    if (sls_time_diff(&a, &b) != 1e-9)
+        return 0;
+
+    // Negative milliseconds borrow from tv_sec
+    struct timespec ts = {10, 100000000};
+    sls_time_add_ms(&ts, -250);
+    if (ts.tv_sec != 9 || ts.tv_nsec != 850000000)
+        return 0;
+    sls_time_add_ms(&ts, 1150);
+    if (ts.tv_sec != 11 || ts.tv_nsec != 0)
+        return 0;
+
+    // Negative times split with a non-negative tv_nsec
+    sls_time_to_timespec(-1, &ts);
+    if (ts.tv_sec != -1 || ts.tv_nsec != 999999999)
+        return 0;
+    sls_double_to_time(-0.25, &ts);
+    if (ts.tv_sec != -1 || ts.tv_nsec != 750000000)
+        return 0;
+
+    if (sls_time_from_seconds(0.1) != 100000000 || sls_time_from_seconds(-2.5) != -2500000000LL)
+        return 0;
+    if (sls_time_to_seconds(1500 * SLS_NS_PER_MS) != 1.5)
+        return 0;
+
+    sls_time_ns_t t0 = sls_time_monotonic_ns();
+    sls_time_sleep_ns(SLS_NS_PER_MS);
+    sls_time_sleep_ns(-SLS_NS_PER_SEC); // returns at once
+    sls_time_ns_t t1 = sls_time_monotonic_ns();
+    if (t1 - t0 < SLS_NS_PER_MS || t1 - t0 > SLS_NS_PER_SEC)
+        return 0;
+
+    return sizeof(((telemetry_point_t *)0)->timestamp_ns) == 8;
+}
+
 // Test data validation
 int test_telemetry_validation()
 {
@@ -64,7 +129,7 @@ int test_telemetry_validation()
         .max_value = 100.0,
         .valid = true,
         .quality = 100};
-    clock_gettime(CLOCK_REALTIME, &valid_point.timestamp);
+    valid_point.timestamp_ns = sls_time_realtime_ns();
 
     if (!sls_validate_telemetry_point(&valid_point))
         return 0;
@@ -79,6 +144,54 @@ int test_telemetry_validation()
     return 1;
 }
 
+// Batch validation: both mask words, the scalar tail, every rejection reason
+int test_telemetry_batch_validation()
+{
+    enum { N = 70 };
+    double values[N], min_values[N], max_values[N];
+    sls_time_ns_t timestamps[N];
+    uint64_t mask[2] = {~0ull, ~0ull};
+    const sls_time_ns_t now = 1700000000LL * SLS_NS_PER_SEC;
+
+    uint64_t expected[2] = {0, 0};
+    for (int i = 0; i < N; i++)
+    {
+        values[i] = 50.0;
+        min_values[i] = 0.0;
+        max_values[i] = 100.0;
+        timestamps[i] = now - 1000000;
+        switch (i % 7)
+        {
+        case 1: values[i] = 150.0; break;
+        case 2: values[i] = -1.0; break;
+        case 3: values[i] = NAN; break;
+        case 4: timestamps[i] = now - SLS_TELEMETRY_MAX_AGE_NS - 1; break;
+        case 5: timestamps[i] = now + SLS_TELEMETRY_MAX_LEAD_NS + 1; break;
+        case 6: values[i] = 100.0; timestamps[i] = now - SLS_TELEMETRY_MAX_AGE_NS; break;
+        default: break;
+        }
+        if (i % 7 == 0 || i % 7 == 6)
+            expected[i / 64] |= 1ull << (i % 64);
+    }
+
+    size_t valid = sls_validate_telemetry_batch(values, min_values, max_values, timestamps, N,
+                                                now, mask);
+    if (mask[0] != expected[0] || mask[1] != expected[1])
+        return 0;
+    if (valid != (size_t)(__builtin_popcountll(expected[0]) + __builtin_popcountll(expected[1])))
+        return 0;
+
+    // Extreme timestamps: the age wraps (INT64_MAX - INT64_MIN is -1) the same
+    // way in the vector lanes (points 0-3) and in the scalar tail (points 4-5)
+    const sls_time_ns_t early = INT64_MIN + 2 * SLS_NS_PER_SEC; // 2 s ahead once wrapped
+    sls_time_ns_t extremes[6] = {INT64_MIN, INT64_MAX - 1000, early, INT64_MAX, INT64_MIN, early};
+    for (int i = 0; i < 6; i++)
+        values[i] = 50.0;
+    valid = sls_validate_telemetry_batch(values, min_values, max_values, extremes, 6, INT64_MAX,
+                                         mask);
+    return mask[0] == 0x1b && valid == 4;
+}
+
 // Test math utilities
 int test_math_utilities()
 {
@@ -165,6 +278,947 @@ int test_vehicle_state_validation()
     return 1;
 }
 
+// Test command line parsing and reply formatting
+int test_command_parsing()
+{
+    cmd_request_t req;
+    char out[256];
+
+    const char *line = "{ \"id\": 7, \"cmd\": \"set_throttle\", \"value\": 60, \"note\": \"go\" }";
+    if (cmd_parse_request(line, strlen(line), &req) != CMD_PARSE_OK)
+        return 0;
+    if (req.type != CMD_REQ_SET_THROTTLE || req.value != 60 || req.id != 7)
+        return 0;
+
+    // Only the "cmd" field selects the command
+    line = "{\"cmd\":\"nogo\"}";
+    if (cmd_parse_request(line, strlen(line), &req) != CMD_PARSE_OK || req.type != CMD_REQ_NOGO)
+        return 0;
+
+    line = "{\"cmd\":\"set_throttle\"}";
+    if (cmd_parse_request(line, strlen(line), &req) != CMD_PARSE_MISSING_VALUE)
+        return 0;
+
+    line = "{\"cmd\":\"go\",}";
+    if (cmd_parse_request(line, strlen(line), &req) != CMD_PARSE_MALFORMED)
+        return 0;
+
+    line = "{\"cmd\":\"launch\"}";
+    if (cmd_parse_request(line, strlen(line), &req) != CMD_PARSE_UNKNOWN_CMD)
+        return 0;
+
+    req.type = CMD_REQ_SET_THROTTLE;
+    req.fields = CMD_FIELD_VALUE | CMD_FIELD_ID;
+    req.value = 75;
+    req.id = 12;
+    if (cmd_format_ack(out, sizeof(out), &req) < 0)
+        return 0;
+    if (strcmp(out, "{\"type\":\"ack\",\"cmd\":\"set_throttle\",\"id\":12,\"value\":75}\n") != 0)
+        return 0;
+
+    // Replies that do not fit are reported, not truncated silently
+    if (cmd_format_ack(out, 8, &req) != -1)
+        return 0;
+
+    return 1;
+}
+
+// Test subscription requests and telemetry stream frames
+int test_stream_frames()
+{
+    cmd_request_t req;
+    char out[256];
+    double values[CMD_CH_COUNT] = {0};
+
+    const char *line = "{\"cmd\":\"subscribe\",\"channels\":[\"altitude\",\"fuel\"],\"rate_hz\":10,\"mode\":\"binary\"}";
+    if (cmd_parse_request(line, strlen(line), &req) != CMD_PARSE_OK)
+        return 0;
+    if (req.type != CMD_REQ_SUBSCRIBE || req.rate_hz != 10 || req.mode != CMD_STREAM_BINARY)
+        return 0;
+    if (req.channels != ((1u << CMD_CH_ALTITUDE) | (1u << CMD_CH_FUEL)))
+        return 0;
+
+    line = "{\"cmd\":\"subscribe\",\"channels\":[\"altitude\",\"warp\"]}";
+    if (cmd_parse_request(line, strlen(line), &req) != CMD_PARSE_UNKNOWN_CHANNEL)
+        return 0;
+
+    values[CMD_CH_ALTITUDE] = 1500.25;
+    values[CMD_CH_FUEL] = 88.5;
+    uint32_t mask = (1u << CMD_CH_ALTITUDE) | (1u << CMD_CH_FUEL);
+
+    if (cmd_format_frame_json(out, sizeof(out), 9, mask, values) < 0)
+        return 0;
+    if (strcmp(out, "{\"type\":\"telemetry\",\"seq\":9,\"altitude\":1500.250,\"fuel\":88.500}\n") != 0)
+        return 0;
+
+    // Header, seq, mask and two little-endian doubles
+    int len = cmd_format_frame_binary(out, sizeof(out), 9, mask, values);
+    if (len != CMD_FRAME_HEADER_SZ + 8 + 16 || (unsigned char)out[0] != CMD_FRAME_MAGIC)
+        return 0;
+    if ((unsigned char)out[1] != 24 || out[2] != 0 || out[3] != 9)
+        return 0;
+
+    return 1;
+}
+
+// Test command queue ordering and capacity
+#define QUEUE_TEST_PRODUCERS 2
+#define QUEUE_TEST_PER_PRODUCER 20000
+
+static sls_cmd_queue_t g_test_queue;
+
+static void *queue_test_producer(void *arg)
+{
+    int producer = (int)(intptr_t)arg;
+    command_t cmd;
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.target_subsystem = (subsystem_type_t)producer;
+
+    for (uint32_t i = 1; i <= QUEUE_TEST_PER_PRODUCER; i++)
+    {
+        cmd.command_id = i;
+        while (sls_cmd_queue_push(&g_test_queue, &cmd) != 0)
+        {
+            // Full; wait for the consumer
+        }
+    }
+    return NULL;
+}
+
+int test_command_queue()
+{
+    command_t cmd;
+    memset(&cmd, 0, sizeof(cmd));
+    sls_cmd_queue_init(&g_test_queue);
+
+    // Bounded: capacity pushes succeed, the next is rejected
+    for (int i = 0; i < SLS_CMD_QUEUE_CAPACITY; i++)
+    {
+        cmd.command_id = (uint32_t)i;
+        if (sls_cmd_queue_push(&g_test_queue, &cmd) != 0)
+            return 0;
+    }
+    if (sls_cmd_queue_push(&g_test_queue, &cmd) == 0)
+        return 0;
+    for (int i = 0; i < SLS_CMD_QUEUE_CAPACITY; i++)
+    {
+        if (!sls_cmd_queue_pop(&g_test_queue, &cmd) || cmd.command_id != (uint32_t)i)
+            return 0;
+    }
+    if (sls_cmd_queue_pop(&g_test_queue, &cmd))
+        return 0;
+
+    // Concurrent producers: nothing lost, each producer's commands in order
+    pthread_t threads[QUEUE_TEST_PRODUCERS];
+    uint32_t last_seen[QUEUE_TEST_PRODUCERS] = {0};
+    for (int p = 0; p < QUEUE_TEST_PRODUCERS; p++)
+        pthread_create(&threads[p], NULL, queue_test_producer, (void *)(intptr_t)p);
+
+    int received = 0;
+    int ordered = 1;
+    while (received < QUEUE_TEST_PRODUCERS * QUEUE_TEST_PER_PRODUCER)
+    {
+        if (!sls_cmd_queue_pop(&g_test_queue, &cmd))
+            continue;
+        int p = (int)cmd.target_subsystem;
+        if (cmd.command_id != last_seen[p] + 1)
+            ordered = 0;
+        last_seen[p] = cmd.command_id;
+        received++;
+    }
+    for (int p = 0; p < QUEUE_TEST_PRODUCERS; p++)
+        pthread_join(threads[p], NULL);
+
+    // Submitted commands get increasing sequence numbers
+    uint32_t seq1 = sls_cmd_submit(SUBSYS_THERMAL, CMD_OP_SET_THROTTLE, 10.0);
+    uint32_t seq2 = sls_cmd_submit(SUBSYS_THERMAL, CMD_OP_SET_THROTTLE, 20.0);
+    if (seq1 == 0 || seq2 <= seq1)
+        return 0;
+    if (!sls_cmd_queue_pop(sls_cmd_queue_for(SUBSYS_THERMAL), &cmd) || cmd.command_id != seq1)
+        return 0;
+    sls_cmd_acknowledge(&cmd);
+
+    sls_cmd_queue_stats_t stats;
+    sls_cmd_queue_get_stats(sls_cmd_queue_for(SUBSYS_THERMAL), &stats);
+    if (stats.submitted != 2 || stats.acknowledged != 1)
+        return 0;
+
+    return ordered;
+}
+
+// Test command latency trace histograms
+int test_command_latency_trace()
+{
+    command_t cmd;
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.opcode = CMD_OP_SET_THROTTLE;
+    cmd_trace_reset();
+
+    // 99 fast commands (~1 us end to end) and one slow one (~1 ms)
+    for (int i = 0; i < 100; i++)
+    {
+        uint64_t base = 1000000 + (uint64_t)i * 10000;
+        uint64_t pickup_delay = (i == 99) ? 1000000 : 500;
+        cmd.stage_ns[CMD_STAGE_RECV] = base;
+        cmd.stage_ns[CMD_STAGE_PARSE] = base + 200;
+        cmd.stage_ns[CMD_STAGE_ENQUEUE] = base + 300;
+        cmd.stage_ns[CMD_STAGE_PICKUP] = base + 300 + pickup_delay;
+        cmd.stage_ns[CMD_STAGE_EFFECT] = cmd.stage_ns[CMD_STAGE_PICKUP] + 100;
+        cmd_trace_record(&cmd);
+    }
+
+    if (cmd_trace_count(CMD_OP_SET_THROTTLE) != 100 || cmd_trace_count(CMD_OP_ABORT) != 0)
+        return 0;
+
+    // Percentiles report the upper bound of the log2 bucket, capped at the max
+    if (cmd_trace_percentile_ns(CMD_OP_SET_THROTTLE, CMD_SEG_PARSE, 50.0) != 200)
+        return 0;
+    if (cmd_trace_percentile_ns(CMD_OP_SET_THROTTLE, CMD_SEG_TOTAL, 50.0) != 1023)
+        return 0;
+    if (cmd_trace_percentile_ns(CMD_OP_SET_THROTTLE, CMD_SEG_TOTAL, 100.0) < 1000000)
+        return 0;
+    if (cmd_trace_max_ns(CMD_OP_SET_THROTTLE, CMD_SEG_PICKUP) != 1000000)
+        return 0;
+
+    char out[2048];
+    if (cmd_trace_format_json(out, sizeof(out), NULL) < 0 || !strstr(out, "\"set_throttle\":{\"count\":100"))
+        return 0;
+
+    return 1;
+}
+
+// Test binary command record encoding
+int test_sim_wire_format()
+{
+    uint8_t buf[SIM_REPLY_WIRE_SZ];
+    sim_msg_t msg = {CMD_SET_THROTTLE, 0x01020304};
+    sim_msg_t decoded;
+
+    // Little-endian regardless of host byte order
+    sim_msg_encode(&msg, buf);
+    if (buf[0] != 5 || buf[1] != 0 || buf[4] != 0x04 || buf[7] != 0x01)
+        return 0;
+    sim_msg_decode(buf, &decoded);
+    if (decoded.type != CMD_SET_THROTTLE || decoded.value != 0x01020304)
+        return 0;
+
+    sim_reply_t reply = {1, 0, -1};
+    sim_reply_t reply_out;
+    sim_reply_encode(&reply, buf);
+    if (buf[8] != 0xFF || buf[11] != 0xFF)
+        return 0;
+    sim_reply_decode(buf, &reply_out);
+    if (reply_out.ok != 1 || reply_out.mission_go != 0 || reply_out.throttle != -1)
+        return 0;
+
+    return 1;
+}
+
+static void echo_mailbox_handler(const sim_msg_t *req, sim_reply_t *rep)
+{
+    rep->ok = req->type == CMD_SET_THROTTLE;
+    rep->mission_go = 0;
+    rep->throttle = req->value;
+}
+
+// Test shared-memory mailbox round trips and state snapshots
+int test_command_mailbox()
+{
+    if (cmd_mailbox_server_start(echo_mailbox_handler) != 0)
+        return 0;
+
+    cmd_mailbox_state_t state = {0};
+    state.seq = 7;
+    state.throttle = 55;
+    state.channels[CMD_CH_ALTITUDE] = 1234.5;
+    cmd_mailbox_publish_state(&state);
+
+    cmd_mailbox_client_t client;
+    int ok = cmd_mailbox_open(&client) == 0;
+    for (int i = 0; ok && i < 100; i++)
+    {
+        sim_msg_t msg = {CMD_SET_THROTTLE, i};
+        sim_reply_t reply;
+        ok = cmd_mailbox_call(&client, &msg, &reply, 1000) == 0 &&
+             reply.ok == 1 && reply.throttle == i;
+    }
+
+    cmd_mailbox_state_t read_back;
+    if (ok)
+        ok = cmd_mailbox_read_state(&client, &read_back) == 0 &&
+             read_back.seq == 7 && read_back.throttle == 55 &&
+             read_back.channels[CMD_CH_ALTITUDE] == 1234.5;
+
+    cmd_mailbox_close(&client);
+    cmd_mailbox_server_stop();
+    return ok;
+}
+
+static int connect_cmd_unix(void)
+{
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+    strncpy(addr.sun_path, "/tmp/sls_cmd.sock", sizeof(addr.sun_path) - 1);
+    for (int attempt = 0; attempt < 100; attempt++)
+    {
+        int fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+        if (fd >= 0 && connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0)
+        {
+            struct timeval timeout = {.tv_sec = 2}; // a lost reply fails, not hangs
+            setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            return fd;
+        }
+        if (fd >= 0)
+            close(fd);
+        usleep(10000);
+    }
+    return -1;
+}
+
+// Seqpacket messages are handled whole: unterminated lines, several lines
+// per message, and oversized messages rejected with a reply per record
+int test_command_unix_seqpacket()
+{
+    if (cmd_server_start() != 0)
+        return 0;
+    int ok = 0;
+    char reply[4096];
+    int fd = connect_cmd_unix();
+    if (fd >= 0)
+    {
+        const char two[] = "{\"cmd\":\"status\"}\n{\"cmd\":\"status\"}";
+        ssize_t n1, n2, n3;
+        char big[3000];
+        memset(big, 'x', sizeof(big));
+        ok = send(fd, two, sizeof(two) - 1, 0) > 0 &&
+             (n1 = recv(fd, reply, sizeof(reply), 0)) > 0 &&
+             strncmp(reply, "{\"type\":\"status\"", 16) == 0 &&
+             (n2 = recv(fd, reply, sizeof(reply), 0)) == n1 &&
+             send(fd, big, sizeof(big), 0) == (ssize_t)sizeof(big) &&
+             (n3 = recv(fd, reply, sizeof(reply) - 1, 0)) > 0;
+        if (ok)
+        {
+            reply[n3] = '\0';
+            ok = strstr(reply, "message too long") != NULL;
+        }
+        close(fd);
+    }
+
+    // 300 binary records (2400 bytes) exceed one message: 300 failed replies
+    fd = ok ? connect_cmd_unix() : -1;
+    if (fd >= 0)
+    {
+        enum { NREC = 300 };
+        static uint8_t batch[NREC * SIM_MSG_WIRE_SZ];
+        uint8_t magic = SIM_WIRE_MAGIC;
+        sim_msg_t msg = {CMD_STATUS, 0};
+        for (int i = 0; i < NREC; i++)
+            sim_msg_encode(&msg, batch + i * SIM_MSG_WIRE_SZ);
+        ok = send(fd, &magic, 1, 0) == 1 && recv(fd, &magic, 1, 0) == 1 &&
+             magic == SIM_WIRE_MAGIC && send(fd, batch, sizeof(batch), 0) > 0;
+
+        size_t got = 0;
+        int failed = 0;
+        while (ok && got < NREC * SIM_REPLY_WIRE_SZ)
+        {
+            ssize_t n = recv(fd, reply, sizeof(reply), 0);
+            ok = n > 0 && n % SIM_REPLY_WIRE_SZ == 0;
+            for (ssize_t k = 0; ok && k < n; k += SIM_REPLY_WIRE_SZ)
+            {
+                sim_reply_t r;
+                sim_reply_decode((const uint8_t *)reply + k, &r);
+                failed += r.ok == 0;
+            }
+            got += ok ? (size_t)n : 0;
+        }
+        ok = ok && failed == NREC;
+
+        // A batch that fits is executed; a trailing partial record fails
+        if (ok)
+        {
+            sim_reply_t r0, r1;
+            ok = send(fd, batch, 2 * SIM_MSG_WIRE_SZ + 3, 0) > 0 &&
+                 recv(fd, reply, sizeof(reply), 0) == 2 * SIM_REPLY_WIRE_SZ &&
+                 recv(fd, reply + 2 * SIM_REPLY_WIRE_SZ, SIM_REPLY_WIRE_SZ, 0) ==
+                     SIM_REPLY_WIRE_SZ;
+            sim_reply_decode((const uint8_t *)reply, &r0);
+            sim_reply_decode((const uint8_t *)reply + 2 * SIM_REPLY_WIRE_SZ, &r1);
+            ok = ok && r0.ok == 1 && r1.ok == 0;
+        }
+        close(fd);
+    }
+    cmd_server_stop();
+    return ok;
+}
+
+// Server side of test_qnx_message_passing: replies value * 2, rejects
+// negative values with MsgError, stops after a pulse with code 1
+static void *qnx_echo_server(void *arg)
+{
+    int chid = *(int *)arg;
+    for (;;)
+    {
+        union
+        {
+            sim_msg_t msg;
+            struct _pulse pulse;
+        } buf;
+        int rcvid = MsgReceive(chid, &buf, sizeof(buf), NULL);
+        if (rcvid == -1)
+            return NULL;
+        if (rcvid == 0)
+        {
+            if (buf.pulse.code == 1)
+                return (void *)(intptr_t)buf.pulse.value.sival_int;
+            continue;
+        }
+        if (buf.msg.value < 0)
+        {
+            MsgError(rcvid, EINVAL);
+            continue;
+        }
+        sim_reply_t reply = {1, 0, buf.msg.value * 2};
+        MsgReply(rcvid, 7, &reply, sizeof(reply));
+    }
+}
+
+// Test the Linux stand-in for QNX send/receive/reply, pulses and names
+int test_qnx_message_passing()
+{
+    setenv(QNX_MOCK_NAMESPACE_ENV, "/tmp/sls_test_names", 1);
+    name_attach_t *attach = name_attach(NULL, "sls_test_srv", 0);
+    if (!attach)
+        return 0;
+    if (name_attach(NULL, "sls_test_srv", 0) != NULL || errno != EEXIST)
+        return 0;
+
+    pthread_t server;
+    pthread_create(&server, NULL, qnx_echo_server, &attach->chid);
+
+    int ok = 1;
+    int coid = name_open("sls_test_srv", 0);
+    if (coid == -1)
+        ok = 0;
+    for (int i = 0; ok && i < 50; i++)
+    {
+        sim_msg_t msg = {CMD_SET_THROTTLE, i};
+        sim_reply_t reply = {0};
+        ok = MsgSend(coid, &msg, sizeof(msg), &reply, sizeof(reply)) == 7 &&
+             reply.ok == 1 && reply.throttle == i * 2;
+    }
+
+    sim_msg_t bad = {CMD_SET_THROTTLE, -1};
+    sim_reply_t reply;
+    if (ok)
+        ok = MsgSend(coid, &bad, sizeof(bad), &reply, sizeof(reply)) == -1 && errno == EINVAL;
+
+    void *pulse_value = NULL;
+    if (ok)
+        ok = MsgSendPulse(coid, SIGEV_PULSE_PRIO_INHERIT, 1, 42) == 0;
+    pthread_join(server, &pulse_value);
+    if ((intptr_t)pulse_value != 42)
+        ok = 0;
+
+    name_close(coid);
+    name_detach(attach, 0);
+    if (name_open("sls_test_srv", 0) != -1)
+        ok = 0;
+    return ok;
+}
+
+// Test telemetry ring: independent readers, small reads, overrun recovery
+int test_telemetry_ring()
+{
+    static telem_ring_t ring;
+    static char expect[4096], got_a[4096], got_b[4096];
+    telem_ring_init(&ring);
+
+    telem_cursor_t a, b;
+    telem_cursor_init(&ring, &a, 1);
+    telem_cursor_init(&ring, &b, 1);
+    if (telem_ring_read(&ring, &a, got_a, sizeof(got_a)) != 0)
+        return 0;
+    if (telem_ring_append(&ring, "", 0) == 0)
+        return 0;
+
+    size_t len = 0;
+    for (int i = 0; i < 20; i++)
+    {
+        char line[32];
+        int n = snprintf(line, sizeof(line), "t=%d,alt=%d\n", i, i * 100);
+        if (telem_ring_append(&ring, line, (size_t)n) != 0)
+            return 0;
+        memcpy(expect + len, line, (size_t)n);
+        len += (size_t)n;
+    }
+
+    // One large read and many 7-byte reads both see every byte once
+    if (telem_ring_read(&ring, &a, got_a, sizeof(got_a)) != len || memcmp(got_a, expect, len) != 0)
+        return 0;
+    size_t got = 0, n;
+    while ((n = telem_ring_read(&ring, &b, got_b + got, 7)) > 0)
+        got += n;
+    if (got != len || memcmp(got_b, expect, len) != 0 || a.lost != 0 || b.lost != 0)
+        return 0;
+
+    // Fall far behind: the reader skips to intact records and counts the rest
+    const int total = 3 * TELEM_RING_RECORDS;
+    for (int i = 0; i < total; i++)
+    {
+        char line[32];
+        int len_i = snprintf(line, sizeof(line), "seq=%d\n", i);
+        telem_ring_append(&ring, line, (size_t)len_i);
+    }
+    int lines = 0, last = -1;
+    char chunk[64];
+    size_t have = 0;
+    while ((n = telem_ring_read(&ring, &a, chunk + have, sizeof(chunk) - 1 - have)) > 0)
+    {
+        have += n;
+        chunk[have] = '\0';
+        char *nl;
+        while ((nl = strchr(chunk, '\n')) != NULL)
+        {
+            int seq;
+            if (sscanf(chunk, "seq=%d", &seq) != 1 || (last >= 0 && seq != last + 1))
+                return 0;
+            last = seq;
+            lines++;
+            have -= (size_t)(nl + 1 - chunk);
+            memmove(chunk, nl + 1, have + 1);
+        }
+    }
+    return last == total - 1 && a.lost > 0 && (int)a.lost + lines == total &&
+           telem_ring_pending(&ring, &a) == 0;
+}
+
+// Test zero-copy spans: two segments across the end of the data area
+int test_telemetry_ring_span()
+{
+    static telem_ring_t ring;
+    static char copied[8192], spanned[8192];
+    telem_ring_init(&ring);
+
+    char rec[100];
+    memset(rec, 'x', sizeof(rec));
+    rec[sizeof(rec) - 1] = '\n';
+    telem_cursor_t a, b;
+    int before_wrap = TELEM_RING_DATA_SIZE / (int)sizeof(rec);
+    for (int i = 0; i < before_wrap + 20; i++)
+    {
+        if (i == before_wrap - 20)
+        {
+            telem_cursor_init(&ring, &a, 0);
+            b = a;
+        }
+        rec[0] = (char)('A' + i % 26);
+        telem_ring_append(&ring, rec, sizeof(rec));
+    }
+
+    telem_ring_span_t span;
+    if (telem_ring_peek(&ring, &a, sizeof(spanned), TELEM_RING_DATA_SIZE, &span) != 0)
+        return 0; // too close to the writer for that much slack
+    size_t n = telem_ring_peek(&ring, &a, sizeof(spanned), 1024, &span);
+    if (n != 40 * sizeof(rec) || span.nseg != 2)
+        return 0;
+    memcpy(spanned, span.seg[0].base, span.seg[0].len);
+    memcpy(spanned + span.seg[0].len, span.seg[1].base, span.seg[1].len);
+    if (telem_ring_commit(&ring, &a, &span) != 0 || telem_ring_pending(&ring, &a) != 0)
+        return 0;
+    return telem_ring_read(&ring, &b, copied, sizeof(copied)) == n && memcmp(copied, spanned, n) == 0;
+}
+
+// Test shared-memory telemetry export: latest values, history, layout checks
+int test_telemetry_shm()
+{
+    static const telem_shm_channel_t channels[] = {{"altitude", "m"}, {"velocity", "m/s"}};
+    telem_shm_t writer, reader;
+    if (telem_shm_create(&writer, "/sls_test_telemetry", channels, 2) != 0)
+        return 0;
+    if (telem_shm_open(&reader, "/sls_test_telemetry") != 0)
+    {
+        telem_shm_close(&writer);
+        return 0;
+    }
+
+    for (int i = 0; i < TELEM_SHM_HISTORY + 10; i++)
+    {
+        double values[2] = {i * 10.0, i * 0.5};
+        telem_shm_publish(&writer, values, 1000 + i);
+    }
+
+    int ok = telem_shm_find(&reader, "velocity") == 1 && telem_shm_find(&reader, "mass") == -1;
+    double value = 0;
+    int64_t ts = 0;
+    ok = ok && telem_shm_read(&reader, 0, &value, &ts) == 0 &&
+         value == (TELEM_SHM_HISTORY + 9) * 10.0 && ts == 1000 + TELEM_SHM_HISTORY + 9;
+    ok = ok && telem_shm_read(&reader, 2, &value, NULL) == -1 && errno == EINVAL;
+
+    // A writer that died mid-update leaves seq odd: the read gives up
+    atomic_fetch_add(&writer.values[1].seq, 1);
+    ok = ok && telem_shm_read(&reader, 1, &value, NULL) == -1 && errno == EAGAIN;
+    atomic_fetch_add(&writer.values[1].seq, 1);
+    ok = ok && telem_shm_read(&reader, 1, &value, NULL) == 0;
+
+    telem_shm_sample_t sample;
+    uint64_t head = telem_shm_history_head(&reader);
+    ok = ok && head == TELEM_SHM_HISTORY + 10;
+    ok = ok && telem_shm_history_get(&reader, head - 1, &sample) == 0 &&
+         sample.values[1] == (TELEM_SHM_HISTORY + 9) * 0.5;
+    ok = ok && telem_shm_history_get(&reader, 5, &sample) == -1; // overwritten
+    ok = ok && telem_shm_history_get(&reader, head, &sample) == -1; // not yet
+
+    telem_shm_close(&reader);
+    telem_shm_close(&writer);
+    ok = ok && telem_shm_open(&reader, "/sls_test_telemetry") == -1;
+    return ok;
+}
+
+// Test telemetry records: compact, and formatted exactly like the old text lines
+int test_telemetry_record_format()
+{
+    if (sizeof(sim_telem_record_t) != 32)
+        return 0;
+
+    // The last pair is beyond what int32 centimetres hold
+    static const double alt[] = {0.0, 12.34, 1234567.89, 0.005, 250000000.25};
+    static const double vel[] = {0.0, -3.21, 812.5, -0.01, -30000000.5};
+    for (int i = 0; i < 5; i++)
+    {
+        sim_telem_record_t rec = {.timestamp_ns = 1691000000123456789LL + i,
+                                  .altitude_cm = (int64_t)llround(alt[i] * 100.0),
+                                  .velocity_cms = (int64_t)llround(vel[i] * 100.0),
+                                  .throttle = 70,
+                                  .mission_go = 1};
+        char line[SIM_TELEM_LINE_MAX], legacy[SIM_TELEM_LINE_MAX];
+        int n = sim_telem_format(&rec, line, sizeof(line));
+        snprintf(legacy, sizeof(legacy), "%ld.%03ld,alt=%.2f,vel=%.2f,thr=%d,go=%d\n",
+                 1691000000L, 123L, alt[i], vel[i], 70, 1);
+        if (n != (int)strlen(legacy) || strcmp(line, legacy) != 0)
+            return 0;
+    }
+    return 1;
+}
+
+// Test configuration loader and handle reload
+int test_config_loader()
+{
+    const char *path = "/tmp/sls_test_config.conf";
+    FILE *f = fopen(path, "w");
+    if (!f)
+        return 0;
+    fprintf(f, "# test\n[system]\nreal_time_factor = 2.5\nname = sim one\n"
+               "[safety]\nabort_enabled = yes\nmax_g = 4\nbogus line\nmax_g = 010\n");
+    fclose(f);
+
+    if (sls_config_load(path) != 4)
+        return 0;
+    if (sls_get_config_int("safety.max_g", 0) != 10 ||
+        sls_get_config_int("safety.abort_enabled", 0) != 1)
+        return 0;
+    if (fabs(sls_get_config_double("system.real_time_factor", 0.0) - 2.5) > 1e-9)
+        return 0;
+    if (strcmp(sls_get_config_string("system.name", ""), "sim one") != 0)
+        return 0;
+    if (sls_get_config_int("system.missing", -7) != -7 || sls_config_has("name"))
+        return 0;
+
+    sls_config_handle_t h;
+    sls_config_handle_init(&h, "system.real_time_factor");
+    uint64_t gen = sls_config_generation();
+    if (fabs(sls_config_handle_double(&h, 1.0) - 2.5) > 1e-9)
+        return 0;
+
+    f = fopen(path, "w");
+    if (!f)
+        return 0;
+    fprintf(f, "[system]\nreal_time_factor = 10\n");
+    fclose(f);
+    if (sls_config_load(path) != 1 || sls_config_generation() == gen)
+        return 0;
+    int ok = sls_config_handle_int(&h, 0) == 10 && !sls_config_has("safety.max_g") &&
+             sls_config_load("/tmp/sls_no_such_config.conf") < 0 &&
+             sls_config_handle_int(&h, 0) == 10;
+
+    sls_config_unload();
+    unlink(path);
+    return ok && sls_config_handle_int(&h, 3) == 3;
+}
+
+// Test config-driven subsystem table and mission timeline
+int test_mission_timeline()
+{
+    const char *path = "/tmp/sls_test_timeline.conf";
+    FILE *f = fopen(path, "w");
+    if (!f)
+        return 0;
+    fprintf(f, "[timeline]\nascent = 20\nliftoff = 0\n"
+               "[subsystem.thermal]\nenabled = false\n"
+               "[subsystem.navigation]\nrate_hz = 0\npriority = critical\n");
+    fclose(f);
+    int loaded = sls_config_load(path);
+    sls_mission_config_load();
+    sls_config_unload();
+    unlink(path);
+    if (loaded != 5)
+        return 0;
+
+    int n;
+    const subsystem_config_t *subs = sls_subsystem_table(&n);
+    if (n != 7)
+        return 0;
+    for (int i = 0; i < n; i++)
+    {
+        if (subs[i].type == SUBSYS_THERMAL)
+            return 0;
+        if (subs[i].type == SUBSYS_NAVIGATION &&
+            (subs[i].update_rate_hz != 20 || subs[i].priority != PRIORITY_CRITICAL))
+            return 0;
+    }
+
+    const phase_config_t *phases = sls_mission_timeline(&n);
+    for (int i = 1; i < n; i++)
+    {
+        if (phases[i].start_time < phases[i - 1].start_time)
+            return 0;
+    }
+
+    sls_timeline_cursor_t cur;
+    sls_timeline_cursor_init(&cur);
+    static const struct
+    {
+        double t;
+        mission_phase_t phase;
+    } steps[] = {{-8000.0, PHASE_UNKNOWN},  {-7200.0, PHASE_PRELAUNCH},
+                 {-6.0, PHASE_IGNITION},    {19.99, PHASE_LIFTOFF},
+                 {20.0, PHASE_ASCENT},      {1000.0, PHASE_MISSION_COMPLETE},
+                 {-1.0, PHASE_IGNITION}};
+    for (size_t i = 0; i < sizeof(steps) / sizeof(steps[0]); i++)
+    {
+        if (sls_timeline_phase(&cur, steps[i].t) != steps[i].phase)
+            return 0;
+    }
+    return sls_timeline_current(&cur)->duration == 6.0;
+}
+
+static void *trace_worker(void *arg)
+{
+    (void)arg;
+    sls_set_thread_name("trace-worker");
+    for (int i = 0; i < 100; i++)
+    {
+        sls_trace_record(SLS_TRACE_BEGIN_EV, "worker_step", 0.0);
+        sls_trace_record(SLS_TRACE_END_EV, "worker_step", 0.0);
+    }
+    return NULL;
+}
+
+// Records 5 events more than a thread buffer holds
+static void *trace_overflow_worker(void *arg)
+{
+    (void)arg;
+    for (int i = 0; i < SLS_TRACE_EVENTS_PER_THREAD + 5; i++)
+        sls_trace_record(SLS_TRACE_COUNTER_EV, "overflow", (double)i);
+    return NULL;
+}
+
+// Test per-thread tracing and Chrome trace export
+int test_trace_export()
+{
+    const char *path = "/tmp/sls_test_trace.json";
+
+    sls_trace_record(SLS_TRACE_BEGIN_EV, "not_started", 0.0); // ignored by the macros only
+    sls_trace_cleanup();
+
+    sls_trace_start();
+    sls_trace_event(SLS_TRACE_BEGIN_EV, "main_step", 0.0);
+    sls_trace_event(SLS_TRACE_COUNTER_EV, "depth", 3.0);
+    sls_trace_event(SLS_TRACE_END_EV, "main_step", 0.0);
+    pthread_t worker;
+    if (pthread_create(&worker, NULL, trace_worker, NULL) != 0)
+        return 0;
+    pthread_join(worker, NULL);
+    sls_trace_stop();
+    sls_trace_event(SLS_TRACE_BEGIN_EV, "after_stop", 0.0);
+
+    long events = sls_trace_export(path);
+    uint64_t dropped = sls_trace_dropped();
+
+    // A full buffer drops and counts the excess; cleanup resets the count
+    if (pthread_create(&worker, NULL, trace_overflow_worker, NULL) != 0)
+        return 0;
+    pthread_join(worker, NULL);
+    uint64_t overflow_dropped = sls_trace_dropped();
+    sls_trace_cleanup();
+    if (events != 203 || dropped != 0 || overflow_dropped != 5 || sls_trace_dropped() != 0)
+        return 0;
+
+    FILE *f = fopen(path, "r");
+    if (!f)
+        return 0;
+    static char json[65536];
+    size_t len = fread(json, 1, sizeof(json) - 1, f);
+    json[len] = '\0';
+    fclose(f);
+    unlink(path);
+
+    int begins = 0;
+    for (const char *p = json; (p = strstr(p, "\"ph\":\"B\"")) != NULL; p++)
+        begins++;
+    return begins == 101 && strstr(json, "\"traceEvents\"") && strstr(json, "trace-worker") &&
+           strstr(json, "\"args\":{\"value\":3}") && !strstr(json, "after_stop");
+}
+
+static void *metrics_worker(void *arg)
+{
+    sls_metric_t *m = arg;
+    for (int i = 0; i < 10000; i++)
+        sls_metric_inc(m);
+    return NULL;
+}
+
+static double metrics_nan(void *arg)
+{
+    (void)arg;
+    return NAN;
+}
+
+// Test sharded metrics and the Prometheus text endpoint
+int test_metrics_registry()
+{
+    sls_metric_t *c = sls_metrics_counter("test_events_total", "kind=\"a\"", "Test events");
+    if (sls_metrics_counter("test_events_total", "kind=\"a\"", "Test events") != c)
+        return 0;
+    pthread_t workers[4];
+    for (int i = 0; i < 4; i++)
+        pthread_create(&workers[i], NULL, metrics_worker, c);
+    for (int i = 0; i < 4; i++)
+        pthread_join(workers[i], NULL);
+    if (sls_metric_value(c) != 40000.0)
+        return 0;
+
+    sls_metrics_counter("test_events_total", "kind=\"b\"", "Test events");
+    static const uint64_t bounds[] = {10, 100};
+    sls_metric_t *h = sls_metrics_histogram("test_latency_seconds", NULL, "Test latency", bounds, 2,
+                                            1e-3);
+    sls_metric_observe(h, 5);
+    sls_metric_observe(h, 50);
+    sls_metric_observe(h, 500);
+    sls_metric_set(sls_metrics_gauge("test_level", NULL, "Test gauge"), 2.5);
+    sls_metrics_callback("test_hidden", NULL, "Not reported", SLS_METRIC_GAUGE, metrics_nan,
+                         NULL);
+
+    static char text[16384];
+    size_t len = sls_metrics_render(text, sizeof(text));
+    if (len >= sizeof(text) || sls_metrics_render(NULL, 0) != len)
+        return 0;
+    if (!strstr(text, "# TYPE test_events_total counter\ntest_events_total{kind=\"a\"} 40000\n"
+                      "test_events_total{kind=\"b\"} 0\n") ||
+        !strstr(text, "test_latency_seconds_bucket{le=\"0.01\"} 1\n") ||
+        !strstr(text, "test_latency_seconds_bucket{le=\"0.1\"} 2\n") ||
+        !strstr(text, "test_latency_seconds_bucket{le=\"+Inf\"} 3\n") ||
+        !strstr(text, "test_latency_seconds_sum 0.555") ||
+        !strstr(text, "test_level 2.5\n") || strstr(text, "\ntest_hidden "))
+        return 0;
+
+    int port = 20000 + (int)(getpid() % 20000);
+    if (sls_metrics_server_start(port) != 0)
+        return 0;
+    int ok = 0;
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = {.sin_family = AF_INET,
+                               .sin_port = htons((uint16_t)port),
+                               .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+    if (fd >= 0 && connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0)
+    {
+        const char req[] = "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n";
+        send(fd, req, sizeof(req) - 1, 0);
+        static char reply[16384];
+        size_t got = 0;
+        ssize_t n;
+        while (got < sizeof(reply) - 1 &&
+               (n = recv(fd, reply + got, sizeof(reply) - 1 - got, 0)) > 0)
+            got += (size_t)n;
+        reply[got] = '\0';
+        ok = strncmp(reply, "HTTP/1.0 200 OK", 15) == 0 && strstr(reply, "test_level 2.5");
+    }
+    if (fd >= 0)
+        close(fd);
+    sls_metrics_server_stop();
+    return ok;
+}
+
+// Allocates from a control-loop thread after the seal
+static void *alloc_steady_worker(void *arg)
+{
+    (void)arg;
+    sls_alloc_steady_thread();
+    sls_free(sls_alloc(SUBSYS_TELEMETRY, 64));
+    return NULL;
+}
+
+int test_alloc_accounting()
+{
+    sls_alloc_stats_t before, after;
+    sls_alloc_get_stats(SUBSYS_NAVIGATION, &before);
+    sls_alloc_tick();
+
+    char *p = sls_alloc(SUBSYS_NAVIGATION, 100);
+    void *aligned = sls_alloc_aligned(SUBSYS_NAVIGATION, 64, 10);
+    void *startup = sls_alloc_startup(SUBSYS_NAVIGATION, 24);
+    if (!p || !aligned || !startup || ((uintptr_t)aligned % 64) != 0 ||
+        ((uintptr_t)startup % 64) != 0)
+        return 0;
+    strcpy(p, "persisted");
+    p = sls_realloc(SUBSYS_NAVIGATION, p, 4000);
+    if (!p || strcmp(p, "persisted") != 0 || sls_alloc_tick() != 4)
+        return 0;
+
+    sls_alloc_get_stats(SUBSYS_NAVIGATION, &after);
+    if (after.bytes_in_use - before.bytes_in_use != 4000 + 10 + 64 ||
+        after.frees - before.frees != 1 || after.peak_bytes < after.bytes_in_use)
+        return 0;
+    sls_free(p);
+    sls_free(aligned);
+    sls_alloc_get_stats(SUBSYS_NAVIGATION, &after);
+    if (after.bytes_in_use - before.bytes_in_use != 64 || sls_alloc_set_policy_name("bogus") == 0)
+        return 0;
+
+    // Only threads that entered their loop violate; this one never does
+    sls_alloc_get_stats(SUBSYS_TELEMETRY, &before);
+    sls_alloc_set_policy(SLS_ALLOC_POLICY_ALLOW);
+    sls_alloc_seal();
+    sls_free(sls_alloc(SUBSYS_TELEMETRY, 64));
+    pthread_t worker;
+    pthread_create(&worker, NULL, alloc_steady_worker, NULL);
+    pthread_join(worker, NULL);
+    sls_alloc_get_stats(SUBSYS_TELEMETRY, &after);
+    sls_alloc_set_policy(SLS_ALLOC_POLICY_LOG);
+    return sls_alloc_sealed() && after.after_seal - before.after_seal == 1 &&
+           after.allocations - before.allocations == 2 &&
+           after.bytes_in_use == before.bytes_in_use;
+}
+
+int test_startup_arena()
+{
+    // No lock: the test must not depend on RLIMIT_MEMLOCK
+    if (sls_alloc_arena_init(300 * 1024, false, false) != 0 ||
+        sls_alloc_arena_init(300 * 1024, false, false) == 0)
+        return 0;
+
+    sls_alloc_arena_info_t before, after;
+    sls_alloc_arena_info(&before);
+    unsigned char *a = sls_alloc_startup(SUBSYS_POWER, 1);
+    unsigned char *b = sls_alloc_startup(SUBSYS_POWER, 100);
+    sls_alloc_arena_info(&after);
+    if (before.size < 300 * 1024 || before.size % 4096 != 0 || after.used - before.used != 192 ||
+        b - a != 64 || ((uintptr_t)b % 64) != 0 || b[99] != 0)
+        return 0;
+
+    // Exhausting the arena moves to the heap rather than failing
+    unsigned char *big = sls_alloc_startup(SUBSYS_POWER, after.size);
+    return big && big[after.size - 1] == 0;
+}
+
 // Test logging system
 int test_logging_system()
 {
@@ -205,10 +1259,30 @@ int main()
 
     // Run tests
     RUN_TEST(test_time_utilities);
+    RUN_TEST(test_ns_timestamps);
     RUN_TEST(test_telemetry_validation);
+    RUN_TEST(test_telemetry_batch_validation);
     RUN_TEST(test_math_utilities);
     RUN_TEST(test_string_utilities);
     RUN_TEST(test_vehicle_state_validation);
+    RUN_TEST(test_command_parsing);
+    RUN_TEST(test_stream_frames);
+    RUN_TEST(test_command_queue);
+    RUN_TEST(test_command_latency_trace);
+    RUN_TEST(test_sim_wire_format);
+    RUN_TEST(test_command_mailbox);
+    RUN_TEST(test_command_unix_seqpacket);
+    RUN_TEST(test_qnx_message_passing);
+    RUN_TEST(test_telemetry_ring);
+    RUN_TEST(test_telemetry_ring_span);
+    RUN_TEST(test_telemetry_shm);
+    RUN_TEST(test_telemetry_record_format);
+    RUN_TEST(test_config_loader);
+    RUN_TEST(test_mission_timeline);
+    RUN_TEST(test_trace_export);
+    RUN_TEST(test_metrics_registry);
+    RUN_TEST(test_alloc_accounting);
+    RUN_TEST(test_startup_arena);
     RUN_TEST(test_logging_system);
 
     // Cleanup